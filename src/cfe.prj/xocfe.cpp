@@ -29,21 +29,111 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 static CHAR const* g_c_file_name = nullptr;
 static CHAR const* g_dump_file_name = nullptr;
+static bool g_is_fold_tree = false;
+static CHAR const* g_diag_file_name = nullptr;
+static DIAG_FMT g_diag_fmt = DIAG_FMT_TEXT;
+static UINT g_diag_limit = DIAG_DEFAULT_LIMIT;
+static CHAR const* g_ast_file_name = nullptr;
+static CHAR const* g_ast_decl_name = nullptr;
+static AST_FMT g_ast_fmt = AST_FMT_JSON;
+static UINT g_ast_flag = 0;
+static bool g_is_decl_init = false;
+static bool g_is_time_report_json = false;
+static bool g_is_prelex = false;
+static bool g_is_lex_thread = false;
+static UINT g_lex_queue_depth = LEX_QUEUE_DEFAULT_DEPTH;
 
-UINT FrontEnd()
+//Lex whole source file into token array, then parse the array.
+static INT prelexAndParse()
 {
+    //Newline token is kept since parser requires it to parse '#' line.
+    Lexer lexer(g_fe_sym_tab, true);
+    TokenArray * ta = new TokenArray();
+    ULONGLONG w;
+    LONG c;
+    START_FE_PHASE(w, c);
+    lexer.lexAll(*ta);
+    END_FE_PHASE(w, c, FE_PHASE_LEX);
+
+    setParserTokenArray(ta);
+    INT s = Parser();
+    setParserTokenArray(nullptr);
+    delete ta;
+    return s;
+}
+
+
+//Lex source file on another thread, and parse the tokens that passed
+//through token queue.
+//Note the time of lexing is not measured because it overlaps parsing.
+static INT pipelineParse()
+{
+    LexPipe * pipe = new LexPipe(g_lex_queue_depth);
+    if (!pipe->start()) {
+        delete pipe;
+        return Parser();
+    }
+    setParserTokenQueue(pipe->getQueue());
     INT s = Parser();
+    setParserTokenQueue(nullptr);
+    pipe->join();
+
+    TokenQueue const* q = pipe->getQueue();
+    g_fe_stat.lex_queue_depth = q->getDepth();
+    g_fe_stat.lex_queue_peak = q->getMaxDepth();
+    g_fe_stat.lex_queue_stall_num = q->getStallNum();
+    g_fe_stat.lex_queue_wait_num = q->getWaitNum();
+    delete pipe;
+    return s;
+}
+
+
+UINT FrontEnd()
+{
+    ULONGLONG w;
+    LONG c;
+    START_FE_PHASE(w, c);
+    INT s;
+    if (g_is_lex_thread) {
+        s = pipelineParse();
+    } else if (g_is_prelex) {
+        s = prelexAndParse();
+    } else {
+        s = Parser();
+    }
+    END_FE_PHASE(w, c, FE_PHASE_PARSE);
     if (s != ST_SUCC) {
         return s;
     }
+
+    START_FE_PHASE(w, c);
     s = TypeTransform();
+    END_FE_PHASE(w, c, FE_PHASE_TYPE_TRAN);
     if (s != ST_SUCC) {
         return s;
     }
+
+    if (g_is_fold_tree) {
+        START_FE_PHASE(w, c);
+        s = FoldTree();
+        END_FE_PHASE(w, c, FE_PHASE_FOLD);
+        if (s != ST_SUCC) {
+            return s;
+        }
+    }
+
+    START_FE_PHASE(w, c);
     s = TypeCheck();
+    END_FE_PHASE(w, c, FE_PHASE_TYPE_CHECK);
     if (s != ST_SUCC) {
         return s;
     }
+
+    if (g_is_decl_init) {
+        START_FE_PHASE(w, c);
+        s = processDeclInit();
+        END_FE_PHASE(w, c, FE_PHASE_DECL_INIT);
+    }
     return s;
 }
 
@@ -71,6 +161,22 @@ static CHAR * process_d(INT argc, CHAR * argv[], INT & i)
 }
 
 
+//Convert decimal digits 'n' into unsigned integer.
+//Return false if 'n' is not a decimal number or it exceeds UINT.
+static bool process_uint(CHAR const* n, OUT UINT & v)
+{
+    if (n == NULL || *n == 0) { return false; }
+    ULONGLONG r = 0;
+    for (CHAR const* p = n; *p != 0; p++) {
+        if (!xisdigit(*p)) { return false; }
+        r = r * 10 + (*p - '0');
+        if (r > (ULONGLONG)(UINT)-1) { return false; }
+    }
+    v = (UINT)r;
+    return true;
+}
+
+
 bool processCmdLine(INT argc, CHAR * argv[])
 {
     if (argc <= 1) return false;
@@ -80,6 +186,69 @@ bool processCmdLine(INT argc, CHAR * argv[])
             CHAR const* cmdstr = &argv[i][1];
             if (!strcmp(cmdstr, "dump")) {
                 g_dump_file_name = process_d(argc, argv, i);      
+            } else if (!strcmp(cmdstr, "fold")) {
+                g_is_fold_tree = true;
+                i++;
+            } else if (!strcmp(cmdstr, "diag-format")) {
+                CHAR const* f = process_d(argc, argv, i);
+                if (f == nullptr) { return false; }
+                if (!strcmp(f, "text")) {
+                    g_diag_fmt = DIAG_FMT_TEXT;
+                } else if (!strcmp(f, "json")) {
+                    g_diag_fmt = DIAG_FMT_JSON;
+                } else if (!strcmp(f, "sarif")) {
+                    g_diag_fmt = DIAG_FMT_SARIF;
+                } else {
+                    return false;
+                }
+            } else if (!strcmp(cmdstr, "diag-output")) {
+                g_diag_file_name = process_d(argc, argv, i);
+                if (g_diag_file_name == nullptr) { return false; }
+            } else if (!strcmp(cmdstr, "diag-limit")) {
+                if (!process_uint(process_d(argc, argv, i), g_diag_limit)) {
+                    return false;
+                }
+            } else if (!strcmp(cmdstr, "prelex")) {
+                g_is_prelex = true;
+                i++;
+            } else if (!strcmp(cmdstr, "lex-thread")) {
+                g_is_lex_thread = true;
+                i++;
+            } else if (!strcmp(cmdstr, "lex-queue-depth")) {
+                if (!process_uint(process_d(argc, argv, i),
+                                  g_lex_queue_depth) ||
+                    g_lex_queue_depth == 0) {
+                    return false;
+                }
+            } else if (!strcmp(cmdstr, "decl-init")) {
+                g_is_decl_init = true;
+                i++;
+            } else if (!strcmp(cmdstr, "time-report")) {
+                g_fe_stat.is_enable = true;
+                i++;
+            } else if (!strcmp(cmdstr, "time-report-json")) {
+                g_fe_stat.is_enable = true;
+                g_is_time_report_json = true;
+                i++;
+            } else if (!strcmp(cmdstr, "dump-ast")) {
+                g_ast_file_name = process_d(argc, argv, i);
+                if (g_ast_file_name == nullptr) { return false; }
+            } else if (!strcmp(cmdstr, "dump-ast-format")) {
+                CHAR const* f = process_d(argc, argv, i);
+                if (f == nullptr) { return false; }
+                if (!strcmp(f, "json")) {
+                    g_ast_fmt = AST_FMT_JSON;
+                } else if (!strcmp(f, "bin")) {
+                    g_ast_fmt = AST_FMT_BIN;
+                } else {
+                    return false;
+                }
+            } else if (!strcmp(cmdstr, "dump-ast-func")) {
+                SET_FLAG(g_ast_flag, AST_DUMP_FUNC_ONLY);
+                i++;
+            } else if (!strcmp(cmdstr, "dump-ast-decl")) {
+                g_ast_decl_name = process_d(argc, argv, i);
+                if (g_ast_decl_name == nullptr) { return false; }
             } else {
                 return false;
             }
@@ -95,12 +264,26 @@ bool processCmdLine(INT argc, CHAR * argv[])
             i++;
         }
     } //end while
+    if (g_diag_fmt != DIAG_FMT_TEXT && g_diag_file_name == nullptr) {
+        //Structured diagnostics can not be interleaved with other messages
+        //on stdout.
+        fprintf(stdout, "xoc: -diag-format json|sarif requires "
+                "-diag-output\n");
+        return false;
+    }
     return true;
 }
 
 extern xoc::LogMgr * g_logmgr;
 
-//cmdline usage: xocfe example.c -dump a.tmp
+//cmdline usage: xocfe example.c [-fold] -dump a.tmp
+//                [-diag-format text|json|sarif] [-diag-output a.diag]
+//                (json and sarif require -diag-output)
+//                [-diag-limit N]
+//                [-dump-ast a.ast [-dump-ast-format json|bin]
+//                 [-dump-ast-func] [-dump-ast-decl name]]
+//                [-decl-init] [-time-report|-time-report-json] [-prelex]
+//                [-lex-thread [-lex-queue-depth N]]
 //#define DEBUG
 #ifdef DEBUG
 INT main(INT argcc, CHAR * argvc[])
@@ -118,6 +301,18 @@ INT main(INT argc, CHAR * argv[])
 #endif
     if (!processCmdLine(argc, argv)) { return 1; }
     initParser();
+    setSrcFileName(g_c_file_name);
+    FILE * diag_out = stdout;
+    if (g_diag_file_name != nullptr) {
+        diag_out = fopen(g_diag_file_name, "wb");
+        if (diag_out == nullptr) {
+            fprintf(stdout, "xoc: cannot open %s, error information is %s\n",
+                    g_diag_file_name, strerror(errno));
+            return 1;
+        }
+    }
+    initDiag(g_diag_fmt, diag_out, g_c_file_name);
+    setDiagLimit(g_diag_limit);
     g_fe_sym_tab = new SymTab();
     g_logmgr = new LogMgr();
     if (g_dump_file_name != nullptr) {
@@ -126,13 +321,27 @@ INT main(INT argc, CHAR * argv[])
     FrontEnd();
 
     //Show you all info that generated by CfrontEnd.
+    ULONGLONG w;
+    LONG c;
+    START_FE_PHASE(w, c);
     dump_scope(get_global_scope(), 0xFFFFFFFF);
-    show_err();
-    show_warn();
+    if (g_ast_file_name != nullptr &&
+        !dumpAST(g_ast_file_name, g_ast_fmt, g_ast_flag, g_ast_decl_name)) {
+        fprintf(stdout, "xoc: cannot open %s, error information is %s\n",
+                g_ast_file_name, strerror(errno));
+    }
+    END_FE_PHASE(w, c, FE_PHASE_DUMP);
+    finiDiag();
+    if (diag_out != stdout) {
+        fclose(diag_out);
+    }
     fprintf(stdout, "\n%s - (%d) error(s), (%d) warnging(s)\n",
             g_c_file_name,
-            g_err_msg_list.get_elem_count(),
-            g_warn_msg_list.get_elem_count());
+            get_err_count(),
+            get_warn_count());
+    if (g_fe_stat.is_enable) {
+        dumpTimeReport(stdout, g_is_time_report_json, g_c_file_name);
+    }
     finiParser();
     delete g_logmgr;
     return 0;
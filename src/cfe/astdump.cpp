@@ -0,0 +1,790 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+//The size of write buffer.
+#define AST_WBUF_SIZE 65536
+
+static CHAR const* g_ast_rec_name[] = {
+    "end",
+    "scope",
+    "decl",
+    "enum",
+    "aggr",
+    "tree",
+};
+
+//Indexed by TREE_TYPE.
+static CHAR const* g_tree_type_name[] = {
+    "NUL",
+    "ASSIGN",
+    "ID",
+    "IMM",
+    "IMMU",
+    "IMML",
+    "IMMUL",
+    "FP",
+    "FPF",
+    "FPLD",
+    "ENUM_CONST",
+    "STRING",
+    "LOGIC_OR",
+    "LOGIC_AND",
+    "INCLUSIVE_OR",
+    "INCLUSIVE_AND",
+    "XOR",
+    "EQUALITY",
+    "RELATION",
+    "SHIFT",
+    "ADDITIVE",
+    "MULTI",
+    "INTRI_FUN",
+    "IF",
+    "ELSE",
+    "DO",
+    "WHILE",
+    "FOR",
+    "SWITCH",
+    "BREAK",
+    "CONTINUE",
+    "RETURN",
+    "GOTO",
+    "LABEL",
+    "DEFAULT",
+    "CASE",
+    "COND",
+    "CVT",
+    "TYPE_NAME",
+    "LDA",
+    "DEREF",
+    "INC",
+    "DEC",
+    "POST_INC",
+    "POST_DEC",
+    "PLUS",
+    "MINUS",
+    "REV",
+    "NOT",
+    "SIZEOF",
+    "DMEM",
+    "INDMEM",
+    "ARRAY",
+    "CALL",
+    "SCOPE",
+    "INITVAL_SCOPE",
+    "PRAGMA",
+    "PREP",
+};
+
+//
+//START ASTWriter
+//
+//Buffered writer that formats records without vsprintf.
+class ASTWriter {
+    COPY_CONSTRUCTOR(ASTWriter);
+protected:
+    AST_FMT m_fmt;
+    bool m_need_sep; //JSON: a ',' is needed before next value.
+    UINT m_pos;
+    UINT m_sym_num;
+    FILE * m_out;
+    TMap<Sym const*, UINT> m_sym2id;
+    CHAR m_buf[AST_WBUF_SIZE];
+
+    void put(CHAR c)
+    {
+        if (m_pos == AST_WBUF_SIZE) { flush(); }
+        m_buf[m_pos++] = c;
+    }
+
+    void write(CHAR const* s, size_t len)
+    {
+        if (len > AST_WBUF_SIZE - m_pos) {
+            flush();
+            if (len >= AST_WBUF_SIZE) {
+                ::fwrite(s, 1, len, m_out);
+                return;
+            }
+        }
+        ::memcpy(m_buf + m_pos, s, len);
+        m_pos += (UINT)len;
+    }
+
+    void putStr(CHAR const* s) { write(s, ::strlen(s)); }
+
+    void putDec(ULONGLONG v)
+    {
+        CHAR tmp[24];
+        UINT i = sizeof(tmp);
+        do {
+            tmp[--i] = (CHAR)('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        write(tmp + i, sizeof(tmp) - i);
+    }
+
+    void putDec(LONGLONG v)
+    {
+        if (v < 0) {
+            put('-');
+            putDec((ULONGLONG)0 - (ULONGLONG)v);
+            return;
+        }
+        putDec((ULONGLONG)v);
+    }
+
+    //Unsigned LEB128.
+    void putVar(ULONGLONG v)
+    {
+        while (v >= 0x80) {
+            put((CHAR)((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        put((CHAR)v);
+    }
+
+    void putJsonStr(CHAR const* s)
+    {
+        static CHAR const* hex = "0123456789abcdef";
+        put('"');
+        CHAR const* start = s;
+        for (; *s != 0; s++) {
+            UCHAR c = (UCHAR)*s;
+            if (c >= 0x20 && c != '"' && c != '\\') { continue; }
+            write(start, s - start);
+            start = s + 1;
+            put('\\');
+            switch (c) {
+            case '"': put('"'); break;
+            case '\\': put('\\'); break;
+            case '\n': put('n'); break;
+            case '\t': put('t'); break;
+            case '\r': put('r'); break;
+            default:
+                putStr("u00");
+                put(hex[c >> 4]);
+                put(hex[c & 0xF]);
+            }
+        }
+        write(start, s - start);
+        put('"');
+    }
+
+    void putKey(CHAR const* name)
+    {
+        if (m_need_sep) { put(','); }
+        m_need_sep = true;
+        if (name == nullptr) { return; }
+        put('"');
+        putStr(name);
+        putStr("\":");
+    }
+public:
+    ASTWriter(FILE * out, AST_FMT fmt)
+    {
+        m_fmt = fmt;
+        m_need_sep = false;
+        m_pos = 0;
+        m_sym_num = 0;
+        m_out = out;
+    }
+    ~ASTWriter() { flush(); }
+
+    void beginArray(CHAR const* name, UINT num)
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            putVar(num);
+            return;
+        }
+        putKey(name);
+        put('[');
+        m_need_sep = false;
+    }
+    void beginObject()
+    {
+        if (m_fmt == AST_FMT_BIN) { return; }
+        putKey(nullptr);
+        put('{');
+        m_need_sep = false;
+    }
+    void beginRecord(AST_REC kind)
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            put((CHAR)kind);
+            return;
+        }
+        putStr("{\"k\":\"");
+        putStr(g_ast_rec_name[kind]);
+        put('"');
+        m_need_sep = true;
+    }
+    void beginStream()
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            putStr("XAST");
+            put((CHAR)AST_BIN_VERSION);
+        }
+    }
+
+    void endArray()
+    {
+        if (m_fmt == AST_FMT_BIN) { return; }
+        put(']');
+        m_need_sep = true;
+    }
+    void endObject()
+    {
+        if (m_fmt == AST_FMT_BIN) { return; }
+        put('}');
+        m_need_sep = true;
+    }
+    void endRecord()
+    {
+        if (m_fmt == AST_FMT_BIN) { return; }
+        putStr("}\n");
+        m_need_sep = false;
+    }
+    void endStream()
+    {
+        if (m_fmt == AST_FMT_BIN) { put((CHAR)AST_REC_END); }
+        flush();
+    }
+
+    //Write an unsigned integer field.
+    void fieldUInt(CHAR const* name, ULONGLONG v)
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            putVar(v);
+            return;
+        }
+        putKey(name);
+        putDec(v);
+    }
+
+    //Write a signed integer field.
+    void fieldInt(CHAR const* name, LONGLONG v)
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            //zigzag
+            putVar(((ULONGLONG)v << 1) ^ (ULONGLONG)(v >> 63));
+            return;
+        }
+        putKey(name);
+        putDec(v);
+    }
+
+    //Write an enumerated field, JSON records the text, binary records
+    //the code.
+    void fieldKind(CHAR const* name, UINT code, CHAR const* text)
+    {
+        if (m_fmt == AST_FMT_BIN) {
+            putVar(code);
+            return;
+        }
+        putKey(name);
+        put('"');
+        putStr(text);
+        put('"');
+    }
+
+    //Write a string field that interned in SymTab.
+    //The field is omitted in JSON if 'sym' is nullptr.
+    void fieldSym(CHAR const* name, Sym const* sym)
+    {
+        if (m_fmt == AST_FMT_JSON) {
+            if (sym == nullptr) { return; }
+            putKey(name);
+            putJsonStr(SYM_name(sym));
+            return;
+        }
+        if (sym == nullptr) {
+            putVar(0);
+            return;
+        }
+        bool find = false;
+        UINT id = m_sym2id.get(sym, &find);
+        if (find) {
+            putVar((ULONGLONG)id << 1);
+            return;
+        }
+        id = ++m_sym_num;
+        m_sym2id.set(sym, id);
+        putVar(((ULONGLONG)id << 1) | 1);
+        size_t len = ::strlen(SYM_name(sym));
+        putVar(len);
+        write(SYM_name(sym), len);
+    }
+
+    void flush()
+    {
+        if (m_pos == 0) { return; }
+        ::fwrite(m_buf, 1, m_pos, m_out);
+        m_pos = 0;
+    }
+};
+//END ASTWriter
+
+
+//
+//START ASTDumper
+//
+typedef enum {
+    AST_TASK_SCOPE = 0, //obj: Scope, a: is_global.
+    AST_TASK_AGGR, //obj: Aggr, a: is_union, b: scope id.
+    AST_TASK_DECL, //obj: Decl and its siblings, a: scope id, b: aggr id,
+                   //fld: 1 if the global filter is applied.
+    AST_TASK_TREE, //obj: Tree and its siblings, a: parent tree id.
+} AST_TASK;
+
+class ASTTask {
+public:
+    AST_TASK kind;
+    void const* obj;
+    UINT a;
+    UINT b;
+    INT fld;
+    UINT prev;
+};
+
+class ASTDumper {
+    COPY_CONSTRUCTOR(ASTDumper);
+protected:
+    UINT m_flag;
+    UINT m_decl_num;
+    UINT m_aggr_num;
+    CHAR const* m_name;
+    ASTWriter & m_w;
+    TMap<Decl const*, UINT> m_decl2id;
+    //Pending records. Nested scopes and trees are dumped from the stack
+    //rather than by recursion, so that deep input does not exhaust the
+    //machine stack.
+    TreeWalkStack<ASTTask> m_task;
+
+    //Return the unique id of declaration, the id is assigned when the
+    //declaration is first referred.
+    UINT getDeclId(Decl const* dcl)
+    {
+        if (dcl == nullptr) { return 0; }
+        bool find = false;
+        UINT id = m_decl2id.get(dcl, &find);
+        if (find) { return id; }
+        id = ++m_decl_num;
+        m_decl2id.set(dcl, id);
+        return id;
+    }
+
+    //Return true if 'dcl' in global scope should be dumped.
+    bool isSelected(Decl const* dcl) const
+    {
+        if (HAVE_FLAG(m_flag, AST_DUMP_FUNC_ONLY) &&
+            !DECL_is_fun_def(dcl)) {
+            return false;
+        }
+        if (m_name != nullptr) {
+            Sym const* sym = get_decl_sym(dcl);
+            if (sym == nullptr || ::strcmp(SYM_name(sym), m_name) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool hasFilter() const
+    { return m_name != nullptr || HAVE_FLAG(m_flag, AST_DUMP_FUNC_ONLY); }
+
+    void dumpSpec(TypeSpec const* spec);
+    void dumpDeclarator(Decl const* dcl);
+    void dumpType(Decl const* dcl);
+    void dumpDecl(Decl const* dcl, UINT scope_id, UINT aggr_id);
+    void dumpEnum(Enum const* e, UINT scope_id);
+    UINT dumpAggr(Aggr const* a, bool is_union, UINT scope_id);
+    void dumpTree(Tree const* t, UINT parent, INT fld, UINT prev);
+    void dumpScopeRec(Scope const* s, bool is_global);
+
+    void pushTask(AST_TASK kind, void const* obj, UINT a = 0, UINT b = 0,
+                  INT fld = -1, UINT prev = 0)
+    {
+        ASTTask * task = m_task.push();
+        task->kind = kind;
+        task->obj = obj;
+        task->a = a;
+        task->b = b;
+        task->fld = fld;
+        task->prev = prev;
+    }
+    void doTask(ASTTask const& task);
+public:
+    ASTDumper(ASTWriter & w, UINT flag, CHAR const* name) : m_w(w)
+    {
+        m_flag = flag;
+        m_decl_num = 0;
+        m_aggr_num = 0;
+        m_name = name;
+    }
+
+    void dumpScope(Scope const* s, bool is_global);
+};
+
+
+void ASTDumper::dumpSpec(TypeSpec const* spec)
+{
+    if (spec == nullptr) {
+        m_w.fieldUInt("spec", 0);
+        m_w.fieldSym("tag", nullptr);
+        return;
+    }
+    m_w.fieldUInt("spec", (ULONGLONG)TYPE_des(spec));
+    Sym const* tag = nullptr;
+    if (IS_USER_TYPE_REF(spec)) {
+        tag = get_decl_sym(TYPE_user_type(spec));
+    } else if (IS_AGGR(spec) && TYPE_aggr_type(spec) != nullptr) {
+        tag = AGGR_tag(TYPE_aggr_type(spec));
+    } else if (IS_ENUM_TYPE(spec) && TYPE_enum_type(spec) != nullptr) {
+        tag = ENUM_name(TYPE_enum_type(spec));
+    }
+    m_w.fieldSym("tag", tag);
+}
+
+
+//Dump declarator list of DCL_DECLARATOR or DCL_ABS_DECLARATOR.
+void ASTDumper::dumpDeclarator(Decl const* dcl)
+{
+    Decl const* d = dcl != nullptr ? DECL_child(dcl) : nullptr;
+    UINT num = 0;
+    for (Decl const* p = d; p != nullptr; p = DECL_next(p)) { num++; }
+    m_w.beginArray("dcl", num);
+    for (; d != nullptr; d = DECL_next(d)) {
+        m_w.beginObject();
+        m_w.fieldKind("t", DECL_dt(d), g_dcl_name[DECL_dt(d)]);
+        switch (DECL_dt(d)) {
+        case DCL_ARRAY:
+            m_w.fieldUInt("dim", DECL_array_dim(d));
+            break;
+        case DCL_FUN: {
+            UINT npara = 0;
+            for (Decl const* p = DECL_fun_para_list(d);
+                 p != nullptr; p = DECL_next(p)) {
+                npara++;
+            }
+            m_w.fieldUInt("npara", npara);
+            break;
+        }
+        case DCL_POINTER:
+        case DCL_ID:
+            m_w.fieldUInt("qua", DECL_qua(d) != nullptr ?
+                          (ULONGLONG)TYPE_des(DECL_qua(d)) : 0);
+            break;
+        default:;
+        }
+        m_w.endObject();
+    }
+    m_w.endArray();
+}
+
+
+//Dump the type of DCL_DECLARATION or DCL_TYPE_NAME.
+void ASTDumper::dumpType(Decl const* dcl)
+{
+    dumpSpec(DECL_spec(dcl));
+    dumpDeclarator(DECL_decl_list(dcl));
+}
+
+
+void ASTDumper::dumpDecl(Decl const* dcl, UINT scope_id, UINT aggr_id)
+{
+    Decl const* dclr = DECL_decl_list(dcl);
+    Tree const* init = nullptr;
+    if (dclr != nullptr && DECL_is_init(dclr)) {
+        init = DECL_init_tree(dclr);
+    }
+    Scope const* body = DECL_is_fun_def(dcl) ? DECL_fun_body(dcl) : nullptr;
+    m_w.beginRecord(AST_REC_DECL);
+    m_w.fieldUInt("id", getDeclId(dcl));
+    m_w.fieldUInt("scope", scope_id);
+    m_w.fieldUInt("aggr", aggr_id);
+    m_w.fieldUInt("line", DECL_lineno(dcl));
+    m_w.fieldSym("name", get_decl_sym(dcl));
+    dumpType(dcl);
+    m_w.fieldUInt("fun_def", DECL_is_fun_def(dcl) ? 1 : 0);
+    m_w.fieldUInt("body", body != nullptr ? SCOPE_id(body) : 0);
+    m_w.fieldUInt("init", init != nullptr ? TREE_uid(init) : 0);
+    m_w.endRecord();
+
+    //Body is dumped after initializer.
+    if (body != nullptr) {
+        pushTask(AST_TASK_SCOPE, body, false);
+    }
+    if (init != nullptr) {
+        pushTask(AST_TASK_TREE, init, 0);
+    }
+}
+
+
+void ASTDumper::dumpEnum(Enum const* e, UINT scope_id)
+{
+    UINT num = 0;
+    for (EnumValueList const* ev = ENUM_vallist(e);
+         ev != nullptr; ev = EVAL_LIST_next(ev)) {
+        num++;
+    }
+    m_w.beginRecord(AST_REC_ENUM);
+    m_w.fieldUInt("scope", scope_id);
+    m_w.fieldSym("name", ENUM_name(e));
+    m_w.beginArray("vals", num);
+    for (EnumValueList const* ev = ENUM_vallist(e);
+         ev != nullptr; ev = EVAL_LIST_next(ev)) {
+        m_w.beginObject();
+        m_w.fieldSym("n", EVAL_LIST_name(ev));
+        m_w.fieldInt("v", EVAL_LIST_val(ev));
+        m_w.endObject();
+    }
+    m_w.endArray();
+    m_w.endRecord();
+}
+
+
+//Return the id of aggregate.
+UINT ASTDumper::dumpAggr(Aggr const* a, bool is_union, UINT scope_id)
+{
+    UINT id = ++m_aggr_num;
+    m_w.beginRecord(AST_REC_AGGR);
+    m_w.fieldUInt("id", id);
+    m_w.fieldUInt("scope", scope_id);
+    m_w.fieldUInt("union", is_union ? 1 : 0);
+    m_w.fieldSym("tag", AGGR_tag(a));
+    m_w.fieldUInt("complete", AGGR_is_complete(a) ? 1 : 0);
+    m_w.endRecord();
+    return id;
+}
+
+
+//parent: tree id of parent, or 0 if 't' is the root.
+//fld: the child index in parent, or -1.
+//prev: tree id of previous sibling, or 0.
+void ASTDumper::dumpTree(Tree const* t, UINT parent, INT fld, UINT prev)
+{
+    ASSERT0(TREE_type(t) <= TR_PREP);
+    m_w.beginRecord(AST_REC_TREE);
+    m_w.fieldUInt("id", TREE_uid(t));
+    m_w.fieldUInt("parent", parent);
+    m_w.fieldInt("fld", fld);
+    m_w.fieldUInt("prev", prev);
+    m_w.fieldKind("t", TREE_type(t), g_tree_type_name[TREE_type(t)]);
+    m_w.fieldInt("line", TREE_lineno(t));
+    m_w.fieldUInt("tok", TREE_token(t));
+
+    Scope const* sub = nullptr;
+    switch (TREE_type(t)) {
+    case TR_ID:
+        m_w.fieldSym("name", TREE_id(t));
+        m_w.fieldUInt("decl", getDeclId(TREE_id_decl(t)));
+        break;
+    case TR_IMM:
+    case TR_IMML:
+        m_w.fieldInt("val", (LONGLONG)TREE_imm_val(t));
+        break;
+    case TR_IMMU:
+    case TR_IMMUL:
+        m_w.fieldUInt("val", (ULONGLONG)TREE_imm_val(t));
+        break;
+    case TR_FP:
+    case TR_FPF:
+    case TR_FPLD:
+        m_w.fieldSym("val", TREE_fp_str_val(t));
+        break;
+    case TR_STRING:
+        m_w.fieldSym("val", TREE_string_val(t));
+        break;
+    case TR_ENUM_CONST: {
+        Enum const* e = TREE_enum(t);
+        m_w.fieldSym("enum", ENUM_name(e));
+        m_w.fieldInt("val", get_enum_const_val(e, TREE_enum_val_idx(t)));
+        break;
+    }
+    case TR_GOTO:
+    case TR_LABEL:
+        m_w.fieldSym("label", TREE_lab_info(t) != nullptr ?
+                     LABELINFO_name(TREE_lab_info(t)) : nullptr);
+        break;
+    case TR_CASE:
+        m_w.fieldInt("val", TREE_case_value(t));
+        break;
+    case TR_TYPE_NAME:
+        dumpType(TREE_type_name(t));
+        break;
+    case TR_SCOPE:
+        sub = TREE_scope(t);
+        m_w.fieldUInt("scope", sub != nullptr ? SCOPE_id(sub) : 0);
+        break;
+    case TR_FOR:
+        sub = TREE_for_scope(t);
+        m_w.fieldUInt("scope", sub != nullptr ? SCOPE_id(sub) : 0);
+        break;
+    default:;
+    }
+    m_w.endRecord();
+
+    //Push in reverse order: kid lists in field order, then sub-scope.
+    if (sub != nullptr) {
+        pushTask(AST_TASK_SCOPE, sub, false);
+    }
+    if (TREE_type(t) != TR_PRAGMA && TREE_type(t) != TR_PREP) {
+        for (INT i = MAX_TREE_FLDS - 1; i >= 0; i--) {
+            if (TREE_fld(t, i) == nullptr) { continue; }
+            pushTask(AST_TASK_TREE, TREE_fld(t, i), TREE_uid(t), 0, i);
+        }
+    }
+    if (TREE_type(t) == TR_INITVAL_SCOPE &&
+        TREE_initval_scope(t) != nullptr) {
+        pushTask(AST_TASK_TREE, TREE_initval_scope(t), TREE_uid(t), 0, 0);
+    }
+}
+
+
+void ASTDumper::dumpScopeRec(Scope const* s, bool is_global)
+{
+    m_w.beginRecord(AST_REC_SCOPE);
+    m_w.fieldUInt("id", SCOPE_id(s));
+    m_w.fieldInt("level", SCOPE_level(s));
+    //Global scope's id is 0, thus -1 indicates there is no parent.
+    m_w.fieldInt("parent", SCOPE_parent(s) != nullptr ?
+                 (INT)SCOPE_id(SCOPE_parent(s)) : -1);
+    m_w.fieldUInt("stmt", SCOPE_stmt_list(s) != nullptr ?
+                  TREE_uid(SCOPE_stmt_list(s)) : 0);
+    m_w.endRecord();
+
+    //Push in reverse order: enums, structs, unions, declarations, then
+    //statements.
+    if (SCOPE_stmt_list(s) != nullptr) {
+        pushTask(AST_TASK_TREE, SCOPE_stmt_list(s), 0);
+    }
+    if (SCOPE_decl_list(s) != nullptr) {
+        pushTask(AST_TASK_DECL, SCOPE_decl_list(s), SCOPE_id(s), 0,
+                 is_global ? 1 : 0);
+    }
+    if (is_global && hasFilter()) { return; }
+    xcom::C<Union*> * cu;
+    List<Union*> & ul = const_cast<Scope*>(s)->union_list;
+    for (Union * un = ul.get_tail(&cu);
+         un != nullptr; un = ul.get_prev(&cu)) {
+        pushTask(AST_TASK_AGGR, un, true, SCOPE_id(s));
+    }
+    xcom::C<Struct*> * cs;
+    List<Struct*> & sl = const_cast<Scope*>(s)->struct_list;
+    for (Struct * st = sl.get_tail(&cs);
+         st != nullptr; st = sl.get_prev(&cs)) {
+        pushTask(AST_TASK_AGGR, st, false, SCOPE_id(s));
+    }
+    for (EnumList const* el = SCOPE_enum_list(s);
+         el != nullptr; el = ENUM_LIST_next(el)) {
+        dumpEnum(ENUM_LIST_enum(el), SCOPE_id(s));
+    }
+}
+
+
+void ASTDumper::doTask(ASTTask const& task)
+{
+    switch (task.kind) {
+    case AST_TASK_SCOPE:
+        dumpScopeRec((Scope const*)task.obj, task.a != 0);
+        return;
+    case AST_TASK_AGGR: {
+        Aggr const* a = (Aggr const*)task.obj;
+        UINT id = dumpAggr(a, task.a != 0, task.b);
+        if (AGGR_decl_list(a) != nullptr) {
+            pushTask(AST_TASK_DECL, AGGR_decl_list(a), task.b, id, 0);
+        }
+        return;
+    }
+    case AST_TASK_DECL: {
+        //Skip declarations that are filtered out.
+        Decl const* dcl = (Decl const*)task.obj;
+        while (dcl != nullptr && task.fld != 0 && !isSelected(dcl)) {
+            dcl = DECL_next(dcl);
+        }
+        if (dcl == nullptr) { return; }
+        if (DECL_next(dcl) != nullptr) {
+            pushTask(AST_TASK_DECL, DECL_next(dcl), task.a, task.b,
+                     task.fld);
+        }
+        dumpDecl(dcl, task.a, task.b);
+        return;
+    }
+    case AST_TASK_TREE: {
+        Tree const* t = (Tree const*)task.obj;
+        if (TREE_nsib(t) != nullptr) {
+            pushTask(AST_TASK_TREE, TREE_nsib(t), task.a, 0, task.fld,
+                     TREE_uid(t));
+        }
+        dumpTree(t, task.a, task.fld, task.prev);
+        return;
+    }
+    default: UNREACHABLE();
+    }
+}
+
+
+void ASTDumper::dumpScope(Scope const* s, bool is_global)
+{
+    pushTask(AST_TASK_SCOPE, s, is_global);
+    while (!m_task.is_empty()) {
+        //Copy the task out, its slot is reused by the tasks it pushes.
+        ASTTask task = *m_task.get_top();
+        m_task.pop();
+        doTask(task);
+    }
+}
+//END ASTDumper
+
+
+void dumpAST(FILE * out, AST_FMT fmt, UINT flag, CHAR const* name)
+{
+    ASSERT0(out);
+    ASSERT0(sizeof(g_tree_type_name) / sizeof(g_tree_type_name[0]) ==
+            TR_PREP + 1);
+    Scope * s = get_global_scope();
+    if (s == nullptr) { return; }
+    //The writer holds a large buffer, do not allocate it on stack.
+    ASTWriter * w = new ASTWriter(out, fmt);
+    w->beginStream();
+    ASTDumper dumper(*w, flag, name);
+    dumper.dumpScope(s, true);
+    w->endStream();
+    delete w;
+}
+
+
+bool dumpAST(CHAR const* filename, AST_FMT fmt, UINT flag, CHAR const* name)
+{
+    ASSERT0(filename);
+    FILE * out = fopen(filename, "wb");
+    if (out == nullptr) { return false; }
+    dumpAST(out, fmt, flag, name);
+    fclose(out);
+    return true;
+}
@@ -0,0 +1,83 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __AST_DUMP_H__
+#define __AST_DUMP_H__
+
+//Streaming serializer of Scope, Decl and Tree.
+//The output is a sequence of records, each record describes one scope,
+//declaration, enum, aggregate or tree node. Records are written in
+//pre-order, thus a record always follows the record of its parent.
+//
+//AST_FMT_JSON: one JSON object per line.
+//  {"k":"scope","id":0,"level":0,"parent":-1,"stmt":0}
+//  {"k":"decl","id":1,"scope":0,"aggr":0,"line":3,"name":"f","spec":64,
+//   "dcl":[{"t":"ID","qua":0},{"t":"FUN","npara":0}],"fun_def":1,
+//   "body":2,"init":0}
+//  {"k":"tree","id":9,"parent":0,"fld":-1,"prev":0,"t":"RETURN",...}
+//  Field "parent" is 0 if the tree is a statement of scope or the root of
+//  initializer, and "fld" is the child index of parent, or -1 if parent
+//  is not a tree. "prev" is the previous sibling, or 0.
+//
+//AST_FMT_BIN: compact binary with the same records and fields.
+//  The stream starts with "XAST" and one version byte.
+//  Each record starts with one kind byte of AST_REC, followed by fields
+//  in the order of JSON format. Integers are LEB128, signed integers
+//  are zigzag encoded. A string is encoded as (id << 1) | is_new, if
+//  is_new is 1, length and bytes follow. String ids start from 1 in the
+//  order of definition. Array is prefixed with element count.
+//  Absent string and reference are encoded as 0.
+
+//Only dump function definitions in global scope.
+#define AST_DUMP_FUNC_ONLY 0x1
+
+typedef enum _AST_FMT {
+    AST_FMT_JSON = 0,
+    AST_FMT_BIN,
+} AST_FMT;
+
+typedef enum _AST_REC {
+    AST_REC_END = 0,
+    AST_REC_SCOPE,
+    AST_REC_DECL,
+    AST_REC_ENUM,
+    AST_REC_AGGR,
+    AST_REC_TREE,
+} AST_REC;
+
+#define AST_BIN_VERSION 1
+
+//Dump global scope to 'out'.
+//flag: the combination of AST_DUMP_xxx.
+//name: only dump the declaration in global scope with given name if it is
+//      not nullptr.
+void dumpAST(FILE * out, AST_FMT fmt, UINT flag, CHAR const* name);
+
+//Dump global scope to file 'filename'.
+//Return false if file can not be created.
+bool dumpAST(CHAR const* filename, AST_FMT fmt, UINT flag, CHAR const* name);
+#endif
@@ -0,0 +1,339 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+//This program measures the throughput of frontend end to end.
+//It generates each shape of corpus by gen_corpus, runs xocfe over the
+//corpus with -time-report-json, and reports tokens/s, lines/s, peak RSS
+//and the time of each phase. The result can be checked against, or
+//recorded into, a baseline file.
+//
+//Usage: bench_cfe [options]
+//  -xocfe <path>     path of xocfe.exe, default is ../../xocfe.exe
+//  -gen <path>       path of gen_corpus, default is ./gen_corpus
+//  -shape <name>     only run the given shape, can be repeated
+//  -scale <n>        scale of generated corpus, default is 1
+//  -repeat <n>       run each corpus n times and keep the fastest one,
+//                    default is 3
+//  -tmp <dir>        directory of generated corpus, default is /tmp
+//  -baseline <file>  compare the result with the baseline file
+//  -update           rewrite the baseline file with the result
+//  -tolerance <pct>  allowed slowdown in percent, default is 20
+//Return 1 if any shape regressed against the baseline.
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define MAX_SHAPE 16
+#define MAX_LINE_BUF 4096
+
+static char const* g_all_shape[] = {
+    "globals", "scope", "enum", "table", "struct", "expr", "deep", "func",
+    "wide", "switch", "mix"
+};
+#define ALL_SHAPE_NUM (sizeof(g_all_shape) / sizeof(g_all_shape[0]))
+
+//The phases are in the same order as -time-report-json prints.
+static char const* g_phase[] = {
+    "lex", "parse", "type_tran", "fold", "type_check", "decl_init", "dump"
+};
+#define PHASE_NUM (sizeof(g_phase) / sizeof(g_phase[0]))
+
+class Result {
+public:
+    char const* shape;
+    unsigned long long lines;
+    unsigned long long tokens;
+    unsigned long long peak_rss;
+    unsigned long long phase_usec[PHASE_NUM];
+    unsigned long long fe_usec; //time of all phases except dump.
+    double tokens_per_sec;
+    double lines_per_sec;
+};
+
+class Baseline {
+public:
+    char shape[64];
+    int scale;
+    double tokens_per_sec;
+    double lines_per_sec;
+    unsigned long long peak_rss;
+};
+
+static char const* g_xocfe = "../../xocfe.exe";
+static char const* g_gen = "./gen_corpus";
+static char const* g_tmp = "/tmp";
+static char const* g_baseline = NULL;
+static char const* g_shape[MAX_SHAPE];
+static unsigned int g_shape_num = 0;
+static int g_scale = 1;
+static int g_repeat = 3;
+static int g_tolerance = 20;
+static bool g_update = false;
+
+
+//Find the unsigned integer that follows the key in JSON text 'buf'.
+//Searching starts from 'from' if it is not NULL.
+static bool findNum(char const* buf, char const* from, char const* key,
+                    unsigned long long * v)
+{
+    char pat[128];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    char const* p = strstr(from != NULL ? from : buf, pat);
+    if (p == NULL) { return false; }
+    *v = strtoull(p + strlen(pat), NULL, 10);
+    return true;
+}
+
+
+static unsigned long long countLine(char const* fn)
+{
+    FILE * f = fopen(fn, "r");
+    if (f == NULL) { return 0; }
+    unsigned long long n = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') { n++; }
+    }
+    fclose(f);
+    return n;
+}
+
+
+//Run xocfe once and parse the time report.
+static bool runOnce(char const* fn, Result & r)
+{
+    char cmd[MAX_LINE_BUF];
+    snprintf(cmd, sizeof(cmd), "%s %s -decl-init -time-report-json 2>&1",
+             g_xocfe, fn);
+    FILE * p = popen(cmd, "r");
+    if (p == NULL) { return false; }
+    char line[MAX_LINE_BUF];
+    char report[MAX_LINE_BUF];
+    report[0] = 0;
+    while (fgets(line, sizeof(line), p) != NULL) {
+        if (strncmp(line, "{\"file\":", 8) == 0) {
+            strcpy(report, line);
+        }
+    }
+    if (pclose(p) != 0 || report[0] == 0) { return false; }
+
+    r.fe_usec = 0;
+    for (unsigned int i = 0; i < PHASE_NUM; i++) {
+        char pat[64];
+        snprintf(pat, sizeof(pat), "\"%s\":{", g_phase[i]);
+        char const* from = strstr(report, pat);
+        if (from == NULL ||
+            !findNum(report, from, "wall_usec", &r.phase_usec[i])) {
+            return false;
+        }
+        if (strcmp(g_phase[i], "dump") != 0) {
+            r.fe_usec += r.phase_usec[i];
+        }
+    }
+    return findNum(report, NULL, "tokens", &r.tokens) &&
+           findNum(report, NULL, "peak_rss_bytes", &r.peak_rss);
+}
+
+
+static bool runShape(char const* shape, Result & r)
+{
+    char fn[MAX_LINE_BUF];
+    char cmd[MAX_LINE_BUF];
+    snprintf(fn, sizeof(fn), "%s/xocfe_bench_%s_%d.c", g_tmp, shape, g_scale);
+    snprintf(cmd, sizeof(cmd), "%s %s %d %s", g_gen, shape, g_scale, fn);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "failed to run: %s\n", cmd);
+        return false;
+    }
+    r.shape = shape;
+    r.lines = countLine(fn);
+    bool has_result = false;
+    for (int i = 0; i < g_repeat; i++) {
+        Result cur = r;
+        if (!runOnce(fn, cur)) {
+            fprintf(stderr, "failed to run xocfe over %s\n", fn);
+            return false;
+        }
+        if (!has_result || cur.fe_usec < r.fe_usec) { r = cur; }
+        has_result = true;
+    }
+    remove(fn);
+    double sec = r.fe_usec == 0 ? 1e-6 : r.fe_usec / 1000000.0;
+    r.tokens_per_sec = r.tokens / sec;
+    r.lines_per_sec = r.lines / sec;
+    return true;
+}
+
+
+static unsigned int readBaseline(Baseline * base, unsigned int max)
+{
+    FILE * f = fopen(g_baseline, "r");
+    if (f == NULL) { return 0; }
+    unsigned int n = 0;
+    char line[MAX_LINE_BUF];
+    while (n < max && fgets(line, sizeof(line), f) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') { continue; }
+        Baseline & b = base[n];
+        if (sscanf(line, "%63s %d %lf %lf %llu", b.shape, &b.scale,
+                   &b.tokens_per_sec, &b.lines_per_sec, &b.peak_rss) == 5) {
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+
+static bool writeBaseline(Result const* res, unsigned int n)
+{
+    FILE * f = fopen(g_baseline, "w");
+    if (f == NULL) { return false; }
+    fprintf(f, "#Generated by bench_cfe -update.\n"
+               "#shape scale tokens/s lines/s peak_rss_bytes\n");
+    for (unsigned int i = 0; i < n; i++) {
+        fprintf(f, "%s %d %.0f %.0f %llu\n", res[i].shape, g_scale,
+                res[i].tokens_per_sec, res[i].lines_per_sec,
+                res[i].peak_rss);
+    }
+    fclose(f);
+    return true;
+}
+
+
+//Return true if 'r' is slower or bigger than the baseline beyond the
+//tolerance.
+static bool isRegressed(Result const& r, Baseline const* base,
+                        unsigned int basenum)
+{
+    for (unsigned int i = 0; i < basenum; i++) {
+        if (strcmp(base[i].shape, r.shape) != 0 ||
+            base[i].scale != g_scale) {
+            continue;
+        }
+        double slow = base[i].tokens_per_sec * (100 - g_tolerance) / 100.0;
+        double big = (double)base[i].peak_rss * (100 + g_tolerance) / 100.0;
+        printf("  baseline: %.0f tokens/s, %.1f MB",
+               base[i].tokens_per_sec, base[i].peak_rss / 1048576.0);
+        if (r.tokens_per_sec < slow || r.peak_rss > big) {
+            printf("  REGRESSED\n");
+            return true;
+        }
+        printf("  ok\n");
+        return false;
+    }
+    return false;
+}
+
+
+static void dumpResult(Result const& r)
+{
+    printf("%-8s %9llu %9llu %10.3f %12.0f %12.0f %8.1f\n", r.shape,
+           r.lines, r.tokens, r.fe_usec / 1000.0, r.tokens_per_sec,
+           r.lines_per_sec, r.peak_rss / 1048576.0);
+    printf("  phase(ms):");
+    for (unsigned int i = 0; i < PHASE_NUM; i++) {
+        printf(" %s=%.3f", g_phase[i], r.phase_usec[i] / 1000.0);
+    }
+    printf("\n");
+}
+
+
+static bool parseOption(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        char const* opt = argv[i];
+        if (strcmp(opt, "-update") == 0) {
+            g_update = true;
+            continue;
+        }
+        if (i + 1 >= argc) { return false; }
+        char const* val = argv[++i];
+        if (strcmp(opt, "-xocfe") == 0) {
+            g_xocfe = val;
+        } else if (strcmp(opt, "-gen") == 0) {
+            g_gen = val;
+        } else if (strcmp(opt, "-tmp") == 0) {
+            g_tmp = val;
+        } else if (strcmp(opt, "-baseline") == 0) {
+            g_baseline = val;
+        } else if (strcmp(opt, "-shape") == 0) {
+            if (g_shape_num >= MAX_SHAPE) { return false; }
+            g_shape[g_shape_num++] = val;
+        } else if (strcmp(opt, "-scale") == 0) {
+            g_scale = atoi(val);
+        } else if (strcmp(opt, "-repeat") == 0) {
+            g_repeat = atoi(val);
+        } else if (strcmp(opt, "-tolerance") == 0) {
+            g_tolerance = atoi(val);
+        } else {
+            return false;
+        }
+    }
+    if (g_update && g_baseline == NULL) { return false; }
+    if (g_scale <= 0 || g_repeat <= 0 || g_tolerance < 0 ||
+        g_tolerance >= 100) {
+        return false;
+    }
+    if (g_shape_num == 0) {
+        for (unsigned int i = 0; i < ALL_SHAPE_NUM; i++) {
+            g_shape[g_shape_num++] = g_all_shape[i];
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char * argv[])
+{
+    if (!parseOption(argc, argv)) {
+        fprintf(stderr, "Usage: bench_cfe [-xocfe path] [-gen path] "
+                "[-shape name]... [-scale n] [-repeat n] [-tmp dir] "
+                "[-baseline file [-update]] [-tolerance pct]\n");
+        return 1;
+    }
+    Baseline base[MAX_SHAPE * 4];
+    unsigned int basenum = 0;
+    if (g_baseline != NULL && !g_update) {
+        basenum = readBaseline(base, sizeof(base) / sizeof(base[0]));
+    }
+
+    printf("%-8s %9s %9s %10s %12s %12s %8s\n", "shape", "lines",
+           "tokens", "time(ms)", "tokens/s", "lines/s", "rss(MB)");
+    Result res[MAX_SHAPE];
+    bool regressed = false;
+    for (unsigned int i = 0; i < g_shape_num; i++) {
+        if (!runShape(g_shape[i], res[i])) { return 1; }
+        dumpResult(res[i]);
+        if (isRegressed(res[i], base, basenum)) { regressed = true; }
+    }
+
+    if (g_update && !writeBaseline(res, g_shape_num)) {
+        fprintf(stderr, "can not write %s\n", g_baseline);
+        return 1;
+    }
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,350 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+//This program generates deterministic preprocessed C source to stress
+//each phase of the frontend. The same shape and scale always produce
+//the same output, so the result of benchmark is comparable between
+//different revisions.
+//
+//Usage: gen_corpus <shape> <scale> [output-file]
+//  shape: globals, scope, enum, table, struct, expr, deep, func, wide,
+//         switch, mix
+//  scale: positive integer that controls the size of output.
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+static FILE * g_out = NULL;
+static unsigned int g_seed = 0x2545F491;
+//Set to false if the generated shape is a part of other shape.
+static bool g_gen_main = true;
+
+//A linear congruential generator that is independent of libc.
+static unsigned int rnd(unsigned int n)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return (g_seed >> 16) % n;
+}
+
+
+static char const* g_type[] = {
+    "int", "unsigned int", "char", "short", "long", "float", "double",
+    "unsigned char", "long long"
+};
+#define TYPE_NUM (sizeof(g_type) / sizeof(g_type[0]))
+
+
+//Many global variables with and without initializer.
+static void genGlobals(int scale)
+{
+    int n = scale * 1000;
+    for (int i = 0; i < n; i++) {
+        char const* ty = g_type[rnd(TYPE_NUM)];
+        switch (rnd(4)) {
+        case 0: fprintf(g_out, "%s g%d;\n", ty, i); break;
+        case 1: fprintf(g_out, "%s g%d = %u;\n", ty, i, rnd(1000)); break;
+        case 2: fprintf(g_out, "%s g%d[%u];\n", ty, i, rnd(64) + 1); break;
+        default: fprintf(g_out, "static %s * g%d;\n", ty, i); break;
+        }
+    }
+    if (g_gen_main) {
+        fprintf(g_out, "int main() { return g0 != 0; }\n");
+    }
+}
+
+
+//Deeply nested compound statements, each declares local variables.
+static void genScope(int scale)
+{
+    int depth = 200;
+    for (int f = 0; f < scale * 5; f++) {
+        fprintf(g_out, "int deep%d(int p)\n{\n", f);
+        for (int d = 0; d < depth; d++) {
+            fprintf(g_out, "%*s{ int v%d = p + %d;\n", d % 64, "", d, d);
+            fprintf(g_out, "%*s  if (v%d > %u) { p = v%d; }\n",
+                    d % 64, "", d, rnd(100), d);
+        }
+        for (int d = depth - 1; d >= 0; d--) {
+            fprintf(g_out, "%*s}\n", d % 64, "");
+        }
+        fprintf(g_out, "return p;\n}\n");
+    }
+}
+
+
+//Huge enumerations.
+static void genEnum(int scale)
+{
+    for (int e = 0; e < scale; e++) {
+        fprintf(g_out, "enum E%d {\n", e);
+        for (int i = 0; i < 5000; i++) {
+            if (i % 100 == 0) {
+                fprintf(g_out, "  E%d_%d = %d,\n", e, i, i);
+            } else {
+                fprintf(g_out, "  E%d_%d,\n", e, i);
+            }
+        }
+        fprintf(g_out, "  E%d_END\n};\n", e);
+    }
+    if (g_gen_main) {
+        fprintf(g_out, "int main() { return E0_END; }\n");
+    }
+}
+
+
+//Giant initializer tables.
+static void genTable(int scale)
+{
+    int n = scale * 20000;
+    fprintf(g_out, "unsigned int gtab[%d] = {\n", n);
+    for (int i = 0; i < n; i++) {
+        fprintf(g_out, "%u,%s", rnd(100000), i % 16 == 15 ? "\n" : " ");
+    }
+    fprintf(g_out, "};\n");
+    fprintf(g_out, "int main()\n{\n");
+    fprintf(g_out, "    short ltab[%d][8] = {\n", scale * 500);
+    for (int i = 0; i < scale * 500; i++) {
+        fprintf(g_out, "    {");
+        for (int j = 0; j < 8; j++) {
+            fprintf(g_out, "%u%s", rnd(30000), j == 7 ? "" : ", ");
+        }
+        fprintf(g_out, "},\n");
+    }
+    fprintf(g_out, "    };\n");
+    fprintf(g_out, "    return ltab[0][0] + gtab[0];\n}\n");
+}
+
+
+//Wide structures and accesses of their fields.
+static void genStruct(int scale)
+{
+    for (int s = 0; s < scale * 10; s++) {
+        fprintf(g_out, "struct S%d {\n", s);
+        for (int i = 0; i < 500; i++) {
+            fprintf(g_out, "    %s f%d;\n", g_type[rnd(TYPE_NUM)], i);
+        }
+        if (s > 0) {
+            fprintf(g_out, "    struct S%d * prev;\n", s - 1);
+        }
+        fprintf(g_out, "};\n");
+        fprintf(g_out, "int useS%d(struct S%d * p)\n{\n    return", s, s);
+        for (int i = 0; i < 50; i++) {
+            fprintf(g_out, "%s(int)p->f%u", i == 0 ? " " : " + ",
+                    rnd(500));
+        }
+        fprintf(g_out, ";\n}\n");
+    }
+}
+
+
+//Long expression chains that mix all kinds of binary operators.
+static void genExpr(int scale)
+{
+    static char const* op[] = {
+        "+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^",
+        "<", ">", "<=", ">=", "==", "!=", "&&", "||"
+    };
+    for (int f = 0; f < scale * 10; f++) {
+        fprintf(g_out, "int expr%d(int a, int b, int c)\n{\n", f);
+        for (int s = 0; s < 10; s++) {
+            fprintf(g_out, "    a = ");
+            for (int i = 0; i < 200; i++) {
+                char const* opnd = i % 3 == 0 ? "a" : i % 3 == 1 ? "b" : "c";
+                if (rnd(8) == 0) {
+                    fprintf(g_out, "(%s %s %u) ", opnd,
+                            op[rnd(sizeof(op) / sizeof(op[0]))],
+                            rnd(100) + 1);
+                } else {
+                    fprintf(g_out, "%s ", opnd);
+                }
+                fprintf(g_out, "%s ",
+                        i == 199 ? ";\n" :
+                        op[rnd(sizeof(op) / sizeof(op[0]))]);
+            }
+        }
+        fprintf(g_out, "    return a;\n}\n");
+    }
+}
+
+
+//Machine generated expressions that chain tens of thousands of operands,
+//the depth of tree is proportional to the number of operands.
+static void genDeep(int scale)
+{
+    int n = scale * 20000;
+    fprintf(g_out, "enum DEEP { DEEP_VAL = 0");
+    for (int i = 0; i < n; i++) {
+        fprintf(g_out, "%s%u", rnd(2) == 0 ? " + " : " - ", rnd(10));
+    }
+    fprintf(g_out, " };\n");
+    fprintf(g_out, "int deep(int a, int b)\n{\n    a = b");
+    for (int i = 0; i < n; i++) {
+        fprintf(g_out, " %s %s", rnd(2) == 0 ? "+" : "-",
+                i % 2 == 0 ? "a" : "b");
+    }
+    fprintf(g_out, ";\n    a = (b");
+    for (int i = 0; i < n; i++) {
+        fprintf(g_out, ", %s", i % 2 == 0 ? "a" : "b");
+    }
+    fprintf(g_out, ");\n    return a + DEEP_VAL;\n}\n");
+    if (g_gen_main) {
+        fprintf(g_out, "int main() { return deep(1, 2); }\n");
+    }
+}
+
+
+//Many small functions that call each other.
+static void genFunc(int scale)
+{
+    int n = scale * 2000;
+    for (int f = 0; f < n; f++) {
+        fprintf(g_out, "static int fn%d(int x, int y)\n{\n", f);
+        fprintf(g_out, "    int t = x * %u + y;\n", rnd(10) + 1);
+        if (f > 0) {
+            fprintf(g_out, "    if (t > %u) { t = fn%u(t, x); }\n",
+                    rnd(1000), rnd(f));
+        }
+        fprintf(g_out, "    return t;\n}\n");
+    }
+    if (g_gen_main) {
+        fprintf(g_out, "int main() { return fn%d(1, 2); }\n", n - 1);
+    }
+}
+
+
+//Long lists in one scope: a hundred thousand global declarations, and
+//a function that has thousands of sibling compound statements.
+static void genWide(int scale)
+{
+    int n = scale * 100000;
+    for (int i = 0; i < n; i++) {
+        fprintf(g_out, "%s w%d;\n", g_type[rnd(TYPE_NUM)], i);
+    }
+    fprintf(g_out, "int wide(int p)\n{\n");
+    for (int i = 0; i < n / 10; i++) {
+        fprintf(g_out, "    { int b = p + %u; p = b; }\n", rnd(100));
+    }
+    fprintf(g_out, "    return p;\n}\n");
+    if (g_gen_main) {
+        fprintf(g_out, "int main() { return wide(w0); }\n");
+    }
+}
+
+
+//Large switch statements.
+static void genSwitch(int scale)
+{
+    for (int f = 0; f < scale; f++) {
+        fprintf(g_out, "int sw%d(int x)\n{\n    int r = 0;\n", f);
+        fprintf(g_out, "    switch (x) {\n");
+        for (int i = 0; i < 3000; i++) {
+            fprintf(g_out, "    case %d: r = x * %u; break;\n",
+                    i, rnd(100));
+        }
+        fprintf(g_out, "    default: r = -1;\n    }\n    return r;\n}\n");
+    }
+}
+
+
+static void genMix(int scale)
+{
+    g_gen_main = false;
+    genGlobals(scale);
+    genEnum(scale);
+    genStruct(scale);
+    genFunc(scale);
+    genSwitch(scale);
+    fprintf(g_out, "int main() { return fn0(g0, E0_END) + sw0(1); }\n");
+}
+
+
+typedef void (*GenFunc)(int scale);
+static struct {
+    char const* name;
+    GenFunc func;
+} g_shape[] = {
+    { "globals", genGlobals },
+    { "scope", genScope },
+    { "enum", genEnum },
+    { "table", genTable },
+    { "struct", genStruct },
+    { "expr", genExpr },
+    { "deep", genDeep },
+    { "func", genFunc },
+    { "wide", genWide },
+    { "switch", genSwitch },
+    { "mix", genMix },
+};
+#define SHAPE_NUM (sizeof(g_shape) / sizeof(g_shape[0]))
+
+
+static void usage()
+{
+    fprintf(stderr, "Usage: gen_corpus <shape> <scale> [output-file]\n"
+                    "shape:");
+    for (unsigned int i = 0; i < SHAPE_NUM; i++) {
+        fprintf(stderr, " %s", g_shape[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+
+int main(int argc, char * argv[])
+{
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    int scale = atoi(argv[2]);
+    if (scale <= 0) {
+        usage();
+        return 1;
+    }
+    GenFunc gen = NULL;
+    for (unsigned int i = 0; i < SHAPE_NUM; i++) {
+        if (strcmp(argv[1], g_shape[i].name) == 0) {
+            gen = g_shape[i].func;
+            break;
+        }
+    }
+    if (gen == NULL) {
+        usage();
+        return 1;
+    }
+    g_out = stdout;
+    if (argc > 3) {
+        g_out = fopen(argv[3], "w");
+        if (g_out == NULL) {
+            fprintf(stderr, "can not open %s\n", argv[3]);
+            return 1;
+        }
+    }
+    fprintf(g_out, "/* generated by gen_corpus %s %d */\n", argv[1], scale);
+    gen(scale);
+    if (g_out != stdout) { fclose(g_out); }
+    return 0;
+}
@@ -38,6 +38,7 @@ using namespace xoc;
 #include "cfeutil.h"
 #include "errno.h"
 #include "cfexport.h"
+#include "srcloc.h"
 #include "err.h"
 #include "lex.h"
 #include "typeck.h"
@@ -39,15 +39,22 @@ using namespace xoc;
 #include "cfeutil.h"
 #include "errno.h"
 #include "cfexport.h"
+#include "srcloc.h"
 #include "err.h"
 #include "lex.h"
+#include "pthread.h"
+#include "lexpipe.h"
 #include "typeck.h"
 #include "typetran.h"
 #include "declinit.h"
 #include "scope.h"
 #include "decl.h"
 #include "tree.h"
+#include "treewalk.h"
 #include "st.h"
 #include "cell.h"
 #include "treegen.h"
 #include "exectree.h"
+#include "foldtree.h"
+#include "astdump.h"
+#include "timereport.h"
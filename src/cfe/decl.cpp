@@ -288,10 +288,10 @@ Decl * cp_decl(Decl const* src)
 Decl * cp_decl_begin_at(Decl const* header)
 {
     if (header == nullptr) { return nullptr; }
-    Decl * newl = nullptr, * p;
+    Decl * newl = nullptr, * last = nullptr, * p;
     while (header != nullptr) {
         p = cp_decl(header);
-        xcom::add_next(&newl, p);
+        xcom::append_tail(&newl, &last, p);
         header = DECL_next(header);
     }
     return newl;
@@ -305,6 +305,7 @@ Decl * new_decl(DCL dcl_type)
     #ifdef _DEBUG_
     DECL_uid(d) = g_decl_counter++;
     #endif
+    g_fe_stat.decl_num++;
     return d;
 }
 
@@ -342,7 +343,7 @@ Decl * new_var_decl(IN Scope * scope, CHAR const* name)
     DECL_spec(declaration) = ty;
 
     //Make Tree node.
-    Tree * tree = allocTreeNode(TR_ID, 0);
+    Tree * tree = allocTreeNode(TR_ID, SRCLOC_UNDEF);
     Sym * sym = g_fe_sym_tab->add(name);
     TREE_id(tree) = sym;
 
@@ -495,6 +496,103 @@ Tree * get_decl_init_tree(Decl const* dcl)
 }
 
 
+//Return the compact constant initial value of array, or nullptr if
+//it has not been built.
+InitData * get_decl_init_data(Decl const* dcl)
+{
+    if (DECL_dt(dcl) == DCL_DECLARATION) {
+        dcl = DECL_decl_list(dcl); //get DCRLARATOR
+        ASSERTN(DECL_dt(dcl) == DCL_DECLARATOR ||
+                DECL_dt(dcl) == DCL_ABS_DECLARATOR, ("requires declaration"));
+    }
+    return DECL_init_data(dcl);
+}
+
+
+InitData * new_init_data(Decl * elem_type, UINT elem_size, UINT dimnum,
+                         ULONG const* dims, ULONG elem_num)
+{
+    ASSERT0(elem_type && dims && dimnum > 0);
+    InitData * data = (InitData*)xmalloc(sizeof(InitData));
+    INITDATA_elem_type(data) = elem_type;
+    INITDATA_elem_size(data) = elem_size;
+    INITDATA_dimnum(data) = dimnum;
+    INITDATA_elem_num(data) = elem_num;
+    data->dims = (ULONG*)xmalloc(sizeof(ULONG) * dimnum);
+    ::memcpy(data->dims, dims, sizeof(ULONG) * dimnum);
+    INITDATA_buf(data) = (BYTE*)xmalloc(elem_num * elem_size);
+    return data;
+}
+
+
+//Dump the No.'idx' element of 'data'.
+static void dump_init_elem(InitData const* data, ULONG idx)
+{
+    TypeSpec const* spec = DECL_spec(INITDATA_elem_type(data));
+    BYTE const* p = INITDATA_buf(data) + idx * INITDATA_elem_size(data);
+    if (is_fp(spec)) {
+        if (INITDATA_elem_size(data) == sizeof(float)) {
+            float f;
+            ::memcpy(&f, p, sizeof(f));
+            prt(g_logmgr, " %g", (double)f);
+            return;
+        }
+        double d;
+        ::memcpy(&d, p, sizeof(d));
+        prt(g_logmgr, " %g", d);
+        return;
+    }
+    bool is_signed = !IS_TYPE(spec, T_SPEC_UNSIGNED);
+    LONGLONG v = 0;
+    switch (INITDATA_elem_size(data)) {
+    case 1: v = is_signed ? (LONGLONG)(CHAR)*p : (LONGLONG)*p; break;
+    case 2: {
+        USHORT x;
+        ::memcpy(&x, p, sizeof(x));
+        v = is_signed ? (LONGLONG)(SHORT)x : (LONGLONG)x;
+        break;
+    }
+    case 4: {
+        UINT x;
+        ::memcpy(&x, p, sizeof(x));
+        v = is_signed ? (LONGLONG)(INT)x : (LONGLONG)x;
+        break;
+    }
+    case 8: ::memcpy(&v, p, sizeof(v)); break;
+    default: UNREACHABLE();
+    }
+    if (is_signed) {
+        prt(g_logmgr, " %lld", v);
+    } else {
+        prt(g_logmgr, " %llu", (ULONGLONG)v);
+    }
+}
+
+
+//Dump the compact initial value in row-major order, at most
+//MAX_DUMP_INIT_DATA_ELEM elements are dumped.
+void dump_init_data(InitData const* data)
+{
+    if (g_logmgr == nullptr || data == nullptr) { return; }
+    xcom::SmallStrBuf<64> buf;
+    format_declaration(buf, INITDATA_elem_type(data));
+    note(g_logmgr, "\nINIT_DATA(elem:%s, elem_size:%u, dims:", buf.buf,
+         INITDATA_elem_size(data));
+    for (UINT i = 0; i < INITDATA_dimnum(data); i++) {
+        prt(g_logmgr, "[%lu]", (unsigned long)INITDATA_dim(data, i));
+    }
+    prt(g_logmgr, ")");
+    g_logmgr->incIndent(2);
+    ULONG num = MIN(INITDATA_elem_num(data), (ULONG)MAX_DUMP_INIT_DATA_ELEM);
+    for (ULONG i = 0; i < num; i++) {
+        if (i % 16 == 0) { note(g_logmgr, "\n"); }
+        dump_init_elem(data, i);
+    }
+    if (num < INITDATA_elem_num(data)) { prt(g_logmgr, " ..."); }
+    g_logmgr->decIndent(2);
+}
+
+
 bool is_volatile(Decl const* dcl)
 {
     ASSERTN(DECL_dt(dcl) == DCL_DECLARATION, ("requires declaration"));
@@ -943,7 +1041,7 @@ static Decl * struct_declaration()
         DECL_decl_list(declaration) = dcl;
         DECL_align(declaration) = g_alignment;
         DECL_decl_scope(declaration) = g_cur_scope;
-        DECL_lineno(declaration) = g_real_line_num;
+        DECL_loc(declaration) = g_real_loc;
 
         if (is_user_type_decl(declaration)) {
             err(g_real_line_num,
@@ -956,10 +1054,10 @@ static Decl * struct_declaration()
             declaration = factor_user_type(declaration);
             DECL_align(declaration) = g_alignment;
             DECL_decl_scope(declaration) = g_cur_scope;
-            DECL_lineno(declaration) = g_real_line_num;
+            DECL_loc(declaration) = g_real_loc;
         }
 
-        xcom::add_next(&SCOPE_decl_list(g_cur_scope), declaration);
+        add_decl_to_scope(g_cur_scope, declaration);
         DECL_decl_scope(declaration) = g_cur_scope;
     }
 
@@ -1009,7 +1107,7 @@ static void type_spec_struct_field(Struct * s, TypeSpec * ty)
     ASSERT0(s);
     match(T_LLPAREN);
     push_scope(false);
-    //UINT errn = g_err_msg_list.get_elem_count();
+    //UINT errn = get_err_count();
     STRUCT_decl_list(s) = struct_declaration_list();
     if (STRUCT_decl_list(s) == nullptr) {
         //Empty field list, for compiler convenient, insert one byte field.
@@ -1017,7 +1115,7 @@ static void type_spec_struct_field(Struct * s, TypeSpec * ty)
         STRUCT_decl_list(s) = var;
     }
     pop_scope();
-    //if (g_err_msg_list.get_elem_count() == errn) {
+    //if (get_err_count() == errn) {
     //    STRUCT_is_complete(s) = true;
     //}
 
@@ -1121,7 +1219,7 @@ static void type_spec_union_field(Union * s, TypeSpec * ty)
     match(T_LLPAREN);
     push_scope(false);
 
-    //UINT errn = g_err_msg_list.get_elem_count();
+    //UINT errn = get_err_count();
     AGGR_decl_list(s) = union_declaration_list();
     if (AGGR_decl_list(s) == nullptr) {
         //Empty field list, for compiler convenient, insert one byte field.
@@ -1129,7 +1227,7 @@ static void type_spec_union_field(Union * s, TypeSpec * ty)
         AGGR_decl_list(s) = var;
     }
     pop_scope();
-    //if (g_err_msg_list.get_elem_count() == errn) {
+    //if (get_err_count() == errn) {
     //    UNION_is_complete(s) = true;
     //}
 
@@ -1747,7 +1845,7 @@ static Decl * parameter_declaration()
         declaration = factor_user_type(declaration);
         DECL_align(declaration) = g_alignment;
         DECL_decl_scope(declaration) = g_cur_scope;
-        DECL_lineno(declaration) = g_real_line_num;
+        DECL_loc(declaration) = g_real_loc;
     }
 
     return declaration;
@@ -1768,13 +1866,13 @@ static Decl * parameter_declaration()
 //    parameter_declaration , ...
 static Decl * parameter_type_list()
 {
-    Decl * declaration = nullptr , * t = nullptr;
+    Decl * declaration = nullptr , * t = nullptr, * last = nullptr;
     for (;;) {
         t = parameter_declaration();
         if (t == nullptr) {
             return declaration;
         }
-        xcom::add_next(&declaration, t);
+        xcom::append_tail(&declaration, &last, t);
         if (g_real_token == T_COMMA) {
             match(T_COMMA);
         } else if (g_real_token == T_RPAREN ||
@@ -1788,7 +1886,7 @@ static Decl * parameter_type_list()
         if (g_real_token == T_DOTDOTDOT) {
             match(T_DOTDOTDOT);
             t = new_decl(DCL_VARIABLE);
-            xcom::add_next(&declaration, t);
+            xcom::append_tail(&declaration, &last, t);
             break;
         }
     }
@@ -1822,7 +1920,7 @@ static Decl * direct_abstract_declarator(TypeSpec * qua)
         break;
     case T_ID: { //identifier
         Sym * sym = g_fe_sym_tab->add(g_real_token_string);
-        add_to_symtab_list(&SCOPE_sym_tab_list(g_cur_scope), sym);
+        add_to_symtab_list(g_cur_scope, sym);
         dcl = new_decl(DCL_ID);
         DECL_id(dcl) = id();
         DECL_qua(dcl) = qua;
@@ -2016,7 +2114,7 @@ static Tree * initializer(TypeSpec * qua)
     Tree * t = nullptr, * es = nullptr;
     switch (g_real_token) {
     case T_LLPAREN: {
-        UINT lineno = g_real_line_num;
+        SrcLoc loc = g_real_loc;
         match(T_LLPAREN); 
         t = initializer_list(qua);
         if (g_real_token == T_COMMA) {
@@ -2029,7 +2127,7 @@ static Tree * initializer(TypeSpec * qua)
             err(g_real_line_num, "syntax error : '%s'", g_real_token_string);
             return t;
         }
-        es = allocTreeNode(TR_INITVAL_SCOPE, lineno);
+        es = allocTreeNode(TR_INITVAL_SCOPE, loc);
         TREE_initval_scope(es) = t;
         t = es;
         return t;
@@ -2100,10 +2198,11 @@ static Decl * struct_declarator_list(TypeSpec * qua)
     Decl * dclr = struct_declarator(qua), * ndclr = nullptr;
     if (dclr == nullptr) { return nullptr; }
 
+    Decl * last = nullptr;
     while (g_real_token == T_COMMA) {
         match(T_COMMA);
         ndclr = struct_declarator(qua);
-        xcom::add_next(&dclr, ndclr);
+        xcom::append_tail(&dclr, &last, ndclr);
     }
 
     return dclr;
@@ -2376,10 +2475,11 @@ static Decl * init_declarator_list(TypeSpec * qua)
     if (dclr == nullptr) {
         return nullptr;
     }
+    Decl * last = nullptr;
     while (g_real_token == T_COMMA) {
         match(T_COMMA);
         Decl * ndclr = init_declarator(qua);
-        xcom::add_next(&dclr, ndclr);
+        xcom::append_tail(&dclr, &last, ndclr);
     }
     return dclr;
 }
@@ -2417,7 +2517,7 @@ static Decl * direct_declarator(TypeSpec * qua)
         break;
     case T_ID: { //identifier
         Sym * sym = g_fe_sym_tab->add(g_real_token_string);
-        add_to_symtab_list(&SCOPE_sym_tab_list(g_cur_scope), sym);
+        add_to_symtab_list(g_cur_scope, sym);
         dcl = new_decl(DCL_ID);
         DECL_id(dcl) = id();
         DECL_qua(dcl) = qua;
@@ -2494,7 +2594,7 @@ TypeSpec * cp_spec(TypeSpec * ty)
 //    '*' type-qualifier-list(pass) pointer
 static Decl * pointer(TypeSpec ** qua)
 {
-    Decl * ndcl = nullptr;
+    Decl * ndcl = nullptr, * last = nullptr;
     TypeSpec * new_qua = *qua;
     while (g_real_token == T_ASTERISK) {
         match(T_ASTERISK);
@@ -2506,7 +2606,7 @@ static Decl * pointer(TypeSpec ** qua)
             SET_FLAG(TYPE_des(DECL_qua(dcl)), T_QUA_RESTRICT);
             REMOVE_FLAG(TYPE_des(new_qua), T_QUA_RESTRICT);
         }
-        xcom::add_next(&ndcl, dcl);
+        xcom::append_tail(&ndcl, &last, dcl);
     }
     quan_spec(new_qua); //match qualifier for followed ID.
     *qua = new_qua;
@@ -2641,7 +2741,7 @@ static Tree * refineArray(Tree * t)
 
     if (base_of_pt != nullptr && DECL_dt(base_of_pt) == DCL_ARRAY) {
         //The base of pointer is an array. Convert a[] to (*a)[].
-        Tree * deref = allocTreeNode(TR_DEREF, TREE_lineno(base));
+        Tree * deref = allocTreeNode(TR_DEREF, TREE_loc(base));
         TREE_lchild(deref) = base;
         setParent(deref, TREE_lchild(deref));
         TREE_array_base(t) = deref;
@@ -2652,37 +2752,55 @@ static Tree * refineArray(Tree * t)
 }
 
 
+//RefineTreeVisitor
 //Do refinement and amendment for tree.
 //    * Revise formal parameter. In C spec, formal array is pointer
 //      that point to an array in actually.
-static Tree * refine_tree(Tree * t)
-{
-    if (t == nullptr) { return nullptr; }
-    if (TREE_type(t) == TR_ARRAY) {
-        t = refineArray(t);
-    } else if (TREE_type(t) == TR_SCOPE) {
-        Scope * s = TREE_scope(t);
-        SCOPE_stmt_list(s) = refine_tree_list(SCOPE_stmt_list(s));
+class RefineTreeVisitor {
+    COPY_CONSTRUCTOR(RefineTreeVisitor);
+public:
+    RefineTreeVisitor() {}
+
+    WALK_ACT visitPre(TreeWalkFrame<TreeWalkNoData> & f)
+    {
+        if (TREE_type(f.tree) == TR_ARRAY) {
+            f.tree = refineArray(f.tree);
+        }
+        return WALK_CONT;
     }
 
-    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
-        refine_tree_list(TREE_fld(t, i));
+    bool getKid(TreeWalkFrame<TreeWalkNoData> & f,
+                OUT TreeWalkFrame<TreeWalkNoData> & kid)
+    {
+        Tree * t = f.tree;
+        if (TREE_type(t) != TR_SCOPE) {
+            return fetchKid(f.kid_idx, kid, MAX_TREE_FLDS, TREE_fld(t, 0),
+                            TREE_fld(t, 1), TREE_fld(t, 2), TREE_fld(t, 3));
+        }
+        if (f.kid_idx == 0) {
+            kid.tree = SCOPE_stmt_list(TREE_scope(t));
+            return true;
+        }
+        return fetchKid(f.kid_idx - 1, kid, MAX_TREE_FLDS, TREE_fld(t, 0),
+                        TREE_fld(t, 1), TREE_fld(t, 2), TREE_fld(t, 3));
     }
-    return t;
-}
+
+    WALK_ACT visitPost(TreeWalkFrame<TreeWalkNoData> & f,
+                       TreeWalkFrame<TreeWalkNoData> * parent)
+    {
+        DUMMYUSE(f);
+        DUMMYUSE(parent);
+        return WALK_CONT;
+    }
+};
 
 
 static Tree * refine_tree_list(Tree * t)
 {
-    if (t == nullptr) { return nullptr; }
-    Tree * head = t;
-    int i = 0;
-    while (t != nullptr) {
-        refine_tree(t);
-        t = TREE_nsib(t);
-        i++;
-    }
-    return head;
+    RefineTreeVisitor visitor;
+    TreeWalker<RefineTreeVisitor> walker(visitor);
+    walker.walk(t, true);
+    return t;
 }
 
 
@@ -2693,7 +2811,7 @@ static void refine_func(Decl * func)
     Tree * t = SCOPE_stmt_list(scope);
     if (t != nullptr) {
         t = refine_tree_list(t);
-        if (g_err_msg_list.get_elem_count() == 0) {
+        if (get_err_count() == 0) {
             ASSERTN(TREE_parent(t) == nullptr,
                     ("parent node of Tree is nullptr"));
         }
@@ -2717,6 +2835,7 @@ Decl * trans_to_pointer(Decl * decl, bool is_append)
     Decl * pure = const_cast<Decl*>(get_pure_declarator(decl));
     Decl * p = pure;
     Decl * new_pure = nullptr;
+    Decl * new_last = nullptr;
     bool isdo = true;
     INT count = 0;
     while (pure != nullptr) {
@@ -2730,7 +2849,7 @@ Decl * trans_to_pointer(Decl * decl, bool is_append)
                     isdo = false;
                 }
                 p = cp_decl(pure);
-                xcom::add_next(&new_pure, p);
+                xcom::append_tail(&new_pure, &new_last, p);
                 break;
             }
         case DCL_ARRAY: //ARRAY declarator
@@ -2738,18 +2857,18 @@ Decl * trans_to_pointer(Decl * decl, bool is_append)
                 if (is_append) {
                     is_append = false;
                     p = new_decl(DCL_POINTER);
-                    xcom::add_next(&new_pure, p);
+                    xcom::append_tail(&new_pure, &new_last, p);
                     isdo = false;
                 }
 
                 if (!isdo) {
                     p = cp_decl(pure);
                     DECL_is_paren(p) = 1;
-                    xcom::add_next(&new_pure, p);
+                    xcom::append_tail(&new_pure, &new_last, p);
                 } else {
                     count++;
                     p = new_decl(DCL_POINTER);
-                    xcom::add_next(&new_pure, p);
+                    xcom::append_tail(&new_pure, &new_last, p);
                 }
                 break;
             }
@@ -2786,35 +2905,6 @@ Enum * find_enum(EnumList * elst , Enum * e)
 }
 
 
-//Return nullptr indicate we haven't found it in 'ut_list', and
-//append 'ut' to tail of the list as correct, otherwise return
-//the finded one.
-Decl * addToUserTypeList(UserTypeList ** ut_list , Decl * decl)
-{
-   if (ut_list == nullptr || decl == nullptr) return nullptr;
-   if ((*ut_list) == nullptr) {
-        *ut_list = (UserTypeList*)xmalloc(sizeof(UserTypeList));
-        USER_TYPE_LIST_utype(*ut_list) = decl;
-        return nullptr;
-   } else {
-        UserTypeList * p = *ut_list, * q = nullptr;
-        while (p != nullptr) {
-            q = p;
-            if (USER_TYPE_LIST_utype(p) == decl) {
-                //'sym' already exist, return 'sym' as result
-                return decl;
-            }
-            p = USER_TYPE_LIST_next(p);
-        }
-        USER_TYPE_LIST_next(q) = (UserTypeList*)xmalloc(sizeof(UserTypeList));
-        USER_TYPE_LIST_prev(USER_TYPE_LIST_next(q)) = q;
-        q = USER_TYPE_LIST_next(q);
-        USER_TYPE_LIST_utype(q) = decl;
-    }
-    return nullptr;
-}
-
-
 //Return true if enum-value existed in current scope.
 bool is_enum_exist(EnumList const* e_list,
                    CHAR const* e_name,
@@ -4234,7 +4324,7 @@ INT format_declaration(Decl const* decl, INT indent)
     if (decl == nullptr || g_logmgr == nullptr) { return ST_SUCC; }
     note(g_logmgr, "\n");
 
-    StrBuf sbuf(128);
+    SmallStrBuf<128> sbuf;
     if (DECL_dt(decl) == DCL_DECLARATION || DECL_dt(decl) == DCL_TYPE_NAME) {
         TypeSpec * ty = DECL_spec(decl);
         Decl * dcl = DECL_decl_list(decl);
@@ -4289,16 +4379,30 @@ INT format_declaration(Decl const* decl, INT indent)
 //END DECL_FMT
 
 
-//Fetch const value of 't' refered
-INT get_enum_const_val(Enum const* e, INT idx)
+//Get the No.'idx' enum constant of 'e'.
+static EnumValueList * get_enum_const(Enum const* e, INT idx)
 {
-    if (e == nullptr) { return -1; }
+    if (ENUM_valtab(e) != nullptr) {
+        if (idx < 0 || (UINT)idx >= ENUM_valnum(e)) { return nullptr; }
+        return ENUM_valtab(e)[idx];
+    }
 
-    EnumValueList const* evl = ENUM_vallist(e);
+    //Index table has not been built yet.
+    EnumValueList * evl = ENUM_vallist(e);
     while (idx > 0 && evl != nullptr) {
         evl = EVAL_LIST_next(evl);
         idx--;
     }
+    return evl;
+}
+
+
+//Fetch const value of 't' refered
+INT get_enum_const_val(Enum const* e, INT idx)
+{
+    if (e == nullptr) { return -1; }
+
+    EnumValueList const* evl = get_enum_const(e, idx);
 
     if (evl == nullptr) {
         err(g_src_line_num, "enum const No.%d is not exist", idx);
@@ -4314,11 +4418,7 @@ CHAR const* get_enum_const_name(Enum const* e, INT idx)
 {
     if (e == nullptr) { return nullptr; }
 
-    EnumValueList * evl = ENUM_vallist(e);
-    while (idx > 0 && evl != nullptr) {
-        evl = EVAL_LIST_next(evl);
-        idx--;
-    }
+    EnumValueList * evl = get_enum_const(e, idx);
 
     if (evl == nullptr) {
         err(g_src_line_num, "enum const No.%d is not exist", idx);
@@ -4746,10 +4846,10 @@ Decl * cp_type_name(Decl const* src)
     PURE_DECL(dest) = nullptr;
     DECL_spec(dest) = DECL_spec(src);
 
-    Decl * p = PURE_DECL(src), * q;
+    Decl * p = PURE_DECL(src), * q, * last = nullptr;
     while (p != nullptr) {
         q = cp_decl(p);
-        xcom::add_next(&PURE_DECL(dest), q);
+        xcom::append_tail(&PURE_DECL(dest), &last, q);
         p = DECL_next(p);
     }
     return dest;
@@ -4878,7 +4978,7 @@ static bool check_struct_union_complete(Decl * decl)
             if (e) {
                 //error occur!
                 ASSERT0(t);
-                StrBuf buf(64);
+                SmallStrBuf<64> buf;
                 if (name != nullptr) {
                     format_struct_union_complete(buf,
                         get_pure_type_spec(type_spec));
@@ -4918,19 +5018,15 @@ static bool func_def(Decl * declaration)
     }
 
     //Check if 'decl' is unique at scope declaration list.
-    Decl * dcl = SCOPE_decl_list(g_cur_scope);
-    while (dcl != nullptr) {
-        if (is_decl_equal(dcl, declaration) && declaration != dcl
-            && DECL_is_fun_def(dcl)) {
-            err(g_real_line_num, "function '%s' already defined",
-                SYM_name(get_decl_sym(dcl)));
-            return false;
-        }
-        dcl = DECL_next(dcl);
+    Decl * dcl = find_fun_def_in_scope(g_cur_scope, get_decl_sym(declaration));
+    if (dcl != nullptr && dcl != declaration) {
+        err(g_real_line_num, "function '%s' already defined",
+            SYM_name(get_decl_sym(dcl)));
+        return false;
     }
 
     //Add decl to scope here to support recursive func-call.
-    xcom::add_next(&SCOPE_decl_list(g_cur_scope), declaration);
+    add_decl_to_scope(g_cur_scope, declaration);
 
     //At function definition mode, identifier of each
     //parameters cannot be nullptr.
@@ -4948,6 +5044,7 @@ static bool func_def(Decl * declaration)
     DECL_is_fun_def(declaration) = true;
     ASSERTN(SCOPE_level(g_cur_scope) == GLOBAL_SCOPE,
             ("Funtion declaration should in global scope"));
+    set_fun_def_in_scope(g_cur_scope, declaration);
 
     refine_func(declaration);
     if (ST_SUCC != label_ck(get_last_sub_scope(g_cur_scope))) {
@@ -5083,6 +5180,27 @@ static void inferEnumValue(EnumValueList * evals)
 }
 
 
+//Build index table for enum value list to access enum constant
+//by index in O(1).
+static void buildEnumValTab(Enum * e)
+{
+    UINT n = 0;
+    for (EnumValueList * evl = ENUM_vallist(e);
+         evl != nullptr; evl = EVAL_LIST_next(evl)) {
+        n++;
+    }
+    EnumValueList ** tab = (EnumValueList**)xmalloc(
+        sizeof(EnumValueList*) * n);
+    n = 0;
+    for (EnumValueList * evl = ENUM_vallist(e);
+         evl != nullptr; evl = EVAL_LIST_next(evl)) {
+        tab[n++] = evl;
+    }
+    ENUM_valtab(e) = tab;
+    ENUM_valnum(e) = n;
+}
+
+
 static void process_enum(TypeSpec * ty)
 {
     if (!IS_ENUM_TYPE(ty) || TYPE_enum_type(ty) == nullptr) { return; }
@@ -5091,6 +5209,7 @@ static void process_enum(TypeSpec * ty)
     if (evals == nullptr) { return; }
 
     inferEnumValue(evals);
+    buildEnumValTab(TYPE_enum_type(ty));
 
     EnumList * elst = (EnumList*)xmalloc(sizeof(EnumList));
     ENUM_LIST_enum(elst) = TYPE_enum_type(ty);
@@ -5129,7 +5248,7 @@ void fix_extern_array_size(Decl * declaration)
 //Split them into a list of declarations via generating the DCL_DECLARATION
 //accroding TypeSpec, DECLLARATOR.
 bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
-                               UINT lineno, bool * is_last_fun_def)
+                               SrcLoc loc, bool * is_last_fun_def)
 {
     *is_last_fun_def = false;
     while (dcl_list != nullptr) {
@@ -5145,13 +5264,13 @@ bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
         DECL_decl_list(declaration) = dcl;
         DECL_align(declaration) = g_alignment;
         DECL_decl_scope(declaration) = g_cur_scope;
-        DECL_lineno(declaration) = lineno;
+        DECL_loc(declaration) = loc;
 
         if (IS_USER_TYPE_REF(type_spec)) {
             declaration = factor_user_type(declaration);
             DECL_align(declaration) = g_alignment;
             DECL_decl_scope(declaration) = g_cur_scope;
-            DECL_lineno(declaration) = lineno;
+            DECL_loc(declaration) = loc;
         }
 
         if (is_fun_decl(declaration)) {
@@ -5161,7 +5280,7 @@ bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
                 }
             } else if (g_real_token == T_SEMI) {
                 //Function Declaration.
-                xcom::add_next(&SCOPE_decl_list(g_cur_scope), declaration);
+                add_decl_to_scope(g_cur_scope, declaration);
                 DECL_is_fun_def(declaration) = 0;
             } else {
                 err(g_real_line_num,
@@ -5172,12 +5291,14 @@ bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
         } else {
             //Common variable definition/declaration.
             //Check the declarator that should be unique at current scope.
-            if (!is_unique_decl(SCOPE_decl_list(g_cur_scope), declaration)) {
+            Decl * prev = find_decl_in_scope(g_cur_scope,
+                                             get_decl_sym(declaration));
+            if (prev != nullptr && prev != declaration) {
                 err(g_real_line_num, "'%s' already defined",
                     SYM_name(get_decl_sym(declaration)));
                 return false;
             }
-            xcom::add_next(&SCOPE_decl_list(g_cur_scope), declaration);
+            add_decl_to_scope(g_cur_scope, declaration);
         }
 
         if (is_user_type_decl(declaration)) { //typedef declaration
@@ -5185,7 +5306,7 @@ bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
             //current identifier is identical exactly in current scope,
             //it is dispensable to warry about the redefinition, even if
             //invoking is_user_type_exist().
-            addToUserTypeList(&SCOPE_user_type_list(g_cur_scope), declaration);
+            add_user_type_to_scope(g_cur_scope, declaration);
         }
 
         if (!check_struct_union_complete(declaration)) {
@@ -5220,7 +5341,7 @@ bool post_init_declarator_list(Decl * dcl_list, TypeSpec * type_spec,
 //Return true if variable declaration is found.
 bool declaration()
 {
-    UINT lineno = g_real_line_num;
+    SrcLoc loc = g_real_loc;
     TypeSpec * type_spec = declaration_spec();
     if (type_spec == nullptr) { return false; }
 
@@ -5247,7 +5368,7 @@ bool declaration()
     
     bool is_last_fun_def = false;
     if (!post_init_declarator_list(dcl_list, type_spec,
-                                   lineno, &is_last_fun_def)) {
+                                   loc, &is_last_fun_def)) {
         return def_or_init_var;
     }
 
@@ -49,11 +49,17 @@ public:
 //Record Enum info, and field 'name' reserved its character description.
 #define ENUM_name(e) ((e)->name)
 #define ENUM_vallist(e) ((e)->pevlist)
+//Record the index table of enum value list, it is built when enum value
+//inferred, and used to access the No.N enum constant in O(1).
+#define ENUM_valtab(e) ((e)->valtab)
+#define ENUM_valnum(e) ((e)->valnum)
 class Enum {
 public:
     INT val;
+    UINT valnum;
     Sym * name;
     EnumValueList * pevlist;
+    EnumValueList ** valtab;
 };
 
 
@@ -229,6 +235,33 @@ public:
 };
 
 
+//The maximum number of elements that dump_init_data() dumps.
+#define MAX_DUMP_INIT_DATA_ELEM 1024
+
+//InitData
+//Record the constant initial value of array with scalar element in a
+//contiguous buffer. Elements are stored in row-major order in host byte
+//order, each element occupies 'elem_size' bytes. Elements that are not
+//initialized or not constant are zero in the buffer.
+//Note dims[0] may be larger than the declared dimension if the size of
+//array is determined by the initializer, e.g: char s[] = "abc";
+#define INITDATA_elem_type(d) ((d)->elem_type)
+#define INITDATA_elem_size(d) ((d)->elem_size)
+#define INITDATA_elem_num(d) ((d)->elem_num)
+#define INITDATA_dimnum(d) ((d)->dimnum)
+#define INITDATA_dim(d, i) ((d)->dims[i])
+#define INITDATA_buf(d) ((d)->buf)
+class InitData {
+public:
+    UINT elem_size; //byte size of each element.
+    UINT dimnum; //the number of dimensions.
+    ULONG elem_num; //the number of elements of whole array.
+    ULONG * dims; //the number of elements of each dimension.
+    Decl * elem_type; //the declaration of element type.
+    BYTE * buf;
+};
+
+
 //
 //START Decl
 //
@@ -257,7 +290,7 @@ public:
     Decl * prev;
     Decl * next;
     Decl * child;
-    UINT lineno; //record line number of declaration.
+    SrcLoc loc; //record location of declaration.
 
     //record the num of fields while the base of Decl is Struct/Union.
     UINT fieldno;
@@ -329,6 +362,10 @@ public:
         //ONLY record as a child of DCL_DECLARATOR
         Tree * init;
     } u2;
+
+    //Record the compact constant initial value of array.
+    //ONLY record as a child of DCL_DECLARATOR
+    InitData * init_data;
 };
 
 #ifdef _DEBUG_
@@ -368,13 +405,19 @@ public:
 //qualifier include const, volatile, restrict.
 #define DECL_qua(d) (d)->qualifier
 
-//Line number
-#define DECL_lineno(d) (d)->lineno
+//Location and line number
+#define DECL_loc(d) (d)->loc
+#define DECL_lineno(d) getSrcRealLineNum(DECL_loc(d))
 
 //If current 'decl' is a DCL_DECLARATOR, the followed member
 //record it initializing tree
 #define DECL_init_tree(d) (d)->u2.init
 
+//If current 'decl' is a DCL_DECLARATOR of array, the followed member
+//record the compact constant initial value, which is built by
+//processDeclInit().
+#define DECL_init_data(d) (d)->init_data
+
 //If current 'decl' is DCL_ID , the followed member record it
 #define DECL_id(d) (d)->u1.id
 
@@ -414,7 +457,6 @@ public:
 #define DECL_FMT_INDENT_INTERVAL 4
 
 //Exported Functions
-Decl * addToUserTypeList(UserTypeList ** ut_list , Decl * decl);
 
 //Copy Decl of src is DCL_TYPE_NAME, or generate TYPE_NAME accroding
 //to src information.
@@ -559,6 +601,12 @@ bool is_struct(Decl const* decl);
 bool is_bitfield(Decl const* decl);
 
 Tree * get_decl_init_tree(Decl const* dcl);
+InitData * get_decl_init_data(Decl const* dcl);
+//Allocate InitData with zero buffer.
+//dims: the number of elements of each dimension, the array is copied.
+InitData * new_init_data(Decl * elem_type, UINT elem_size, UINT dimnum,
+                         ULONG const* dims, ULONG elem_num);
+void dump_init_data(InitData const* data);
 CHAR const* get_aggr_type_name(TypeSpec const* type);
 Decl const* gen_type_name(TypeSpec * ty);
 Decl const* get_return_type(Decl const* dcl);
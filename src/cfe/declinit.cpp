@@ -28,35 +28,42 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "cfeinc.h"
 #include "cfecommacro.h"
 
+//Array that its byte size exceeds the limit is not compacted.
+#define MAX_INIT_DATA_BYTE_SIZE 0x4000000
+
 static void replaceBaseWith(Tree const* newbase, Tree * stmts);
-static INT processAggrInit(Decl const* dcl, Tree * initval, OUT Tree ** stmts);
+static INT processAggrInit(Decl const* dcl, Tree * initval,
+                           OUT Tree ** stmts, OUT Tree ** last);
 static INT processScope(Scope * scope);
 
-static INT processArrayInitRecur(Decl const* dcl, Tree * initval, UINT curdim,
-                                 xcom::Vector<UINT> & dimvec,
-                                 OUT Tree ** stmts)
+//elemdcl: the declaration of element of 'dcl'.
+static INT processArrayInitRecur(Decl const* dcl, Decl const* elemdcl,
+                                 Tree * initval, UINT curdim,
+                                 IdxVec & dimvec,
+                                 OUT Tree ** stmts, OUT Tree ** last)
 {
     if (TREE_type(initval) == TR_INITVAL_SCOPE) {
-        Decl const* dummy_elemdcl = get_array_elem_decl(dcl);
-        if (is_aggr(dummy_elemdcl)) {
+        if (is_aggr(elemdcl)) {
             Tree * inittree = nullptr;
+            Tree * initlast = nullptr;
             //If element of array is Aggregate type.
-            processAggrInit(dummy_elemdcl, initval, &inittree);
+            processAggrInit(elemdcl, initval, &inittree, &initlast);
 
             Tree * arr_ref = buildArray(dcl, dimvec);
-            TREE_lineno(arr_ref) = TREE_lineno(initval);
+            TREE_loc(arr_ref) = TREE_loc(initval);
             replaceBaseWith(arr_ref, inittree);
-            xcom::add_next(stmts, inittree);
+            xcom::add_next(stmts, last, inittree);
             return ST_SUCC;
         }
 
-        if (is_array(dummy_elemdcl)) {
+        if (is_array(elemdcl)) {
             curdim++;
             UINT pos_in_curdim = 0;
             for (Tree * t = TREE_initval_scope(initval);
                  t != nullptr; t = TREE_nsib(t), pos_in_curdim++) {
                 dimvec.set(curdim, pos_in_curdim);
-                processArrayInitRecur(dcl, t, curdim, dimvec, stmts);
+                processArrayInitRecur(dcl, elemdcl, t, curdim, dimvec,
+                                      stmts, last);
             }
             return ST_SUCC;
         }
@@ -66,10 +73,10 @@ static INT processArrayInitRecur(Decl const* dcl, Tree * initval, UINT curdim,
     }
 
     Tree * lhs = buildArray(dcl, dimvec);
-    TREE_lineno(lhs) = TREE_lineno(initval);
+    TREE_loc(lhs) = TREE_loc(initval);
     Tree * assign = buildAssign(lhs, copyTree(initval));
-    TREE_lineno(assign) = TREE_lineno(initval);
-    xcom::add_next(stmts, assign);
+    TREE_loc(assign) = TREE_loc(initval);
+    xcom::add_next(stmts, last, assign);
     return ST_SUCC;
 }
 
@@ -77,25 +84,29 @@ static INT processArrayInitRecur(Decl const* dcl, Tree * initval, UINT curdim,
 //dcl: the declaration of array.
 //initval: the initial-value tree to array.
 //stmts: generated tree to perform initialization of array.
-static INT processArrayInit(Decl const* dcl, Tree * initval, OUT Tree ** stmts)
+//last: the last tree of 'stmts'.
+static INT processArrayInit(Decl const* dcl, Tree * initval,
+                            OUT Tree ** stmts, OUT Tree ** last)
 {
     ASSERT0(initval && TREE_type(initval) == TR_INITVAL_SCOPE);
 
     //Record the position in each dimension of array.
     //e.g: given array[I][J][K], curdim begins at the left-first dimension I,
     //the position in dimension I begins at 0.
-    xcom::Vector<UINT> dimvec;
+    IdxVec dimvec;
     //TBD:Could 'dcl' be declared as zero dimension array? May be it is true
     //in dynamic-type language.
     for (INT i = get_array_dim(dcl) - 1; i >= 0; i--) {
         dimvec.set(i, 0);
     }
+    //Element declaration is same to all elements.
+    Decl const* elemdcl = get_array_elem_decl(dcl);
     UINT pos_in_curdim = 0;
     UINT curdim = 0;
     for (Tree * t = TREE_initval_scope(initval);
          t != nullptr; t = TREE_nsib(t), pos_in_curdim++) {
         dimvec.set(curdim, pos_in_curdim);
-        processArrayInitRecur(dcl, t, curdim, dimvec, stmts);
+        processArrayInitRecur(dcl, elemdcl, t, curdim, dimvec, stmts, last);
     }
     return ST_SUCC;
 }
@@ -117,14 +128,14 @@ static Tree * canonArrayInitVal(Decl const* dcl, Tree * initval)
         size_t len = ::strlen(str) + 1;
         Tree * last = nullptr;
         Tree * explst = nullptr;
-        UINT lineno = TREE_lineno(initval);
+        SrcLoc loc = TREE_loc(initval);
         for (UINT i = 0; i < len; i++) {
             Tree * v = buildUInt(str[i]);
-            TREE_lineno(v) = lineno;
+            TREE_loc(v) = loc;
             xcom::add_next(&explst, &last, v);
         }
         Tree * new_initval = buildInitvalScope(explst);
-        TREE_lineno(new_initval) = lineno;
+        TREE_loc(new_initval) = loc;
         return new_initval;
     }
 
@@ -133,17 +144,285 @@ static Tree * canonArrayInitVal(Decl const* dcl, Tree * initval)
 }
 
 
+static bool is_const_init_operand(Tree const* t);
+
+//Return true if 't' only consists of constants and arithmetic operators.
+//Note 't' itself may be one of the element list of initializer.
+static bool is_const_init_exp(Tree const* t)
+{
+    if (t == nullptr) { return false; }
+    switch (TREE_type(t)) {
+    case TR_IMM:
+    case TR_IMMU:
+    case TR_IMML:
+    case TR_IMMUL:
+    case TR_FP:
+    case TR_FPF:
+    case TR_FPLD:
+    case TR_ENUM_CONST:
+        return true;
+    case TR_CVT:
+        return is_const_init_operand(TREE_cast_exp(t));
+    case TR_PLUS:
+    case TR_MINUS:
+    case TR_REV:
+    case TR_NOT:
+        return is_const_init_operand(TREE_lchild(t));
+    case TR_LOGIC_OR:
+    case TR_LOGIC_AND:
+    case TR_INCLUSIVE_OR:
+    case TR_INCLUSIVE_AND:
+    case TR_XOR:
+    case TR_EQUALITY:
+    case TR_RELATION:
+    case TR_SHIFT:
+    case TR_ADDITIVE:
+    case TR_MULTI:
+        return is_const_init_operand(TREE_lchild(t)) &&
+               is_const_init_operand(TREE_rchild(t));
+    case TR_COND:
+        return is_const_init_operand(TREE_det(t)) &&
+               is_const_init_operand(TREE_true_part(t)) &&
+               is_const_init_operand(TREE_false_part(t));
+    default:;
+    }
+    return false;
+}
+
+
+//Return true if operand 't' is a single constant expression.
+static bool is_const_init_operand(Tree const* t)
+{
+    return t != nullptr && TREE_nsib(t) == nullptr && is_const_init_exp(t);
+}
+
+
+//Write value of constant expression 't' into No.'idx' element of 'data'.
+//Return false if 't' can not be evaluated.
+static bool writeInitElem(InitData * data, ULONG idx, Tree * t)
+{
+    ConstVal v;
+    if (!is_const_init_exp(t) || !computeConstExp(t, v, true) ||
+        !convertConstVal(v, INITDATA_elem_type(data))) {
+        return false;
+    }
+    BYTE * p = INITDATA_buf(data) + idx * INITDATA_elem_size(data);
+    if (CVAL_is_fp(v)) {
+        if (INITDATA_elem_size(data) == sizeof(float)) {
+            float f = (float)CVAL_fp(v);
+            ::memcpy(p, &f, sizeof(f));
+        } else {
+            ASSERT0(INITDATA_elem_size(data) == sizeof(double));
+            double d = (double)CVAL_fp(v);
+            ::memcpy(p, &d, sizeof(d));
+        }
+        return true;
+    }
+    switch (INITDATA_elem_size(data)) {
+    case 1: *p = (BYTE)CVAL_int(v); break;
+    case 2: {
+        USHORT x = (USHORT)CVAL_int(v);
+        ::memcpy(p, &x, sizeof(x));
+        break;
+    }
+    case 4: {
+        UINT x = (UINT)CVAL_int(v);
+        ::memcpy(p, &x, sizeof(x));
+        break;
+    }
+    case 8: {
+        ULONGLONG x = (ULONGLONG)CVAL_int(v);
+        ::memcpy(p, &x, sizeof(x));
+        break;
+    }
+    default: UNREACHABLE();
+    }
+    return true;
+}
+
+
+//Copy string to the sub-array that begins at No.'idx' element.
+static void writeInitString(InitData * data, ULONG idx, ULONG num,
+                            Tree const* t)
+{
+    ASSERT0(INITDATA_elem_size(data) == 1);
+    CHAR const* str = SYM_name(TREE_string_val(t));
+    //The terminating zero is dropped if there is no room.
+    size_t len = ::strlen(str) + 1;
+    ::memcpy(INITDATA_buf(data) + idx, str, MIN(len, (size_t)num));
+}
+
+
+//Fill elements of the sub-array of dimension 'dim' which begins at No.'base'
+//element. Non-constant elements are recorded in 'nonconst_idx' and
+//'nonconst_val'.
+//Return false if the initializer can not be represented by 'data'.
+static bool fillInitData(InitData * data, Tree * initval, UINT dim,
+                         ULONG base, ULONG stride,
+                         OUT xcom::Vector<ULONG> & nonconst_idx,
+                         OUT xcom::Vector<Tree*> & nonconst_val)
+{
+    ASSERT0(TREE_type(initval) == TR_INITVAL_SCOPE);
+    bool is_last_dim = dim + 1 == INITDATA_dimnum(data);
+    ULONG substride = is_last_dim ? 1 : stride / INITDATA_dim(data, dim + 1);
+    ULONG i = 0;
+    for (Tree * t = TREE_initval_scope(initval); t != nullptr;
+         t = TREE_nsib(t), i++) {
+        if (i >= INITDATA_dim(data, dim)) { return false; }
+        ULONG idx = base + i * stride;
+        if (TREE_type(t) == TR_INITVAL_SCOPE) {
+            if (is_last_dim ||
+                !fillInitData(data, t, dim + 1, idx, substride,
+                              nonconst_idx, nonconst_val)) {
+                return false;
+            }
+            continue;
+        }
+        if (TREE_type(t) == TR_STRING) {
+            //e.g: char s[2][4] = { "ab", "cd" };
+            if (dim + 2 != INITDATA_dimnum(data) ||
+                INITDATA_elem_size(data) != 1) {
+                return false;
+            }
+            writeInitString(data, idx, stride, t);
+            continue;
+        }
+        if (!is_last_dim) {
+            //Elided braces of sub-array are not supported.
+            return false;
+        }
+        if (!writeInitElem(data, idx, t)) {
+            nonconst_idx.append(idx);
+            nonconst_val.append(t);
+        }
+    }
+    return true;
+}
+
+
+//Return true if array element that described by 'elemdcl' can be
+//recorded by InitData.
+static bool is_compactable_elem(Decl const* elemdcl, UINT elem_size)
+{
+    if (!is_arith(elemdcl) || is_pointer(elemdcl) || is_array(elemdcl)) {
+        return false;
+    }
+    if (is_fp(elemdcl)) {
+        return elem_size == sizeof(float) || elem_size == sizeof(double);
+    }
+    return elem_size == 1 || elem_size == 2 || elem_size == 4 ||
+           elem_size == 8;
+}
+
+
+//Build InitData for array 'dcl' that element is scalar arithmetic type.
+//The non-constant elements are lowered to assignments and appended to
+//'stmts'. If 'stmts' is nullptr, only constant initializer is accepted.
+//Return nullptr if the initializer of 'dcl' can not be compacted.
+static InitData * buildInitData(Decl const* dcl, OUT Tree ** stmts,
+                                OUT Tree ** last)
+{
+    Tree * initval = get_decl_init_tree(dcl);
+    if (TREE_type(initval) != TR_INITVAL_SCOPE &&
+        TREE_type(initval) != TR_STRING) {
+        return nullptr;
+    }
+    //Peel each dimension off to get the scalar element type.
+    Decl * basedcl = get_array_base_decl(dcl);
+    while (is_array(basedcl)) {
+        basedcl = get_array_base_decl(basedcl);
+    }
+    Decl * elemdcl = cp_typename(basedcl);
+    UINT elem_size = get_decl_size(elemdcl);
+    if (!is_compactable_elem(elemdcl, elem_size)) { return nullptr; }
+
+    UINT dimnum = get_array_dim(dcl);
+    ASSERT0(dimnum > 0);
+    xcom::Vector<ULONG> dims((INT)dimnum);
+    for (UINT i = 0; i < dimnum; i++) {
+        dims.set(i, get_array_elemnum_to_dim(dcl, i));
+        if (dims.get(i) == 0) { return nullptr; }
+    }
+
+    //The size of incomplete array is determined by initializer.
+    ULONG initnum = 0;
+    if (TREE_type(initval) == TR_STRING) {
+        if (dimnum != 1 || elem_size != 1) { return nullptr; }
+        initnum = (ULONG)::strlen(SYM_name(TREE_string_val(initval))) + 1;
+    } else {
+        initnum = (ULONG)xcom::cnt_list(TREE_initval_scope(initval));
+    }
+    dims.set(0, MAX(dims.get(0), initnum));
+
+    ULONG elem_num = 1;
+    for (UINT i = 0; i < dimnum; i++) {
+        if (dims.get(i) > MAX_INIT_DATA_BYTE_SIZE / elem_size / elem_num) {
+            return nullptr;
+        }
+        elem_num *= dims.get(i);
+    }
+
+    InitData * data = new_init_data(elemdcl, elem_size, dimnum,
+                                    dims.get_vec(), elem_num);
+
+    xcom::Vector<ULONG> nonconst_idx;
+    xcom::Vector<Tree*> nonconst_val;
+    if (TREE_type(initval) == TR_STRING) {
+        writeInitString(data, 0, elem_num, initval);
+    } else if (!fillInitData(data, initval, 0, 0, elem_num / dims.get(0),
+                             nonconst_idx, nonconst_val)) {
+        return nullptr;
+    }
+    if (nonconst_idx.get_elem_count() == 0) { return data; }
+    if (stmts == nullptr) { return nullptr; }
+
+    //Lower non-constant elements to assignments.
+    IdxVec dimvec;
+    for (INT i = 0; i <= nonconst_idx.get_last_idx(); i++) {
+        ULONG idx = nonconst_idx.get(i);
+        for (INT d = dimnum - 1; d >= 0; d--) {
+            dimvec.set(d, (UINT)(idx % dims.get(d)));
+            idx /= dims.get(d);
+        }
+        Tree * val = nonconst_val.get(i);
+        Tree * lhs = buildArray(dcl, dimvec);
+        TREE_loc(lhs) = TREE_loc(val);
+        Tree * assign = buildAssign(lhs, copyTree(val));
+        TREE_loc(assign) = TREE_loc(val);
+        xcom::add_next(stmts, last, assign);
+    }
+    return data;
+}
+
+
+//Record compact initial value into declarator of 'dcl'.
+static void set_decl_init_data(Decl const* dcl, InitData * data)
+{
+    ASSERT0(DECL_dt(dcl) == DCL_DECLARATION);
+    DECL_init_data(DECL_decl_list(dcl)) = data;
+}
+
+
 //Note the function does not check whether initval scope matchs the
 //declaration. It should be diagnosticed before.
-static INT processArrayInit(Decl const* dcl, OUT Tree ** stmts)
+static INT processArrayInit(Decl const* dcl, OUT Tree ** stmts,
+                            OUT Tree ** last)
 {
     ASSERT0(is_array(dcl));
+    //Scalar constant elements are kept in InitData rather than lowered
+    //to assignment one by one.
+    InitData * data = buildInitData(dcl, stmts, last);
+    if (data != nullptr) {
+        set_decl_init_data(dcl, data);
+        return ST_SUCC;
+    }
+
     Tree * initval = get_decl_init_tree(dcl);
     Tree * new_initval = canonArrayInitVal(dcl, initval);
     if (new_initval != initval) {
         set_decl_init_tree(dcl, new_initval); 
     }
-    return processArrayInit(dcl, new_initval, stmts);
+    return processArrayInit(dcl, new_initval, stmts, last);
 }
 
 
@@ -167,8 +446,8 @@ static void replaceBaseWith(Tree const* newbase, Tree * stmts)
 
 static INT processAggrInitRecur(Decl const* dcl, Decl const* flddecl,
                                 Tree * initval, UINT curdim,
-                                xcom::Vector<UINT> & fldvec,
-                                OUT Tree ** stmts)
+                                IdxVec & fldvec,
+                                OUT Tree ** stmts, OUT Tree ** last)
 {
     if (TREE_type(initval) == TR_INITVAL_SCOPE) {
         if (is_aggr(flddecl)) {
@@ -182,21 +461,23 @@ static INT processAggrInitRecur(Decl const* dcl, Decl const* flddecl,
                 ASSERT0(flddecl_of_fld);
                 fldvec.set(curdim, pos_in_curdim);
                 processAggrInitRecur(dcl, flddecl_of_fld, t,
-                                     curdim, fldvec, stmts);
+                                     curdim, fldvec, stmts, last);
             }
             return ST_SUCC;
         }
 
         if (is_array(flddecl)) {
             Tree * inittree = nullptr;
-            if (ST_SUCC != processArrayInit(flddecl, initval, &inittree)) {
+            Tree * initlast = nullptr;
+            if (ST_SUCC != processArrayInit(flddecl, initval, &inittree,
+                                            &initlast)) {
                 return ST_ERR;
             }
             Tree * aggr_ref = buildAggrFieldRef(dcl, fldvec);
-            TREE_lineno(aggr_ref) = TREE_lineno(initval);
+            TREE_loc(aggr_ref) = TREE_loc(initval);
             ASSERT0(is_aggr_field_access(aggr_ref));
             replaceBaseWith(aggr_ref, inittree);
-            xcom::add_next(stmts, inittree);
+            xcom::add_next(stmts, last, inittree);
             return ST_SUCC;
         }
 
@@ -205,10 +486,10 @@ static INT processAggrInitRecur(Decl const* dcl, Decl const* flddecl,
     }
 
     Tree * lhs = buildAggrFieldRef(dcl, fldvec);
-    TREE_lineno(lhs) = TREE_lineno(initval);
+    TREE_loc(lhs) = TREE_loc(initval);
     Tree * assign = buildAssign(lhs, copyTree(initval));
-    TREE_lineno(assign) = TREE_lineno(initval);
-    xcom::add_next(stmts, assign);
+    TREE_loc(assign) = TREE_loc(initval);
+    xcom::add_next(stmts, last, assign);
     return ST_SUCC;
 }
 
@@ -216,15 +497,16 @@ static INT processAggrInitRecur(Decl const* dcl, Decl const* flddecl,
 //dcl: the declaration of aggregate.
 //initval: the initial-value tree to aggregate.
 //stmts: generated tree to perform initialization of aggregate.
+//last: the last tree of 'stmts'.
 static INT processAggrInit(Decl const* dcl, Tree * initval,
-                             OUT Tree ** stmts)
+                           OUT Tree ** stmts, OUT Tree ** last)
 {
     ASSERT0(initval && TREE_type(initval) == TR_INITVAL_SCOPE);
 
     //Record the position in each dimension of array.
     //e.g: given array[I][J][K], curdim begins at the left-first dimension I,
     //the position in dimension I begins at 0.
-    xcom::Vector<UINT> fieldvec;
+    IdxVec fieldvec;
 
     UINT pos_in_curdim = 0;
     UINT curdim = 0;
@@ -235,47 +517,60 @@ static INT processAggrInit(Decl const* dcl, Tree * initval,
         ASSERT0(flddecl);
         fieldvec.clean();
         fieldvec.set(curdim, pos_in_curdim);
-        processAggrInitRecur(dcl, flddecl, t, curdim, fieldvec, stmts);
+        processAggrInitRecur(dcl, flddecl, t, curdim, fieldvec, stmts, last);
     }
     return ST_SUCC;
 }
 
 
-static INT processAggrInit(Decl const* dcl, OUT Tree ** stmts)
+static INT processAggrInit(Decl const* dcl, OUT Tree ** stmts,
+                           OUT Tree ** last)
 {
     ASSERT0(is_struct(dcl) || is_union(dcl));
     Tree * initval = get_decl_init_tree(dcl);
-    return processAggrInit(dcl, initval, stmts);
+    return processAggrInit(dcl, initval, stmts, last);
 }
 
 
-static INT processScalarInit(Decl const* dcl, OUT Tree ** stmts)
+static INT processScalarInit(Decl const* dcl, OUT Tree ** stmts,
+                             OUT Tree ** last)
 {
     Tree * initval = get_decl_init_tree(dcl);
     Tree * assign = buildAssign(dcl, initval);
-    TREE_lineno(assign) = TREE_lineno(initval);
-    xcom::add_next(stmts, assign);
+    TREE_loc(assign) = TREE_loc(initval);
+    xcom::add_next(stmts, last, assign);
     return ST_SUCC;
 }
 
 
+//stmts: record generated assignments, it must be empty list.
 static INT processDeclList(Decl const* decl, OUT Tree ** stmts)
 {
+    ASSERT0(*stmts == nullptr);
+    Tree * last = nullptr;
     for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
         if (!is_initialized(dcl)) { continue; }
         if (is_pointer(dcl)) {
-            if (ST_SUCC != processScalarInit(dcl, stmts)) { return ST_ERR; }
+            if (ST_SUCC != processScalarInit(dcl, stmts, &last)) {
+                return ST_ERR;
+            }
             continue;
         }
         if (is_array(dcl)) {
-            if (ST_SUCC != processArrayInit(dcl, stmts)) { return ST_ERR; }
+            if (ST_SUCC != processArrayInit(dcl, stmts, &last)) {
+                return ST_ERR;
+            }
             continue;
         }
         if (is_struct(dcl) || is_union(dcl)) {
-            if (ST_SUCC != processAggrInit(dcl, stmts)) { return ST_ERR; }
+            if (ST_SUCC != processAggrInit(dcl, stmts, &last)) {
+                return ST_ERR;
+            }
             continue;
         }
-        if (ST_SUCC != processScalarInit(dcl, stmts)) { return ST_ERR; }
+        if (ST_SUCC != processScalarInit(dcl, stmts, &last)) {
+            return ST_ERR;
+        }
     }
     return ST_SUCC;
 }
@@ -365,7 +660,7 @@ static INT processFuncDef(Decl * dcl)
     if (ST_SUCC != processScope(DECL_fun_body(dcl))) {
         return ST_ERR;
     }
-    if (g_err_msg_list.get_elem_count() > 0) {
+    if (get_err_count() > 0) {
         return ST_ERR;
     }
     return ST_SUCC;
@@ -381,9 +676,18 @@ INT processDeclInit()
          dcl != nullptr; dcl = DECL_next(dcl)) {
         if (DECL_is_fun_def(dcl)) {
             if (ST_SUCC != processFuncDef(dcl)) { return ST_ERR; }
-            if (g_err_msg_list.get_elem_count() > 0) {
+            if (get_err_count() > 0) {
                 return ST_ERR;
             }
+            continue;
+        }
+        if (is_initialized(dcl) && is_array(dcl)) {
+            //Global array is not lowered to assignments, only the constant
+            //initial value is compacted.
+            InitData * data = buildInitData(dcl, nullptr, nullptr);
+            if (data != nullptr) {
+                set_decl_init_data(dcl, data);
+            }
         }
     }
 
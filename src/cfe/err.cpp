@@ -27,59 +27,424 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
 #include "cfeinc.h"
 
-List<ERR_MSG*> g_err_msg_list;
-List<WARN_MSG*> g_warn_msg_list;
+//Counters are kept after finiDiag() for the final summary.
+static UINT g_err_count = 0;
+static UINT g_warn_count = 0;
 
-static void * xmalloc(size_t size)
+static CHAR const* g_diag_severity_name[] = {
+    "note",
+    "warning",
+    "error",
+};
+
+static CHAR const* g_sarif_level_name[] = {
+    "note",
+    "warning",
+    "error",
+};
+
+
+//Write 's' to 'out' as the content of JSON string.
+static void dump_json_str(FILE * out, CHAR const* s)
 {
-    void * p = smpoolMalloc(size, g_pool_general_used);
-    if (p == nullptr) { return nullptr; }
-    ::memset(p, 0, size);
-    return p;
+    for (; *s != 0; s++) {
+        UCHAR c = (UCHAR)*s;
+        switch (c) {
+        case '"': fputs("\\\"", out); break;
+        case '\\': fputs("\\\\", out); break;
+        case '\n': fputs("\\n", out); break;
+        case '\r': fputs("\\r", out); break;
+        case '\t': fputs("\\t", out); break;
+        default:
+            if (c < 0x20) {
+                fprintf(out, "\\u%04x", c);
+            } else {
+                fputc(c, out);
+            }
+        }
+    }
 }
 
 
-void show_err()
+//
+//START DiagTextSink
+//
+//Output diagnostic in the form of: error(line):message
+class DiagTextSink : public DiagSink {
+protected:
+    FILE * m_out;
+public:
+    DiagTextSink(FILE * out) : m_out(out) {}
+
+    virtual void emit(Diag const* d)
+    {
+        DiagRange const& r = DIAG_range(d);
+        if (r.start_col != 0) {
+            fprintf(m_out, "%s(%d:%d):%s\n",
+                    g_diag_severity_name[DIAG_severity(d)],
+                    r.start_line, r.start_col, DIAG_msg(d));
+        } else {
+            fprintf(m_out, "%s(%d):%s\n",
+                    g_diag_severity_name[DIAG_severity(d)],
+                    r.start_line, DIAG_msg(d));
+        }
+        //Each diagnostic is a whole line, flush it to keep it from
+        //interleaving with the output of parser.
+        fflush(m_out);
+    }
+    virtual void summary(UINT id, CHAR const* fmt, UINT num)
+    {
+        DUMMYUSE(id);
+        fprintf(m_out, "note:%u more diagnostic(s) of '%s' suppressed\n",
+                num, fmt);
+    }
+    virtual void end() { fflush(m_out); }
+};
+//END DiagTextSink
+
+
+//
+//START DiagJsonSink
+//
+//Output each diagnostic as a JSON object in one line.
+class DiagJsonSink : public DiagSink {
+protected:
+    FILE * m_out;
+    CHAR const* m_file;
+public:
+    DiagJsonSink(FILE * out, CHAR const* file) : m_out(out), m_file(file) {}
+
+    virtual void emit(Diag const* d)
+    {
+        DiagRange const& r = DIAG_range(d);
+        fprintf(m_out, "{\"severity\":\"%s\",\"id\":\"%08X\",\"file\":\"",
+                g_diag_severity_name[DIAG_severity(d)], DIAG_id(d));
+        dump_json_str(m_out, m_file != nullptr ? m_file : "");
+        fprintf(m_out, "\",\"range\":{\"startLine\":%d,\"startColumn\":%d,"
+                "\"endLine\":%d,\"endColumn\":%d},\"message\":\"",
+                r.start_line, r.start_col, r.end_line, r.end_col);
+        dump_json_str(m_out, DIAG_msg(d));
+        fprintf(m_out, "\"}\n");
+    }
+    virtual void summary(UINT id, CHAR const* fmt, UINT num)
+    {
+        fprintf(m_out, "{\"severity\":\"note\",\"id\":\"%08X\","
+                "\"suppressed\":%u,\"message\":\"", id, num);
+        dump_json_str(m_out, fmt);
+        fprintf(m_out, "\"}\n");
+    }
+    virtual void end() { fflush(m_out); }
+};
+//END DiagJsonSink
+
+
+//
+//START DiagSarifSink
+//
+//Output diagnostics as a SARIF v2.1.0 log. Results are written as soon
+//as they are reported, the enclosing objects are closed in end().
+class DiagSarifSink : public DiagSink {
+protected:
+    bool m_has_result;
+    FILE * m_out;
+    CHAR const* m_file;
+public:
+    DiagSarifSink(FILE * out, CHAR const* file) :
+        m_has_result(false), m_out(out), m_file(file) {}
+
+    virtual void begin()
+    {
+        fprintf(m_out, "{\"version\":\"2.1.0\",\"$schema\":"
+                "\"https://json.schemastore.org/sarif-2.1.0.json\","
+                "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"xocfe\"}},"
+                "\"results\":[");
+    }
+    virtual void emit(Diag const* d)
+    {
+        DiagRange const& r = DIAG_range(d);
+        fprintf(m_out, "%s\n{\"ruleId\":\"%08X\",\"level\":\"%s\","
+                "\"message\":{\"text\":\"", m_has_result ? "," : "",
+                DIAG_id(d), g_sarif_level_name[DIAG_severity(d)]);
+        m_has_result = true;
+        dump_json_str(m_out, DIAG_msg(d));
+        fprintf(m_out, "\"},\"locations\":[{\"physicalLocation\":"
+                "{\"artifactLocation\":{\"uri\":\"");
+        dump_json_str(m_out, m_file != nullptr ? m_file : "");
+        fprintf(m_out, "\"}");
+        if (r.start_line > 0) {
+            //SARIF line and column are 1-based.
+            fprintf(m_out, ",\"region\":{\"startLine\":%d", r.start_line);
+            if (r.start_col > 0) {
+                fprintf(m_out, ",\"startColumn\":%d", r.start_col);
+            }
+            if (r.end_line >= r.start_line) {
+                fprintf(m_out, ",\"endLine\":%d", r.end_line);
+            }
+            if (r.end_col > 0) {
+                fprintf(m_out, ",\"endColumn\":%d", r.end_col);
+            }
+            fprintf(m_out, "}");
+        }
+        fprintf(m_out, "}}]}");
+    }
+    virtual void end()
+    {
+        fprintf(m_out, "\n]}]}\n");
+        fflush(m_out);
+    }
+};
+//END DiagSarifSink
+
+
+//
+//START DiagMgr
+//
+//Record the statistics of diagnostics that have same ID.
+class DiagInfo {
+public:
+    CHAR const* fmt;
+    UINT emitted;
+    UINT suppressed;
+};
+
+
+class DiagMgr {
+    COPY_CONSTRUCTOR(DiagMgr);
+protected:
+    bool m_is_begun;
+    UINT m_limit;
+    DiagSink * m_sink;
+    SMemPool * m_pool;
+    TMap<UINT, DiagInfo*> m_id2info;
+    //Record the hash of emitted diagnostics.
+    TTab<ULONGLONG> m_emitted;
+    //Buffer that reused to format message.
+    StrBuf m_buf;
+
+    //Compute ID via the text of message format.
+    static UINT computeId(CHAR const* fmt)
+    {
+        //FNV-1a
+        UINT h = 2166136261u;
+        for (; *fmt != 0; fmt++) {
+            h ^= (UCHAR)*fmt;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static ULONGLONG computeHash(UINT id, DiagRange const& r, CHAR const* msg)
+    {
+        ULONGLONG h = 14695981039346656037ull;
+        h = (h ^ id) * 1099511628211ull;
+        h = (h ^ (UINT)r.start_line) * 1099511628211ull;
+        h = (h ^ (UINT)r.start_col) * 1099511628211ull;
+        for (; *msg != 0; msg++) {
+            h = (h ^ (UCHAR)*msg) * 1099511628211ull;
+        }
+        //0 is reserved by TTab.
+        return h == 0 ? 1 : h;
+    }
+
+    DiagInfo * getInfo(UINT id, CHAR const* fmt)
+    {
+        DiagInfo * info = m_id2info.get(id);
+        if (info != nullptr) { return info; }
+        info = (DiagInfo*)smpoolMallocConstSize(sizeof(DiagInfo), m_pool);
+        ::memset(info, 0, sizeof(DiagInfo));
+        info->fmt = fmt;
+        m_id2info.set(id, info);
+        return info;
+    }
+public:
+    DiagMgr(DiagSink * sink) : m_buf(64)
+    {
+        m_is_begun = false;
+        m_limit = DIAG_DEFAULT_LIMIT;
+        m_sink = sink;
+        m_pool = smpoolCreate(sizeof(DiagInfo) * 16, MEM_CONST_SIZE);
+    }
+    ~DiagMgr()
+    {
+        delete m_sink;
+        smpoolDelete(m_pool);
+    }
+
+    void fini()
+    {
+        if (!m_is_begun) { m_sink->begin(); }
+        TMapIter<UINT, DiagInfo*> iter;
+        DiagInfo * info;
+        for (UINT id = m_id2info.get_first(iter, &info);
+             info != nullptr; id = m_id2info.get_next(iter, &info)) {
+            if (info->suppressed != 0) {
+                m_sink->summary(id, info->fmt, info->suppressed);
+            }
+        }
+        m_sink->end();
+    }
+
+    //Count the diagnostic, and return nullptr if the number of
+    //diagnostics of the ID exceeded the limit.
+    DiagInfo * countDiag(DIAG_SEVERITY sev, CHAR const* fmt, OUT UINT & id)
+    {
+        if (sev == DIAG_ERR) {
+            g_err_count++;
+        } else if (sev == DIAG_WARN) {
+            g_warn_count++;
+        }
+
+        id = computeId(fmt);
+        DiagInfo * info = getInfo(id, fmt);
+        if (m_limit != 0 && info->emitted >= m_limit) {
+            info->suppressed++;
+            return nullptr;
+        }
+        return info;
+    }
+
+    void report(DIAG_SEVERITY sev, DiagRange const& r, CHAR const* fmt,
+                va_list args)
+    {
+        UINT id;
+        DiagInfo * info = countDiag(sev, fmt, id);
+        //Suppressed diagnostic is never formatted.
+        if (info == nullptr) { return; }
+        m_buf.vsprint(fmt, args);
+        emit(sev, r, id, info, m_buf.buf);
+    }
+
+    //Report diagnostic that message has been formatted.
+    void report(DIAG_SEVERITY sev, DiagRange const& r, CHAR const* fmt,
+                CHAR const* msg)
+    {
+        UINT id;
+        DiagInfo * info = countDiag(sev, fmt, id);
+        if (info == nullptr) { return; }
+        emit(sev, r, id, info, msg);
+    }
+
+    void emit(DIAG_SEVERITY sev, DiagRange const& r, UINT id,
+              DiagInfo * info, CHAR const* msg)
+    {
+        ULONGLONG h = computeHash(id, r, msg);
+        if (m_emitted.find(h)) { return; }
+        m_emitted.append(h);
+        info->emitted++;
+
+        if (!m_is_begun) {
+            m_sink->begin();
+            m_is_begun = true;
+        }
+        Diag d;
+        DIAG_severity(&d) = sev;
+        DIAG_id(&d) = id;
+        DIAG_range(&d) = r;
+        DIAG_fmt(&d) = info->fmt;
+        DIAG_msg(&d) = msg;
+        m_sink->emit(&d);
+    }
+
+    void setLimit(UINT limit) { m_limit = limit; }
+};
+//END DiagMgr
+
+
+static DiagMgr * g_diag_mgr = nullptr;
+
+static DiagMgr * get_diag_mgr()
 {
-    if (g_err_msg_list.get_elem_count() == 0) { return; }
-    fprintf(stdout,"\n");
-    for (ERR_MSG * e = g_err_msg_list.get_head();
-         e != nullptr; e = g_err_msg_list.get_next()) {
-        fprintf(stdout, "\nerror(%d):%s", ERR_MSG_lineno(e), ERR_MSG_msg(e));
+    if (g_diag_mgr == nullptr) {
+        //Diagnostic engine is not initialized, output text to stdout.
+        g_diag_mgr = new DiagMgr(new DiagTextSink(stdout));
     }
-    fprintf(stdout,"\n");
+    return g_diag_mgr;
 }
 
 
-void show_warn()
+void initDiag(DiagSink * sink)
 {
-    if (g_warn_msg_list.get_elem_count() == 0) { return; }
-    fprintf(stdout,"\n");
-    for (WARN_MSG * e = g_warn_msg_list.get_head();
-         e != nullptr; e = g_warn_msg_list.get_next()) {
-        fprintf(stdout, "\nwarning(%d):%s",
-                WARN_MSG_lineno(e), WARN_MSG_msg(e));
+    ASSERT0(sink);
+    if (g_diag_mgr != nullptr) { delete g_diag_mgr; }
+    g_diag_mgr = new DiagMgr(sink);
+}
+
+
+void initDiag(DIAG_FMT fmt, FILE * out, CHAR const* srcfile)
+{
+    ASSERT0(out);
+    switch (fmt) {
+    case DIAG_FMT_TEXT:
+        initDiag(new DiagTextSink(out));
+        break;
+    case DIAG_FMT_JSON:
+        initDiag(new DiagJsonSink(out, srcfile));
+        break;
+    case DIAG_FMT_SARIF:
+        initDiag(new DiagSarifSink(out, srcfile));
+        break;
+    default: UNREACHABLE();
     }
-    fprintf(stdout,"\n");
 }
 
 
-//Report warning with line number.
-void warn(INT line_num, CHAR const* msg, ...)
+//Flush the summary of suppressed diagnostics and close the sink.
+void finiDiag()
+{
+    if (g_diag_mgr == nullptr) { return; }
+    g_diag_mgr->fini();
+    delete g_diag_mgr;
+    g_diag_mgr = nullptr;
+}
+
+
+void setDiagLimit(UINT limit)
+{
+    get_diag_mgr()->setLimit(limit);
+}
+
+
+UINT get_err_count()
+{
+    return g_err_count;
+}
+
+
+UINT get_warn_count()
+{
+    return g_warn_count;
+}
+
+
+//Report diagnostic with source range.
+void diag(DIAG_SEVERITY sev, DiagRange const& range, CHAR const* msg, ...)
 {
     if (msg == nullptr) { return; }
+    va_list arg;
+    va_start(arg, msg);
+    get_diag_mgr()->report(sev, range, msg, arg);
+    va_end(arg);
+}
 
-    WARN_MSG * p = nullptr;
-    StrBuf sbuf(64);
 
+static void set_line_range(OUT DiagRange & r, INT line_num)
+{
+    r.start_line = line_num;
+    r.start_col = 0;
+    r.end_line = line_num;
+    r.end_col = 0;
+}
+
+
+//Report warning with line number.
+void warn(INT line_num, CHAR const* msg, ...)
+{
+    if (msg == nullptr) { return; }
+    DiagRange r;
+    set_line_range(r, line_num);
     va_list arg;
     va_start(arg, msg);
-    sbuf.vsprint(msg, arg);
-    p = (WARN_MSG*)xmalloc(sizeof(WARN_MSG));
-    p->msg = (CHAR*)xmalloc(sbuf.strlen() + 1);
-    ::memcpy(p->msg, sbuf.buf, sbuf.strlen() + 1);
-    p->lineno = line_num;
-    g_warn_msg_list.append_tail(p);
+    get_diag_mgr()->report(DIAG_WARN, r, msg, arg);
     va_end(arg);
 }
 
@@ -88,24 +453,64 @@ void warn(INT line_num, CHAR const* msg, ...)
 void err(INT line_num, CHAR const* msg, ...)
 {
     if (msg == nullptr) { return; }
+    DiagRange r;
+    set_line_range(r, line_num);
+    va_list arg;
+    va_start(arg, msg);
+    get_diag_mgr()->report(DIAG_ERR, r, msg, arg);
+    va_end(arg);
+}
 
-    ERR_MSG * p = nullptr;
-    StrBuf sbuf(64);
 
+static void set_loc_range(OUT DiagRange & r, SrcLoc loc)
+{
+    SrcLocInfo info;
+    decodeSrcLoc(loc, info);
+    r.start_line = (INT)SRCLOC_INFO_real_line(info);
+    r.start_col = (INT)SRCLOC_INFO_col(info);
+    r.end_line = r.start_line;
+    //The range covers the token at 'loc'.
+    UINT len = r.start_col > 0 ? getSrcTokenLen(loc) : 0;
+    r.end_col = len > 0 ? r.start_col + (INT)len : 0;
+}
+
+
+//Report warning with source location.
+void warnLoc(SrcLoc loc, CHAR const* msg, ...)
+{
+    if (msg == nullptr) { return; }
+    DiagRange r;
+    set_loc_range(r, loc);
     va_list arg;
     va_start(arg, msg);
-    sbuf.vsprint(msg, arg);
-    p = (ERR_MSG*)xmalloc(sizeof(ERR_MSG));
-    p->msg = (CHAR*)xmalloc(sbuf.strlen() + 1);
-    ::memcpy(p->msg, sbuf.buf, sbuf.strlen() + 1);
-    p->lineno = line_num;
-    g_err_msg_list.append_tail(p);
+    get_diag_mgr()->report(DIAG_WARN, r, msg, arg);
     va_end(arg);
 }
 
 
-INT is_too_many_err()
+//Report error with source location.
+void errLoc(SrcLoc loc, CHAR const* msg, ...)
 {
-    return g_err_msg_list.get_elem_count() > TOO_MANY_ERR;
+    if (msg == nullptr) { return; }
+    DiagRange r;
+    set_loc_range(r, loc);
+    va_list arg;
+    va_start(arg, msg);
+    get_diag_mgr()->report(DIAG_ERR, r, msg, arg);
+    va_end(arg);
+}
+
+
+void errMsg(SrcLoc loc, CHAR const* fmt, CHAR const* msg)
+{
+    ASSERT0(fmt && msg);
+    DiagRange r;
+    set_loc_range(r, loc);
+    get_diag_mgr()->report(DIAG_ERR, r, fmt, msg);
 }
 
+
+INT is_too_many_err()
+{
+    return get_err_count() > TOO_MANY_ERR;
+}
@@ -28,38 +28,104 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef _ERR_H_
 #define _ERR_H_
 
-//record each error msg
-class WARN_MSG {
+//Diagnostic engine of front end.
+//Diagnostics are streamed to a DiagSink as soon as they are reported.
+//Each diagnostic has a severity, an ID and a source range. The ID is
+//computed from the message format, thus all diagnostics that reported
+//by the same message share the same ID.
+//Memory is bounded: a diagnostic is formatted only if it is not
+//suppressed by the per-ID limit, and only emitted diagnostics are
+//recorded for deduplication.
+
+#define TOO_MANY_ERR 10
+
+//Default maximum number of emitted diagnostics for each ID.
+#define DIAG_DEFAULT_LIMIT 100
+
+typedef enum _DIAG_SEVERITY {
+    DIAG_NOTE = 0,
+    DIAG_WARN,
+    DIAG_ERR,
+} DIAG_SEVERITY;
+
+typedef enum _DIAG_FMT {
+    DIAG_FMT_TEXT = 0, //human readable text
+    DIAG_FMT_JSON, //one JSON object per line
+    DIAG_FMT_SARIF, //SARIF v2.1.0 log
+} DIAG_FMT;
+
+//Describe the source range of diagnostic.
+//Column is 0 if it is unknown.
+class DiagRange {
 public:
-    CHAR * msg;
-    INT lineno;
+    INT start_line;
+    INT start_col;
+    INT end_line;
+    INT end_col; //the column next to the last character of range.
 };
-#define WARN_MSG_msg(e) (e)->msg
-#define WARN_MSG_lineno(e) (e)->lineno
 
-
-//record each error msg
-class ERR_MSG {
+#define DIAG_severity(d) ((d)->severity)
+#define DIAG_id(d) ((d)->id)
+#define DIAG_range(d) ((d)->range)
+#define DIAG_fmt(d) ((d)->fmt)
+#define DIAG_msg(d) ((d)->msg)
+class Diag {
 public:
-    CHAR * msg;
-    INT lineno;
+    DIAG_SEVERITY severity;
+    UINT id;
+    DiagRange range;
+    CHAR const* fmt; //message format
+    CHAR const* msg; //formatted message
 };
-#define ERR_MSG_msg(e) (e)->msg
-#define ERR_MSG_lineno(e) (e)->lineno
 
-#define TOO_MANY_ERR 10
-#define ERR_SHOW 1
-#define WARN_SHOW 2
-#endif
+//The interface of diagnostic output.
+class DiagSink {
+public:
+    virtual ~DiagSink() {}
+
+    //Invoked before the first diagnostic.
+    virtual void begin() {}
+
+    //Invoked for each diagnostic that is neither suppressed nor
+    //duplicated.
+    virtual void emit(Diag const* d) = 0;
 
+    //Invoked if the number of diagnostics of 'id' exceeded the limit.
+    //num: the number of suppressed diagnostics.
+    virtual void summary(UINT id, CHAR const* fmt, UINT num)
+    { DUMMYUSE(id); DUMMYUSE(fmt); DUMMYUSE(num); }
 
-//Exported Variables
-extern List<ERR_MSG*> g_err_msg_list;
-extern List<WARN_MSG*> g_warn_msg_list;
+    //Invoked after the last diagnostic.
+    virtual void end() {}
+};
 
 //Exported Functions
+//Start diagnostic engine and all diagnostics will be written to 'sink'.
+//The engine takes the ownership of 'sink'.
+void initDiag(DiagSink * sink);
+//Start diagnostic engine and all diagnostics will be written to 'out'
+//in given format.
+//srcfile: the name of source file.
+void initDiag(DIAG_FMT fmt, FILE * out, CHAR const* srcfile);
+void finiDiag();
+//Set the maximum number of emitted diagnostics for each ID.
+//0 means no limitation.
+void setDiagLimit(UINT limit);
+
+//Report diagnostic with source range.
+void diag(DIAG_SEVERITY sev, DiagRange const& range, CHAR const* msg, ...);
 void warn(INT line_num, CHAR const* msg, ...);
 void err(INT line_num, CHAR const* msg, ...);
-void show_err();
-void show_warn();
+//Report diagnostic with line and column that decoded from 'loc'.
+void warnLoc(SrcLoc loc, CHAR const* msg, ...);
+void errLoc(SrcLoc loc, CHAR const* msg, ...);
+//Report error that message has been formatted.
+//loc: the location that line and column are decoded from.
+//fmt: the format of 'msg', which is used to compute diagnostic ID.
+void errMsg(SrcLoc loc, CHAR const* fmt, CHAR const* msg);
+
+//Return the number of reported diagnostics, including the suppressed.
+UINT get_err_count();
+UINT get_warn_count();
 INT is_too_many_err();
+#endif
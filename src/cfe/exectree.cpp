@@ -28,56 +28,294 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "cfeinc.h"
 
 //Computing expected value in compiling period, such as constant expression.
-// 'g_is_allow_float' cannot be used via extern , it must be assigned with
-// 'compute_constant_value' absolutely.
+//The evaluator walks the expression tree iteratively and returns value by
+//ConstVal, there is no global state, and memory is allocated only if the
+//expression is deeper than the inline frames of walker, thus it is
+//reentrant.
 
-static bool g_is_allow_float = false;
-static Stack<Cell*> g_cell_stack;
-static bool compute_conditional_exp(IN Tree * t);
+//The data attached to the walking frame of expression.
+class ConstExpData {
+public:
+    //True if float-point operand is permitted.
+    bool is_allow_float;
+    //False if the expression is not evaluated, e.g: the part of '?:' that
+    //is not chosen, whose type is still required. Division by zero is not
+    //an error in such expression.
+    bool is_eval;
+    bool is_det_true; //true if the determinant of '?:' is nonzero.
+    ConstVal l; //the value of first kid.
+    ConstVal r; //the value of second kid.
+    ConstVal v; //the value of current expression.
+    Decl * type_name; //the type-name of cast.
+};
+typedef TreeWalkFrame<ConstExpData> ConstExpFrame;
 
-static Cell * pushv(LONGLONG v)
+static bool is_fp_cval(CVAL_TYPE ty)
 {
-    Cell * c = newcell(0);
-    CELL_val(c) = v;
-    CELL_line_no(c) = g_real_line_num;
-    g_cell_stack.push(c);
-    return c;
+    return ty == CVAL_FP || ty == CVAL_FPF;
 }
 
 
-static LONGLONG popv()
+static bool is_unsigned_cval(CVAL_TYPE ty)
 {
-    Cell *c = g_cell_stack.pop();
-    if (!c) {
-        err(g_real_line_num, "cell value stack cannot be nullptr");
-        return -1;
+    return ty == CVAL_UINT || ty == CVAL_ULONG || ty == CVAL_ULONGLONG;
+}
+
+
+//Return the byte size of integer value type on target machine.
+static UINT get_cval_bytesize(CVAL_TYPE ty)
+{
+    switch (ty) {
+    case CVAL_INT:
+    case CVAL_UINT:
+        return BYTE_PER_INT;
+    case CVAL_LONG:
+    case CVAL_ULONG:
+        return BYTE_PER_LONG;
+    case CVAL_LONGLONG:
+    case CVAL_ULONGLONG:
+        return BYTE_PER_LONGLONG;
+    default: UNREACHABLE();
+    }
+    return 0;
+}
+
+
+//Return the conversion rank of integer value type.
+static UINT get_cval_rank(CVAL_TYPE ty)
+{
+    switch (ty) {
+    case CVAL_INT:
+    case CVAL_UINT:
+        return 1;
+    case CVAL_LONG:
+    case CVAL_ULONG:
+        return 2;
+    case CVAL_LONGLONG:
+    case CVAL_ULONGLONG:
+        return 3;
+    default: UNREACHABLE();
+    }
+    return 0;
+}
+
+
+static CVAL_TYPE get_unsigned_cval(CVAL_TYPE ty)
+{
+    switch (ty) {
+    case CVAL_INT: return CVAL_UINT;
+    case CVAL_LONG: return CVAL_ULONG;
+    case CVAL_LONGLONG: return CVAL_ULONGLONG;
+    default:;
+    }
+    return ty;
+}
+
+
+//Truncate 'v' to 'bytesize' and extend the result to HOST_INT.
+static HOST_INT truncate_int(HOST_INT v, UINT bytesize, bool is_signed)
+{
+    UINT bits = bytesize * HOST_BIT_PER_BYTE;
+    if (bits >= sizeof(HOST_INT) * HOST_BIT_PER_BYTE) { return v; }
+    HOST_UINT mask = (((HOST_UINT)1) << bits) - 1;
+    HOST_UINT uv = ((HOST_UINT)v) & mask;
+    if (is_signed && (uv & (((HOST_UINT)1) << (bits - 1))) != 0) {
+        uv |= ~mask;
+    }
+    return (HOST_INT)uv;
+}
+
+
+static void set_int(OUT ConstVal & v, CVAL_TYPE ty, HOST_INT val)
+{
+    ASSERT0(!is_fp_cval(ty));
+    CVAL_type(v) = ty;
+    CVAL_int(v) = truncate_int(val, get_cval_bytesize(ty),
+                               !is_unsigned_cval(ty));
+}
+
+
+//ty: float-point value type, the value of float is rounded to its precision.
+static void set_fp(OUT ConstVal & v, HOST_FP val, CVAL_TYPE ty = CVAL_FP)
+{
+    ASSERT0(is_fp_cval(ty));
+    CVAL_type(v) = ty;
+    CVAL_fp(v) = ty == CVAL_FPF ? (HOST_FP)(float)val : val;
+}
+
+
+static HOST_FP get_fp(ConstVal const& v)
+{
+    if (CVAL_is_fp(v)) { return CVAL_fp(v); }
+    if (is_unsigned_cval(CVAL_type(v))) {
+        return (HOST_FP)(HOST_UINT)CVAL_int(v);
+    }
+    return (HOST_FP)CVAL_int(v);
+}
+
+
+//Convert 'v' to the value type 'ty'.
+static void convert_cval(IN OUT ConstVal & v, CVAL_TYPE ty)
+{
+    if (CVAL_type(v) == ty) { return; }
+    if (is_fp_cval(ty)) {
+        set_fp(v, get_fp(v), ty);
+        return;
+    }
+    if (CVAL_is_fp(v)) {
+        HOST_FP f = CVAL_fp(v);
+        if (is_unsigned_cval(ty) && f >= 0) {
+            set_int(v, ty, (HOST_INT)(HOST_UINT)f);
+            return;
+        }
+        set_int(v, ty, (HOST_INT)f);
+        return;
+    }
+    set_int(v, ty, CVAL_int(v));
+}
+
+
+//Return true if the value is nonzero.
+static bool is_nonzero(ConstVal const& v)
+{
+    return CVAL_is_fp(v) ? CVAL_fp(v) != 0 : CVAL_int(v) != 0;
+}
+
+
+//Perform usual arithmetic conversions to 'l' and 'r'.
+//Return the common type.
+static CVAL_TYPE convert_to_common_type(IN OUT ConstVal & l,
+                                        IN OUT ConstVal & r)
+{
+    CVAL_TYPE lt = CVAL_type(l);
+    CVAL_TYPE rt = CVAL_type(r);
+    CVAL_TYPE ct;
+    if (lt == CVAL_FP || rt == CVAL_FP) {
+        ct = CVAL_FP;
+    } else if (lt == CVAL_FPF || rt == CVAL_FPF) {
+        ct = CVAL_FPF;
+    } else if (lt == rt) {
+        ct = lt;
+    } else if (is_unsigned_cval(lt) == is_unsigned_cval(rt)) {
+        ct = get_cval_rank(lt) > get_cval_rank(rt) ? lt : rt;
+    } else {
+        CVAL_TYPE ut = is_unsigned_cval(lt) ? lt : rt;
+        CVAL_TYPE st = is_unsigned_cval(lt) ? rt : lt;
+        if (get_cval_rank(ut) >= get_cval_rank(st)) {
+            ct = ut;
+        } else if (get_cval_bytesize(st) > get_cval_bytesize(ut)) {
+            //Signed type can represent all values of unsigned type.
+            ct = st;
+        } else {
+            ct = get_unsigned_cval(st);
+        }
     }
-    free_cell(c);
-    return (LONG)CELL_val(c);
+    convert_cval(l, ct);
+    convert_cval(r, ct);
+    return ct;
 }
 
 
-static bool compute_enum_const(Tree * t)
+//Map type-name to value type. Return false if 'dcl' is not arithmetic type.
+//bytesize: record the byte size of the type.
+static bool get_cval_type(Decl const* dcl, OUT CVAL_TYPE & ty,
+                          OUT UINT & bytesize)
 {
-    Enum * e = TREE_enum(t);
-    INT i = TREE_enum_val_idx(t);
-    EnumValueList * evl = ENUM_vallist(e);
-    for (; i > 0; i--, evl = EVAL_LIST_next(evl)) {
-        ASSERT0(evl);
+    if (!is_arith(dcl)) { return false; }
+    TypeSpec const* spec = DECL_spec(dcl);
+    if (is_fp(spec)) {
+        bytesize = get_decl_size(dcl);
+        ty = bytesize == BYTE_PER_FLOAT ? CVAL_FPF : CVAL_FP;
+        return true;
+    }
+    bool is_unsigned = IS_TYPE(spec, T_SPEC_UNSIGNED);
+    if (IS_TYPE(spec, T_SPEC_LONGLONG)) {
+        ty = is_unsigned ? CVAL_ULONGLONG : CVAL_LONGLONG;
+    } else if (IS_TYPE(spec, T_SPEC_LONG)) {
+        ty = is_unsigned ? CVAL_ULONG : CVAL_LONG;
+    } else {
+        //char, short, bool and enum are promoted to int.
+        ty = is_unsigned && BYTE_PER_INT <= getSpecTypeSize(spec) ?
+             CVAL_UINT : CVAL_INT;
     }
+    bytesize = get_decl_size(dcl);
+    return true;
+}
+
 
-    ASSERT0(evl);
-    pushv(EVAL_LIST_val(evl));
+//Convert 'v' to the arithmetic type 'type_name' with the semantics of
+//C cast. Return false if 'type_name' is not arithmetic type.
+bool convertConstVal(IN OUT ConstVal & v, Decl const* type_name)
+{
+    CVAL_TYPE ty;
+    UINT bytesize;
+    if (!get_cval_type(type_name, ty, bytesize)) { return false; }
+    if (is_fp_cval(ty)) {
+        convert_cval(v, ty);
+        return true;
+    }
+    if (IS_TYPE(DECL_spec(type_name), T_SPEC_BOOL)) {
+        set_int(v, CVAL_INT, is_nonzero(v) ? 1 : 0);
+        return true;
+    }
+    convert_cval(v, ty);
+    if (bytesize < get_cval_bytesize(ty)) {
+        //Narrow to char or short, then promote to int.
+        CVAL_int(v) = truncate_int(CVAL_int(v), bytesize,
+            !IS_TYPE(DECL_spec(type_name), T_SPEC_UNSIGNED));
+    }
     return true;
 }
 
 
-//Compute byte size of TYPE_NAME and record in the cell stack, or record
-//-1 if failed. The function return true if the computation is success,
+static bool compute_enum_const(Tree const* t, OUT ConstVal & v)
+{
+    ASSERT0(TREE_enum(t));
+    set_int(v, CVAL_INT, get_enum_const_val(TREE_enum(t),
+                                            TREE_enum_val_idx(t)));
+    return true;
+}
+
+
+//Compute the byte size of expression that is not type-name.
+//Return 0 if the size can not be determined before type transformation.
+static UINT compute_exp_size(Tree const* p)
+{
+    switch (TREE_type(p)) {
+    case TR_IMM:
+    case TR_IMMU:
+    case TR_ENUM_CONST:
+        return BYTE_PER_INT;
+    case TR_IMML:
+    case TR_IMMUL:
+        return BYTE_PER_LONGLONG;
+    case TR_FP:
+    case TR_FPLD:
+        return BYTE_PER_DOUBLE;
+    case TR_FPF:
+        return BYTE_PER_FLOAT;
+    case TR_STRING:
+        return (UINT)strlen(SYM_name(TREE_string_val(p))) + 1;
+    case TR_ID: {
+        Decl const* dcl = TREE_id_decl(p);
+        if (dcl != nullptr && DECL_dt(dcl) == DCL_DECLARATION) {
+            return get_decl_size(dcl);
+        }
+        return 0;
+    }
+    default:;
+    }
+    return 0;
+}
+
+
+//Compute byte size of TYPE_NAME or expression.
+//The function return true if the computation is success,
 //otherwise return false.
-static bool compute_sizeof(Tree * t)
+static bool compute_sizeof(Tree const* t, OUT ConstVal & v)
 {
     Tree * p = TREE_sizeof_exp(t);
+    ULONG sz = 0;
     if (TREE_type(p) == TR_TYPE_NAME) {
         Decl * dcl = TREE_type_name(p);
         ASSERT0(dcl && DECL_dt(dcl) == DCL_TYPE_NAME);
@@ -87,239 +325,505 @@ static bool compute_sizeof(Tree * t)
             dcl = factor_user_type(dcl);
             TREE_type_name(p) = dcl;
         }
-
-        ULONG sz = get_decl_size(dcl);
-        //if (is_complex_type(abs_decl) || is_user_type_ref(dcl)) {
-        //    sz = getComplexTypeSize(dcl);
-        //} else {
-        //    sz = getSimplyTypeSize(type_spec);
-        //}
-
-        if (sz != 0) {
-            pushv(sz);
-            return true;
-        }
+        sz = get_decl_size(dcl);
     } else {
-        return compute_conditional_exp(p);
+        sz = compute_exp_size(p);
     }
 
-    err(TREE_lineno(p), "'sizeof' requires type-name");
+    if (sz != 0) {
+        //The result type of sizeof is same as TypeTran, see TypeTranSizeof.
+        set_int(v, CVAL_UINT, (HOST_INT)sz);
+        return true;
+    }
 
+    errLoc(TREE_loc(p), "'sizeof' requires type-name");
     return false;
 }
 
 
-static bool compute_unary_op(Tree * t)
+//Check the type of cast before its operand is computed.
+//type_name: record the type-name of cast.
+static bool check_cvt(Tree const* t, bool is_allow_float,
+                      OUT Decl *& type_name)
 {
-    if (!compute_conditional_exp(TREE_lchild(t))) {
+    type_name = TREE_type_name(TREE_cvt_type(t));
+    ASSERT0(type_name);
+    if (is_user_type_ref(type_name)) {
+        type_name = factor_user_type(type_name);
+    }
+    CVAL_TYPE ty;
+    UINT bytesize;
+    if (!get_cval_type(type_name, ty, bytesize)) {
+        errLoc(TREE_loc(t), "expected constant expression");
+        return false;
+    }
+    if (is_fp_cval(ty) && !is_allow_float) {
+        errLoc(TREE_loc(t), "constant expression is not integral");
         return false;
     }
-    LONGLONG l = popv();
+    return true;
+}
+
+
+//v: the value of operand, and the result of operation.
+static bool compute_unary_op(Tree const* t, IN OUT ConstVal & v)
+{
     switch (TREE_type(t)) {
     case TR_PLUS: // +123
-        pushv(l);
         break;
     case TR_MINUS:  // -123
-        pushv((LONGLONG)-l);
+        if (CVAL_is_fp(v)) {
+            CVAL_fp(v) = -CVAL_fp(v);
+            break;
+        }
+        set_int(v, CVAL_type(v), (HOST_INT)(0 - (HOST_UINT)CVAL_int(v)));
         break;
     case TR_REV:  // Reverse
-        pushv(~l);
+        if (CVAL_is_fp(v)) {
+            errLoc(TREE_loc(t), "illegal operand of '~'");
+            return false;
+        }
+        set_int(v, CVAL_type(v), ~CVAL_int(v));
         break;
     case TR_NOT:  // get non-value
-        pushv(!l);
+        set_int(v, CVAL_INT, is_nonzero(v) ? 0 : 1);
         break;
     default:
-        err(TREE_lineno(t),"illegal duality expression");
+        errLoc(TREE_loc(t),"illegal duality expression");
         return false;
     }
     return true;
 }
 
 
-static bool compute_binary_op(Tree * t)
+//is_eval: false if the expression is not evaluated.
+static bool compute_shift(Tree const* t, ConstVal const& r, bool is_eval,
+                          IN OUT ConstVal & l)
 {
-    if (t == nullptr) { return false; }
-    LONGLONG r,l;
-    if (!compute_conditional_exp(TREE_lchild(t))) { return false; }
-    if (!compute_conditional_exp(TREE_rchild(t))) { return false; }
-    r = popv();
-    l = popv();
-    switch (TREE_type(t)) {
-    case TR_LOGIC_OR: //logical or
-        l = l || r;
-        pushv(l);
-        break;
-    case TR_LOGIC_AND: //logical and
-        l = l && r;
-        pushv(l);
-        break;
-    case TR_INCLUSIVE_OR: //inclusive or
-        l = l | r;
-        pushv(l);
-        break;
-    case TR_INCLUSIVE_AND: //inclusive and
-        l = l & r;
-        pushv(l);
-        break;
-    case TR_XOR: //exclusive or
-        l = l ^ r;
-        pushv(l);
-        break;
-    case TR_EQUALITY: // == !=
-        switch (TREE_token(t)) {
-        case T_EQU:
-            l = (l == r);
-            pushv(l);
-            break;
-        case T_NOEQU:
-            l = (l != r);
-            pushv(l);
-            break;
-        default: UNREACHABLE();
+    if (CVAL_is_fp(l) || CVAL_is_fp(r)) {
+        errLoc(TREE_loc(t), "illegal operand of shift");
+        return false;
+    }
+    //The result has the type of the promoted left operand.
+    UINT bits = get_cval_bytesize(CVAL_type(l)) * HOST_BIT_PER_BYTE;
+    HOST_UINT cnt = (HOST_UINT)CVAL_int(r);
+    if (!is_unsigned_cval(CVAL_type(r)) && CVAL_int(r) < 0) {
+        if (is_eval) { warnLoc(TREE_loc(t), "shift count is negative"); }
+        cnt &= bits - 1;
+    } else if (cnt >= bits) {
+        if (is_eval) {
+            warnLoc(TREE_loc(t), "shift count >= width of type");
         }
+        cnt &= bits - 1;
+    }
+    switch (TREE_token(t)) {
+    case T_LSHIFT:
+        set_int(l, CVAL_type(l), (HOST_INT)(((HOST_UINT)CVAL_int(l)) << cnt));
         break;
-    case TR_RELATION: // < > >= <=
-        switch (TREE_token(t)) {
-        case T_LESSTHAN:
-            l = (l == r);
-            pushv(l);
-            break;
-        case T_MORETHAN:
-            l = (l != r);
-            pushv(l);
-            break;
-        case T_NOLESSTHAN:
-            l = (l >= r);
-            pushv(l);
-            break;
-        case T_NOMORETHAN:
-            l = (l <= r);
-            pushv(l);
-            break;
-        default: UNREACHABLE();
+    case T_RSHIFT:
+        if (is_unsigned_cval(CVAL_type(l))) {
+            //Value has been zero-extended to HOST_INT.
+            set_int(l, CVAL_type(l),
+                    (HOST_INT)(((HOST_UINT)CVAL_int(l)) >> cnt));
+        } else {
+            set_int(l, CVAL_type(l), CVAL_int(l) >> cnt);
         }
         break;
-    case TR_SHIFT:   // >> <<
+    default: UNREACHABLE();
+    }
+    return true;
+}
+
+
+//ty: the common float-point type of 'l' and 'r'.
+//is_eval: false if the expression is not evaluated.
+static bool compute_fp_binary_op(Tree const* t, HOST_FP l, HOST_FP r,
+                                 CVAL_TYPE ty, bool is_eval,
+                                 OUT ConstVal & v)
+{
+    switch (TREE_type(t)) {
+    case TR_EQUALITY: // == !=
+        set_int(v, CVAL_INT, TREE_token(t) == T_EQU ? l == r : l != r);
+        return true;
+    case TR_RELATION: // < > >= <=
         switch (TREE_token(t)) {
-        case T_LSHIFT:
-            l = (l >> r);
-            pushv(l);
-            break;
-        case T_RSHIFT:
-            l = (l << r);
-            pushv(l);
-            break;
+        case T_LESSTHAN: set_int(v, CVAL_INT, l < r); return true;
+        case T_MORETHAN: set_int(v, CVAL_INT, l > r); return true;
+        case T_NOLESSTHAN: set_int(v, CVAL_INT, l >= r); return true;
+        case T_NOMORETHAN: set_int(v, CVAL_INT, l <= r); return true;
         default: UNREACHABLE();
         }
         break;
     case TR_ADDITIVE: // '+' '-'
-        switch (TREE_token(t)) {
-        case T_ADD:
-            l = (l + r);
-            pushv(l);
-            break;
-        case T_SUB:
-            l = (l - r);
-            pushv(l);
-            break;
-        default: UNREACHABLE();
-        }
-        break;
-    case TR_MULTI:    // '*' '/' '%'
+        set_fp(v, TREE_token(t) == T_ADD ? l + r : l - r, ty);
+        return true;
+    case TR_MULTI: // '*' '/' '%'
         switch (TREE_token(t)) {
         case T_ASTERISK:
-            l = (l * r);
-            pushv(l);
-            break;
+            set_fp(v, l * r, ty);
+            return true;
         case T_DIV:
-            l = (l / r);
-            pushv(l);
-            if (r == 0) { warn(TREE_lineno(t), "divisor is zero"); }
-            break;
-        case T_MOD:
-            l = (l % r);
-            pushv(l);
-            if (r == 0) { warn(TREE_lineno(t), "divisor is zero"); }
-            break;
-        default: UNREACHABLE();
+            if (r != 0) {
+                set_fp(v, l / r, ty);
+                return true;
+            }
+            if (is_eval) {
+                errLoc(TREE_loc(t), "divisor is zero");
+                return false;
+            }
+            set_fp(v, 0, ty);
+            return true;
+        default:;
         }
         break;
-    default:
-        err(TREE_lineno(t),"illegal duality expression");
-        return false;
+    default:;
     }
-    return true;
+    errLoc(TREE_loc(t), "illegal operand of float-point");
+    return false;
 }
 
 
-static bool compute_conditional_exp(IN Tree * t)
+//is_eval: false if the expression is not evaluated.
+static bool compute_int_binary_op(Tree const* t, ConstVal const& lv,
+                                  ConstVal const& rv, bool is_eval,
+                                  OUT ConstVal & v)
 {
-    if (t == nullptr) { return true;}
+    CVAL_TYPE ty = CVAL_type(lv);
+    bool is_unsigned = is_unsigned_cval(ty);
+    HOST_INT l = CVAL_int(lv);
+    HOST_INT r = CVAL_int(rv);
+    //Operate in HOST_UINT to obtain wrap-around semantics, the result will
+    //be truncated to target width by set_int().
+    HOST_UINT ul = (HOST_UINT)l;
+    HOST_UINT ur = (HOST_UINT)r;
     switch (TREE_type(t)) {
-    case TR_ENUM_CONST:
-        return compute_enum_const(t);
-    case TR_PLUS: // +123
-    case TR_MINUS:  // -123
-    case TR_REV:  // Reverse
-    case TR_NOT:  // get non-value
-        return compute_unary_op(t);
-    case TR_LOGIC_OR: //logical or
-    case TR_LOGIC_AND: //logical and
     case TR_INCLUSIVE_OR: //inclusive or
+        set_int(v, ty, l | r);
+        return true;
     case TR_INCLUSIVE_AND: //inclusive and
+        set_int(v, ty, l & r);
+        return true;
     case TR_XOR: //exclusive or
+        set_int(v, ty, l ^ r);
+        return true;
     case TR_EQUALITY: // == !=
-    case TR_RELATION: // < > >= <=
-    case TR_SHIFT:   // >> <<
+        set_int(v, CVAL_INT, TREE_token(t) == T_EQU ? l == r : l != r);
+        return true;
+    case TR_RELATION: { // < > >= <=
+        bool res = false;
+        switch (TREE_token(t)) {
+        case T_LESSTHAN: res = is_unsigned ? ul < ur : l < r; break;
+        case T_MORETHAN: res = is_unsigned ? ul > ur : l > r; break;
+        case T_NOLESSTHAN: res = is_unsigned ? ul >= ur : l >= r; break;
+        case T_NOMORETHAN: res = is_unsigned ? ul <= ur : l <= r; break;
+        default: UNREACHABLE();
+        }
+        set_int(v, CVAL_INT, res);
+        return true;
+    }
     case TR_ADDITIVE: // '+' '-'
-    case TR_MULTI:// '*' '/' '%'
-        return compute_binary_op(t);
+        set_int(v, ty, (HOST_INT)(TREE_token(t) == T_ADD ?
+                                  ul + ur : ul - ur));
+        return true;
+    case TR_MULTI: // '*' '/' '%'
+        if (TREE_token(t) == T_ASTERISK) {
+            set_int(v, ty, (HOST_INT)(ul * ur));
+            return true;
+        }
+        if (r == 0) {
+            if (is_eval) {
+                errLoc(TREE_loc(t), "divisor is zero");
+                return false;
+            }
+            set_int(v, ty, 0);
+            return true;
+        }
+        if (TREE_token(t) == T_DIV) {
+            if (is_unsigned) {
+                set_int(v, ty, (HOST_INT)(ul / ur));
+            } else if (r == -1) {
+                //Avoid overflow of host division.
+                set_int(v, ty, (HOST_INT)(0 - ul));
+            } else {
+                set_int(v, ty, l / r);
+            }
+            return true;
+        }
+        ASSERT0(TREE_token(t) == T_MOD);
+        if (is_unsigned) {
+            set_int(v, ty, (HOST_INT)(ul % ur));
+        } else {
+            set_int(v, ty, r == -1 ? 0 : l % r);
+        }
+        return true;
+    default:;
+    }
+    errLoc(TREE_loc(t),"illegal duality expression");
+    return false;
+}
+
+
+//is_eval: false if the expression is not evaluated.
+static bool compute_binary_op(Tree const* t, ConstVal l, ConstVal r,
+                              bool is_eval, OUT ConstVal & v)
+{
+    switch (TREE_type(t)) {
+    case TR_LOGIC_OR: //logical or
+        set_int(v, CVAL_INT, is_nonzero(l) || is_nonzero(r));
+        return true;
+    case TR_LOGIC_AND: //logical and
+        set_int(v, CVAL_INT, is_nonzero(l) && is_nonzero(r));
+        return true;
+    case TR_SHIFT: // >> <<
+        v = l;
+        return compute_shift(t, r, is_eval, v);
+    default:;
+    }
+    CVAL_TYPE ct = convert_to_common_type(l, r);
+    if (is_fp_cval(ct)) {
+        return compute_fp_binary_op(t, CVAL_fp(l), CVAL_fp(r), ct,
+                                    is_eval, v);
+    }
+    return compute_int_binary_op(t, l, r, is_eval, v);
+}
+
+
+//Compute the value of leaf expression.
+static bool compute_leaf(Tree const* t, bool is_allow_float,
+                         OUT ConstVal & v)
+{
+    switch (TREE_type(t)) {
+    case TR_ENUM_CONST:
+        return compute_enum_const(t, v);
     case TR_IMM:
+        //Keep consistent with TypeTran that regards integer which is
+        //longer than 32bit as long long.
+        set_int(v, GET_HIGH_32BIT(TREE_imm_val(t)) != 0 ?
+                   CVAL_LONGLONG : CVAL_INT, TREE_imm_val(t));
+        return true;
     case TR_IMMU:
+        set_int(v, GET_HIGH_32BIT(TREE_imm_val(t)) != 0 ?
+                   CVAL_ULONGLONG : CVAL_UINT, TREE_imm_val(t));
+        return true;
     case TR_IMML:
+        set_int(v, CVAL_LONGLONG, TREE_imm_val(t));
+        return true;
     case TR_IMMUL:
-        pushv(TREE_imm_val(t));
-        break;
+        set_int(v, CVAL_ULONGLONG, TREE_imm_val(t));
+        return true;
     case TR_FP:
     case TR_FPF:
     case TR_FPLD:
-        if (!g_is_allow_float) {
-            err(TREE_lineno(t),"constant expression is not integral");
+        if (!is_allow_float) {
+            errLoc(TREE_loc(t),"constant expression is not integral");
             return false;
         }
-        pushv((LONGLONG)atof(SYM_name(TREE_fp_str_val(t))));
-        break;
+        set_fp(v, (HOST_FP)atof(SYM_name(TREE_fp_str_val(t))),
+               TREE_type(t) == TR_FPF ? CVAL_FPF : CVAL_FP);
+        return true;
     case TR_SIZEOF:
-        return compute_sizeof(t);
-    case TR_ID:
-        {
-            Decl * dcl = nullptr;
-            if (!is_decl_exist_in_outer_scope(SYM_name(TREE_id(t)), &dcl)) {
-                err(TREE_lineno(t), "'%s' undefined");
-                return false;
-            }
-            err(TREE_lineno(t), "expected constant expression");
+        return compute_sizeof(t, v);
+    case TR_ID: {
+        Decl * dcl = nullptr;
+        if (!is_decl_exist_in_outer_scope(SYM_name(TREE_id(t)), &dcl)) {
+            errLoc(TREE_loc(t), "'%s' undefined", SYM_name(TREE_id(t)));
             return false;
+        }
+        errLoc(TREE_loc(t), "expected constant expression");
+        return false;
 
-            //TODO: infer the constant value of ID.
-            //pushv(get_decl_size(dcl));
+        //TODO: infer the constant value of ID.
+    }
+    default:
+        errLoc(TREE_loc(t), "expected constant expression");
+        return false;
+    }
+    return true;
+}
+
+
+//ConstExpVisitor
+//Compute the value of operands before the operation. The value of kid is
+//passed to 'l' or 'r' of parent frame, the empty kid is regarded as 0.
+class ConstExpVisitor {
+    COPY_CONSTRUCTOR(ConstExpVisitor);
+    ConstVal m_res;
+public:
+    ConstExpVisitor() {}
+
+    ConstVal const& getResult() const { return m_res; }
+
+    WALK_ACT visitPre(ConstExpFrame & f)
+    {
+        Tree const* t = f.tree;
+        switch (TREE_type(t)) {
+        case TR_PLUS: // +123
+        case TR_MINUS:  // -123
+        case TR_REV:  // Reverse
+        case TR_NOT:  // get non-value
+        case TR_LOGIC_OR: //logical or
+        case TR_LOGIC_AND: //logical and
+        case TR_INCLUSIVE_OR: //inclusive or
+        case TR_INCLUSIVE_AND: //inclusive and
+        case TR_XOR: //exclusive or
+        case TR_EQUALITY: // == !=
+        case TR_RELATION: // < > >= <=
+        case TR_SHIFT:   // >> <<
+        case TR_ADDITIVE: // '+' '-'
+        case TR_MULTI:// '*' '/' '%'
+        case TR_COND:
+            return WALK_CONT;
+        case TR_CVT:
+            return check_cvt(t, f.data.is_allow_float, f.data.type_name) ?
+                   WALK_CONT : WALK_ABORT;
+        default:
+            return compute_leaf(t, f.data.is_allow_float, f.data.v) ?
+                   WALK_SKIP_KID : WALK_ABORT;
         }
-        break;
-    case TR_COND:
-        {
-            if (!compute_conditional_exp(TREE_det(t))) { return false; }
-            LONGLONG v = popv();
-            if (v != 0) {
-                return compute_conditional_exp(TREE_true_part(t));
-            } else {
-                return compute_conditional_exp(TREE_false_part(t));
+        return WALK_CONT;
+    }
+
+    bool getKid(ConstExpFrame & f, OUT ConstExpFrame & kid)
+    {
+        Tree const* t = f.tree;
+        kid.is_list = false;
+        kid.data.is_allow_float = f.data.is_allow_float;
+        kid.data.is_eval = f.data.is_eval;
+        switch (TREE_type(t)) {
+        case TR_PLUS:
+        case TR_MINUS:
+        case TR_REV:
+        case TR_NOT:
+            if (f.kid_idx > 0) { return false; }
+            set_int(f.data.l, CVAL_INT, 0);
+            kid.tree = TREE_lchild(t);
+            return true;
+        case TR_CVT:
+            if (f.kid_idx > 0) { return false; }
+            set_int(f.data.l, CVAL_INT, 0);
+            //Float-point constant is permitted to be the immediate operand
+            //of cast to integer.
+            kid.data.is_allow_float = true;
+            kid.tree = TREE_cast_exp(t);
+            return true;
+        case TR_COND:
+            //Both parts are computed to obtain the common type, whereas
+            //only the chosen part is evaluated.
+            if (f.kid_idx == 0) {
+                set_int(f.data.l, CVAL_INT, 0);
+                kid.tree = TREE_det(t);
+                return true;
+            }
+            if (f.kid_idx == 1) {
+                f.data.is_det_true = is_nonzero(f.data.l);
+                set_int(f.data.r, CVAL_INT, 0);
+                kid.data.is_eval = f.data.is_eval && f.data.is_det_true;
+                kid.tree = TREE_true_part(t);
+                return true;
+            }
+            if (f.kid_idx > 2) { return false; }
+            //Keep the value of true part in 'l'.
+            f.data.l = f.data.r;
+            set_int(f.data.r, CVAL_INT, 0);
+            kid.data.is_eval = f.data.is_eval && !f.data.is_det_true;
+            kid.tree = TREE_false_part(t);
+            return true;
+        case TR_LOGIC_OR:
+        case TR_LOGIC_AND:
+            if (f.kid_idx == 0) {
+                set_int(f.data.l, CVAL_INT, 0);
+                kid.tree = TREE_lchild(t);
+                return true;
             }
+            if (f.kid_idx > 1) { return false; }
+            if (is_nonzero(f.data.l) == (TREE_type(t) == TR_LOGIC_OR)) {
+                //The second operand is not computed if the first
+                //operand determines the result, e.g: 0 && 1/0.
+                f.data.r = f.data.l;
+                return false;
+            }
+            set_int(f.data.r, CVAL_INT, 0);
+            kid.tree = TREE_rchild(t);
+            return true;
+        default:;
         }
-        break;
-    default:
-        err(TREE_lineno(t), "expected constant expression");
+        if (f.kid_idx == 0) {
+            set_int(f.data.l, CVAL_INT, 0);
+            kid.tree = TREE_lchild(t);
+            return true;
+        }
+        if (f.kid_idx > 1) { return false; }
+        set_int(f.data.r, CVAL_INT, 0);
+        kid.tree = TREE_rchild(t);
+        return true;
+    }
+
+    WALK_ACT visitPost(ConstExpFrame & f, ConstExpFrame * parent)
+    {
+        Tree const* t = f.tree;
+        switch (TREE_type(t)) {
+        case TR_PLUS:
+        case TR_MINUS:
+        case TR_REV:
+        case TR_NOT:
+            f.data.v = f.data.l;
+            if (!compute_unary_op(t, f.data.v)) { return WALK_ABORT; }
+            break;
+        case TR_CVT:
+            f.data.v = f.data.l;
+            if (!convertConstVal(f.data.v, f.data.type_name)) {
+                return WALK_ABORT;
+            }
+            break;
+        case TR_COND:
+            //The usual arithmetic conversions are performed to both parts.
+            convert_to_common_type(f.data.l, f.data.r);
+            f.data.v = f.data.is_det_true ? f.data.l : f.data.r;
+            break;
+        case TR_LOGIC_OR:
+        case TR_LOGIC_AND:
+        case TR_INCLUSIVE_OR:
+        case TR_INCLUSIVE_AND:
+        case TR_XOR:
+        case TR_EQUALITY:
+        case TR_RELATION:
+        case TR_SHIFT:
+        case TR_ADDITIVE:
+        case TR_MULTI:
+            if (!compute_binary_op(t, f.data.l, f.data.r, f.data.is_eval,
+                                   f.data.v)) {
+                return WALK_ABORT;
+            }
+            break;
+        default:; //Leaf has been computed in visitPre.
+        }
+        if (parent == nullptr) {
+            m_res = f.data.v;
+        } else if (parent->kid_idx == 1) {
+            parent->data.l = f.data.v;
+        } else {
+            //The false part of '?:' is the third kid.
+            ASSERT0(parent->kid_idx == 2 || parent->kid_idx == 3);
+            parent->data.r = f.data.v;
+        }
+        return WALK_CONT;
+    }
+};
+
+
+bool computeConstExp(IN Tree * t, OUT ConstVal & v, bool is_allow_float)
+{
+    ASSERT0(t);
+    ConstExpVisitor visitor;
+    TreeWalker<ConstExpVisitor, ConstExpData> walker(visitor);
+    ConstExpData data;
+    data.is_allow_float = is_allow_float;
+    data.is_eval = true;
+    if (!walker.walk(t, false, data)) {
+        set_int(v, CVAL_INT, 0);
         return false;
     }
+    v = visitor.getResult();
     return true;
 }
 
@@ -327,11 +831,11 @@ static bool compute_conditional_exp(IN Tree * t)
 bool computeConstExp(IN Tree * t, OUT LONGLONG * v, bool is_allow_float)
 {
     ASSERT0(t && v);
-    g_is_allow_float = is_allow_float;
-    if (!compute_conditional_exp(t)) {
+    ConstVal cv;
+    if (!computeConstExp(t, cv, is_allow_float)) {
         *v = 0;
         return false;
     }
-    *v = popv();
+    *v = CVAL_is_fp(cv) ? (LONGLONG)CVAL_fp(cv) : (LONGLONG)CVAL_int(cv);
     return true;
 }
@@ -28,7 +28,49 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __EXEC_TREE_H__
 #define __EXEC_TREE_H__
 
+//Describe the C type of constant value.
+//Integer promotion has been applied to values, thus there is no
+//kind for char, short and bool.
+typedef enum _CVAL_TYPE {
+    CVAL_INT = 0, //signed int, BYTE_PER_INT
+    CVAL_UINT, //unsigned int, BYTE_PER_INT
+    CVAL_LONG, //signed long, BYTE_PER_LONG
+    CVAL_ULONG, //unsigned long, BYTE_PER_LONG
+    CVAL_LONGLONG, //signed long long, BYTE_PER_LONGLONG
+    CVAL_ULONGLONG, //unsigned long long, BYTE_PER_LONGLONG
+    CVAL_FPF, //float, evaluated in HOST_FP and rounded to BYTE_PER_FLOAT
+    CVAL_FP, //double and long double, evaluated in HOST_FP
+} CVAL_TYPE;
+
+//Represent the value of constant expression.
+//Integer value is always kept in its target bit-width, namely, it has been
+//truncated and sign- or zero-extended to HOST_INT according to
+//cfe_targ_const_info.h.
+#define CVAL_type(v) ((v).type)
+#define CVAL_int(v) ((v).u1.ival)
+#define CVAL_fp(v) ((v).u1.fval)
+#define CVAL_is_fp(v) (CVAL_type(v) == CVAL_FP || CVAL_type(v) == CVAL_FPF)
+class ConstVal {
+public:
+    CVAL_TYPE type;
+    union {
+        HOST_INT ival;
+        HOST_FP fval;
+    } u1;
+};
+
+
+//Compute the value of constant expression 't'.
+//Return true if 't' is constant expression, and 'v' holds the value.
+//is_allow_float: true if float-point operand is legal in 't'. Otherwise
+//  float-point constant can only be the operand of cast to integer type.
+extern bool computeConstExp(IN Tree * t, OUT ConstVal & v,
+                            bool is_allow_float);
 extern bool computeConstExp(IN Tree * t, OUT LONGLONG * v,
                             bool is_allow_float);
 
+//Convert 'v' to the arithmetic type 'type_name' with the semantics of
+//C cast. Return false if 'type_name' is not arithmetic type.
+extern bool convertConstVal(IN OUT ConstVal & v, Decl const* type_name);
+
 #endif
@@ -0,0 +1,537 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+//The pass folds constant subexpressions in place into TR_IMM and TR_FP
+//nodes that keep the line number and result type of the original node.
+//It also removes no-op type conversions and simplifies conditional
+//expression and if-stmt whose determinant is constant.
+
+//The data attached to the walking frame of FoldVisitor.
+//Kids of a tree are folded list by list, the decl-init of scope first, then
+//the statements or fields.
+class FoldData {
+public:
+    Tree ** head; //the head of list that the tree of frame belongs to.
+    Tree ** kid_head; //the head of list of kids that being folded.
+    Tree * next_kid; //the next kid to fold in 'kid_head'.
+    UINT fld; //the index of next field to fold.
+    Decl * decl; //the next declaration whose initial value to fold.
+    Decl * init_decl; //the declaration whose initial value being folded.
+    Tree * init_head; //the initial value of 'init_decl'.
+};
+typedef TreeWalkFrame<FoldData> FoldFrame;
+
+//Return true if 't' is single constant leaf.
+static bool is_const_operand(Tree const* t)
+{
+    if (t == nullptr || TREE_nsib(t) != nullptr) { return false; }
+    switch (TREE_type(t)) {
+    case TR_IMM:
+    case TR_IMMU:
+    case TR_IMML:
+    case TR_IMMUL:
+    case TR_FP:
+    case TR_FPF:
+    case TR_FPLD:
+    case TR_ENUM_CONST:
+        return true;
+    default:;
+    }
+    return false;
+}
+
+
+//Return true if 't' is single integer constant leaf.
+static bool is_int_operand(Tree const* t)
+{
+    return is_const_operand(t) && !is_imm_fp(t);
+}
+
+
+static bool is_arith_type(Decl const* dcl)
+{
+    return dcl != nullptr && !is_user_type_ref(dcl) && is_arith(dcl) &&
+           !is_pointer(dcl) && !is_array(dcl);
+}
+
+
+//Return true if conversion between 'src' and 'tgt' does nothing.
+static bool is_noop_cvt(Decl const* src, Decl const* tgt)
+{
+    if (!is_arith_type(src) || !is_arith_type(tgt)) { return false; }
+    TypeSpec const* sty = DECL_spec(src);
+    TypeSpec const* tty = DECL_spec(tgt);
+    return get_decl_size(src) == get_decl_size(tgt) &&
+           is_fp(sty) == is_fp(tty) &&
+           IS_TYPE(sty, T_SPEC_UNSIGNED) == IS_TYPE(tty, T_SPEC_UNSIGNED) &&
+           IS_TYPE(sty, T_SPEC_BOOL) == IS_TYPE(tty, T_SPEC_BOOL);
+}
+
+
+static UINT get_cval_bitsize(ConstVal const& v)
+{
+    switch (CVAL_type(v)) {
+    case CVAL_LONG:
+    case CVAL_ULONG:
+        return BYTE_PER_LONG * HOST_BIT_PER_BYTE;
+    case CVAL_LONGLONG:
+    case CVAL_ULONGLONG:
+        return BYTE_PER_LONGLONG * HOST_BIT_PER_BYTE;
+    default:;
+    }
+    return BYTE_PER_INT * HOST_BIT_PER_BYTE;
+}
+
+
+//Return true if 'divisor' is nonzero.
+static bool is_legal_divisor(Tree * divisor)
+{
+    ConstVal v;
+    if (!computeConstExp(divisor, v, true)) { return false; }
+    return CVAL_is_fp(v) ? CVAL_fp(v) != 0 : CVAL_int(v) != 0;
+}
+
+
+//Return true if the shift count is in the range of width of 't'.
+static bool is_legal_shift(Tree * t)
+{
+    ConstVal l;
+    ConstVal r;
+    if (!computeConstExp(TREE_lchild(t), l, false) ||
+        !computeConstExp(TREE_rchild(t), r, false)) {
+        return false;
+    }
+    return CVAL_int(r) >= 0 && CVAL_int(r) < (HOST_INT)get_cval_bitsize(l);
+}
+
+
+//Return true if 't' can be evaluated at compiling period without
+//diagnostic.
+static bool is_foldable(Tree * t)
+{
+    switch (TREE_type(t)) {
+    case TR_ENUM_CONST:
+        return true;
+    case TR_PLUS:
+    case TR_MINUS:
+    case TR_NOT:
+        return is_const_operand(TREE_lchild(t));
+    case TR_REV:
+        return is_int_operand(TREE_lchild(t));
+    case TR_LOGIC_OR:
+    case TR_LOGIC_AND:
+    case TR_EQUALITY:
+    case TR_RELATION:
+    case TR_ADDITIVE:
+        return is_const_operand(TREE_lchild(t)) &&
+               is_const_operand(TREE_rchild(t));
+    case TR_INCLUSIVE_OR:
+    case TR_INCLUSIVE_AND:
+    case TR_XOR:
+        return is_int_operand(TREE_lchild(t)) &&
+               is_int_operand(TREE_rchild(t));
+    case TR_SHIFT:
+        return is_int_operand(TREE_lchild(t)) &&
+               is_int_operand(TREE_rchild(t)) &&
+               is_legal_shift(t);
+    case TR_MULTI:
+        if (TREE_token(t) == T_MOD) {
+            return is_int_operand(TREE_lchild(t)) &&
+                   is_int_operand(TREE_rchild(t)) &&
+                   is_legal_divisor(TREE_rchild(t));
+        }
+        if (!is_const_operand(TREE_lchild(t)) ||
+            !is_const_operand(TREE_rchild(t))) {
+            return false;
+        }
+        return TREE_token(t) != T_DIV || is_legal_divisor(TREE_rchild(t));
+    case TR_CVT:
+        return is_const_operand(TREE_cast_exp(t)) &&
+               is_arith_type(TREE_type_name(TREE_cvt_type(t)));
+    default:;
+    }
+    return false;
+}
+
+
+//Replace 't' with constant value 'v' in place.
+//Line number, result type and sibling of 't' are kept unchanged.
+static bool replaceWithConst(Tree * t, ConstVal & v)
+{
+    Decl * rt = TREE_result_type(t);
+    if (is_arith_type(rt) && !convertConstVal(v, rt)) {
+        return false;
+    }
+    if (CVAL_is_fp(v)) {
+        HOST_FP f = CVAL_fp(v);
+        if (f != f || f - f != 0) {
+            //NaN or infinity can not be represented by literal.
+            return false;
+        }
+        xcom::SmallStrBuf<32> buf;
+        buf.sprint("%.17g", f);
+        if (strpbrk(buf.buf, ".eE") == nullptr) { buf.strcat(".0"); }
+        //The kind of value has been converted to 'rt' if 'rt' is
+        //arithmetic type, thus it also describes untyped expression.
+        bool is_flt = CVAL_type(v) == CVAL_FPF;
+        TREE_type(t) = is_flt ? TR_FPF : TR_FP;
+        TREE_token(t) = is_flt ? T_FPF : T_FP;
+        TREE_fp_str_val(t) = g_fe_sym_tab->add(buf.buf);
+    } else {
+        UINT bytesize = get_cval_bitsize(v) / HOST_BIT_PER_BYTE;
+        bool is_unsigned = CVAL_type(v) == CVAL_UINT ||
+                           CVAL_type(v) == CVAL_ULONG ||
+                           CVAL_type(v) == CVAL_ULONGLONG;
+        if (is_arith_type(rt)) {
+            bytesize = get_decl_size(rt);
+            is_unsigned = IS_TYPE(DECL_spec(rt), T_SPEC_UNSIGNED);
+        }
+        if (bytesize >= BYTE_PER_LONGLONG) {
+            TREE_type(t) = is_unsigned ? TR_IMMUL : TR_IMML;
+            TREE_token(t) = is_unsigned ? T_IMMUL : T_IMML;
+        } else if (is_unsigned && bytesize >= BYTE_PER_INT) {
+            TREE_type(t) = TR_IMMU;
+            TREE_token(t) = T_IMMU;
+        } else {
+            TREE_type(t) = TR_IMM;
+            TREE_token(t) = T_IMM;
+        }
+        TREE_imm_val(t) = CVAL_int(v);
+    }
+    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
+        TREE_fld(t, i) = nullptr;
+    }
+    return true;
+}
+
+
+//LabelFinder
+//Find label, case or default in tree, the walking is aborted once found.
+class LabelFinder {
+    COPY_CONSTRUCTOR(LabelFinder);
+public:
+    LabelFinder() {}
+
+    WALK_ACT visitPre(TreeWalkFrame<TreeWalkNoData> & f)
+    {
+        switch (TREE_type(f.tree)) {
+        case TR_LABEL:
+        case TR_CASE:
+        case TR_DEFAULT:
+            return WALK_ABORT;
+        default:;
+        }
+        return WALK_CONT;
+    }
+
+    bool getKid(TreeWalkFrame<TreeWalkNoData> & f,
+                OUT TreeWalkFrame<TreeWalkNoData> & kid)
+    {
+        Tree * t = f.tree;
+        if (TREE_type(t) == TR_SCOPE) {
+            return fetchKid(f.kid_idx, kid, 1,
+                            SCOPE_stmt_list(TREE_scope(t)));
+        }
+        return fetchKid(f.kid_idx, kid, MAX_TREE_FLDS, TREE_fld(t, 0),
+                        TREE_fld(t, 1), TREE_fld(t, 2), TREE_fld(t, 3));
+    }
+
+    WALK_ACT visitPost(TreeWalkFrame<TreeWalkNoData> &,
+                       TreeWalkFrame<TreeWalkNoData> *)
+    { return WALK_CONT; }
+};
+
+
+//Return true if there is label, case or default in 't' and its kids.
+//Statements that contain jump target can not be removed.
+static bool has_label(Tree * t)
+{
+    LabelFinder v;
+    TreeWalker<LabelFinder> w(v);
+    return !w.walk(t, true);
+}
+
+
+//Return the kept part if determinant of conditional expression is
+//constant, or 't' itself.
+static Tree * foldCond(Tree * t)
+{
+    Tree * det = TREE_det(t);
+    if (!is_const_operand(det) || TREE_result_type(t) == nullptr) {
+        return t;
+    }
+    ConstVal v;
+    if (!computeConstExp(det, v, true)) { return t; }
+    bool is_true = CVAL_is_fp(v) ? CVAL_fp(v) != 0 : CVAL_int(v) != 0;
+    Tree * kept = is_true ? TREE_true_part(t) : TREE_false_part(t);
+    if (kept == nullptr || TREE_nsib(kept) != nullptr) { return t; }
+    if (TREE_result_type(kept) == TREE_result_type(t) ||
+        is_noop_cvt(TREE_result_type(kept), TREE_result_type(t))) {
+        return kept;
+    }
+    Tree * cvt = gen_cvt(TREE_result_type(t), kept);
+    TREE_loc(cvt) = TREE_loc(t);
+    TREE_loc(TREE_cvt_type(cvt)) = TREE_loc(t);
+    TREE_result_type(cvt) = TREE_result_type(t);
+    return cvt;
+}
+
+
+//Return the kept statement list if determinant of if-stmt is constant,
+//or 't' itself.
+static Tree * foldIf(Tree * t)
+{
+    Tree * det = TREE_if_det(t);
+    if (!is_const_operand(det)) { return t; }
+    ConstVal v;
+    if (!computeConstExp(det, v, true)) { return t; }
+    bool is_true = CVAL_is_fp(v) ? CVAL_fp(v) != 0 : CVAL_int(v) != 0;
+    Tree * kept = is_true ? TREE_if_true_stmt(t) : TREE_if_false_stmt(t);
+    Tree * removed = is_true ? TREE_if_false_stmt(t) : TREE_if_true_stmt(t);
+    if (has_label(removed)) { return t; }
+    TREE_if_true_stmt(t) = nullptr;
+    TREE_if_false_stmt(t) = nullptr;
+    return kept;
+}
+
+
+static Tree * foldExp(Tree * t)
+{
+    switch (TREE_type(t)) {
+    case TR_COND:
+        return foldCond(t);
+    case TR_IF:
+        return foldIf(t);
+    case TR_CVT: {
+        Tree * exp = TREE_cast_exp(t);
+        if (!is_const_operand(exp) && exp != nullptr &&
+            TREE_nsib(exp) == nullptr &&
+            is_noop_cvt(TREE_result_type(exp), TREE_result_type(t))) {
+            return exp;
+        }
+        break;
+    }
+    default:;
+    }
+    if (!is_foldable(t)) { return t; }
+    ConstVal v;
+    if (!computeConstExp(t, v, true)) { return t; }
+    replaceWithConst(t, v);
+    return t;
+}
+
+
+//Replace 'olds' in list with a list that leading by 'news'.
+//Remove 'olds' if 'news' is empty.
+static void replaceTree(Tree ** head, Tree * olds, Tree * news)
+{
+    for (Tree * p = news; p != nullptr; p = TREE_nsib(p)) {
+        TREE_parent(p) = TREE_parent(olds);
+    }
+    if (news != nullptr) {
+        xcom::insertbefore(head, olds, news);
+    }
+    xcom::remove(head, olds);
+}
+
+
+//Record the folded initial value of declaration being folded.
+static void flushDeclInit(IN OUT FoldData & d)
+{
+    if (d.init_decl == nullptr) { return; }
+    if (d.init_head != get_decl_init_tree(d.init_decl)) {
+        set_decl_init_tree(d.init_decl, d.init_head);
+    }
+    d.init_decl = nullptr;
+}
+
+
+//Move to the next list of kids of 'f.tree'.
+//Return false if there is no more list.
+static bool nextKidList(IN OUT FoldFrame & f)
+{
+    FoldData & d = f.data;
+    flushDeclInit(d);
+    for (; d.decl != nullptr; d.decl = DECL_next(d.decl)) {
+        if (!is_initialized(d.decl)) { continue; }
+        d.init_decl = d.decl;
+        d.init_head = get_decl_init_tree(d.decl);
+        d.decl = DECL_next(d.decl);
+        d.kid_head = &d.init_head;
+        d.next_kid = d.init_head;
+        return true;
+    }
+    Tree * t = f.tree;
+    switch (TREE_type(t)) {
+    case TR_SCOPE:
+        if (d.fld > 0) { return false; }
+        d.kid_head = &SCOPE_stmt_list(TREE_scope(t));
+        break;
+    case TR_INITVAL_SCOPE:
+        if (d.fld > 0) { return false; }
+        d.kid_head = &TREE_initval_scope(t);
+        break;
+    default:
+        if (d.fld >= MAX_TREE_FLDS) { return false; }
+        d.kid_head = &TREE_fld(t, d.fld);
+    }
+    d.fld++;
+    d.next_kid = *d.kid_head;
+    return true;
+}
+
+
+//FoldVisitor
+//Fold kids of tree first, then the tree itself. Each kid is visited as
+//single tree, the parent records the next kid before the kid is folded,
+//thus the kid is able to be replaced in its list.
+class FoldVisitor {
+    COPY_CONSTRUCTOR(FoldVisitor);
+public:
+    FoldVisitor() {}
+
+    WALK_ACT visitPre(FoldFrame & f)
+    {
+        Tree * t = f.tree;
+        FoldData & d = f.data;
+        d.kid_head = nullptr;
+        d.next_kid = nullptr;
+        d.fld = 0;
+        d.decl = nullptr;
+        d.init_decl = nullptr;
+        d.init_head = nullptr;
+        switch (TREE_type(t)) {
+        case TR_SCOPE:
+            d.decl = SCOPE_decl_list(TREE_scope(t));
+            return WALK_CONT;
+        case TR_INITVAL_SCOPE:
+            return WALK_CONT;
+        case TR_TYPE_NAME:
+        case TR_PRAGMA:
+        case TR_PREP:
+        case TR_IMM:
+        case TR_IMMU:
+        case TR_IMML:
+        case TR_IMMUL:
+        case TR_FP:
+        case TR_FPF:
+        case TR_FPLD:
+        case TR_ENUM_CONST:
+        case TR_STRING:
+        case TR_ID:
+            //Leaf node. Note the kid of sizeof is still recorded after
+            //TypeTran transformed it into TR_IMMU.
+            return WALK_SKIP_KID;
+        case TR_FOR:
+            if (TREE_for_scope(t) != nullptr) {
+                d.decl = SCOPE_decl_list(TREE_for_scope(t));
+            }
+            return WALK_CONT;
+        default:;
+        }
+        return WALK_CONT;
+    }
+
+    bool getKid(FoldFrame & f, OUT FoldFrame & kid)
+    {
+        while (f.data.next_kid == nullptr) {
+            if (!nextKidList(f)) { return false; }
+        }
+        kid.tree = f.data.next_kid;
+        kid.is_list = false;
+        kid.data.head = f.data.kid_head;
+        f.data.next_kid = TREE_nsib(kid.tree);
+        return true;
+    }
+
+    WALK_ACT visitPost(FoldFrame & f, FoldFrame *)
+    {
+        Tree * t = f.tree;
+        switch (TREE_type(t)) {
+        case TR_SCOPE:
+        case TR_INITVAL_SCOPE:
+        case TR_TYPE_NAME:
+        case TR_PRAGMA:
+        case TR_PREP:
+            return WALK_CONT;
+        default:;
+        }
+        Tree * nt = foldExp(t);
+        if (nt != t) {
+            ASSERT0(f.data.head);
+            replaceTree(f.data.head, t, nt);
+        }
+        return WALK_CONT;
+    }
+};
+
+
+//Fold each tree in list 'head'.
+static void foldTreeList(Tree ** head)
+{
+    FoldVisitor v;
+    TreeWalker<FoldVisitor, FoldData> w(v);
+    FoldData data;
+    ::memset((void*)&data, 0, sizeof(FoldData));
+    data.head = head;
+    Tree * next = nullptr;
+    for (Tree * t = *head; t != nullptr; t = next) {
+        next = TREE_nsib(t);
+        w.walk(t, false, data);
+    }
+}
+
+
+static void foldScope(Scope * sc)
+{
+    for (Decl * dcl = SCOPE_decl_list(sc); dcl != nullptr;
+         dcl = DECL_next(dcl)) {
+        if (!is_initialized(dcl)) { continue; }
+        Tree * inittree = get_decl_init_tree(dcl);
+        Tree * newtree = inittree;
+        foldTreeList(&newtree);
+        if (newtree != inittree) {
+            set_decl_init_tree(dcl, newtree);
+        }
+    }
+    foldTreeList(&SCOPE_stmt_list(sc));
+}
+
+
+INT FoldTree()
+{
+    Scope * s = get_global_scope();
+    for (Decl * dcl = SCOPE_decl_list(s); dcl != nullptr;
+         dcl = DECL_next(dcl)) {
+        if (DECL_is_fun_def(dcl)) {
+            foldScope(DECL_fun_body(dcl));
+        }
+    }
+    return ST_SUCC;
+}
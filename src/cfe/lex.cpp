@@ -26,6 +26,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
 USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
 #include "../com/xcominc.h"
+#include "srcloc.h"
 #include "err.h"
 #include "cfeinc.h"
 #include "cfecommacro.h"
@@ -43,16 +44,26 @@ static INT  g_last_read_num = 0;
 //Set true to return the newline charactors as normal character.
 static bool g_use_newline_char = true;
 static UINT g_cur_src_ofst = 0;  //Record current file offset of src file
+static UINT g_cur_line_ofst = 0; //Record file offset of 'g_cur_line'
+static UINT g_cur_token_ofst = 0; //Record file offset of current token
+//Line number that lexer has scanned. It is published to g_src_line_num
+//by getNextToken(), whereas Lexer reports it through Token.
+static UINT g_lex_line_num = 0;
+//Set true to regard '\n' as token during current scanning.
+static bool g_is_newline_token = false;
+//Set true to record lexical diagnostics rather than report them.
+static bool g_is_defer_diag = false;
+static LexDiag * g_defer_diag = nullptr;
+static LexDiag * g_defer_diag_last = nullptr;
 
 UINT g_src_line_num = 0; //line number of src file
+SrcLoc g_src_loc = SRCLOC_UNDEF; //location of current token in src file
 
 //The string buffer which token were reside.
 CHAR g_cur_token_string[MAX_BUF_LINE] = {0};
 CHAR * g_cur_line; //Current parsing line of src file
 UINT g_cur_line_len = 0; //The current line buf length ,than read from file buf
 TOKEN g_cur_token = T_NUL;
-LONG * g_ofst_tab = nullptr; //Record offset of each line in src file
-LONG g_ofst_tab_byte_size = 0; //Record byte size position of Offset Table
 bool g_enable_newline_token = false; //Set true to regard '\n' as token.
 
 //If true, recognize the true and false token.
@@ -60,10 +71,7 @@ bool g_enable_true_false_token = true;
 FILE * g_hsrc = nullptr;
 xoc::LogMgr * g_logmgr = nullptr;
 INT g_real_line_num;
-
-//Record the number of disgarded line, that always
-//sparking by preprecossor.
-UINT g_disgarded_line_num = 0;
+SrcLoc g_real_loc = SRCLOC_UNDEF;
 
 //Make sure following Tokens or Keywords is consistent with
 //declarations of TOKEN enumeration declared in lex.h.
@@ -261,21 +269,9 @@ static UINT g_keyword_num = sizeof(g_keyword_info)/sizeof(g_keyword_info[0]);
 //Return status, which could be ST_SUCC or ST_ERR.
 static INT getLine()
 {
-    //Initializing or realloc offset table.
-    if (g_ofst_tab == nullptr) {
-        g_ofst_tab_byte_size = MAX_OFST_BUF_LEN * sizeof(LONG);
-        g_ofst_tab = (LONG*)::malloc(g_ofst_tab_byte_size);
-        ::memset(g_ofst_tab, 0, g_ofst_tab_byte_size);
-    } else if (OFST_TAB_LINE_SIZE < (g_src_line_num + 10)) {
-        g_ofst_tab = (LONG*)::realloc(g_ofst_tab, g_ofst_tab_byte_size +
-                                      MAX_OFST_BUF_LEN * sizeof(LONG));
-        ::memset(((BYTE*)g_ofst_tab) + g_ofst_tab_byte_size,
-                 0, MAX_OFST_BUF_LEN * sizeof(LONG));
-        g_ofst_tab_byte_size += MAX_OFST_BUF_LEN * sizeof(LONG);
-    }
-
     UINT pos = 0;
     bool is_some_chars_in_cur_line = false;
+    g_cur_line_ofst = g_cur_src_ofst;
     for (;;) {
         if (g_cur_line == nullptr) {
             g_cur_line = (CHAR*)::malloc(MAX_BUF_LINE);
@@ -330,7 +326,7 @@ static INT getLine()
                     g_file_buf_pos += 2;
                 }
                 g_cur_src_ofst += 2;
-                g_src_line_num++;
+                g_lex_line_num++;
                 goto FIN;
             } else if (g_file_buf[g_file_buf_pos] == 0xa) { //unix text format
                 if (is_0xd_recog) {
@@ -355,7 +351,7 @@ static INT getLine()
                     }
                 }
                 g_cur_src_ofst++;
-                g_src_line_num++;
+                g_lex_line_num++;
                 goto FIN;
             } else if(g_file_buf[g_file_buf_pos] == 0xd && g_is_dos) {
                 //0xd is the last charactor in 'g_file_buf',so 0xa is
@@ -387,8 +383,8 @@ static INT getLine()
     }
 
 FIN:
-    ASSERT0((g_src_line_num + 1) < OFST_TAB_LINE_SIZE);
-    g_ofst_tab[g_src_line_num + 1] = g_cur_src_ofst;
+    //Record the start offset of next line.
+    setSrcLineStart(g_lex_line_num + 1, g_cur_src_ofst);
     g_cur_line[pos] = 0;
     g_cur_line_num = (INT)strlen(g_cur_line);
     g_cur_line_pos = 0;
@@ -398,7 +394,7 @@ FAILED:
     return ST_ERR;
 
 FEOF:
-    g_src_line_num++;
+    g_lex_line_num++;
     g_cur_line[pos] = 0;
     g_cur_line_num = 0;
     g_cur_line_pos = 0;
@@ -406,9 +402,10 @@ FEOF:
 }
 
 
-class String2Token : public HMap<CHAR const*, TOKEN, HashFuncString2> {
+class String2Token : public OAHMap<CHAR const*, TOKEN, HashFuncString2> {
 public:
-    String2Token(UINT bsize) : HMap<CHAR const*, TOKEN, HashFuncString2>(bsize) {}
+    String2Token(UINT bsize) :
+        OAHMap<CHAR const*, TOKEN, HashFuncString2>(bsize) {}
     virtual ~String2Token() {}
 };
 
@@ -432,6 +429,36 @@ static TOKEN getKeyWord(CHAR const* s)
 }
 
 
+//Report lexical error, or record it if diagnostics are deferred.
+static void lexErr(CHAR const* fmt, ...)
+{
+    CHAR buf[MAX_BUF_LINE];
+    va_list arg;
+    va_start(arg, fmt);
+    ::vsnprintf(buf, sizeof(buf), fmt, arg);
+    va_end(arg);
+    //Parser may not reach the token yet, e.g: prelexing, thus the line
+    //is decoded from the location of token rather than parser's line.
+    SrcLoc loc = makeSrcLoc(g_cur_token_ofst);
+    if (!g_is_defer_diag) {
+        errMsg(loc, fmt, buf);
+        return;
+    }
+    LexDiag * d = (LexDiag*)::malloc(sizeof(LexDiag));
+    ASSERT0(d);
+    LEXDIAG_fmt(d) = fmt;
+    LEXDIAG_msg(d) = ::strdup(buf);
+    LEXDIAG_loc(d) = loc;
+    LEXDIAG_next(d) = nullptr;
+    if (g_defer_diag_last == nullptr) {
+        g_defer_diag = d;
+    } else {
+        LEXDIAG_next(g_defer_diag_last) = d;
+    }
+    g_defer_diag_last = d;
+}
+
+
 //Get a charactor from g_cur_line.
 //If it meets the EOF, the return value will be -1.
 static CHAR getNextChar()
@@ -556,7 +583,7 @@ FIN:
     } else if (g_cur_char == 'F' || g_cur_char == 'f') {
         //e.g: 1.0F, float
         if (t == T_IMM) {
-            err(g_real_line_num, "invalid suffix \"%c\" on integer constant",
+            lexErr("invalid suffix \"%c\" on integer constant",
                 g_cur_char);
         } else {
             ASSERT0(t == T_FP);
@@ -645,7 +672,7 @@ static TOKEN t_string()
                     c = getNextChar();
                 }
                 if (n > 2 && only_allow_two_hex) {
-                    err(g_real_line_num, "constant too big, only permit two hex digits");
+                    lexErr("constant too big, only permit two hex digits");
                 }
             } else {
                 g_cur_token_string[g_cur_token_string_pos++] = '\\';
@@ -736,7 +763,7 @@ static TOKEN t_char_list()
                     c = getNextChar();
                 }
                 if (n > 2 && only_allow_two_hex) {
-                    err(g_real_line_num, "constant too big, only permit two hex digits");
+                    lexErr("constant too big, only permit two hex digits");
                 }
             } else {
                 g_cur_token_string[g_cur_token_string_pos++] = '\\';
@@ -774,6 +801,8 @@ static TOKEN t_id()
 }
 
 
+static TOKEN scanToken();
+
 //'g_cur_char' hold the current charactor right now.
 //You should assign 'g_cur_char' the next valid charactor before
 //the function return.
@@ -799,7 +828,7 @@ static TOKEN t_solidus(bool * is_restart)
                 t = t_solidus(is_restart);
                 goto FIN;
             } else {
-                t = getNextToken();
+                t = scanToken();
                 goto FIN;
              }
         } else if (st == ST_EOF) {
@@ -808,14 +837,14 @@ static TOKEN t_solidus(bool * is_restart)
         }
         break;
     case '*': { // multi comment line
-        UINT cur_line_num = g_src_line_num;
+        UINT cur_line_num = g_lex_line_num;
         c = getNextChar();
         CHAR c1 = 0;
         for (;;) {
-            cur_line_num = g_src_line_num;
+            cur_line_num = g_lex_line_num;
             c1 = getNextChar();
             if (c == '*' && c1 == '/') {
-                if (g_src_line_num == cur_line_num) {
+                if (g_lex_line_num == cur_line_num) {
                     //We meet the multipul comment terminated token '*/',
                     //so change the parsing state to normal.
                     g_cur_char = getNextChar();
@@ -885,6 +914,16 @@ TOKEN t_dot()
 }
 
 
+//Return file offset of 'g_cur_char'.
+static UINT get_cur_char_ofst()
+{
+    if (g_cur_char == ST_EOF || g_cur_line_pos == 0) {
+        return g_cur_src_ofst;
+    }
+    return g_cur_line_ofst + g_cur_line_pos - 1;
+}
+
+
 CHAR const* getTokenName(TOKEN tok)
 {
     return TOKEN_INFO_name(&g_token_info[tok]);
@@ -1147,8 +1186,9 @@ static TOKEN t_rest(bool * is_restart)
 }
 
 
-//Get current token.
-TOKEN getNextToken()
+//Scan next token from source file.
+//Note the function only updates lexer state.
+static TOKEN scanToken()
 {
     if (g_cur_token == T_END) {
         return g_cur_token;
@@ -1158,6 +1198,7 @@ TOKEN getNextToken()
     g_cur_token_string[0] = 0;
     while (g_cur_char == 0) { g_cur_char = getNextChar(); }
 START:
+    g_cur_token_ofst = get_cur_char_ofst();
     switch (g_cur_char) {
     case ST_EOF:
         token = T_END; //Meet file end.
@@ -1165,7 +1206,7 @@ START:
     case 0xa:
     case 0xd:
         //'\n'
-        if (g_enable_newline_token && g_cur_char == 0xa) {
+        if (g_is_newline_token && g_cur_char == 0xa) {
             token = T_NEWLINE;
             g_cur_token_string[g_cur_token_string_pos++] = g_cur_char;
             g_cur_token_string[g_cur_token_string_pos] = 0;
@@ -1181,11 +1222,11 @@ START:
         break;
     case '\t':
         while ((g_cur_char = getNextChar()) == '\t') { }
-        token = getNextToken();
+        token = scanToken();
         break;
     case ' ':
         while((g_cur_char = getNextChar())==' ') { }
-        token = getNextToken();
+        token = scanToken();
         break;
     case '@':
         token = T_AT;
@@ -1296,6 +1337,94 @@ START:
 }
 
 
+//Get current token.
+TOKEN getNextToken()
+{
+    g_is_newline_token = g_enable_newline_token;
+    TOKEN tok = scanToken();
+    g_src_line_num = g_lex_line_num;
+    g_src_loc = makeSrcLoc(tok == T_END ? g_cur_src_ofst : g_cur_token_ofst);
+    return tok;
+}
+
+
+void reportLexDiag(LexDiag * d)
+{
+    for (LexDiag * p = d; p != nullptr; p = LEXDIAG_next(p)) {
+        errMsg(LEXDIAG_loc(p), LEXDIAG_fmt(p), LEXDIAG_msg(p));
+    }
+    freeLexDiag(d);
+}
+
+
+void freeLexDiag(LexDiag * d)
+{
+    while (d != nullptr) {
+        LexDiag * next = LEXDIAG_next(d);
+        ::free(LEXDIAG_msg(d));
+        ::free(d);
+        d = next;
+    }
+}
+
+
+void Lexer::setDeferDiag(bool defer)
+{
+    g_is_defer_diag = defer;
+}
+
+
+LexDiag * Lexer::popDiag()
+{
+    LexDiag * d = g_defer_diag;
+    g_defer_diag = nullptr;
+    g_defer_diag_last = nullptr;
+    return d;
+}
+
+
+CHAR const* Lexer::getTokenString() const
+{
+    return g_cur_token_string;
+}
+
+
+bool Lexer::next(OUT Token & t)
+{
+    g_is_newline_token = m_is_newline_token;
+    TOKEN tok = scanToken();
+
+    TOKEN_tok(t) = tok;
+    //Keywords, punctuations and newline are spelled as getTokenName()
+    //says, only the string of other tokens is worth interning.
+    TOKEN_sym(t) = m_sym_tab != nullptr && !isFixedSpellToken(tok) ?
+        m_sym_tab->add(g_cur_token_string) : nullptr;
+    if (tok == T_END) {
+        TOKEN_loc(t) = makeSrcLoc(g_cur_src_ofst);
+        TOKEN_len(t) = 0;
+        return false;
+    }
+    UINT end = get_cur_char_ofst();
+    TOKEN_loc(t) = makeSrcLoc(g_cur_token_ofst);
+    TOKEN_len(t) = end > g_cur_token_ofst ? end - g_cur_token_ofst : 0;
+    return true;
+}
+
+
+UINT Lexer::lexAll(OUT TokenArray & ta)
+{
+    UINT n = 0;
+    Token t;
+    for (;;) {
+        bool has_more = next(t);
+        ta.append(t);
+        n++;
+        if (!has_more || TOKEN_tok(t) == T_NUL) { break; }
+    }
+    return n;
+}
+
+
 #ifdef _DEBUG_
 //Only for test.
 void test_lex()
@@ -163,14 +163,10 @@ typedef enum _TOKEN {
 
 #define TOKEN_INFO_name(ti) (ti)->name
 #define TOKEN_INFO_token(ti) (ti)->tok
-#define TOKEN_INFO_lineno(ti) (ti)->u1.lineno
 class TokenInfo {
 public:
     TOKEN tok;
     CHAR const* name;
-    union{
-        INT  lineno;
-    } u1;
 };
 
 
@@ -183,25 +179,150 @@ public:
 };
 
 
+//Token
+//Record a token that fetched from source file.
+#define TOKEN_tok(t) (t).tok
+#define TOKEN_loc(t) (t).loc
+#define TOKEN_len(t) (t).len
+#define TOKEN_sym(t) (t).sym
+class Token {
+public:
+    TOKEN tok;
+    SrcLoc loc; //location of the first character in source file.
+    UINT len; //byte length of token in source file.
+    //The interned string of token. It is nullptr if the token has fixed
+    //spelling, see isFixedSpellToken().
+    Sym const* sym;
+};
+
+
+//TokenArray
+//Record a sequence of tokens in struct-of-arrays layout. The i-th token
+//is described by the i-th element of each array.
+class TokenArray {
+    COPY_CONSTRUCTOR(TokenArray);
+protected:
+    xcom::Vector<BYTE> m_tok;
+    xcom::Vector<SrcLoc> m_loc;
+    xcom::Vector<UINT> m_len;
+    xcom::Vector<Sym const*> m_sym;
+public:
+    TokenArray() {}
+
+    void append(Token const& t)
+    {
+        ASSERT0(TOKEN_tok(t) <= T_END && T_END <= 0xFF);
+        m_tok.append((BYTE)TOKEN_tok(t));
+        m_loc.append(TOKEN_loc(t));
+        m_len.append(TOKEN_len(t));
+        m_sym.append(TOKEN_sym(t));
+    }
+    void clean()
+    {
+        m_tok.clean();
+        m_loc.clean();
+        m_len.clean();
+        m_sym.clean();
+    }
+
+    //Fill 't' with the No.'idx' token.
+    void get(UINT idx, OUT Token & t) const
+    {
+        ASSERT0(idx < get_elem_count());
+        TOKEN_tok(t) = get_tok(idx);
+        TOKEN_loc(t) = get_loc(idx);
+        TOKEN_len(t) = get_len(idx);
+        TOKEN_sym(t) = get_sym(idx);
+    }
+    UINT get_elem_count() const { return m_tok.get_elem_count(); }
+    TOKEN get_tok(UINT idx) const { return (TOKEN)m_tok.get(idx); }
+    SrcLoc get_loc(UINT idx) const { return m_loc.get(idx); }
+    UINT get_len(UINT idx) const { return m_len.get(idx); }
+    Sym const* get_sym(UINT idx) const { return m_sym.get(idx); }
+
+    //Return the buffer of token kinds, which is useful to scan token
+    //kinds quickly.
+    BYTE const* get_tok_vec() const
+    { return const_cast<TokenArray*>(this)->m_tok.get_vec(); }
+};
+
+
+//LexDiag
+//Record lexical diagnostic that is deferred to report.
+#define LEXDIAG_fmt(d) (d)->fmt
+#define LEXDIAG_msg(d) (d)->msg
+#define LEXDIAG_loc(d) (d)->loc
+#define LEXDIAG_next(d) (d)->next
+class LexDiag {
+public:
+    CHAR const* fmt; //the format of message, which determines the ID.
+    CHAR * msg; //formatted message.
+    SrcLoc loc; //location of the token that the diagnostic refers to.
+    LexDiag * next;
+};
+
+
+//Lexer
+//Fetch tokens from the source file that 'g_hsrc' indicated, and the
+//string of identifiers and literals is interned into symbol table.
+//Note lexer state is global, thus there should be only one Lexer
+//working at the same time, and the Lexer should not be mixed with
+//getNextToken().
+class Lexer {
+    COPY_CONSTRUCTOR(Lexer);
+protected:
+    bool m_is_newline_token;
+    SymTab * m_sym_tab;
+public:
+    //symtab: symbol table to intern the string of token. If it is
+    //nullptr, the string is not interned and Token.sym is nullptr, use
+    //getTokenString() to access the string instead.
+    //is_newline_token: true to regard '\n' as token.
+    Lexer(SymTab * symtab, bool is_newline_token = false)
+    {
+        m_sym_tab = symtab;
+        m_is_newline_token = is_newline_token;
+    }
+
+    //Set true to record lexical diagnostics rather than report them,
+    //the recorded diagnostics are fetched by popDiag().
+    void setDeferDiag(bool defer);
+
+    //Fetch next token into 't'.
+    //Return false if there is no more token, and 't' is T_END.
+    //Return true with 't' is T_NUL if there is illegal character.
+    bool next(OUT Token & t);
+
+    //Fetch all tokens until the end of file and append them to 'ta'.
+    //Return the number of appended tokens. The last one is T_END, or
+    //T_NUL if lexer meets illegal character.
+    UINT lexAll(OUT TokenArray & ta);
+
+    //Return the string of the token that fetched by last next().
+    //The string is overwritten by next invocation of next().
+    CHAR const* getTokenString() const;
+
+    //Return the diagnostics that recorded since last invocation, or
+    //nullptr if there is none. The caller should free each LexDiag and
+    //its message by freeLexDiag().
+    LexDiag * popDiag();
+};
+
+
 #define MAX_BUF_LINE 4096
-#define MAX_OFST_BUF_LEN 1024
-#define OFST_TAB_LINE_SIZE (g_ofst_tab_byte_size / sizeof(LONG))
 
 //Exported Variables
 extern UINT g_src_line_num; //line number of src file
+extern SrcLoc g_src_loc; //location of current token in src file
 extern CHAR g_cur_token_string[]; //the string name of current token.
 extern CHAR * g_cur_line; //the current line during parsing of src file.
 extern UINT g_cur_line_len; //the current line buffer length.
 extern TOKEN g_cur_token; //the current token.
-extern LONG * g_ofst_tab; //record the byte offset of each line in src file.
-extern LONG g_ofst_tab_byte_size;//record entry number of offset table.
 extern bool g_enable_newline_token; //set true to regard '\n' as token.
 extern FILE * g_hsrc; //the file handler of source file.
 extern LogMgr * g_logmgr; //the file handler of log file.
 extern INT g_real_line_num;
-//Record the number of disgarded line, that always
-//sparking by preprecossor.
-extern UINT g_disgarded_line_num;
+extern SrcLoc g_real_loc; //location of the token that parser is handling.
 
 //Exported Functions
 //This is the first function you should invoke before start lex scanning.
@@ -210,8 +331,20 @@ void initKeyWordTab();
 //Get current token.
 TOKEN getNextToken();
 
+//Report the lexical diagnostics and free them.
+//The diagnostics are reported at the location of their own tokens.
+void reportLexDiag(LexDiag * d);
+void freeLexDiag(LexDiag * d);
+
 //Get the string name of current token.
 CHAR const* getTokenName(TOKEN tok);
 
+//Return true if the string of 'tok' is always same as getTokenName(),
+//e.g: keywords and punctuations. Identifiers, literals and illegal
+//characters have variable spelling.
+//Note T_NEWLINE is regarded as fixed, its name is the escaped form.
+inline bool isFixedSpellToken(TOKEN tok)
+{ return tok > T_INTRI_VAL; }
+
 TokenInfo const* get_token_info(TOKEN tok);
 #endif
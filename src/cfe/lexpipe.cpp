@@ -0,0 +1,215 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+#include "sched.h"
+
+//Spin a few times before yielding the processor.
+#define SPIN_NUM_BEFORE_YIELD 64
+
+static inline UINT load_acquire(UINT const* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+
+static inline void store_release(UINT * p, UINT v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+
+static inline void wait_a_moment(UINT & spin)
+{
+    if (spin < SPIN_NUM_BEFORE_YIELD) {
+        spin++;
+        return;
+    }
+    sched_yield();
+}
+
+
+//
+//START TokenQueue
+//
+TokenQueue::TokenQueue(UINT depth)
+{
+    ASSERT0(depth > 0);
+    m_depth = getNearestPowerOf2(depth);
+    m_rec = (TokenRecord*)::malloc(sizeof(TokenRecord) * m_depth);
+    ASSERT0(m_rec);
+    ::memset(m_rec, 0, sizeof(TokenRecord) * m_depth);
+    m_head = 0;
+    m_tail = 0;
+    m_is_stop = false;
+    m_stall_num = 0;
+    m_max_depth = 0;
+    m_wait_num = 0;
+}
+
+
+TokenQueue::~TokenQueue()
+{
+    //Free the records that have not been consumed.
+    while (m_head != m_tail) {
+        pop();
+    }
+    ::free(m_rec);
+}
+
+
+TokenRecord * TokenQueue::beginPush()
+{
+    UINT head = load_acquire(&m_head);
+    if (m_tail - head < m_depth) {
+        return &m_rec[m_tail & (m_depth - 1)];
+    }
+    m_stall_num++;
+    UINT spin = 0;
+    do {
+        if (__atomic_load_n(&m_is_stop, __ATOMIC_ACQUIRE)) {
+            return nullptr;
+        }
+        wait_a_moment(spin);
+        head = load_acquire(&m_head);
+    } while (m_tail - head >= m_depth);
+    return &m_rec[m_tail & (m_depth - 1)];
+}
+
+
+void TokenQueue::endPush()
+{
+    UINT tail = m_tail + 1;
+    UINT num = tail - load_acquire(&m_head);
+    m_max_depth = MAX(m_max_depth, num);
+    store_release(&m_tail, tail);
+}
+
+
+TokenRecord * TokenQueue::front()
+{
+    if (load_acquire(&m_tail) == m_head) {
+        m_wait_num++;
+        UINT spin = 0;
+        do {
+            wait_a_moment(spin);
+        } while (load_acquire(&m_tail) == m_head);
+    }
+    return &m_rec[m_head & (m_depth - 1)];
+}
+
+
+void TokenQueue::pop()
+{
+    ASSERT0(m_head != load_acquire(&m_tail));
+    TokenRecord * r = &m_rec[m_head & (m_depth - 1)];
+    if (TOKREC_str(r) != r->buf) {
+        ::free(TOKREC_str(r));
+    }
+    freeLexDiag(TOKREC_diag(r));
+    TOKREC_str(r) = nullptr;
+    TOKREC_diag(r) = nullptr;
+    store_release(&m_head, m_head + 1);
+}
+
+
+void TokenQueue::stop()
+{
+    __atomic_store_n(&m_is_stop, true, __ATOMIC_RELEASE);
+}
+//END TokenQueue
+
+
+//
+//START LexPipe
+//
+LexPipe::LexPipe(UINT depth) : m_queue(depth), m_lexer(nullptr, true)
+{
+    //Newline token is kept since parser requires it to parse '#' line.
+    m_is_started = false;
+}
+
+
+LexPipe::~LexPipe()
+{
+    join();
+}
+
+
+bool LexPipe::start()
+{
+    ASSERT0(!m_is_started);
+    m_lexer.setDeferDiag(true);
+    if (pthread_create(&m_thread, nullptr, run, this) != 0) {
+        m_lexer.setDeferDiag(false);
+        return false;
+    }
+    m_is_started = true;
+    return true;
+}
+
+
+void LexPipe::join()
+{
+    if (!m_is_started) { return; }
+    m_queue.stop();
+    pthread_join(m_thread, nullptr);
+    m_lexer.setDeferDiag(false);
+    m_is_started = false;
+}
+
+
+void * LexPipe::run(void * arg)
+{
+    ((LexPipe*)arg)->produce();
+    return nullptr;
+}
+
+
+void LexPipe::produce()
+{
+    Token t;
+    for (;;) {
+        TokenRecord * r = m_queue.beginPush();
+        if (r == nullptr) { return; }
+        bool has_more = m_lexer.next(t);
+        CHAR const* str = m_lexer.getTokenString();
+        size_t len = ::strlen(str);
+        if (len < TOKREC_INLINE_STR_LEN) {
+            ::memcpy(r->buf, str, len + 1);
+            TOKREC_str(r) = r->buf;
+        } else {
+            TOKREC_str(r) = ::strdup(str);
+        }
+        TOKREC_tok(r) = TOKEN_tok(t);
+        TOKREC_loc(r) = TOKEN_loc(t);
+        TOKREC_diag(r) = m_lexer.popDiag();
+        m_queue.endPush();
+        if (!has_more || TOKEN_tok(t) == T_NUL) { return; }
+    }
+}
+//END LexPipe
@@ -0,0 +1,131 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __LEX_PIPE_H__
+#define __LEX_PIPE_H__
+
+//The default number of records in TokenQueue.
+#define LEX_QUEUE_DEFAULT_DEPTH 4096
+
+//The string shorter than the length is stored in TokenRecord itself.
+#define TOKREC_INLINE_STR_LEN 48
+
+//TokenRecord
+//Record a token that produced by lexer thread.
+#define TOKREC_tok(r) (r)->tok
+#define TOKREC_loc(r) (r)->loc
+#define TOKREC_str(r) (r)->str
+#define TOKREC_diag(r) (r)->diag
+class TokenRecord {
+public:
+    TOKEN tok;
+    SrcLoc loc;
+    CHAR * str; //refers to 'buf', or heap memory if string is long.
+    LexDiag * diag; //deferred lexical diagnostics of the token.
+    CHAR buf[TOKREC_INLINE_STR_LEN];
+};
+
+
+//TokenQueue
+//A bounded lock-free ring of TokenRecord with single producer and single
+//consumer. The producer fills the record returned by beginPush() and
+//publishes it by endPush(), the consumer reads the record returned by
+//front() and releases it by pop().
+class TokenQueue {
+    COPY_CONSTRUCTOR(TokenQueue);
+protected:
+    TokenRecord * m_rec;
+    UINT m_depth;
+
+    //Head and tail are placed in different cache lines to avoid false
+    //sharing between producer and consumer.
+    BYTE m_pad0[64];
+    UINT m_head; //the number of popped records, written by consumer.
+    BYTE m_pad1[64];
+    UINT m_tail; //the number of pushed records, written by producer.
+    BYTE m_pad2[64];
+    bool m_is_stop; //set by consumer to stop the producer.
+
+    //Following counters are written by producer.
+    ULONGLONG m_stall_num; //the number of waiting for full queue.
+    UINT m_max_depth; //the maximum number of records in queue.
+
+    //Following counters are written by consumer.
+    ULONGLONG m_wait_num; //the number of waiting for empty queue.
+public:
+    //depth: the number of records, rounded up to power of 2.
+    explicit TokenQueue(UINT depth);
+    ~TokenQueue();
+
+    //Producer: return the record to be filled. Wait if queue is full.
+    //Return nullptr if the consumer has stopped the queue.
+    TokenRecord * beginPush();
+    //Producer: publish the record that filled.
+    void endPush();
+
+    //Consumer: return the oldest record. Wait if queue is empty.
+    TokenRecord * front();
+    //Consumer: release the oldest record.
+    void pop();
+    //Consumer: let producer give up pushing.
+    void stop();
+
+    UINT getDepth() const { return m_depth; }
+    UINT getMaxDepth() const { return m_max_depth; }
+    ULONGLONG getStallNum() const { return m_stall_num; }
+    ULONGLONG getWaitNum() const { return m_wait_num; }
+};
+
+
+//LexPipe
+//Run lexer on a separate thread, which lexes ahead into TokenQueue while
+//parser consumes tokens from the queue.
+//Note there should be only one LexPipe working at the same time, and
+//parser should not invoke getNextToken() while the pipe is running.
+class LexPipe {
+    COPY_CONSTRUCTOR(LexPipe);
+protected:
+    bool m_is_started;
+    pthread_t m_thread;
+    TokenQueue m_queue;
+    Lexer m_lexer;
+
+    static void * run(void * arg);
+    void produce();
+public:
+    explicit LexPipe(UINT depth = LEX_QUEUE_DEFAULT_DEPTH);
+    ~LexPipe();
+
+    //Start lexer thread, return false if thread can not be created.
+    bool start();
+    //Wait lexer thread to finish. The pipe is stopped if the consumer
+    //did not consume all tokens, e.g: parser terminated by error.
+    void join();
+
+    TokenQueue * getQueue() { return &m_queue; }
+};
+#endif
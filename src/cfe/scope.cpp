@@ -49,6 +49,7 @@ Scope * new_scope()
     Scope * sc = (Scope*)xmalloc(sizeof(Scope));
     sc->init(g_scope_count);
     g_scope_list.append_tail(sc);
+    g_fe_stat.scope_num++;
     return sc;
 }
 
@@ -69,32 +70,122 @@ void dec_indent(UINT ind)
 }
 
 
+static void add_decl_to_index(ScopeSymIndex * idx, Decl * decl)
+{
+    Sym const* sym = get_decl_sym(decl);
+    if (sym == nullptr) { return; }
+    if (idx->sym2decl.get(sym) == nullptr) {
+        idx->sym2decl.set(sym, decl);
+    }
+    if (DECL_is_fun_def(decl) && idx->sym2fundef.get(sym) == nullptr) {
+        idx->sym2fundef.set(sym, decl);
+    }
+}
+
+
+//Build the side index of symbol if the lists of 'sc' grow large.
+static ScopeSymIndex * get_sym_index(Scope * sc)
+{
+    if (sc->sym_index != nullptr) { return sc->sym_index; }
+    if (sc->elem_num < SCOPE_SYM_INDEX_THRESHOLD) { return nullptr; }
+    ScopeSymIndex * idx = new ScopeSymIndex();
+    for (SymList * p = SCOPE_sym_tab_list(sc); p != nullptr;
+         p = SYM_LIST_next(p)) {
+        idx->sym_tab.append(SYM_LIST_sym(p));
+    }
+    for (Decl * d = SCOPE_decl_list(sc); d != nullptr; d = DECL_next(d)) {
+        add_decl_to_index(idx, d);
+    }
+    sc->sym_index = idx;
+    return idx;
+}
+
+
 //Be usually used in scope process.
-//Return nullptr if this function do not find 'sym' in 'sym_list', and
-//'sym' will be appended  into list, otherwise return 'sym'.
-Sym * add_to_symtab_list(SymList ** sym_list , Sym * sym)
+//Return nullptr if this function do not find 'sym' in symbol list of
+//'sc', and 'sym' will be appended into list, otherwise return 'sym'.
+Sym * add_to_symtab_list(Scope * sc, Sym * sym)
 {
-    if (sym_list == nullptr || sym == nullptr) {
+    if (sc == nullptr || sym == nullptr) {
         return nullptr;
     }
-    if ((*sym_list) == nullptr) {
-        *sym_list = (SymList*)xmalloc(sizeof(SymList));
-        SYM_LIST_sym(*sym_list) = sym;
-        return nullptr;
+    ScopeSymIndex * idx = get_sym_index(sc);
+    if (idx != nullptr) {
+        if (idx->sym_tab.find(sym)) {
+            //'sym' already exist, return 'sym' as result
+            return sym;
+        }
+        idx->sym_tab.append(sym);
     } else {
-        SymList * p = *sym_list, * q = nullptr;
-        while (p != nullptr) {
-            q = p;
+        for (SymList * p = SCOPE_sym_tab_list(sc); p != nullptr;
+             p = SYM_LIST_next(p)) {
             if (SYM_LIST_sym(p) == sym) {
                 //'sym' already exist, return 'sym' as result
                 return sym;
             }
-            p = SYM_LIST_next(p);
         }
-        SYM_LIST_next(q) = (SymList*)xmalloc(sizeof(SymList));
-        SYM_LIST_prev(SYM_LIST_next(q)) = q;
-        q = SYM_LIST_next(q);
-        SYM_LIST_sym(q) = sym;
+    }
+    SymList * q = (SymList*)xmalloc(sizeof(SymList));
+    SYM_LIST_sym(q) = sym;
+    xcom::append_tail(&SCOPE_sym_tab_list(sc), &sc->last_sym, q);
+    sc->elem_num++;
+    return nullptr;
+}
+
+
+void add_decl_to_scope(Scope * sc, Decl * decl)
+{
+    ASSERT0(sc && decl);
+    ASSERT0(DECL_next(decl) == nullptr);
+    xcom::append_tail(&SCOPE_decl_list(sc), &sc->last_decl, decl);
+    sc->elem_num++;
+    ScopeSymIndex * idx = get_sym_index(sc);
+    if (idx != nullptr) {
+        //Nothing changed if the index has been built right now.
+        add_decl_to_index(idx, decl);
+    }
+}
+
+
+void set_fun_def_in_scope(Scope * sc, Decl * decl)
+{
+    ASSERT0(sc && decl && DECL_is_fun_def(decl));
+    if (sc->sym_index != nullptr) {
+        add_decl_to_index(sc->sym_index, decl);
+    }
+}
+
+
+void add_user_type_to_scope(Scope * sc, Decl * decl)
+{
+    ASSERT0(sc && decl);
+    UserTypeList * utl = (UserTypeList*)xmalloc(sizeof(UserTypeList));
+    USER_TYPE_LIST_utype(utl) = decl;
+    xcom::append_tail(&SCOPE_user_type_list(sc), &sc->last_utl, utl);
+}
+
+
+Decl * find_decl_in_scope(Scope * sc, Sym const* sym)
+{
+    ASSERT0(sc);
+    if (sym == nullptr) { return nullptr; }
+    ScopeSymIndex * idx = get_sym_index(sc);
+    if (idx != nullptr) { return idx->sym2decl.get(sym); }
+    for (Decl * d = SCOPE_decl_list(sc); d != nullptr; d = DECL_next(d)) {
+        if (get_decl_sym(d) == sym) { return d; }
+    }
+    return nullptr;
+}
+
+
+Decl * find_fun_def_in_scope(Scope * sc, Sym const* sym)
+{
+    ASSERT0(sc);
+    if (sym == nullptr) { return nullptr; }
+    ScopeSymIndex * idx = get_sym_index(sc);
+    if (idx != nullptr) { return idx->sym2fundef.get(sym); }
+    for (Decl * d = SCOPE_decl_list(sc); d != nullptr; d = DECL_next(d)) {
+        if (DECL_is_fun_def(d) && get_decl_sym(d) == sym) { return d; }
     }
     return nullptr;
 }
@@ -112,7 +203,8 @@ Scope * push_scope(bool is_tmp_sc)
 
     //Add 'sc' as sub scope followed the most right one of subscope list.
     //e.g: first_sub_scope -> second_sub_scope -> ...
-    xcom::add_next(&SCOPE_sub(g_cur_scope), sc);
+    xcom::append_tail(&SCOPE_sub(g_cur_scope), &SCOPE_last_sub(g_cur_scope),
+                      sc);
     g_cur_scope = sc;
     return g_cur_scope;
 }
@@ -122,7 +214,8 @@ Scope * pop_scope()
 {
     Scope * parent = SCOPE_parent(g_cur_scope);
     if (SCOPE_is_tmp_sc(g_cur_scope)) {
-        xcom::remove(&SCOPE_sub(parent), g_cur_scope);
+        xcom::remove(&SCOPE_sub(parent), &SCOPE_last_sub(parent),
+                     g_cur_scope);
     }
     g_cur_scope = parent;
     return g_cur_scope;
@@ -146,11 +239,10 @@ Scope * get_global_scope()
 Scope * get_last_sub_scope(Scope * s)
 {
     ASSERT0(s);
-    Scope * sub = SCOPE_sub(s);
-    while (SCOPE_nsibling(sub) != nullptr) {
-        sub = SCOPE_nsibling(sub);
+    if (SCOPE_last_sub(s) == nullptr) {
+        SCOPE_last_sub(s) = xcom::get_last(SCOPE_sub(s));
     }
-    return sub;
+    return SCOPE_last_sub(s);
 }
 
 
@@ -225,7 +317,7 @@ static void dump_enums(Scope * s)
 {
     EnumList * el = SCOPE_enum_list(s);
     if (el != nullptr) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         note(g_logmgr, "\nENUM List:");
         g_logmgr->incIndent(2);
         note(g_logmgr, "\n");
@@ -245,7 +337,7 @@ static void dump_user_defined_type(Scope * s)
 {
     UserTypeList * utl = SCOPE_user_type_list(s);
     if (utl != nullptr) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         note(g_logmgr, "\nUSER Type:");
         g_logmgr->incIndent(2);
         note(g_logmgr, "\n");
@@ -268,7 +360,7 @@ static void dump_structs(Scope * s)
         g_logmgr->incIndent(2);
         note(g_logmgr, "\n");
 
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         xcom::C<Struct*> * ct;
         for (Struct * st = SCOPE_struct_list(s).get_head(&ct);
              st != nullptr; st = SCOPE_struct_list(s).get_next(&ct)) {
@@ -290,7 +382,7 @@ static void dump_unions(Scope * s)
         g_logmgr->incIndent(2);
         note(g_logmgr, "\n");
 
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         xcom::C<Union*> * ct;
         for (Union * st = SCOPE_union_list(s).get_head(&ct);
              st != nullptr; st = SCOPE_union_list(s).get_next(&ct)) {
@@ -310,7 +402,7 @@ static void dump_declarations(Scope * s, UINT flag)
     Decl * dcl = SCOPE_decl_list(s);
     if (dcl == nullptr) { return; }
 
-    StrBuf buf(64);
+    SmallStrBuf<64> buf;
     note(g_logmgr, "\nDECLARATIONS:");
     g_logmgr->incIndent(2);
     while (dcl != nullptr) {
@@ -336,6 +428,9 @@ static void dump_declarations(Scope * s, UINT flag)
             g_logmgr->decIndent(8);
         }
 
+        //Dump compact initial value.
+        dump_init_data(get_decl_init_data(dcl));
+
         g_logmgr->decIndent(2);
         note(g_logmgr, "\n");
         dcl = DECL_next(dcl);
@@ -371,7 +466,7 @@ void dump_scope_list(Scope * s, UINT flag)
 void dump_scope(Scope * s, UINT flag)
 {
     if (g_logmgr == nullptr) { return; }
-    StrBuf buf(64);
+    SmallStrBuf<64> buf;
     note(g_logmgr, "\nSCOPE(id:%d, level:%d)", SCOPE_id(s), SCOPE_level(s));
     g_logmgr->incIndent(2);
     dump_symbols(s);
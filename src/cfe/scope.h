@@ -54,6 +54,27 @@ public:
 // |--SUB_SCOPE
 // |--UserTypeList
 
+//The number of elements in lists of scope, that the side index of symbol
+//will be built once exceeded.
+#define SCOPE_SYM_INDEX_THRESHOLD 32
+
+//ScopeSymIndex
+//Side index of the symbol list and declaration list of Scope, which
+//makes duplicate detection cost O(log n) rather than walking through
+//the lists. It is built lazily when the scope has many elements.
+class ScopeSymIndex {
+    COPY_CONSTRUCTOR(ScopeSymIndex);
+public:
+    //Record the symbols in symbol list.
+    TTab<Sym const*> sym_tab;
+    //Map symbol to the first declaration in declaration list.
+    TMap<Sym const*, Decl*> sym2decl;
+    //Map symbol to the function definition in declaration list.
+    TMap<Sym const*, Decl*> sym2fundef;
+public:
+    ScopeSymIndex() {}
+};
+
 #define MAX_SCOPE_FILED 4
 #define GLOBAL_SCOPE 0 //Global memory space
 #define FUNCTION_SCOPE 1 //Function unit
@@ -74,6 +95,7 @@ public:
 #define SCOPE_struct_list(sc) ((sc)->struct_list)
 #define SCOPE_union_list(sc) ((sc)->union_list)
 #define SCOPE_stmt_list(sc) ((sc)->stmt_list)
+#define SCOPE_last_sub(sc) ((sc)->last_sub)
 class Scope {
 public:
     UINT is_tmp_scope:1;
@@ -93,6 +115,14 @@ public:
     List<Struct*> struct_list; //structure list of current scope
     List<Union*> union_list; //union list of current scope
 
+    //Cache the tail of lists, so that appending costs O(1).
+    Scope * last_sub;
+    Decl * last_decl;
+    SymList * last_sym;
+    UserTypeList * last_utl;
+    UINT elem_num; //the number of elements in symbol and declaration list
+    ScopeSymIndex * sym_index; //nullptr until the lists grow large
+
 public:
     void init(UINT & sc)
     {
@@ -106,6 +136,12 @@ public:
         SCOPE_parent(this) = nullptr;
         SCOPE_nsibling(this) = nullptr;
         SCOPE_sub(this)  = nullptr;
+        last_sub = nullptr;
+        last_decl = nullptr;
+        last_sym = nullptr;
+        last_utl = nullptr;
+        elem_num = 0;
+        sym_index = nullptr;
     }
 
     void destroy()
@@ -114,6 +150,10 @@ public:
         lref_list.destroy();
         struct_list.destroy();
         union_list.destroy();
+        if (sym_index != nullptr) {
+            delete sym_index;
+            sym_index = nullptr;
+        }
     }
 };
 
@@ -159,6 +199,17 @@ extern Scope * g_cur_scope;
 extern LabelTab g_labtab;
 
 //Export Functions
-Sym * add_to_symtab_list(SymList ** sym_list , Sym * sym);
+Sym * add_to_symtab_list(Scope * sc, Sym * sym);
+//Append 'decl' to the declaration list of 'sc'.
+void add_decl_to_scope(Scope * sc, Decl * decl);
+//Record that 'decl' in declaration list of 'sc' has been defined as
+//function.
+void set_fun_def_in_scope(Scope * sc, Decl * decl);
+//Append 'decl' to the user-defined type list of 'sc'.
+void add_user_type_to_scope(Scope * sc, Decl * decl);
+//Return the first declaration of 'sym' in declaration list of 'sc'.
+Decl * find_decl_in_scope(Scope * sc, Sym const* sym);
+//Return the function definition of 'sym' in declaration list of 'sc'.
+Decl * find_fun_def_in_scope(Scope * sc, Sym const* sym);
 #endif
 
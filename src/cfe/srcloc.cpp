@@ -0,0 +1,330 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "cfeinc.h"
+
+//Line table, the i-th entry records the start offset of line i+1.
+static UINT * g_line_chunk[SRC_LINE_CHUNK_NUM] = { nullptr };
+
+//The number of recorded lines. It is published with release semantics
+//after the entry is written, so that the reader in other thread observes
+//the entries before it.
+static UINT g_line_count = 0;
+
+//The 0-based index of last decoded line, which speeds up decoding of
+//adjacent locations.
+static UINT g_last_line = 0;
+
+//Record the lines generated by preprocessor in ascending order.
+static xcom::Vector<UINT> g_discarded_line;
+
+static CHAR const* g_src_file_name = nullptr;
+
+//The source file that is opened by parser thread to rescan token, which
+//is independent of the file handle of lexer.
+static FILE * g_src_file = nullptr;
+
+//The maximum length of token that is able to be rescanned.
+#define SRC_TOKEN_MAX_LEN 256
+
+//Return the chunk that line 'idx' resides in, and the index of the first
+//line of the chunk.
+static inline UINT get_line_chunk(UINT idx, OUT UINT & first)
+{
+    //Chunk i starts at SRC_LINE_CHUNK_SIZE * (2^i - 1).
+    UINT q = idx / SRC_LINE_CHUNK_SIZE + 1;
+    UINT ci = 31 - (UINT)__builtin_clz(q);
+    ASSERT0(ci < SRC_LINE_CHUNK_NUM);
+    first = SRC_LINE_CHUNK_SIZE * ((1u << ci) - 1);
+    return ci;
+}
+
+
+static inline UINT * get_line_slot(UINT idx)
+{
+    UINT first;
+    UINT * chunk = g_line_chunk[get_line_chunk(idx, first)];
+    ASSERT0(chunk);
+    return &chunk[idx - first];
+}
+
+
+static inline UINT get_line_start(UINT idx)
+{
+    return __atomic_load_n(get_line_slot(idx), __ATOMIC_RELAXED);
+}
+
+
+void initSrcMgr()
+{
+    finiSrcMgr();
+    setSrcLineStart(1, 0);
+}
+
+
+void finiSrcMgr()
+{
+    for (UINT i = 0; i < SRC_LINE_CHUNK_NUM; i++) {
+        if (g_line_chunk[i] == nullptr) { break; }
+        ::free(g_line_chunk[i]);
+        g_line_chunk[i] = nullptr;
+    }
+    g_line_count = 0;
+    g_last_line = 0;
+    g_discarded_line.clean();
+    g_src_file_name = nullptr;
+    if (g_src_file != nullptr) {
+        fclose(g_src_file);
+        g_src_file = nullptr;
+    }
+}
+
+
+void setSrcFileName(CHAR const* file)
+{
+    g_src_file_name = file;
+}
+
+
+void setSrcLineStart(UINT lineno, UINT ofst)
+{
+    ASSERT0(lineno > 0);
+    UINT idx = lineno - 1;
+    //Writer is the only one that modifies the count.
+    UINT count = g_line_count;
+    if (idx < count) {
+        ASSERTN(idx + 1 == count, ("only last line can be overwritten"));
+        __atomic_store_n(get_line_slot(idx), ofst, __ATOMIC_RELAXED);
+        return;
+    }
+    //Lines that have not been recorded start at 'ofst' as well.
+    for (; count <= idx; count++) {
+        UINT first;
+        UINT ci = get_line_chunk(count, first);
+        if (g_line_chunk[ci] == nullptr) {
+            g_line_chunk[ci] = (UINT*)::malloc(sizeof(UINT) *
+                                               (SRC_LINE_CHUNK_SIZE << ci));
+            ASSERTN(g_line_chunk[ci], ("out of memory"));
+        }
+        __atomic_store_n(get_line_slot(count), ofst, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_line_count, count + 1, __ATOMIC_RELEASE);
+    }
+}
+
+
+void addSrcDiscardedLine(UINT lineno)
+{
+    INT last = g_discarded_line.get_last_idx();
+    ASSERT0(last < 0 || g_discarded_line.get(last) <= lineno);
+    if (last >= 0 && g_discarded_line.get(last) == lineno) { return; }
+    g_discarded_line.append(lineno);
+}
+
+
+//Return the 0-based index of the line that 'ofst' resides in.
+static UINT find_line(UINT ofst)
+{
+    UINT count = __atomic_load_n(&g_line_count, __ATOMIC_ACQUIRE);
+    ASSERT0(count > 0);
+    //Try the last decoded line and its next line at first.
+    UINT l = g_last_line;
+    if (l < count && get_line_start(l) <= ofst) {
+        if (l + 1 >= count || ofst < get_line_start(l + 1)) { return l; }
+        if (l + 2 >= count || ofst < get_line_start(l + 2)) {
+            g_last_line = l + 1;
+            return l + 1;
+        }
+    }
+    //Find the last line that starts before or at 'ofst'.
+    UINT lo = 0;
+    UINT hi = count - 1;
+    while (lo < hi) {
+        UINT mid = lo + (hi - lo + 1) / 2;
+        if (get_line_start(mid) <= ofst) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    g_last_line = lo;
+    return lo;
+}
+
+
+UINT getSrcLineNum(SrcLoc loc)
+{
+    if (loc == SRCLOC_UNDEF) { return 0; }
+    return find_line(getSrcLocOfst(loc)) + 1;
+}
+
+
+UINT getSrcRealLineNum(SrcLoc loc)
+{
+    if (loc == SRCLOC_UNDEF) { return 0; }
+    return mapSrcLineToRealLine(getSrcLineNum(loc));
+}
+
+
+UINT getSrcColNum(SrcLoc loc)
+{
+    if (loc == SRCLOC_UNDEF) { return 0; }
+    UINT ofst = getSrcLocOfst(loc);
+    return ofst - get_line_start(find_line(ofst)) + 1;
+}
+
+
+void decodeSrcLoc(SrcLoc loc, OUT SrcLocInfo & info)
+{
+    SRCLOC_INFO_file(info) = g_src_file_name;
+    if (loc == SRCLOC_UNDEF) {
+        SRCLOC_INFO_line(info) = 0;
+        SRCLOC_INFO_real_line(info) = 0;
+        SRCLOC_INFO_col(info) = 0;
+        return;
+    }
+    UINT ofst = getSrcLocOfst(loc);
+    UINT l = find_line(ofst);
+    SRCLOC_INFO_line(info) = l + 1;
+    SRCLOC_INFO_real_line(info) = mapSrcLineToRealLine(l + 1);
+    SRCLOC_INFO_col(info) = ofst - get_line_start(l) + 1;
+}
+
+
+static bool is_src_id_char(CHAR c)
+{
+    return xisalpha(c) || xisdigit(c) || c == '_';
+}
+
+
+//Return the length of punctuator at the start of 's'.
+static UINT get_punct_len(CHAR const* s, UINT len)
+{
+    static CHAR const* const punct[] = {
+        "<<=", ">>=", "...", "->", "++", "--", "<<", ">>", "<=", ">=",
+        "==", "!=", "&&", "||", "*=", "/=", "%=", "+=", "-=", "&=",
+        "^=", "|=", "##",
+    };
+    for (UINT i = 0; i < sizeof(punct) / sizeof(punct[0]); i++) {
+        UINT l = (UINT)::strlen(punct[i]);
+        if (l <= len && ::strncmp(s, punct[i], l) == 0) { return l; }
+    }
+    return 1;
+}
+
+
+//Return the length of token at the start of 's'.
+static UINT get_token_len(CHAR const* s, UINT len)
+{
+    if (len == 0 || s[0] == '\n' || s[0] == '\r' || xisspace(s[0])) {
+        return 0;
+    }
+    UINT i = 0;
+    if (xisdigit(s[0]) || (s[0] == '.' && len > 1 && xisdigit(s[1]))) {
+        //Preprocessing number, e.g: 1.5e+3f
+        for (i = 1; i < len; i++) {
+            CHAR c = s[i];
+            if ((c == '+' || c == '-') && (s[i - 1] == 'e' ||
+                s[i - 1] == 'E' || s[i - 1] == 'p' || s[i - 1] == 'P')) {
+                continue;
+            }
+            if (!is_src_id_char(c) && c != '.') { break; }
+        }
+        return i;
+    }
+    if (is_src_id_char(s[0])) {
+        for (i = 1; i < len && is_src_id_char(s[i]); i++) {}
+        if (i != 1 || s[0] != 'L' || i >= len ||
+            (s[i] != '"' && s[i] != '\'')) {
+            return i;
+        }
+        //Wide character or string literal.
+    }
+    if (s[i] != '"' && s[i] != '\'') { return get_punct_len(s, len); }
+    CHAR quote = s[i];
+    for (i++; i < len && s[i] != quote && s[i] != '\n'; i++) {
+        if (s[i] == '\\' && i + 1 < len) { i++; }
+    }
+    return i < len && s[i] == quote ? i + 1 : i;
+}
+
+
+UINT getSrcTokenLen(SrcLoc loc)
+{
+    if (loc == SRCLOC_UNDEF || g_src_file_name == nullptr) { return 0; }
+    if (g_src_file == nullptr) {
+        g_src_file = fopen(g_src_file_name, "rb");
+        if (g_src_file == nullptr) { return 0; }
+    }
+    CHAR buf[SRC_TOKEN_MAX_LEN];
+    if (fseek(g_src_file, (long)getSrcLocOfst(loc), SEEK_SET) != 0) {
+        return 0;
+    }
+    UINT len = (UINT)fread(buf, 1, sizeof(buf), g_src_file);
+    return get_token_len(buf, len);
+}
+
+
+UINT mapSrcLineToRealLine(UINT srcline)
+{
+    UINT num = (UINT)g_discarded_line.get_elem_count();
+    if (num == 0 || g_discarded_line.get(0) >= srcline) { return srcline; }
+    //Count the discarded lines before 'srcline'.
+    UINT lo = 0;
+    UINT hi = num;
+    while (lo < hi) {
+        UINT mid = lo + (hi - lo) / 2;
+        if (g_discarded_line.get(mid) < srcline) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    ASSERT0(srcline > lo);
+    return srcline - lo;
+}
+
+
+UINT mapRealLineToSrcLine(UINT realline)
+{
+    //The i-th discarded line d(i) is skipped if d(i) <= realline + i, that
+    //is d(i) - i <= realline. Since the discarded lines are ascending and
+    //distinct, d(i) - i is ascending, thus count the skipped lines by
+    //binary search.
+    //The line next to discarded line has same real line number as
+    //discarded line, choose the former.
+    UINT lo = 0;
+    UINT hi = (UINT)g_discarded_line.get_elem_count();
+    while (lo < hi) {
+        UINT mid = lo + (hi - lo) / 2;
+        if (g_discarded_line.get(mid) - mid <= realline) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return realline + lo;
+}
@@ -0,0 +1,101 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __SRC_LOC_H__
+#define __SRC_LOC_H__
+
+//SrcLoc
+//A packed 32-bit source location, that is 1 plus the byte offset of the
+//character in source file, thus 0 indicates unknown location. The line
+//and column are decoded lazily by binary search over the table of line
+//start offsets, which is recorded by lexer.
+//Note lexer thread is the only writer of line table, and the decoding
+//must be performed by parser thread, see LexPipe.
+typedef UINT SrcLoc;
+#define SRCLOC_UNDEF 0
+
+//The number of line start offsets in the first chunk of line table.
+//The chunk i has SRC_LINE_CHUNK_SIZE << i entries, thus the table grows
+//geometrically while the recorded line starts never move.
+#define SRC_LINE_CHUNK_SIZE 4096
+
+//The number of chunks of line table, which is enough to record every
+//line that a 32-bit offset is able to address, so the chunk directory is
+//never reallocated.
+#define SRC_LINE_CHUNK_NUM 21
+
+//Record the decoded information of SrcLoc.
+#define SRCLOC_INFO_file(i) (i).file
+#define SRCLOC_INFO_line(i) (i).line
+#define SRCLOC_INFO_real_line(i) (i).real_line
+#define SRCLOC_INFO_col(i) (i).col
+class SrcLocInfo {
+public:
+    CHAR const* file; //the name of source file.
+    UINT line; //1-based line number in source file.
+    //1-based line number that excludes the lines generated by
+    //preprocessor, e.g: # 1 "a.c"
+    UINT real_line;
+    UINT col; //1-based byte column.
+};
+
+inline SrcLoc makeSrcLoc(UINT ofst) { return ofst + 1; }
+inline UINT getSrcLocOfst(SrcLoc loc)
+{
+    ASSERT0(loc != SRCLOC_UNDEF);
+    return loc - 1;
+}
+
+//Exported Functions
+void initSrcMgr();
+void finiSrcMgr();
+//Set the name of source file.
+void setSrcFileName(CHAR const* file);
+//Record the byte offset that line 'lineno' starts at.
+//Line must be recorded in ascending order, whereas the last line may be
+//overwritten.
+void setSrcLineStart(UINT lineno, UINT ofst);
+//Record the line generated by preprocessor, which is not counted by real
+//line number. Line must be recorded in ascending order.
+void addSrcDiscardedLine(UINT lineno);
+//Return 1-based line number of 'loc', or 0 if 'loc' is unknown.
+UINT getSrcLineNum(SrcLoc loc);
+//Return 1-based line number of 'loc' that excludes the lines generated by
+//preprocessor, or 0 if 'loc' is unknown.
+UINT getSrcRealLineNum(SrcLoc loc);
+//Return 1-based byte column of 'loc', or 0 if 'loc' is unknown.
+UINT getSrcColNum(SrcLoc loc);
+void decodeSrcLoc(SrcLoc loc, OUT SrcLocInfo & info);
+//Return the byte length of the token that starts at 'loc', or 0 if it is
+//unknown. The token is rescanned from source file, thus the function is
+//intended for diagnostics only.
+UINT getSrcTokenLen(SrcLoc loc);
+//Map line number in source file to the real line number.
+UINT mapSrcLineToRealLine(UINT srcline);
+//Map real line number to the line number in source file.
+UINT mapRealLineToSrcLine(UINT realline);
+#endif
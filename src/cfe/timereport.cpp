@@ -0,0 +1,163 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef _ON_WINDOWS_
+#include <sys/resource.h>
+#endif
+
+#include "cfeinc.h"
+
+FEStat g_fe_stat;
+
+static CHAR const* g_fe_phase_name[] = {
+    "lex",
+    "parse",
+    "type_tran",
+    "fold",
+    "type_check",
+    "decl_init",
+    "dump",
+};
+
+
+ULONGLONG getPeakRSS()
+{
+#ifdef _ON_WINDOWS_
+    return 0;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) { return 0; }
+    #ifdef __APPLE__
+    return (ULONGLONG)ru.ru_maxrss; //in bytes
+    #else
+    return (ULONGLONG)ru.ru_maxrss * 1024; //in kilobytes
+    #endif
+#endif
+}
+
+
+//Return the time of 'phase' that excluded the time of nested phase.
+static ULONGLONG get_self_usec(ULONGLONG const* usec, UINT phase)
+{
+    if (phase != FE_PHASE_PARSE) { return usec[phase]; }
+    //Prelexing is performed inside the parse phase.
+    return usec[FE_PHASE_PARSE] > usec[FE_PHASE_LEX] ?
+           usec[FE_PHASE_PARSE] - usec[FE_PHASE_LEX] : 0;
+}
+
+
+static void dump_text_report(FILE * out, CHAR const* srcfile)
+{
+    ULONGLONG total_wall = 0;
+    ULONGLONG total_cpu = 0;
+    fprintf(out, "\n==---- TIME REPORT: %s ----==", srcfile);
+    fprintf(out, "\n  %-12s %12s %12s", "PHASE", "WALL(sec)", "CPU(sec)");
+    for (UINT i = 0; i < FE_PHASE_NUM; i++) {
+        ULONGLONG w = get_self_usec(g_fe_stat.wall_usec, i);
+        ULONGLONG c = get_self_usec(g_fe_stat.cpu_usec, i);
+        total_wall += w;
+        total_cpu += c;
+        fprintf(out, "\n  %-12s %12.6f %12.6f", g_fe_phase_name[i],
+                w / 1000000.0, c / 1000000.0);
+    }
+    fprintf(out, "\n  %-12s %12.6f %12.6f", "total",
+            total_wall / 1000000.0, total_cpu / 1000000.0);
+    fprintf(out, "\n  COUNTER");
+    fprintf(out, "\n  %-24s %12llu", "tokens", g_fe_stat.token_num);
+    fprintf(out, "\n  %-24s %12llu", "lookahead_pushbacks",
+            g_fe_stat.lookahead_num);
+    fprintf(out, "\n  %-24s %12u", "symbols",
+            g_fe_sym_tab != nullptr ? g_fe_sym_tab->get_elem_count() : 0);
+    fprintf(out, "\n  %-24s %12llu", "decls", g_fe_stat.decl_num);
+    fprintf(out, "\n  %-24s %12llu", "trees", g_fe_stat.tree_num);
+    fprintf(out, "\n  %-24s %12llu", "scopes", g_fe_stat.scope_num);
+    if (g_fe_stat.lex_queue_depth != 0) {
+        fprintf(out, "\n  %-24s %12u", "lex_queue_depth",
+                g_fe_stat.lex_queue_depth);
+        fprintf(out, "\n  %-24s %12u", "lex_queue_peak",
+                g_fe_stat.lex_queue_peak);
+        fprintf(out, "\n  %-24s %12llu", "lex_queue_stalls",
+                g_fe_stat.lex_queue_stall_num);
+        fprintf(out, "\n  %-24s %12llu", "lex_queue_waits",
+                g_fe_stat.lex_queue_wait_num);
+    }
+    fprintf(out, "\n  %-24s %12lu", "pool_general_bytes",
+            (ULONG)smpoolGetPoolSize(g_pool_general_used));
+    fprintf(out, "\n  %-24s %12lu", "pool_tree_bytes",
+            (ULONG)smpoolGetPoolSize(g_pool_tree_used));
+    fprintf(out, "\n  %-24s %12lu", "pool_st_bytes",
+            (ULONG)smpoolGetPoolSize(g_pool_st_used));
+    fprintf(out, "\n  %-24s %12llu", "peak_rss_bytes", getPeakRSS());
+    fprintf(out, "\n");
+}
+
+
+static void dump_json_report(FILE * out, CHAR const* srcfile)
+{
+    //The file name is user input, only quote and backslash are escaped.
+    fprintf(out, "{\"file\":\"");
+    for (CHAR const* p = srcfile; *p != 0; p++) {
+        if (*p == '"' || *p == '\\') { fputc('\\', out); }
+        fputc(*p, out);
+    }
+    fprintf(out, "\",\"phases\":{");
+    for (UINT i = 0; i < FE_PHASE_NUM; i++) {
+        fprintf(out, "%s\"%s\":{\"wall_usec\":%llu,\"cpu_usec\":%llu}",
+                i == 0 ? "" : ",", g_fe_phase_name[i],
+                get_self_usec(g_fe_stat.wall_usec, i),
+                get_self_usec(g_fe_stat.cpu_usec, i));
+    }
+    fprintf(out, "},\"counters\":{\"tokens\":%llu,"
+            "\"lookahead_pushbacks\":%llu,\"symbols\":%u,\"decls\":%llu,"
+            "\"trees\":%llu,\"scopes\":%llu,\"lex_queue_depth\":%u,"
+            "\"lex_queue_peak\":%u,\"lex_queue_stalls\":%llu,"
+            "\"lex_queue_waits\":%llu},",
+            g_fe_stat.token_num, g_fe_stat.lookahead_num,
+            g_fe_sym_tab != nullptr ? g_fe_sym_tab->get_elem_count() : 0,
+            g_fe_stat.decl_num, g_fe_stat.tree_num, g_fe_stat.scope_num,
+            g_fe_stat.lex_queue_depth, g_fe_stat.lex_queue_peak,
+            g_fe_stat.lex_queue_stall_num, g_fe_stat.lex_queue_wait_num);
+    fprintf(out, "\"pools\":{\"general\":%lu,\"tree\":%lu,\"st\":%lu},",
+            (ULONG)smpoolGetPoolSize(g_pool_general_used),
+            (ULONG)smpoolGetPoolSize(g_pool_tree_used),
+            (ULONG)smpoolGetPoolSize(g_pool_st_used));
+    fprintf(out, "\"peak_rss_bytes\":%llu}\n", getPeakRSS());
+}
+
+
+void dumpTimeReport(FILE * out, bool is_json, CHAR const* srcfile)
+{
+    ASSERT0(out);
+    ASSERT0(sizeof(g_fe_phase_name) / sizeof(g_fe_phase_name[0]) ==
+            FE_PHASE_NUM);
+    if (srcfile == nullptr) { srcfile = ""; }
+    if (is_json) {
+        dump_json_report(out, srcfile);
+        return;
+    }
+    dump_text_report(out, srcfile);
+}
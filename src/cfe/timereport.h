@@ -0,0 +1,98 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __TIME_REPORT_H__
+#define __TIME_REPORT_H__
+
+//Record the time and counters of each phase of front end.
+//Timing is only performed if g_fe_stat.is_enable is true, whereas the
+//cheap counters are always maintained.
+
+typedef enum _FE_PHASE {
+    //Lexing is measured only if it is a separate phase, that is -prelex.
+    //Otherwise tokens are lexed on demand and the time is a part of
+    //FE_PHASE_PARSE.
+    FE_PHASE_LEX = 0,
+    FE_PHASE_PARSE,
+    FE_PHASE_TYPE_TRAN,
+    FE_PHASE_FOLD,
+    FE_PHASE_TYPE_CHECK,
+    FE_PHASE_DECL_INIT,
+    FE_PHASE_DUMP,
+    FE_PHASE_NUM,
+} FE_PHASE;
+
+class FEStat {
+public:
+    bool is_enable;
+    ULONGLONG wall_usec[FE_PHASE_NUM];
+    ULONGLONG cpu_usec[FE_PHASE_NUM];
+    ULONGLONG token_num; //the number of tokens that fetched from lexer.
+    ULONGLONG lookahead_num; //the number of tokens pushed back to buffer.
+    ULONGLONG decl_num; //the number of allocated Decl.
+    ULONGLONG tree_num; //the number of allocated Tree.
+    ULONGLONG scope_num; //the number of allocated Scope.
+    //Following counters are only available if lexer runs on another
+    //thread, that is lex_queue_depth is not 0.
+    UINT lex_queue_depth; //the capacity of token queue.
+    UINT lex_queue_peak; //the maximum number of tokens in queue.
+    ULONGLONG lex_queue_stall_num; //the number of lexer waiting full queue.
+    ULONGLONG lex_queue_wait_num; //the number of parser waiting empty queue.
+};
+
+//Phase timer, which is similar to START_TIMER/END_TIMER in opt/timer.h,
+//but accumulates the time into g_fe_stat rather than printing it.
+//Wall time is read by getMicroSec(), CPU time by getclockstart().
+//Usage:
+//    ULONGLONG w;
+//    LONG c;
+//    START_FE_PHASE(w, c);
+//    Parser();
+//    END_FE_PHASE(w, c, FE_PHASE_PARSE);
+#define START_FE_PHASE(_wall_, _cpu_) \
+    _wall_ = 0; _cpu_ = 0; \
+    if (g_fe_stat.is_enable) { \
+        _wall_ = getMicroSec(); \
+        _cpu_ = getclockstart(); \
+    }
+#define END_FE_PHASE(_wall_, _cpu_, _phase_) \
+    if (g_fe_stat.is_enable) { \
+        g_fe_stat.wall_usec[_phase_] += getMicroSec() - (_wall_); \
+        g_fe_stat.cpu_usec[_phase_] += \
+            (ULONGLONG)(getclockend(_cpu_) * 1000000.0); \
+    }
+
+//Exported Variables
+extern FEStat g_fe_stat;
+
+//Exported Functions
+//Return the peak resident set size in bytes, or 0 if it is unknown.
+ULONGLONG getPeakRSS();
+//Print report to 'out'.
+//is_json: print report as one JSON object, otherwise print a table.
+void dumpTimeReport(FILE * out, bool is_json, CHAR const* srcfile);
+#endif
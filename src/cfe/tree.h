@@ -129,7 +129,9 @@ public:
 #define MAX_TREE_FLDS 4
 #define TREE_uid(tn) ((tn)->id)
 #define TREE_token(tn) ((tn)->tok)
-#define TREE_lineno(tn) ((tn)->lineno)
+#define TREE_loc(tn) ((tn)->loc)
+//Line number is decoded from location lazily.
+#define TREE_lineno(tn) ((INT)getSrcRealLineNum(TREE_loc(tn)))
 #define TREE_type(tn) ((tn)->tree_node_type)
 #define TREE_result_type(tn) ((tn)->result_type_name)
 #define TREE_fld(tn,N) ((tn)->fld[N]) //access no.N child of tree
@@ -240,7 +242,7 @@ public:
     Tree * parent;
     Tree * next;
     Tree * prev;
-    INT lineno; ///line number in src file
+    SrcLoc loc; ///location in src file
     TOKEN tok; //record the token that tree-node related.
 
     union {
@@ -276,7 +278,7 @@ public:
 
 
 //Exported Functions
-extern Tree * allocTreeNode(TREE_TYPE tnt, INT lineno);
+extern Tree * allocTreeNode(TREE_TYPE tnt, SrcLoc loc);
 extern void dump_tree(Tree const* t);
 extern void dump_trees(Tree const* t);
 extern INT is_indirect_tree_node(Tree const* t);
@@ -28,7 +28,7 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "cfeinc.h"
 #include "cfecommacro.h"
 
-#define NEWTN(tok)  allocTreeNode((tok), g_real_line_num)
+#define NEWTN(tok)  allocTreeNode((tok), g_real_loc)
 
 static Tree * statement();
 static bool is_c_type_spec(TOKEN tok);
@@ -46,9 +46,28 @@ SymTab * g_fe_sym_tab = nullptr;
 bool g_dump_token = false;
 CHAR * g_real_token_string = nullptr;
 TOKEN g_real_token = T_NUL;
+//Record the tokens that have been pried by lookahead, each element is
+//LookaheadTok.
 static List<Cell*> g_cell_list;
+//Record the tokens if source file has been lexed before parsing.
+static TokenArray const* g_tok_array = nullptr;
+static UINT g_tok_array_pos = 0;
+//Record the queue if source file is being lexed by another thread.
+static TokenQueue * g_tok_queue = nullptr;
+static bool g_tok_queue_has_front = false;
 bool g_enable_C99_declaration = true;
-xcom::Vector<UINT> g_realline2srcline;
+
+//LookaheadTok
+//Record the token that has been fetched but not yet parsed.
+#define LATOK_name(t) (t)->name
+#define LATOK_tok(t) (t)->tok
+#define LATOK_loc(t) (t)->loc
+class LookaheadTok {
+public:
+    TOKEN tok;
+    CHAR const* name;
+    SrcLoc loc;
+};
 
 static void * xmalloc(size_t size)
 {
@@ -76,7 +95,7 @@ Tree * buildIndmem(Tree * base, Decl const* fld)
 //fldvec: record a list of indices in aggregate.
 //  e.g: struct T { unsigned int b, c; struct Q {int m,n;} char e; };
 //  The accessing to m's fldvec is <2, 0>, whereas e's fldvec is <3>.
-Tree * buildAggrFieldRef(Decl const* decl, xcom::Vector<UINT> & fldvec)
+Tree * buildAggrFieldRef(Decl const* decl, IdxVec & fldvec)
 {
     ASSERT0(is_struct(decl) || is_union(decl));
     ASSERTN(fldvec.get_last_idx() >= 0, ("miss field index"));
@@ -204,7 +223,7 @@ Tree * buildAssign(Tree * lhs, Tree * rhs)
 }
 
 
-Tree * buildArray(Tree * base, xcom::Vector<UINT> & subexp_vec)
+Tree * buildArray(Tree * base, IdxVec & subexp_vec)
 {
     ASSERTN(subexp_vec.get_last_idx() >= 0, ("miss dimension exp"));
     for (INT i = 0; i <= subexp_vec.get_last_idx(); i++) {
@@ -222,47 +241,92 @@ Tree * buildArray(Tree * base, xcom::Vector<UINT> & subexp_vec)
 //Build array tree node.
 //subexp_vec: record a list of subscript expressions.
 //            e.g: arr[3][5], subexp_vec is <3, 5>.
-Tree * buildArray(Decl const* decl, xcom::Vector<UINT> & subexp_vec)
+Tree * buildArray(Decl const* decl, IdxVec & subexp_vec)
 {
     ASSERTN(subexp_vec.get_last_idx() >= 0, ("miss dimension exp"));
     return buildArray(buildId(decl), subexp_vec);
 }
 
 
+//The data attached to the walking frame of copyTree.
+class CopyTreeData {
+public:
+    Tree * newt; //the duplication of current tree node.
+    Tree * last; //the last duplicated kid of the field being copied.
+};
+typedef TreeWalkFrame<CopyTreeData> CopyTreeFrame;
+
+//CopyTreeVisitor
+//Duplicate node in visitPre, then append the duplication to the field of
+//parent's duplication in visitPost.
+class CopyTreeVisitor {
+    COPY_CONSTRUCTOR(CopyTreeVisitor);
+    Tree * m_new_list;
+    Tree * m_last;
+public:
+    CopyTreeVisitor() : m_new_list(nullptr), m_last(nullptr) {}
+
+    Tree * getNewList() const { return m_new_list; }
+
+    WALK_ACT visitPre(CopyTreeFrame & f)
+    {
+        Tree * newt = NEWTN(TREE_type(f.tree));
+        UINT id = TREE_uid(newt);
+        ::memcpy(newt, f.tree, sizeof(Tree));
+        TREE_uid(newt) = id;
+        TREE_parent(newt) = nullptr;
+        TREE_psib(newt) = nullptr;
+        TREE_nsib(newt) = nullptr;
+        for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
+            TREE_fld(newt, i) = nullptr;
+        }
+        f.data.newt = newt;
+        f.data.last = nullptr;
+        return WALK_CONT;
+    }
+
+    bool getKid(CopyTreeFrame & f, OUT CopyTreeFrame & kid)
+    {
+        f.data.last = nullptr;
+        Tree * t = f.tree;
+        return fetchKid(f.kid_idx, kid, MAX_TREE_FLDS, TREE_fld(t, 0),
+                        TREE_fld(t, 1), TREE_fld(t, 2), TREE_fld(t, 3));
+    }
+
+    WALK_ACT visitPost(CopyTreeFrame & f, CopyTreeFrame * parent)
+    {
+        Tree * newt = f.data.newt;
+        if (parent == nullptr) {
+            xcom::add_next(&m_new_list, &m_last, newt);
+            return WALK_CONT;
+        }
+        Tree * newparent = parent->data.newt;
+        ASSERT0(parent->kid_idx > 0 && parent->kid_idx <= MAX_TREE_FLDS);
+        xcom::add_next(&TREE_fld(newparent, parent->kid_idx - 1),
+                       &parent->data.last, newt);
+        TREE_parent(newt) = newparent;
+        return WALK_CONT;
+    }
+};
+
+
+//Duplicate 't' and its kids, as well as the siblings of 't'.
 Tree * copyTreeList(Tree const* t)
 {
-    Tree * new_list = nullptr;
-    while (t != nullptr) {
-        Tree * newt = copyTree(t);
-        xcom::add_next(&new_list, newt);
-        t = TREE_nsib(t);
-    }
-    return new_list;
+    CopyTreeVisitor visitor;
+    TreeWalker<CopyTreeVisitor, CopyTreeData> walker(visitor);
+    walker.walk(const_cast<Tree*>(t), true);
+    return visitor.getNewList();
 }
 
 
 //Duplicate 't' and its kids, but without ir's sibiling node.
 Tree * copyTree(Tree const* t)
 {
-    if (t == nullptr) { return nullptr; }    
-    Tree * newt = NEWTN(TREE_type(t));    
-    UINT id = TREE_uid(newt);
-    ::memcpy(newt, t, sizeof(Tree));
-    TREE_uid(newt) = id;
-    TREE_parent(newt) = nullptr;
-    TREE_psib(newt) = nullptr;
-    TREE_nsib(newt) = nullptr;
-    for (UINT i = 0; i < MAX_TREE_FLDS; i++) {
-        Tree * kid = TREE_fld(t, i);
-        if (kid == nullptr) { continue; }
-
-        Tree * newkid_list = copyTreeList(kid);
-        TREE_fld(newt, i) = newkid_list;
-        for (Tree * xt = newkid_list; xt != nullptr; xt = TREE_nsib(xt)) {
-            TREE_parent(xt) = newt;
-        }
-    }
-    return newt;
+    CopyTreeVisitor visitor;
+    TreeWalker<CopyTreeVisitor, CopyTreeData> walker(visitor);
+    walker.walk(const_cast<Tree*>(t), false);
+    return visitor.getNewList();
 }
 
 
@@ -427,27 +491,29 @@ static void append_c_head(size_t v)
 
 
 //Append current token info descripte by 'g_cur_token','g_cur_token_string'
-//and 'g_src_line_num'
-static void append_tok_tail(TOKEN tok, CHAR * tokname, INT lineno)
+//and 'g_src_loc'
+static void append_tok_tail(TOKEN tok, CHAR * tokname, SrcLoc loc)
 {
-    TokenInfo * tki = (TokenInfo*)xmalloc(sizeof(TokenInfo));
+    g_fe_stat.lookahead_num++;
+    LookaheadTok * tki = (LookaheadTok*)xmalloc(sizeof(LookaheadTok));
     Sym * s = g_fe_sym_tab->add(tokname);
-    TOKEN_INFO_name(tki) = SYM_name(s);
-    TOKEN_INFO_token(tki) = tok;
-    TOKEN_INFO_lineno(tki) = lineno;
+    LATOK_name(tki) = SYM_name(s);
+    LATOK_tok(tki) = tok;
+    LATOK_loc(tki) = loc;
     append_c_tail((size_t)tki);
 }
 
 
 //Append current token info descripte by 'g_cur_token','g_cur_token_string'
-//and 'g_src_line_num'
-static void append_tok_head(TOKEN tok, CHAR * tokname, INT lineno)
+//and 'g_src_loc'
+static void append_tok_head(TOKEN tok, CHAR * tokname, SrcLoc loc)
 {
-    TokenInfo * tki = (TokenInfo*)xmalloc(sizeof(TokenInfo));
+    g_fe_stat.lookahead_num++;
+    LookaheadTok * tki = (LookaheadTok*)xmalloc(sizeof(LookaheadTok));
     Sym * s = g_fe_sym_tab->add(tokname);
-    TOKEN_INFO_name(tki) = SYM_name(s);
-    TOKEN_INFO_token(tki) = tok;
-    TOKEN_INFO_lineno(tki) = lineno;
+    LATOK_name(tki) = SYM_name(s);
+    LATOK_tok(tki) = tok;
+    LATOK_loc(tki) = loc;
     append_c_head((size_t)tki);
 }
 
@@ -471,7 +537,7 @@ void dump_tok_list()
     if (c != nullptr) {
         prt("\nTOKEN:");
         for (; c; c = g_cell_list.get_next()) {
-            CHAR const* s = TOKEN_INFO_name((TokenInfo*)CELL_val(c));
+            CHAR const* s = LATOK_name((LookaheadTok*)CELL_val(c));
             prt("'%s' ", s);
         }
         prt("\n");
@@ -729,60 +795,132 @@ Tree * id()
 }
 
 
-static void setMapRealLineToSrcLine(UINT realline, UINT srcline)
+void setParserTokenArray(TokenArray const* ta)
+{
+    ASSERT0(ta == nullptr || ta->get_elem_count() > 0);
+    g_tok_array = ta;
+    g_tok_array_pos = 0;
+}
+
+
+//Fetch next token from 'g_tok_array'.
+//The newline token is skipped unless 'g_enable_newline_token' is set,
+//which is same as getNextToken() does.
+static TOKEN fetch_tok_from_array()
 {
-    g_realline2srcline.set(realline, srcline);
+    UINT last = g_tok_array->get_elem_count() - 1;
+    UINT i = g_tok_array_pos;
+    while (i < last && !g_enable_newline_token &&
+           g_tok_array->get_tok(i) == T_NEWLINE) {
+        i++;
+    }
+    //Stay at the last token, that is either T_END or T_NUL.
+    g_tok_array_pos = i < last ? i + 1 : last;
+    g_src_loc = g_tok_array->get_loc(i);
+    g_src_line_num = getSrcLineNum(g_src_loc);
+    TOKEN tok = g_tok_array->get_tok(i);
+    Sym const* sym = g_tok_array->get_sym(i);
+    g_real_token_string = const_cast<CHAR*>(sym != nullptr ?
+        SYM_name(sym) : getTokenName(tok));
+    return tok;
 }
 
 
-UINT mapRealLineToSrcLine(UINT realline)
+void setParserTokenQueue(TokenQueue * q)
 {
-    return g_realline2srcline.get(realline);
+    if (g_tok_queue != nullptr && g_tok_queue_has_front) {
+        g_tok_queue->pop();
+    }
+    g_tok_queue = q;
+    g_tok_queue_has_front = false;
+}
+
+
+//Fetch next token from 'g_tok_queue'.
+//The record of current token is released lazily when next token fetched,
+//because 'g_real_token_string' refers to the string in record.
+//The newline token is skipped unless 'g_enable_newline_token' is set,
+//which is same as getNextToken() does.
+static TOKEN fetch_tok_from_queue()
+{
+    TokenRecord * r = nullptr;
+    for (;;) {
+        if (g_tok_queue_has_front) {
+            r = g_tok_queue->front();
+            if (TOKREC_tok(r) == T_END || TOKREC_tok(r) == T_NUL) {
+                //Stay at the last token.
+                break;
+            }
+            g_tok_queue->pop();
+        }
+        r = g_tok_queue->front();
+        g_tok_queue_has_front = true;
+        if (TOKREC_diag(r) != nullptr) {
+            //Lexical diagnostics are decoded on parser thread, since
+            //parser thread is the only reader of line table.
+            reportLexDiag(TOKREC_diag(r));
+            TOKREC_diag(r) = nullptr;
+        }
+        if (TOKREC_tok(r) != T_NEWLINE || g_enable_newline_token) {
+            break;
+        }
+    }
+    //The line that token resides in has been recorded before the token
+    //is pushed into queue.
+    g_src_loc = TOKREC_loc(r);
+    g_src_line_num = getSrcLineNum(g_src_loc);
+    g_real_token_string = TOKREC_str(r);
+    return TOKREC_tok(r);
 }
 
 
 static TOKEN gettok()
 {
-    TOKEN tok = getNextToken();
-    ASSERT0(tok == g_cur_token);
-    g_real_token = tok;
-    g_real_token_string = g_cur_token_string;
-    ASSERT0(g_src_line_num >= g_disgarded_line_num);
-    g_real_line_num = g_src_line_num - g_disgarded_line_num;
-    if (g_disgarded_line_num != 0) {
-        //Map the real line to the line in input file, where input file
-        //may be the output from preprocessor.
-        setMapRealLineToSrcLine(g_real_line_num, g_src_line_num);
+    TOKEN tok;
+    g_fe_stat.token_num++;
+    if (g_tok_array != nullptr) {
+        tok = fetch_tok_from_array();
+    } else if (g_tok_queue != nullptr) {
+        tok = fetch_tok_from_queue();
+    } else {
+        tok = getNextToken();
+        ASSERT0(tok == g_cur_token);
+        g_real_token_string = g_cur_token_string;
     }
+    g_real_token = tok;
+    g_real_loc = g_src_loc;
+    g_real_line_num = mapSrcLineToRealLine(g_src_line_num);
     return g_real_token;
 }
 
 
 static TOKEN reset_tok()
 {
-    TokenInfo * tki = nullptr;
-    if ((tki = (TokenInfo*)remove_head_tok()) == nullptr) {
+    LookaheadTok * tki = nullptr;
+    if ((tki = (LookaheadTok*)remove_head_tok()) == nullptr) {
         return g_real_token;
     }
 
     //Set the current token with the head element in token_list.
-    g_real_token_string = const_cast<CHAR*>(TOKEN_INFO_name(tki));
-    g_real_token = TOKEN_INFO_token(tki);
-    g_real_line_num = TOKEN_INFO_lineno(tki);
+    g_real_token_string = const_cast<CHAR*>(LATOK_name(tki));
+    g_real_token = LATOK_tok(tki);
+    g_real_loc = LATOK_loc(tki);
+    g_real_line_num = getSrcRealLineNum(g_real_loc);
     return g_real_token;
 }
 
 
 INT suck_tok()
 {
-    TokenInfo * tki = nullptr;
-    if ((tki = (TokenInfo*)remove_head_tok()) == nullptr) {
+    LookaheadTok * tki = nullptr;
+    if ((tki = (LookaheadTok*)remove_head_tok()) == nullptr) {
         gettok();
     } else {
         //Set the current token with head in token-info list
-        g_real_token_string = const_cast<CHAR*>(TOKEN_INFO_name(tki));
-        g_real_token = TOKEN_INFO_token(tki);
-        g_real_line_num = TOKEN_INFO_lineno(tki);
+        g_real_token_string = const_cast<CHAR*>(LATOK_name(tki));
+        g_real_token = LATOK_tok(tki);
+        g_real_loc = LATOK_loc(tki);
+        g_real_line_num = getSrcRealLineNum(g_real_loc);
     }
 
     return ST_SUCC;
@@ -824,13 +962,13 @@ static TOKEN look_next_token(INT n,
             //'n' can be finded in token-buffer
             Cell * c = g_cell_list.get_head_nth(n - 1);
             ASSERT0(c);
-            return TOKEN_INFO_token((TokenInfo*)CELL_val(c));
+            return LATOK_tok((LookaheadTok*)CELL_val(c));
         }
 
         //New tokens need to be fetched into the buffer.
         n -= count;
         //Restore current token into token-buffer
-        append_tok_head(g_real_token, g_real_token_string, g_real_line_num);
+        append_tok_head(g_real_token, g_real_token_string, g_real_loc);
         while (n > 0) {
             //get new token from file
             gettok();
@@ -840,7 +978,7 @@ static TOKEN look_next_token(INT n,
                 return g_real_token;
             }
             append_tok_tail(g_real_token,
-                            g_real_token_string, g_real_line_num);
+                            g_real_token_string, g_real_loc);
             n--;
         }
 
@@ -850,7 +988,7 @@ static TOKEN look_next_token(INT n,
 
     //For now, count == 0
     //Fetch a number of n tokens into the buffer
-    append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
+    append_tok_tail(g_real_token, g_real_token_string, g_real_loc);
     while (n > 0) {
         gettok();
         tok = g_real_token;
@@ -864,7 +1002,7 @@ static TOKEN look_next_token(INT n,
             reset_tok();
             return g_real_token;
         }
-        append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
+        append_tok_tail(g_real_token, g_real_token_string, g_real_loc);
         n--;
     }
 
@@ -892,21 +1030,21 @@ bool look_forward_token(INT num, ...)
     Cell * c = g_cell_list.get_head();
     if (c != nullptr) {
         //append current real token to 'token-list'
-        append_tok_head(g_real_token, g_real_token_string, g_real_line_num);
+        append_tok_head(g_real_token, g_real_token_string, g_real_loc);
 
         //Restart again.
         c = g_cell_list.get_head();
         while (num > 0) {
             if (c) { //match element resided in token_list.
-                TokenInfo * tki = (TokenInfo*)CELL_val(c);
-                if (TOKEN_INFO_token(tki) != v) {
+                LookaheadTok * tki = (LookaheadTok*)CELL_val(c);
+                if (LATOK_tok(tki) != v) {
                     goto UNMATCH;
                 }
                 c = g_cell_list.get_next();
             } else { //fetch new token to match.
                 gettok();
                 append_tok_tail(g_real_token, g_real_token_string,
-                                g_real_line_num);
+                                g_real_loc);
                 if (g_real_token != v) {
                     goto UNMATCH;
                 }
@@ -918,13 +1056,13 @@ bool look_forward_token(INT num, ...)
     } else {
         //token_list is empty. So fetch new token to match.
         while (num > 0) {
-            append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
+            append_tok_tail(g_real_token, g_real_token_string, g_real_loc);
             if (g_real_token != v) { goto UNMATCH; }
             gettok();
             v = (TOKEN)va_arg(arg, INT);
             num--;
         }
-        append_tok_tail(g_real_token, g_real_token_string, g_real_line_num);
+        append_tok_tail(g_real_token, g_real_token_string, g_real_loc);
     }
     va_end(arg);
     reset_tok();
@@ -1505,332 +1643,146 @@ FAILED:
 }
 
 
-static Tree * multiplicative_exp()
-{
-    Tree * t = cast_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_ASTERISK ||
-           g_real_token == T_DIV ||
-           g_real_token == T_MOD) {
-        p = NEWTN(TR_MULTI);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-            // a*b*c  =>
-            //             *
-            //           /  |
-            //           *  c
-            //          / |
-            //         a  b
-        match(g_real_token);
-        TREE_rchild(p) = cast_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-
-FAILED:
-    prt("error in multiplicative_exp()");
-    return t;
-}
-
-
-static Tree * additive_exp()
-{
-    Tree * t = multiplicative_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_ADD || g_real_token == T_SUB) {
-        p = NEWTN(TR_ADDITIVE);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-           //  a+b-c  =>
-           //              -
-           //             / |
-           //            +  c
-           //           / |
-           //          a  b
-        match(g_real_token);
-        TREE_rchild(p) = multiplicative_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-
-FAILED:
-    prt("error in additive_exp()");
-    return t;
-}
-
-
-static Tree * shift_exp()
-{
-    Tree * t = additive_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_LSHIFT || g_real_token == T_RSHIFT) {
-        p = NEWTN(TR_SHIFT);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-           //  a<<b<<c  =>
-           //              <<
-           //             /  |
-           //            <<  c
-           //           /  |
-           //          a   b
-        match(g_real_token);
-        TREE_rchild(p) = additive_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-
-    prt("error in shift_exp()");
-    return t;
-}
-
-
-static Tree * relational_exp()
-{
-    Tree * t = shift_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_LESSTHAN || g_real_token == T_MORETHAN ||
-           g_real_token == T_NOMORETHAN || g_real_token == T_NOLESSTHAN) {
-        p = NEWTN(TR_RELATION);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-           //  a<b<c   =>
-           //              <
-           //             / |
-           //            <  c
-           //           / |
-           //          a  b
-        match(g_real_token);
-        TREE_rchild(p) = shift_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-    prt("error in relational_exp()");
-    return t;
-}
-
+//The number of precedence levels of binary operator.
+#define BINOP_PREC_NUM 10
 
-static Tree * equality_exp()
-{
-    Tree * t = relational_exp(), * p = nullptr;
+//Binary operator information.
+class BinOpInfo {
+public:
+    TOKEN tok;
+    TREE_TYPE tree_type;
+    //The higher precedence binds tighter, all binary operators are
+    //left associative.
+    UINT prec;
+    //The grammar rule of the operator, used by error message.
+    CHAR const* rule;
+};
+
+//CAVEAT: The precedence must be consistent with C specification.
+static BinOpInfo const g_binop_info[] = {
+    { T_OR,          TR_LOGIC_OR,       1,  "logical_OR_exp" },
+    { T_AND,         TR_LOGIC_AND,      2,  "logical_AND_exp" },
+    { T_BITOR,       TR_INCLUSIVE_OR,   3,  "inclusive_OR_exp" },
+    { T_XOR,         TR_XOR,            4,  "exclusive_OR_exp" },
+    { T_BITAND,      TR_INCLUSIVE_AND,  5,  "AND_exp" },
+    { T_EQU,         TR_EQUALITY,       6,  "equality_exp" },
+    { T_NOEQU,       TR_EQUALITY,       6,  "equality_exp" },
+    { T_LESSTHAN,    TR_RELATION,       7,  "relational_exp" },
+    { T_MORETHAN,    TR_RELATION,       7,  "relational_exp" },
+    { T_NOMORETHAN,  TR_RELATION,       7,  "relational_exp" },
+    { T_NOLESSTHAN,  TR_RELATION,       7,  "relational_exp" },
+    { T_LSHIFT,      TR_SHIFT,          8,  "shift_exp" },
+    { T_RSHIFT,      TR_SHIFT,          8,  "shift_exp" },
+    { T_ADD,         TR_ADDITIVE,       9,  "additive_exp" },
+    { T_SUB,         TR_ADDITIVE,       9,  "additive_exp" },
+    { T_ASTERISK,    TR_MULTI,          10, "multiplicative_exp" },
+    { T_DIV,         TR_MULTI,          10, "multiplicative_exp" },
+    { T_MOD,         TR_MULTI,          10, "multiplicative_exp" },
+};
+
+//Map token to binary operator information, nullptr if the token is not
+//binary operator.
+static BinOpInfo const* g_binop_tab[T_END + 1];
+
+static void initBinOpTab()
+{
+    ::memset((void*)g_binop_tab, 0, sizeof(g_binop_tab));
+    for (UINT i = 0; i < sizeof(g_binop_info) / sizeof(g_binop_info[0]);
+         i++) {
+        ASSERT0(g_binop_info[i].prec > 0 &&
+                g_binop_info[i].prec <= BINOP_PREC_NUM);
+        g_binop_tab[g_binop_info[i].tok] = &g_binop_info[i];
+    }
+}
+
+
+static inline BinOpInfo const* get_binop_info(TOKEN tok)
+{
+    ASSERT0((UINT)tok <= T_END);
+    return g_binop_tab[tok];
+}
+
+
+//Parse the binary expression from logical_OR_expression down to
+//multiplicative_expression by precedence climbing, e.g:
+//  logical_OR_expression:
+//      logical_AND_expression
+//      logical_OR_expression || logical_AND_expression
+//  ...
+//  multiplicative_expression:
+//      cast_expression
+//      multiplicative_expression * / % cast_expression
+//The operator whose right operand is being parsed is pending. The
+//precedence of pending operators strictly increases, thus there are at
+//most BINOP_PREC_NUM pending operators, and the C stack is constant no
+//matter how long the expression is. The tree is same as the one built by
+//recursive descent parser, e.g:
+//  a+b*c-d  =>
+//              -
+//             / |
+//            +  d
+//           / |
+//          a  *
+//            / |
+//           b  c
+static Tree * binary_exp()
+{
+    Tree * t = cast_exp();
     if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_EQU || g_real_token == T_NOEQU) {
-        p = NEWTN(TR_EQUALITY);
+    BinOpInfo const* bi = get_binop_info(g_real_token);
+    if (bi == nullptr) { return t; }
+
+    Tree * pending[BINOP_PREC_NUM];
+    UINT pending_prec[BINOP_PREC_NUM];
+    UINT num = 0;
+    //Only the operator that binds looser than 'ceiling' can be accepted.
+    UINT ceiling = BINOP_PREC_NUM + 1;
+    for (; bi != nullptr && bi->prec < ceiling;
+         bi = get_binop_info(g_real_token)) {
+        //Left associative, reduce the operator that binds tighter than
+        //or equal to current operator.
+        for (; num > 0 && pending_prec[num - 1] >= bi->prec; num--) {
+            Tree * p = pending[num - 1];
+            TREE_rchild(p) = t;
+            setParent(p, TREE_rchild(p));
+            t = p;
+        }
+        Tree * p = NEWTN(bi->tree_type);
         TREE_token(p) = g_real_token;
         TREE_lchild(p) = t;
         setParent(p, TREE_lchild(p));
-           //  a==b!=c   =>
-           //              !=
-           //             /  |
-           //            ==  c
-           //           /  |
-           //          a   b
         match(g_real_token);
-        TREE_rchild(p) = relational_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-    prt("error in equality_exp()");
-    return t;
-}
-
-
-static Tree * AND_exp()
-{
-    Tree * t = equality_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_BITAND) {
-        p = NEWTN(TR_INCLUSIVE_AND);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-           //  a&b&c   =>  &
-           //             / |
-           //            &  c
-           //           / |
-           //          a  b
-        match(T_BITAND);
-        TREE_rchild(p) = equality_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
+        Tree * r = cast_exp();
+        if (r == nullptr) {
             err(g_real_line_num, "'%s': right operand cannot be nullptr",
                 TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-    prt("error in AND_exp()");
-    return t;
-}
-
-
-static Tree * exclusive_OR_exp()
-{
-    Tree * t = AND_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_XOR) {
-        p = NEWTN(TR_XOR);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-           //  a^b^c   =>  ^
-           //             / |
-           //            ^  c
-           //           / |
-           //          a  b
-        match(T_XOR);
-        TREE_rchild(p) = AND_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-    prt("error in exclusive_OR_exp()");
-    return t;
-}
-
-
-static Tree * inclusive_OR_exp()
-{
-    Tree * t = exclusive_OR_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_BITOR) {
-        p = NEWTN(TR_INCLUSIVE_OR);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-        //  a|b|c   =>  |
-        //             / |
-        //            |  c
-        //           / |
-        //          a  b
-        match(T_BITOR);
-        TREE_rchild(p) = exclusive_OR_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
-        t = p;
-    }
-    return t;
-FAILED:
-    prt("error in inclusive_OR_exp()");
-    return t;
-}
-
-
-static Tree * logical_AND_exp()
-{
-    Tree * t = inclusive_OR_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_AND) {
-        p = NEWTN(TR_LOGIC_AND);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-        //a && b && c =>
-        //              &&
-        //             /  |
-        //            &&  c
-        //           /  |
-        //           a  b
-        match(T_AND);
-        TREE_rchild(p) = inclusive_OR_exp();
-        setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
+            prt("error in %s()", bi->rule);
+            //Drop the operator, the left operand has been complete, and
+            //only the operator that binds looser can follow it.
+            ceiling = bi->prec;
+            continue;
         }
-        t = p;
+        ASSERT0(num < BINOP_PREC_NUM);
+        pending[num] = p;
+        pending_prec[num] = bi->prec;
+        num++;
+        t = r;
+        ceiling = BINOP_PREC_NUM + 1;
     }
-    return t;
-FAILED:
-    prt("error in logical_AND_exp()");
-    return t;
-}
-
-
-static Tree * logical_OR_exp()
-{
-    Tree * t = logical_AND_exp(), * p = nullptr;
-    if (t == nullptr) { return nullptr; }
-    while (g_real_token == T_OR) {
-        p = NEWTN(TR_LOGIC_OR);
-        TREE_token(p) = g_real_token;
-        TREE_lchild(p) = t;
-        setParent(p, TREE_lchild(p));
-        //  a||b||c  =>  ||
-        //              /  |
-        //             ||  c
-        //            /  |
-        //           a   b
-        match(T_OR);
-        TREE_rchild(p) = logical_AND_exp();
+    for (; num > 0; num--) {
+        Tree * p = pending[num - 1];
+        TREE_rchild(p) = t;
         setParent(p, TREE_rchild(p));
-        if (TREE_rchild(p) == nullptr) {
-            err(g_real_line_num, "'%s': right operand cannot be nullptr",
-                TOKEN_INFO_name(get_token_info(TREE_token(p))));
-            goto FAILED;
-        }
         t = p;
     }
     return t;
-FAILED:
-    prt("error in logical_OR_exp()");
-    return t;
 }
 
 
 //logical_OR_expression ? expression : conditional_expression
 Tree * conditional_exp()
 {
-    Tree * t = logical_OR_exp();
+    Tree * t = binary_exp();
     if (g_real_token == T_QUES_MARK) {
         match(T_QUES_MARK);
         Tree * p = NEWTN(TR_COND);
@@ -1983,7 +1935,7 @@ static Tree * sharp_start_stmt()
     case T_IMM:
         //Current line generated by preprocessor.
         //e.g: # 1 "test/compile/prc.c"
-        g_disgarded_line_num++;
+        addSrcDiscardedLine(getSrcLineNum(g_real_loc));
         t = NEWTN(TR_PREP);
         TREE_token(t) = g_real_token;
         match(T_IMM);
@@ -2384,7 +2336,6 @@ Scope * compound_stmt(Decl * para_list)
     Scope * cur_scope = push_scope(false);
 
     //Append parameters to declaration list of function body scope.
-    Decl * lastdcl = xcom::get_last(SCOPE_decl_list(cur_scope));
     UINT pos = 0;
     for (; para_list != nullptr; para_list = DECL_next(para_list), pos++) {
         if (DECL_dt(para_list) == DCL_VARIABLE) {
@@ -2410,15 +2361,13 @@ Scope * compound_stmt(Decl * para_list)
         }
 
         DECL_is_formal_para(declaration) = true;
-        xcom::add_next(&SCOPE_decl_list(cur_scope), &lastdcl, declaration);
+        add_decl_to_scope(cur_scope, declaration);
         DECL_decl_scope(declaration) = cur_scope;
         DECL_formal_param_pos(declaration) = pos;
 
-        lastdcl = declaration;
-
         //Append parameter list to symbol list of function body scope.
         Sym * sym = get_decl_sym(declaration);
-        if (add_to_symtab_list(&SCOPE_sym_tab_list(cur_scope), sym)) {
+        if (add_to_symtab_list(cur_scope, sym)) {
             err(g_real_line_num, "'%s' already defined",
                 g_real_token_string);
             goto FAILED;
@@ -2430,12 +2379,12 @@ Scope * compound_stmt(Decl * para_list)
     declaration_list();
 
     //statement list
-    cerr = g_err_msg_list.get_elem_count();
+    cerr = get_err_count();
     last = nullptr;
     for (;;) {
         if (g_real_token == T_END || g_real_token == T_NUL) {
             break;
-        } else if (g_err_msg_list.get_elem_count() >= TOO_MANY_ERR) {
+        } else if (get_err_count() >= TOO_MANY_ERR) {
             goto FAILED;
         } else if (is_compound_terminal()) {
             break;
@@ -2452,7 +2401,7 @@ Scope * compound_stmt(Decl * para_list)
 
         last = xcom::get_last(t);
 
-        if ((cerr != (INT)g_err_msg_list.get_elem_count()) ||
+        if ((cerr != (INT)get_err_count()) ||
             (cerr > 0 && t == nullptr)) {
             suck_tok_to(0, T_SEMI, T_RLPAREN, T_END, T_NUL);
         }
@@ -2461,7 +2410,7 @@ Scope * compound_stmt(Decl * para_list)
             match(T_SEMI);
         }
 
-        cerr = g_err_msg_list.get_elem_count();
+        cerr = get_err_count();
     }
 
     if (match(T_RLPAREN) != ST_SUCC) {
@@ -2785,9 +2734,11 @@ static Tree * dispatch()
 void initParser()
 {
     initKeyWordTab();
+    initBinOpTab();
     g_pool_general_used = smpoolCreate(256, MEM_COMM);
     g_pool_tree_used = smpoolCreate(128, MEM_COMM);
     g_pool_st_used = smpoolCreate(64, MEM_COMM);
+    initSrcMgr();
 }
 
 
@@ -2800,10 +2751,7 @@ void finiParser()
     g_pool_tree_used = nullptr;
     g_pool_st_used = nullptr;
 
-    if (g_ofst_tab != nullptr) {
-        ::free(g_ofst_tab);
-        g_ofst_tab = nullptr;
-    }
+    finiSrcMgr();
 
     if (g_cur_line != nullptr) {
         ::free(g_cur_line);
@@ -2878,7 +2826,7 @@ INT Parser()
             return ST_ERR;
         }
 
-        if (dispatch() == nullptr && g_err_msg_list.get_elem_count() != 0) {
+        if (dispatch() == nullptr && get_err_count() != 0) {
             return ST_ERR;
         }
     }
@@ -38,6 +38,10 @@ extern SMemPool * g_pool_st_used;
 extern SymTab * g_fe_sym_tab;
 extern bool g_dump_token;
 
+//Record the subscripts of array or the field indices of aggregate. The
+//initializations are seldom nested deeply, so the indices are kept inline.
+#define IDX_VEC_INLINE_NUM 8
+typedef xcom::SmallVector<UINT, IDX_VEC_INLINE_NUM> IdxVec;
 
 //Exported Functions
 void initParser();
@@ -50,8 +54,8 @@ Tree * buildUInt(HOST_UINT val);
 Tree * buildId(Decl const* decl);
 Tree * buildAssign(Decl const* decl, Tree * rhs);
 Tree * buildAssign(Tree * lhs, Tree * rhs);
-Tree * buildArray(Decl const* decl, xcom::Vector<UINT> & subexp_vec);
-Tree * buildArray(Tree * base, xcom::Vector<UINT> & subexp_vec);
+Tree * buildArray(Decl const* decl, IdxVec & subexp_vec);
+Tree * buildArray(Tree * base, IdxVec & subexp_vec);
 Tree * buildIndmem(Tree * base, Decl const* fld);
 Tree * buildDmem(Tree * base, Decl const* fld);
 //Build aggregate reference tree node.
@@ -59,7 +63,7 @@ Tree * buildDmem(Tree * base, Decl const* fld);
 //fldvec: record a list of indices in aggregate.
 //  e.g: struct T { unsigned int b, c; struct Q {int m,n;} char e; };
 //  m's fldvec is <2, 1>, e's fldvec is <3>.
-Tree * buildAggrFieldRef(Decl const* decl, xcom::Vector<UINT> & fldvec);
+Tree * buildAggrFieldRef(Decl const* decl, IdxVec & fldvec);
 Tree * buildAggrRef(Tree * base, Decl const* fld);
 
 //Duplicate 't' and its kids, but without ir's sibiling node.
@@ -67,6 +71,12 @@ Tree * copyTree(Tree const* t);
 Tree * copyTreeList(Tree const* t);
 
 INT Parser();
+//Parse tokens in 'ta' rather than fetching token from lexer.
+//Pass nullptr to restore fetching token from lexer.
+void setParserTokenArray(TokenArray const* ta);
+//Parse tokens that fetched from 'q', which is fed by lexer thread.
+//Pass nullptr to restore fetching token from lexer.
+void setParserTokenQueue(TokenQueue * q);
 Scope * compound_stmt(Decl * para_list);
 Tree * conditional_exp();
 
@@ -86,7 +96,6 @@ Tree * exp_list();
 bool look_forward_token(INT num, ...);
 
 INT match(TOKEN tok);
-UINT mapRealLineToSrcLine(UINT realline);
 
 void setParent(Tree * parent, Tree * child);
 void setLogMgr(LogMgr * lm);
@@ -0,0 +1,296 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __TREE_WALK_H__
+#define __TREE_WALK_H__
+
+//This file defines the iterative tree walker.
+//The walker keeps the visiting state in an explicit stack rather than
+//C stack, thus the C stack consumed is bounded no matter how deep the
+//tree is, e.g: the machine generated expression that chains tens of
+//thousands of '+' or ','.
+
+//The number of frames that reside in the walker itself.
+#define TREE_WALK_INLINE_FRAME_NUM 32
+
+//The number of frames of each chunk that allocated from pool.
+#define TREE_WALK_CHUNK_FRAME_NUM 256
+
+typedef enum _WALK_ACT {
+    WALK_CONT = 0, //continue walking.
+    WALK_SKIP_KID, //skip the kids of current node, only used by visitPre.
+    WALK_ABORT, //terminate walking, see TreeWalkFrame::is_barrier.
+} WALK_ACT;
+
+//The default data attached to frame.
+class TreeWalkNoData {};
+
+//TreeWalkFrame
+//Record the visiting state of a tree node.
+//T: the data attached to the frame by visitor, it must be plain old data
+//   because the frame may reside in the memory allocated from pool.
+template <class T> class TreeWalkFrame {
+public:
+    Tree * tree; //current tree node.
+    UINT kid_idx; //the index of next kid to be fetched.
+    BYTE is_list:1; //visit the siblings of 'tree' after 'tree'.
+    //WALK_ABORT unwinds frames until the barrier frame is popped, then
+    //walking continues from the parent frame, which is same as a
+    //recursive walker that ignores the failure of callee.
+    BYTE is_barrier:1;
+    BYTE is_pre_done:1; //visitPre has been invoked.
+    BYTE is_skip_kid:1; //visitPre asks for skipping kids.
+    T data;
+
+    void init(Tree * t, bool list, T const& d)
+    {
+        tree = t;
+        kid_idx = 0;
+        is_list = list;
+        is_barrier = false;
+        is_pre_done = false;
+        is_skip_kid = false;
+        data = d;
+    }
+};
+
+
+//TreeWalkStack
+//A stack of frames that never moves pushed frames. The first chunk of
+//frames resides in the stack object, the others are allocated from pool
+//on demand and reused after popped.
+template <class Frame> class TreeWalkStack {
+    COPY_CONSTRUCTOR(TreeWalkStack);
+protected:
+    class Chunk {
+    public:
+        Chunk * prev;
+        Chunk * next;
+        UINT cap;
+        Frame * frame;
+    };
+    UINT m_num; //the number of frames in 'm_cur'.
+    UINT m_depth; //the number of frames in stack.
+    UINT m_max_depth;
+    Chunk * m_cur;
+    SMemPool * m_pool;
+    Chunk m_inline_chunk;
+    Frame m_inline_frame[TREE_WALK_INLINE_FRAME_NUM];
+
+    Chunk * allocChunk()
+    {
+        if (m_pool == nullptr) {
+            m_pool = smpoolCreate((sizeof(Chunk) + sizeof(Frame) *
+                                   TREE_WALK_CHUNK_FRAME_NUM) * 4, MEM_COMM);
+        }
+        Chunk * c = (Chunk*)smpoolMalloc(sizeof(Chunk), m_pool);
+        ASSERT0(c);
+        c->frame = (Frame*)smpoolMalloc(sizeof(Frame) *
+                                        TREE_WALK_CHUNK_FRAME_NUM, m_pool);
+        ASSERT0(c->frame);
+        c->cap = TREE_WALK_CHUNK_FRAME_NUM;
+        c->next = nullptr;
+        return c;
+    }
+public:
+    TreeWalkStack()
+    {
+        m_num = 0;
+        m_depth = 0;
+        m_max_depth = 0;
+        m_pool = nullptr;
+        m_inline_chunk.prev = nullptr;
+        m_inline_chunk.next = nullptr;
+        m_inline_chunk.cap = TREE_WALK_INLINE_FRAME_NUM;
+        m_inline_chunk.frame = m_inline_frame;
+        m_cur = &m_inline_chunk;
+    }
+    ~TreeWalkStack()
+    {
+        if (m_pool != nullptr) {
+            smpoolDelete(m_pool);
+            m_pool = nullptr;
+        }
+    }
+
+    bool is_empty() const { return m_depth == 0; }
+    UINT get_depth() const { return m_depth; }
+    UINT get_max_depth() const { return m_max_depth; }
+
+    //Return the top frame.
+    Frame * get_top()
+    {
+        ASSERT0(m_num > 0);
+        return &m_cur->frame[m_num - 1];
+    }
+
+    //Return the frame under the top frame, or nullptr if there is not.
+    Frame * get_second_top()
+    {
+        if (m_num >= 2) { return &m_cur->frame[m_num - 2]; }
+        if (m_num == 1 && m_cur->prev != nullptr) {
+            return &m_cur->prev->frame[m_cur->prev->cap - 1];
+        }
+        return nullptr;
+    }
+
+    //Push an uninitialized frame.
+    Frame * push()
+    {
+        if (m_num == m_cur->cap) {
+            if (m_cur->next == nullptr) {
+                Chunk * c = allocChunk();
+                c->prev = m_cur;
+                m_cur->next = c;
+            }
+            m_cur = m_cur->next;
+            m_num = 0;
+        }
+        m_depth++;
+        m_max_depth = MAX(m_max_depth, m_depth);
+        return &m_cur->frame[m_num++];
+    }
+
+    void pop()
+    {
+        ASSERT0(m_depth > 0 && m_num > 0);
+        m_depth--;
+        m_num--;
+        if (m_num == 0 && m_cur->prev != nullptr) {
+            m_cur = m_cur->prev;
+            m_num = m_cur->cap;
+        }
+    }
+};
+
+
+//Fetch the kid at index 'idx' in 'num' given kids.
+//Return false if all kids have been fetched.
+template <class Frame>
+bool fetchKid(UINT idx, OUT Frame & kid, UINT num, Tree * k0,
+              Tree * k1 = nullptr, Tree * k2 = nullptr,
+              Tree * k3 = nullptr)
+{
+    ASSERT0(num <= 4);
+    if (idx >= num) { return false; }
+    switch (idx) {
+    case 0: kid.tree = k0; break;
+    case 1: kid.tree = k1; break;
+    case 2: kid.tree = k2; break;
+    default: kid.tree = k3; break;
+    }
+    kid.is_list = true;
+    return true;
+}
+
+
+//TreeWalker
+//Walk tree iteratively, the visitor is invoked at each tree node.
+//Visitor should provide following functions:
+//  //Invoked before the kids of 'f.tree' are visited.
+//  WALK_ACT visitPre(TreeWalkFrame<T> & f);
+//  //Fill 'kid' with the kid of 'f.tree' at index 'f.kid_idx'. The kid
+//  //may be nullptr if the field is empty. Return false if there is no
+//  //more kid. 'kid' has been initialized to be a list by default.
+//  bool getKid(TreeWalkFrame<T> & f, OUT TreeWalkFrame<T> & kid);
+//  //Invoked after the kids of 'f.tree' are visited. 'parent' is the
+//  //frame of parent node, it is nullptr for the node to start walking.
+//  WALK_ACT visitPost(TreeWalkFrame<T> & f, TreeWalkFrame<T> * parent);
+//Note the frames returned by visitor are always stable during walking.
+template <class Visitor, class T = TreeWalkNoData> class TreeWalker {
+    COPY_CONSTRUCTOR(TreeWalker);
+protected:
+    typedef TreeWalkFrame<T> Frame;
+    Visitor & m_visitor;
+    TreeWalkStack<Frame> m_stack;
+
+    //Pop frames until barrier frame popped.
+    //Return false if there is no barrier frame.
+    bool unwind()
+    {
+        while (!m_stack.is_empty()) {
+            bool is_barrier = m_stack.get_top()->is_barrier;
+            m_stack.pop();
+            if (is_barrier) { return true; }
+        }
+        return false;
+    }
+public:
+    explicit TreeWalker(Visitor & v) : m_visitor(v) {}
+
+    //Return the maximum number of frames during walking.
+    UINT getMaxDepth() const { return m_stack.get_max_depth(); }
+
+    //Walk 't', and its siblings if 'is_list' is true.
+    //data: the data attached to the frame of 't'.
+    //Return false if walking is aborted.
+    bool walk(Tree * t, bool is_list, T const& data)
+    {
+        ASSERT0(m_stack.is_empty());
+        if (t == nullptr) { return true; }
+        m_stack.push()->init(t, is_list, data);
+        while (!m_stack.is_empty()) {
+            Frame * f = m_stack.get_top();
+            if (!f->is_pre_done) {
+                f->is_pre_done = true;
+                WALK_ACT act = m_visitor.visitPre(*f);
+                if (act == WALK_ABORT) {
+                    if (!unwind()) { return false; }
+                    continue;
+                }
+                f->is_skip_kid = act == WALK_SKIP_KID;
+            }
+            if (!f->is_skip_kid) {
+                Frame * kid = m_stack.push();
+                kid->init(nullptr, true, T());
+                if (m_visitor.getKid(*f, *kid)) {
+                    f->kid_idx++;
+                    if (kid->tree == nullptr) { m_stack.pop(); }
+                    continue;
+                }
+                m_stack.pop();
+            }
+            if (m_visitor.visitPost(*f, m_stack.get_second_top()) ==
+                WALK_ABORT) {
+                if (!unwind()) { return false; }
+                continue;
+            }
+            if (f->is_list && TREE_nsib(f->tree) != nullptr) {
+                //Reuse the frame to visit next sibling.
+                f->tree = TREE_nsib(f->tree);
+                f->kid_idx = 0;
+                f->is_pre_done = false;
+                f->is_skip_kid = false;
+                continue;
+            }
+            m_stack.pop();
+        }
+        return true;
+    }
+    bool walk(Tree * t, bool is_list) { return walk(t, is_list, T()); }
+};
+#endif
@@ -70,10 +70,7 @@ static INT checkDeclaration(Decl const* d)
 
 static bool checkCall(Tree * t, TYCtx * cont)
 {
-    if (ST_SUCC != TypeCheckTreeList(TREE_para_list(t), cont)) {
-        return false;
-    }
-    if (ST_SUCC != TypeCheckTreeList(TREE_fun_exp(t), cont)) { return false; }
+    DUMMYUSE(cont);
     Decl * fun_decl = TREE_result_type(TREE_fun_exp(t));
 
     //Return type is the call type.
@@ -87,10 +84,10 @@ static bool checkCall(Tree * t, TYCtx * cont)
     //Do legality checking first for the return value type.
     if (pure_decl) {
         if (is_array(pure_decl)) {
-            err(TREE_lineno(t), "function cannot returns array");
+            errLoc(TREE_loc(t), "function cannot returns array");
         }
         if (is_fun_decl(pure_decl)) {
-            err(TREE_lineno(t), "function cannot returns function");
+            errLoc(TREE_loc(t), "function cannot returns function");
         }
     }
 
@@ -104,7 +101,7 @@ static bool checkCall(Tree * t, TYCtx * cont)
             count++;
             Decl * pld = TREE_result_type(real_param);
             if (!checkParam(formal_param_decl, pld)) {
-                err(TREE_lineno(t), "%dth parameter type incompatible", count);
+                errLoc(TREE_loc(t), "%dth parameter type incompatible", count);
                 return false;
             }
 
@@ -135,13 +132,13 @@ static bool checkCall(Tree * t, TYCtx * cont)
         }
 
         if (count == 0) {
-            err(TREE_lineno(t),
-                "function '%s' cannot take any parameter",
-                name != nullptr ? name : "");
+            errLoc(TREE_loc(t),
+                   "function '%s' cannot take any parameter",
+                   name != nullptr ? name : "");
         } else {
-            err(TREE_lineno(t),
-                "function '%s' should take %d parameters",
-                name != nullptr ? name : "", c);
+            errLoc(TREE_loc(t),
+                   "function '%s' should take %d parameters",
+                   name != nullptr ? name : "", c);
         }
 
         return false;
@@ -189,27 +186,26 @@ static void checkAssignLHS(Tree * t)
     case TR_ARRAY:
         break;
     default:
-        err(TREE_lineno(t),
-            "'%s': the left operand must be left-value",
-            TOKEN_INFO_name(get_token_info(TREE_token(t))));
+        errLoc(TREE_loc(t),
+               "'%s': the left operand must be left-value",
+               TOKEN_INFO_name(get_token_info(TREE_token(t))));
     }
 }
 
 
 static bool TypeCheckAssign(Tree * t, TYCtx * cont)
 {
-    TypeCheckTreeList(TREE_lchild(t), cont);
-    TypeCheckTreeList(TREE_rchild(t), cont);
+    DUMMYUSE(cont);
     if ((is_pointer(TREE_result_type(TREE_lchild(t))) &&
          !isConsistentWithPointer(TREE_rchild(t))) ||
         (is_pointer(TREE_result_type(TREE_rchild(t))) &&
          !isConsistentWithPointer(TREE_lchild(t)))) {
-        xcom::StrBuf bufl(64);
-        xcom::StrBuf bufr(64);
+        xcom::SmallStrBuf<64> bufl;
+        xcom::SmallStrBuf<64> bufr;
         format_declaration(bufl, TREE_result_type(TREE_lchild(t)));
         format_declaration(bufr, TREE_result_type(TREE_rchild(t)));
-        warn(TREE_lineno(t),
-             "should not assign '%s' to '%s'", bufr.buf, bufl.buf);
+        warnLoc(TREE_loc(t),
+                "should not assign '%s' to '%s'", bufr.buf, bufl.buf);
     }
     //Check lhs of assignment.
     checkAssignLHS(t);
@@ -217,37 +213,44 @@ static bool TypeCheckAssign(Tree * t, TYCtx * cont)
 }
 
 
-static void TypeCheckDeclInit(Decl const* decl, TYCtx * cont)
-{
-    for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
-        if (!is_initialized(dcl)) { continue; }
-        Tree * inittree = get_decl_init_tree(dcl);
-        ASSERT0(inittree);
-        TypeCheckTreeList(inittree, cont);    
-    }
-}
-
+//The data that attached to each frame of TypeCheckVisitor.
+class TypeCheckData {
+public:
+    //Record the next declaration whose initial value should be checked.
+    Decl const* decl;
+    //The number of kids that are initial values of declarations.
+    UINT init_num;
+};
+typedef TreeWalkFrame<TypeCheckData> TypeCheckFrame;
 
-static void TypeCheckInitValScope(Tree const* t, TYCtx * cont)
-{
-    TypeCheckTreeList(TREE_initval_scope(t), cont);
-}
 
+class TypeCheckVisitor {
+    COPY_CONSTRUCTOR(TypeCheckVisitor);
+    TYCtx * m_ctx;
+public:
+    explicit TypeCheckVisitor(TYCtx * cont) : m_ctx(cont) {}
 
-//Perform type checking.
-INT TypeCheckTreeList(Tree * t, TYCtx * cont)
-{
-    TYCtx ct;
-    if (cont == nullptr) {
-        cont = &ct;
+    WALK_ACT visitPre(TypeCheckFrame & f)
+    {
+        Tree * t = f.tree;
+        g_src_line_num = TREE_lineno(t);
+        f.data.decl = nullptr;
+        f.data.init_num = 0;
+        if (TREE_type(t) == TR_SCOPE) {
+            f.data.decl = SCOPE_decl_list(TREE_scope(t));
+        }
+        return WALK_CONT;
     }
 
-    for (; t != nullptr; t = TREE_nsib(t)) {
-        g_src_line_num = TREE_lineno(t);
+    bool getKid(TypeCheckFrame & f, OUT TypeCheckFrame & kid)
+    {
+        Tree * t = f.tree;
+        UINT idx = f.kid_idx;
+        //Only the failure of parameter and callee of function call
+        //propagates to the parent.
+        kid.is_barrier = TREE_type(t) != TR_CALL;
         switch (TREE_type(t)) {
         case TR_ASSIGN:
-            TypeCheckAssign(t, cont);
-            break;
         case TR_ID:
         case TR_IMM:
         case TR_IMML:
@@ -268,85 +271,75 @@ INT TypeCheckTreeList(Tree * t, TYCtx * cont)
         case TR_RELATION:      // < > >= <=
         case TR_ADDITIVE:      // '+' '-'
         case TR_MULTI:         // '*' '/' '%'
-            TypeCheckTreeList(TREE_lchild(t), cont);
-            TypeCheckTreeList(TREE_rchild(t), cont);
-            break;
-        case TR_SCOPE:
-            TypeCheckDeclInit(SCOPE_decl_list(TREE_scope(t)), cont);
-            TypeCheckTreeList(SCOPE_stmt_list(TREE_scope(t)), cont);
-            break;
+            return fetchKid(idx, kid, 2, TREE_lchild(t), TREE_rchild(t));
+        case TR_SCOPE: {
+            //Check initial values of declarations, then statements.
+            Decl const* dcl = f.data.decl;
+            while (dcl != nullptr && !is_initialized(dcl)) {
+                dcl = DECL_next(dcl);
+            }
+            if (dcl != nullptr) {
+                f.data.decl = DECL_next(dcl);
+                f.data.init_num++;
+                kid.tree = get_decl_init_tree(dcl);
+                ASSERT0(kid.tree);
+                return true;
+            }
+            f.data.decl = nullptr;
+            return fetchKid(idx - f.data.init_num, kid, 1,
+                            SCOPE_stmt_list(TREE_scope(t)));
+        }
         case TR_INITVAL_SCOPE:
-            TypeCheckInitValScope(t, cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_initval_scope(t));
         case TR_IF:
-            TypeCheckTreeList(TREE_if_det(t), cont);
-            TypeCheckTreeList(TREE_if_true_stmt(t), cont);
-            TypeCheckTreeList(TREE_if_false_stmt(t), cont);
-            break;
+            return fetchKid(idx, kid, 3, TREE_if_det(t),
+                            TREE_if_true_stmt(t), TREE_if_false_stmt(t));
         case TR_DO:
-            TypeCheckTreeList(TREE_dowhile_body(t), cont);
-            TypeCheckTreeList(TREE_dowhile_det(t), cont);
-            break;
+            return fetchKid(idx, kid, 2, TREE_dowhile_body(t),
+                            TREE_dowhile_det(t));
         case TR_WHILE:
-            TypeCheckTreeList(TREE_whiledo_det(t), cont);
-            TypeCheckTreeList(TREE_whiledo_body(t), cont);
-            break;
+            return fetchKid(idx, kid, 2, TREE_whiledo_det(t),
+                            TREE_whiledo_body(t));
         case TR_FOR:
-            TypeCheckTreeList(TREE_for_init(t), cont);
-            TypeCheckTreeList(TREE_for_det(t), cont);
-            TypeCheckTreeList(TREE_for_step(t), cont);
-            TypeCheckTreeList(TREE_for_body(t), cont);
-            break;
+            return fetchKid(idx, kid, 4, TREE_for_init(t), TREE_for_det(t),
+                            TREE_for_step(t), TREE_for_body(t));
         case TR_SWITCH:
-            TypeCheckTreeList(TREE_switch_det(t), cont);
-            TypeCheckTreeList(TREE_switch_body(t), cont);
-            break;
-        case TR_BREAK:
-        case TR_CONTINUE:
-        case TR_GOTO:
-        case TR_LABEL:
-        case TR_DEFAULT:
-        case TR_CASE:
-            break;
+            return fetchKid(idx, kid, 2, TREE_switch_det(t),
+                            TREE_switch_body(t));
         case TR_RETURN:
-            TypeCheckTreeList(TREE_ret_exp(t), cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_ret_exp(t));
         case TR_COND:      //formulized log_OR_exp?exp:cond_exp
-            TypeCheckTreeList(TREE_det(t), cont);
-            TypeCheckTreeList(TREE_true_part(t), cont);
-            TypeCheckTreeList(TREE_false_part(t), cont);
-            break;
+            return fetchKid(idx, kid, 3, TREE_det(t), TREE_true_part(t),
+                            TREE_false_part(t));
         case TR_CVT:       //type convertion
-            TypeCheckTreeList(TREE_cast_exp(t), cont);
-            break;
-        case TR_TYPE_NAME: //user defined type or C standard type
-            break;
+            return fetchKid(idx, kid, 1, TREE_cast_exp(t));
         case TR_LDA:       // &a get address of 'a'
         case TR_DEREF:     // *p  dereferencing the pointer 'p'
         case TR_PLUS:      // +123
         case TR_MINUS:     // -123
         case TR_REV:       // Reverse
         case TR_NOT:       // get non-value
-            TypeCheckTreeList(TREE_lchild(t), cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_lchild(t));
         case TR_INC:       //++a
         case TR_POST_INC:  //a++
-            TypeCheckTreeList(TREE_inc_exp(t), cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_inc_exp(t));
         case TR_DEC:       //--a
         case TR_POST_DEC:  //a--
-            TypeCheckTreeList(TREE_dec_exp(t), cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_dec_exp(t));
         case TR_SIZEOF:    // sizeof(a)
-            TypeCheckTreeList(TREE_sizeof_exp(t), cont);
-            break;
+            return fetchKid(idx, kid, 1, TREE_sizeof_exp(t));
         case TR_CALL:
-            if (!checkCall(t, cont)) { goto FAILED; }
-            break;
+            return fetchKid(idx, kid, 2, TREE_para_list(t), TREE_fun_exp(t));
         case TR_ARRAY:
-            TypeCheckTreeList(TREE_array_base(t), cont);
-            TypeCheckTreeList(TREE_array_indx(t), cont);
-            break;
+            return fetchKid(idx, kid, 2, TREE_array_base(t),
+                            TREE_array_indx(t));
+        case TR_BREAK:
+        case TR_CONTINUE:
+        case TR_GOTO:
+        case TR_LABEL:
+        case TR_DEFAULT:
+        case TR_CASE:
+        case TR_TYPE_NAME: //user defined type or C standard type
         case TR_DMEM:      // a.b
         case TR_INDMEM:    // a->b
         case TR_PRAGMA:
@@ -354,10 +347,43 @@ INT TypeCheckTreeList(Tree * t, TYCtx * cont)
             break;
         default: ASSERTN(0, ("unknown tree type:%d", TREE_type(t)));
         }
+        return false;
+    }
+
+    WALK_ACT visitPost(TypeCheckFrame & f, TypeCheckFrame *)
+    {
+        Tree * t = f.tree;
+        if (TREE_type(t) == TR_ASSIGN) {
+            TypeCheckAssign(t, m_ctx);
+        } else if (TREE_type(t) == TR_CALL && !checkCall(t, m_ctx)) {
+            return WALK_ABORT;
+        }
+        return WALK_CONT;
+    }
+};
+
+
+//Perform type checking.
+INT TypeCheckTreeList(Tree * t, TYCtx * cont)
+{
+    TYCtx ct;
+    if (cont == nullptr) {
+        cont = &ct;
+    }
+    TypeCheckVisitor v(cont);
+    TreeWalker<TypeCheckVisitor, TypeCheckData> w(v);
+    return w.walk(t, true) ? ST_SUCC : ST_ERR;
+}
+
+
+static void TypeCheckDeclInit(Decl const* decl, TYCtx * cont)
+{
+    for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
+        if (!is_initialized(dcl)) { continue; }
+        Tree * inittree = get_decl_init_tree(dcl);
+        ASSERT0(inittree);
+        TypeCheckTreeList(inittree, cont);    
     }
-    return ST_SUCC;
-FAILED:
-    return ST_ERR;
 }
 
 
@@ -373,7 +399,7 @@ INT TypeCheck()
             TypeCheckDeclInit(SCOPE_decl_list(DECL_fun_body(dcl)), nullptr);
             Tree * stmt = SCOPE_stmt_list(DECL_fun_body(dcl));
             TypeCheckTreeList(stmt, nullptr);
-            if (g_err_msg_list.get_elem_count() > 0) {
+            if (get_err_count() > 0) {
                 st = ST_ERR;
                 break;
             }
@@ -50,7 +50,8 @@ static INT process_struct_init(TypeSpec * ty, Tree ** init);
 static INT process_union_init(TypeSpec * ty, Tree ** init);
 static INT process_base_init(TypeSpec * ty, Tree ** init);
 static TypeSpec * buildBaseTypeSpec(INT des);
-static INT TypeTran(Tree * t, TYCtx * cont);
+static INT TypeTran(Tree * t);
+static INT TypeTranNode(Tree * t, TYCtx * cont);
 
 //Go through the init tree , 'dcl' must be DCL_ARRAY
 //NOTE: compute_array_dim() should be invoked.
@@ -543,18 +544,18 @@ static Decl * buildPointerType(TypeSpec * ty)
 static bool checkAssign(Tree const* t, Decl * ld, Decl *)
 {
     ASSERT0(t && ld);
-    StrBuf buf(64);
+    SmallStrBuf<64> buf;
     if (is_array(ld)) {
         format_declaration(buf, ld);
-        err(TREE_lineno(t), "illegal '%s', left operand must be l-value",
-            buf.buf);
+        errLoc(TREE_loc(t), "illegal '%s', left operand must be l-value",
+               buf.buf);
         return false;
     }
 
     if (IS_CONST(DECL_spec(ld))) {
         format_declaration(buf, ld);
-        err(TREE_lineno(t),
-            "illegal '%s', l-value specifies const object", buf.buf);
+        errLoc(TREE_loc(t),
+               "illegal '%s', l-value specifies const object", buf.buf);
         return false;
     }
 
@@ -602,7 +603,7 @@ static void insertCvtForParams(Tree * t)
 static bool findAndRefillStructUnionField(Decl const* base,
                                           Sym const* field_name,
                                           OUT Decl ** field_decl,
-                                          INT lineno)
+                                          SrcLoc loc)
 {
     TypeSpec * base_spec = DECL_spec(base);
     Aggr * s = TYPE_aggr_type(base_spec);
@@ -625,12 +626,12 @@ static bool findAndRefillStructUnionField(Decl const* base,
 
         if (field_list == nullptr) {
             //Not find field.
-            StrBuf buf(64);
+            SmallStrBuf<64> buf;
             format_struct_union_complete(buf, base_spec);
-            err(lineno,
-                " '%s' is an empty %s, '%s' is not its field",
-                buf.buf, get_aggr_type_name(base_spec),
-                SYM_name(field_name));
+            errLoc(loc,
+                   " '%s' is an empty %s, '%s' is not its field",
+                   buf.buf, get_aggr_type_name(base_spec),
+                   SYM_name(field_name));
             return false;
         }
     }
@@ -673,11 +674,11 @@ static INT TypeTranIDField(Tree * t, Decl ** field_decl, TYCtx * cont)
     ASSERTN(base, ("should be struct/union type"));
 
     if (!findAndRefillStructUnionField(base, TREE_id(t), field_decl,
-                                       TREE_lineno(t))) {
-        StrBuf buf(64);
+                                       TREE_loc(t))) {
+        SmallStrBuf<64> buf;
         format_struct_union_complete(buf, DECL_spec(base));
-        err(TREE_lineno(t), " '%s' : is not a member of type '%s'",
-            SYM_name(TREE_id(t)), buf.buf);
+        errLoc(TREE_loc(t), " '%s' : is not a member of type '%s'",
+               SYM_name(TREE_id(t)), buf.buf);
         return ST_ERR;
     }
     ASSERT0(*field_decl);
@@ -722,37 +723,37 @@ static INT TypeTranID(Tree * t, TYCtx * cont)
 
         //Check bitfield properties.
         if (is_pointer(id_decl)) {
-            StrBuf buf(64);
+            SmallStrBuf<64> buf;
             format_declaration(buf, id_decl);
-            err(TREE_lineno(t),
-                "'%s' : pointer cannot assign bit length", buf.buf);
+            errLoc(TREE_loc(t),
+                   "'%s' : pointer cannot assign bit length", buf.buf);
             return ST_ERR;
         }
 
         if (is_array(id_decl)) {
-            StrBuf buf(64);
+            SmallStrBuf<64> buf;
             format_declaration(buf, id_decl);
-            err(TREE_lineno(t),
-                "'%s' : array type cannot assign bit length", buf.buf);
+            errLoc(TREE_loc(t),
+                   "'%s' : array type cannot assign bit length", buf.buf);
             return ST_ERR;
         }
 
         if (!is_integer(id_decl)) {
-            StrBuf buf(64);
+            SmallStrBuf<64> buf;
             format_declaration(buf, id_decl);
-            err(TREE_lineno(t), "'%s' : bit field must have integer type",
-                buf.buf);
+            errLoc(TREE_loc(t), "'%s' : bit field must have integer type",
+                   buf.buf);
             return ST_ERR;
         }
 
         //Check bitfield's base type is big enough to hold it.
         INT size = get_decl_size(id_decl) * BIT_PER_BYTE;
         if (size < DECL_bit_len(declarator)) {
-            StrBuf buf(64);
+            SmallStrBuf<64> buf;
             format_declaration(buf, id_decl);
-            err(TREE_lineno(t),
-                "'%s' : type of bit field too small for number of bits",
-                buf.buf);
+            errLoc(TREE_loc(t),
+                   "'%s' : type of bit field too small for number of bits",
+                   buf.buf);
             return ST_ERR;
         }
     }
@@ -797,18 +798,24 @@ static INT TypeTranID(Tree * t, TYCtx * cont)
 }
 
 
+//The function handles the field of struct/union access.
+static INT TypeTranField(Tree * t, TYCtx * cont)
+{
+    ASSERT0(t && TREE_type(t) == TR_ID && TREE_nsib(t) == nullptr);
+    g_src_line_num = TREE_lineno(t);
+    return TypeTranID(t, cont);
+}
+
+
 //The function handles dereference of pointer.
 static INT TypeTranDeref(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) {
-        return ST_ERR;
-    }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_lchild(t));
     if (!is_pointer(ld) && !is_array(ld)) {
-        err(TREE_lineno(t), "Illegal dereferencing operation, "
-            "indirection operation should operate on pointer type.");
+        errLoc(TREE_loc(t), "Illegal dereferencing operation, "
+               "indirection operation should operate on pointer type.");
         return ST_ERR;
     }
 
@@ -827,7 +834,7 @@ static INT TypeTranDeref(Tree * t, TYCtx * cont)
     } else if (DECL_dt(ld) == DCL_FUN) {
         //ACCEPT
     } else {
-        err(TREE_lineno(t), "illegal indirection");
+        errLoc(TREE_loc(t), "illegal indirection");
         return ST_ERR;
     }
     TREE_result_type(t) = td;
@@ -838,9 +845,7 @@ static INT TypeTranDeref(Tree * t, TYCtx * cont)
 static INT TypeTranMulti(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) { return ST_ERR; }
-    if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_lchild(t));
     Decl * rd = TREE_result_type(TREE_rchild(t));
     if (TREE_token(t) == T_ASTERISK || TREE_token(t) == T_DIV) {
@@ -848,8 +853,8 @@ static INT TypeTranMulti(Tree * t, TYCtx * cont)
             //arithmetic operation
             TREE_result_type(t) = buildBinaryOpType(TREE_type(t), ld, rd);
         } else {
-            err(TREE_lineno(t), "illegal operation for '%s'",
-                getTokenName(TREE_token(TREE_rchild(t))));
+            errLoc(TREE_loc(t), "illegal operation for '%s'",
+                   getTokenName(TREE_token(TREE_rchild(t))));
             return ST_ERR;
         }
     } else {
@@ -857,7 +862,7 @@ static INT TypeTranMulti(Tree * t, TYCtx * cont)
             //arithmetic operation
             TREE_result_type(t) = buildBinaryOpType(TREE_type(t), ld, rd);
         } else {
-            err(TREE_lineno(t), "illegal operation for '%%'");
+            errLoc(TREE_loc(t), "illegal operation for '%%'");
             return ST_ERR;
         }
     }
@@ -868,40 +873,37 @@ static INT TypeTranMulti(Tree * t, TYCtx * cont)
 static INT TypeTranCond(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_det(t), cont)) { return ST_ERR; }
-    if (ST_SUCC != TypeTran(TREE_true_part(t), cont)) { return ST_ERR; }
-    if (ST_SUCC != TypeTran(TREE_false_part(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * td = TREE_result_type(TREE_true_part(t));
     Decl * fd = TREE_result_type(TREE_false_part(t));
     ASSERT0(td && fd);
     if (is_pointer(td) && !is_pointer(fd)) {
         if (!is_imm_int(TREE_false_part(t)) ||
             TREE_imm_val(TREE_false_part(t)) != 0) {
-            err(TREE_lineno(t),
-                "no conversion from pointer to non-pointer");
+            errLoc(TREE_loc(t),
+                   "no conversion from pointer to non-pointer");
             return ST_ERR;
         }
     } else if (!is_pointer(td) && is_pointer(fd)) {
         if (!is_imm_int(TREE_true_part(t)) ||
             TREE_imm_val(TREE_true_part(t)) != 0) {
-            err(TREE_lineno(t),
-                "no conversion from pointer to non-pointer");
+            errLoc(TREE_loc(t),
+                   "no conversion from pointer to non-pointer");
             return ST_ERR;
         }
     } else if (is_array(td) && !is_array(fd)) {
-        err(TREE_lineno(t), "no conversion from array to non-array");
+        errLoc(TREE_loc(t), "no conversion from array to non-array");
         return ST_ERR;
     } else if (!is_array(td) && is_array(fd)) {
-        err(TREE_lineno(t), "no conversion from non-array to array");
+        errLoc(TREE_loc(t), "no conversion from non-array to array");
         return ST_ERR;
     } else if (is_struct(td) && !is_struct(fd)) {
-        err(TREE_lineno(t),
-            "can not select between struct and non-struct");
+        errLoc(TREE_loc(t),
+               "can not select between struct and non-struct");
         return ST_ERR;
     } else if (is_union(td) && !is_union(fd)) {
-        err(TREE_lineno(t),
-            "can not select between union and non-union");
+        errLoc(TREE_loc(t),
+               "can not select between union and non-union");
         return ST_ERR;
     }
 
@@ -914,18 +916,17 @@ static INT TypeTranCond(Tree * t, TYCtx * cont)
 static INT TypeTranPreAndPostInc(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_inc_exp(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * d = TREE_result_type(TREE_inc_exp(t));
     if (!is_arith(d) && !is_pointer(d)) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         format_declaration(buf, d);
         if (TREE_type(t) == TR_INC) {
-            err(TREE_lineno(t),
-                "illegal prefixed '++', for type '%s'", buf.buf);
+            errLoc(TREE_loc(t),
+                   "illegal prefixed '++', for type '%s'", buf.buf);
         } else {
-            err(TREE_lineno(t),
-                "illegal postfix '++', for type '%s'", buf.buf);
+            errLoc(TREE_loc(t),
+                   "illegal postfix '++', for type '%s'", buf.buf);
         }
     }
     TREE_result_type(t) = d;
@@ -936,18 +937,17 @@ static INT TypeTranPreAndPostInc(Tree * t, TYCtx * cont)
 static INT TypeTranPreAndPostDec(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_dec_exp(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * d = TREE_result_type(TREE_dec_exp(t));
     if (!is_arith(d) && !is_pointer(d)) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         format_declaration(buf, d);
         if (TREE_type(t) == TR_DEC) {
-            err(TREE_lineno(t),
-                "illegal prefixed '--' for type '%s'", buf.buf);
+            errLoc(TREE_loc(t),
+                   "illegal prefixed '--' for type '%s'", buf.buf);
         } else {
-            err(TREE_lineno(t),
-                "illegal postfix '--' for type '%s'", buf.buf);
+            errLoc(TREE_loc(t),
+                   "illegal postfix '--' for type '%s'", buf.buf);
         }
     }
     TREE_result_type(t) = d;
@@ -955,12 +955,13 @@ static INT TypeTranPreAndPostDec(Tree * t, TYCtx * cont)
 }
 
 
-static INT TypeTranSizeof(Tree * t, TYCtx * cont)
+//The function prepares the operand of sizeof before it is translated.
+static INT TypeTranSizeofKid(Tree * t)
 {
     ASSERT0(t);
     Tree * kid = TREE_sizeof_exp(t);
     if (kid == nullptr) {
-        err(TREE_lineno(t), "miss expression after sizeof");
+        errLoc(TREE_loc(t), "miss expression after sizeof");
         return ST_ERR;
     }
 
@@ -974,54 +975,55 @@ static INT TypeTranSizeof(Tree * t, TYCtx * cont)
             TREE_type_name(kid) = type_name;
         }
     }
+    return ST_SUCC;
+}
+
 
+static INT TypeTranSizeof(Tree * t, TYCtx * cont)
+{
+    ASSERT0(t);
+    Tree * kid = TREE_sizeof_exp(t);
     INT size;
     if (TREE_type(kid) == TR_TYPE_NAME) {
         ASSERT0(TREE_type_name(kid));
         size = get_decl_size(TREE_type_name(kid));
     } else {
-        if (ST_SUCC != TypeTran(kid, cont)) { 
-            return ST_ERR;
-        }
         ASSERT0(TREE_result_type(kid));
         size = get_decl_size(TREE_result_type(kid));
     }
     ASSERT0(size != 0);
     TREE_type(t) = TR_IMMU;
     TREE_imm_val(t) = size;
-    return TypeTran(t, cont);
+    return TypeTranNode(t, cont);
 }
 
 
 static INT TypeTranInDMem(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_base_region(t), cont)) {
-        return ST_ERR;
-    }
-
     Decl * ld = TREE_result_type(TREE_base_region(t));
     ASSERTN(TREE_type(TREE_field(t)) == TR_ID, ("illegal TR_INDMEM node!!"));
     if (!IS_STRUCT(DECL_spec(ld)) && !IS_UNION(DECL_spec(ld))) {
-        err(TREE_lineno(t), "left of '->' must have struct/union type");
+        errLoc(TREE_loc(t), "left of '->' must have struct/union type");
         return ST_ERR;
     }
 
     cont->is_field = true;
     cont->base_tree_node = TREE_base_region(t);
-    if (ST_SUCC != TypeTran(TREE_field(t), cont)) {
+    INT st = TypeTranField(TREE_field(t), cont);
+    cont->base_tree_node = nullptr;
+    cont->is_field = false;
+    if (ST_SUCC != st) {
         return ST_ERR;
     }
 
     Decl * rd = TREE_result_type(TREE_field(t));
-    cont->base_tree_node = nullptr;
-    cont->is_field = false;
 
     if (!is_pointer(ld)) {
         xoc::Sym * sym = get_decl_sym(TREE_id_decl(TREE_field(t)));
-        err(TREE_lineno(t),
-            "'->%s' : left operand has 'struct' type, use '.'",
-            SYM_name(sym));
+        errLoc(TREE_loc(t),
+               "'->%s' : left operand has 'struct' type, use '.'",
+               SYM_name(sym));
         return ST_ERR;
     }
 
@@ -1034,33 +1036,30 @@ static INT TypeTranInDMem(Tree * t, TYCtx * cont)
 static INT TypeTranDMem(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_base_region(t), cont)) {
-        return ST_ERR; 
-    }
-
     Decl * ld = TREE_result_type(TREE_base_region(t));
     ASSERTN(TREE_type(TREE_field(t)) == TR_ID, ("illegal TR_DMEM node!!"));
     if (!IS_STRUCT(DECL_spec(ld)) && !IS_UNION(DECL_spec(ld))) {
-        err(TREE_lineno(t),
-            "left of field access operation '.' must be struct/union type");
+        errLoc(TREE_loc(t),
+               "left of field access operation '.' must be struct/union type");
         return ST_ERR; 
     }
  
     cont->is_field = true;
     cont->base_tree_node = TREE_base_region(t);
-    if (ST_SUCC != TypeTran(TREE_field(t), cont)) {
+    INT st = TypeTranField(TREE_field(t), cont);
+    cont->base_tree_node = nullptr;
+    cont->is_field = false;
+    if (ST_SUCC != st) {
         return ST_ERR; 
     }
 
     Decl * rd = TREE_result_type(TREE_field(t));
-    cont->base_tree_node = nullptr;
-    cont->is_field = false;
  
     if (is_pointer(ld)) {
         Sym * sym = get_decl_sym(TREE_id_decl(TREE_field(t)));
-        err(TREE_lineno(t),
-            "'.%s' : left operand points to 'struct' type, should use '->'",
-            SYM_name(sym));
+        errLoc(TREE_loc(t),
+               "'.%s' : left operand points to 'struct' type, should use '->'",
+               SYM_name(sym));
         return ST_ERR; 
     }
 
@@ -1078,21 +1077,15 @@ static INT TypeTranArray(Tree * t, TYCtx * cont)
     //e.g:
     //    int ** p;
     //    p[i][j] = 10;
-    if (ST_SUCC != TypeTran(TREE_array_base(t), cont)) {
-        return ST_ERR;
-    }
-    if (ST_SUCC != TypeTran(TREE_array_indx(t), cont)) {
-        return ST_ERR;
-    }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_array_base(t));
 
     //Return sub-dimension of base if 'ld' is
     //multi-dimensional array.
     Decl * td = cp_type_name(ld);
     if (PURE_DECL(td) == nullptr) {
-        err(TREE_lineno(t),
-            "The referrence of array is not match with its declaration.");
+        errLoc(TREE_loc(t),
+               "The referrence of array is not match with its declaration.");
     } else if (DECL_dt(PURE_DECL(td)) == DCL_ARRAY ||
                DECL_dt(PURE_DECL(td)) == DCL_POINTER) {
         xcom::removehead(&PURE_DECL(td));
@@ -1105,13 +1098,7 @@ static INT TypeTranArray(Tree * t, TYCtx * cont)
 static INT TypeTranCall(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_para_list(t), cont)) {
-        return ST_ERR;
-    }
-    if (ST_SUCC != TypeTran(TREE_fun_exp(t), cont)) {
-        return ST_ERR;
-    }
-
+    DUMMYUSE(cont);
     insertCvtForParams(t);
     Decl * ld = TREE_result_type(TREE_fun_exp(t));
     ASSERTN(DECL_dt(ld) == DCL_TYPE_NAME, ("expect TypeSpec-NAME"));
@@ -1143,31 +1130,24 @@ static INT TypeTranCall(Tree * t, TYCtx * cont)
 static INT TypeTranAdditive(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) {
-        return ST_ERR;
-    }
-
-    if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) {
-        return ST_ERR;
-    }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_lchild(t));
     Decl * rd = TREE_result_type(TREE_rchild(t));
     if (TREE_token(t) == T_ADD) { // '+'
         if (is_pointer(ld) && is_pointer(rd)) {
-            err(TREE_lineno(t), "can not add two pointers");
+            errLoc(TREE_loc(t), "can not add two pointers");
             return ST_ERR;
         }
 
         if (is_array(ld) && is_array(rd)) {
-            err(TREE_lineno(t), "can not add two arrays");
+            errLoc(TREE_loc(t), "can not add two arrays");
             return ST_ERR;
         }
 
         if (!is_pointer(ld)) {
             if (is_struct(ld) || is_union(rd)) {
-                err(TREE_lineno(t), "illegal '%s' for struct/union",
-                    getTokenName(TREE_token(t)));
+                errLoc(TREE_loc(t), "illegal '%s' for struct/union",
+                       getTokenName(TREE_token(t)));
                 return ST_ERR;
             }
         }
@@ -1200,23 +1180,23 @@ static INT TypeTranAdditive(Tree * t, TYCtx * cont)
 
     if (TREE_token(t) == T_SUB) { // '-'
         if (!is_pointer(ld) && is_pointer(rd)) {
-            err(TREE_lineno(t),
-                "pointer can only be subtracted from another pointer");
+            errLoc(TREE_loc(t),
+                   "pointer can only be subtracted from another pointer");
             return ST_ERR;
         }
 
         if (!is_pointer(ld)) {
             if (is_struct(DECL_spec(ld)) || is_union(DECL_spec(ld))) {
-                err(TREE_lineno(t), "illegal '%s' for struct/union",
-                    getTokenName(TREE_token(t)));
+                errLoc(TREE_loc(t), "illegal '%s' for struct/union",
+                       getTokenName(TREE_token(t)));
                 return ST_ERR;
             }
         }
 
         if (!is_pointer(rd)) {
             if (is_struct(DECL_spec(rd)) || is_union(DECL_spec(rd))) {
-                err(TREE_lineno(t), "illegal '%s' for struct/union",
-                    getTokenName(TREE_token(t)));
+                errLoc(TREE_loc(t), "illegal '%s' for struct/union",
+                       getTokenName(TREE_token(t)));
                 return ST_ERR;
             }
         }
@@ -1242,31 +1222,12 @@ static INT TypeTranAdditive(Tree * t, TYCtx * cont)
 }
 
 
-static INT TypeTranDeclInit(Decl const* decl, TYCtx * cont)
-{
-    for (Decl const* dcl = decl; dcl != nullptr; dcl = DECL_next(dcl)) {
-        if (!is_initialized(dcl)) { continue; }
-        Tree * inittree = get_decl_init_tree(dcl);
-        ASSERT0(inittree);
-        if (ST_SUCC != TypeTran(inittree, cont)) {
-            return ST_ERR;
-        } 
-    }
-    return ST_SUCC;
-}
-
-
 static INT TypeTranAssign(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
     // one of   '='   '*='   '/='   '%='  '+='
     //          '-='  '<<='  '>>='  '&='  '^='  '|='
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) {
-        return ST_ERR;
-    }
-    if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) {
-        return ST_ERR;
-    }
+    DUMMYUSE(cont);
     if (!checkAssign(t, TREE_result_type(TREE_lchild(t)),
                      TREE_result_type(TREE_rchild(t)))) {
         return ST_ERR;
@@ -1279,31 +1240,29 @@ static INT TypeTranAssign(Tree * t, TYCtx * cont)
 static INT TypeTranBinaryLogical(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) { return ST_ERR; }
-    if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_lchild(t));
     Decl * rd = TREE_result_type(TREE_rchild(t));
     if (is_pointer(ld) || is_array(ld)) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         format_declaration(buf,ld);
-        err(TREE_lineno(t), "illegal '%s', left operand has type '%s'",
-            getTokenName(TREE_token(TREE_lchild(t))), buf.buf);
+        errLoc(TREE_loc(t), "illegal '%s', left operand has type '%s'",
+               getTokenName(TREE_token(TREE_lchild(t))), buf.buf);
         return ST_ERR;
     }
 
     if (is_pointer(rd) || is_array(rd)) {
-        StrBuf buf(64);
+        SmallStrBuf<64> buf;
         format_declaration(buf,rd);
-        err(TREE_lineno(t), "illegal '%s', right operand has type '%s'",
-            getTokenName(TREE_token(TREE_rchild(t))), buf.buf);
+        errLoc(TREE_loc(t), "illegal '%s', right operand has type '%s'",
+               getTokenName(TREE_token(TREE_rchild(t))), buf.buf);
         return ST_ERR;
     }
 
     if (is_struct(DECL_spec(ld)) || is_struct(DECL_spec(rd)) ||
         is_union(DECL_spec(ld)) || is_union(DECL_spec(rd))) {
-        err(TREE_lineno(t), "illegal '%s' for struct/union",
-            getTokenName(TREE_token(TREE_rchild(t))));
+        errLoc(TREE_loc(t), "illegal '%s' for struct/union",
+               getTokenName(TREE_token(TREE_rchild(t))));
         return ST_ERR;
     }
     TREE_result_type(t) = buildBinaryOpType(TREE_type(t), ld, rd);
@@ -1314,24 +1273,22 @@ static INT TypeTranBinaryLogical(Tree * t, TYCtx * cont)
 static INT TypeTranBinaryRelation(Tree * t, TYCtx * cont)
 {
     ASSERT0(t);
-    if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) { return ST_ERR; }
-    if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) { return ST_ERR; }
-
+    DUMMYUSE(cont);
     Decl * ld = TREE_result_type(TREE_lchild(t));
     Decl * rd = TREE_result_type(TREE_rchild(t));
     ASSERT0(ld && rd);
     if ((is_struct(DECL_spec(ld)) || is_union(DECL_spec(ld))) &&
         !is_pointer(ld)) {
-        err(TREE_lineno(t),
-            "can not do '%s' operation for struct/union.",
-            getTokenName(TREE_token(t)));
+        errLoc(TREE_loc(t),
+               "can not do '%s' operation for struct/union.",
+               getTokenName(TREE_token(t)));
         return ST_ERR;
     }
     if ((is_struct(DECL_spec(rd)) || is_union(DECL_spec(rd))) &&
         !is_pointer(rd)) {
-        err(TREE_lineno(t),
-            "can not do '%s' operation for struct/union.",
-            getTokenName(TREE_token(t)));
+        errLoc(TREE_loc(t),
+               "can not do '%s' operation for struct/union.",
+               getTokenName(TREE_token(t)));
         return ST_ERR;
     }
     TREE_result_type(t) = BUILD_TYNAME(T_SPEC_UNSIGNED | T_SPEC_CHAR);
@@ -1347,274 +1304,364 @@ static INT TypeTranInitValScope(Tree * t, TYCtx * cont)
     Decl * decl = TREE_id_decl(TREE_lchild(TREE_parent(t)));
     ASSERT0(decl);
     ASSERT0(is_array(decl) || is_struct(decl) || is_union(decl));
-    TypeTran(TREE_initval_scope(t), nullptr);
+    DUMMYUSE(cont);
     TREE_result_type(t) = decl;
     return ST_SUCC;
 }
 
 
-//Transfering type declaration for all AST nodes.
-static INT TypeTran(Tree * t, TYCtx * cont)
+//Transfering type declaration for 't'.
+//The kids of 't' have been translated.
+static INT TypeTranNode(Tree * t, TYCtx * cont)
+{
+    ASSERT0(t && cont);
+    switch (TREE_type(t)) {
+    case TR_ASSIGN:
+        if (ST_SUCC != TypeTranAssign(t, cont)) { goto FAILED; }
+        break;
+    case TR_ID:
+        if (ST_SUCC != TypeTranID(t, cont)) { goto FAILED; }
+        break;
+    case TR_IMM:
+        if (GET_HIGH_32BIT(TREE_imm_val(t)) != 0) {
+            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_LONGLONG|T_QUA_CONST);
+        } else {
+            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_INT|T_QUA_CONST);
+        }
+        break;
+    case TR_IMMU:
+        if (GET_HIGH_32BIT(TREE_imm_val(t)) != 0) {
+            TREE_result_type(t) = BUILD_TYNAME(
+                T_SPEC_UNSIGNED|T_SPEC_LONGLONG|T_QUA_CONST);
+        } else {
+            TREE_result_type(t) = BUILD_TYNAME(
+                T_SPEC_UNSIGNED|T_SPEC_INT|T_QUA_CONST);
+        }
+        break;
+    case TR_IMML:
+        TREE_result_type(t) = BUILD_TYNAME(T_SPEC_LONGLONG|T_QUA_CONST);
+        break;
+    case TR_IMMUL:
+        TREE_result_type(t) = BUILD_TYNAME(
+            T_SPEC_UNSIGNED|T_SPEC_LONGLONG|T_QUA_CONST);
+        break;
+    case TR_FP:
+    case TR_FPLD:
+        TREE_result_type(t) = BUILD_TYNAME(T_SPEC_DOUBLE|T_QUA_CONST);
+        break;
+    case TR_FPF:
+        TREE_result_type(t) = BUILD_TYNAME(T_SPEC_FLOAT|T_QUA_CONST);
+        break;
+    case TR_ENUM_CONST:
+        TREE_result_type(t) = BUILD_TYNAME(T_SPEC_ENUM|T_QUA_CONST);
+        break;
+    case TR_STRING: {
+        Decl * tn = BUILD_TYNAME(T_SPEC_CHAR|T_QUA_CONST);
+        Decl * d = new_decl(DCL_ARRAY);
+        ASSERT0(TREE_string_val(t));
+        DECL_array_dim(d) = strlen(SYM_name(TREE_string_val(t))) + 1;
+        xcom::add_next(&PURE_DECL(tn), d);
+        TREE_result_type(t) = tn;
+        break;
+    }
+    case TR_LOGIC_OR: //logical or ||
+    case TR_LOGIC_AND: //logical and &&
+        TREE_result_type(t) = BUILD_TYNAME(T_SPEC_UNSIGNED|T_SPEC_CHAR);
+        break;
+    case TR_INCLUSIVE_OR: //inclusive or |
+    case TR_XOR: //exclusive or
+    case TR_INCLUSIVE_AND: //inclusive and &
+    case TR_SHIFT: // >> <<
+        if (ST_SUCC != TypeTranBinaryLogical(t, cont)) { goto FAILED; }
+        break;
+    case TR_EQUALITY: // == !=
+    case TR_RELATION: // < > >= <=
+        if (ST_SUCC != TypeTranBinaryRelation(t, cont)) { goto FAILED; }
+        break;
+    case TR_ADDITIVE: // '+' '-'
+        if (ST_SUCC != TypeTranAdditive(t, cont)) { goto FAILED; }
+        break;
+    case TR_MULTI: // '*' '/' '%'
+        if (ST_SUCC != TypeTranMulti(t, cont)) { goto FAILED; }
+        break;
+    case TR_INITVAL_SCOPE:
+        if (ST_SUCC != TypeTranInitValScope(t, cont)) { goto FAILED; }
+        break;
+    case TR_SCOPE:
+    case TR_IF:
+    case TR_DO:
+    case TR_WHILE:
+    case TR_FOR:
+    case TR_SWITCH:
+    case TR_BREAK:
+    case TR_CONTINUE:
+    case TR_GOTO:
+    case TR_LABEL:
+    case TR_DEFAULT:
+    case TR_CASE:
+        break;
+    case TR_RETURN:
+        break;
+    case TR_COND: //formulized log_OR_exp?exp:cond_exp
+        if (ST_SUCC != TypeTranCond(t, cont)) { goto FAILED; }
+        break;
+    case TR_CVT: { //type convertion
+        Decl * type_name = TREE_type_name(TREE_cvt_type(t));
+        if (IS_USER_TYPE_REF(DECL_spec(type_name))) {
+            //Expand the combined type here.
+            type_name = expand_user_type(type_name);
+            ASSERTN(is_valid_type_name(type_name),
+                    ("Illegal expanding user-type"));
+        }
+        TREE_result_type(t) = type_name;
+        break;
+    }
+    case TR_TYPE_NAME: //user defined type or C standard type
+        //TR_TYPE_NAME node should be process by its parent node directly.
+        ASSERTN(0, ("Should not be arrival"));
+        break;
+    case TR_LDA: {  // &a get address of 'a'
+        Decl * ld = TREE_result_type(TREE_lchild(t));
+        Decl * td = cp_type_name(ld);
+        insertafter(&PURE_DECL(td), new_decl(DCL_POINTER));
+        TREE_result_type(t) = td;
+        break;
+    }
+    case TR_DEREF: // *p dereferencing the pointer 'p'
+        if (ST_SUCC != TypeTranDeref(t, cont)) { goto FAILED; }
+        break;
+    case TR_PLUS: // +123
+    case TR_MINUS: { // -123
+        Decl * ld = TREE_result_type(TREE_lchild(t));
+        if (!is_arith(ld) || is_array(ld) || is_pointer(ld)) {
+            SmallStrBuf<64> buf;
+            format_declaration(buf,ld);
+            if (TREE_type(t) == TR_PLUS) {
+                errLoc(TREE_loc(t),
+                       "illegal positive '+' for type '%s'", buf.buf);
+            } else {
+                errLoc(TREE_loc(t),
+                       "illegal minus '-' for type '%s'", buf.buf);
+            }
+        }
+        TREE_result_type(t) = ld;
+        break;
+    }
+    case TR_REV: { // reverse
+        Decl * ld = TREE_result_type(TREE_lchild(t));
+        if (!is_integer(ld) || is_array(ld) || is_pointer(ld)) {
+            SmallStrBuf<64> buf;
+            format_declaration(buf,ld);
+            errLoc(TREE_loc(t),
+                   "illegal bit reverse operation for type '%s'", buf.buf);
+        }
+        TREE_result_type(t) = ld;
+        break;
+    }
+    case TR_NOT: { // get non-value
+        Decl * ld = TREE_result_type(TREE_lchild(t));
+        if (!is_arith(ld) && !is_pointer(ld)) {
+            SmallStrBuf<64> buf;
+            format_declaration(buf, ld);
+            errLoc(TREE_loc(t),
+                   "illegal logical not operation for type '%s'", buf.buf);
+        }
+        TREE_result_type(t) = ld;
+        break;
+    }
+    case TR_INC:   //++a
+    case TR_POST_INC: //a++
+        if (ST_SUCC != TypeTranPreAndPostInc(t, cont)) { goto FAILED; }
+        break;
+    case TR_DEC: //--a
+    case TR_POST_DEC: //a--
+        if (ST_SUCC != TypeTranPreAndPostDec(t, cont)) { goto FAILED; }
+        break;
+    case TR_SIZEOF: // sizeof(a)
+        if (ST_SUCC != TypeTranSizeof(t, cont)) { goto FAILED; }
+        break;
+    case TR_CALL:
+        if (ST_SUCC != TypeTranCall(t, cont)) { goto FAILED; }
+        break;
+    case TR_ARRAY:
+        if (ST_SUCC != TypeTranArray(t, cont)) { goto FAILED; }
+        break;
+    case TR_DMEM: // a.b
+        if (ST_SUCC != TypeTranDMem(t, cont)) { goto FAILED; }
+        break;
+    case TR_INDMEM: // a->b
+        if (ST_SUCC != TypeTranInDMem(t, cont)) { goto FAILED; }
+        break;
+    case TR_PRAGMA:
+    case TR_PREP:
+        break;
+    default: ASSERTN(0, ("unknown tree type:%d", TREE_type(t)));
+    }
+    return ST_SUCC;
+FAILED:
+    return ST_ERR;
+}
+
+
+//The data that attached to each frame of TypeTranVisitor.
+class TypeTranData {
+public:
+    //Record the next declaration whose initial value should be translated.
+    Decl const* decl;
+    //The number of kids that are initial values of declarations.
+    UINT init_num;
+};
+typedef TreeWalkFrame<TypeTranData> TypeTranFrame;
+
+
+//Fetch the initial value of declarations in 'f.data.decl' as kid.
+//Return false if there is no more initialized declaration.
+static bool fetchDeclInitKid(TypeTranFrame & f, OUT TypeTranFrame & kid)
 {
-    TYCtx ct;
-    if (cont == nullptr) {
-        cont = &ct;
+    Decl const* dcl = f.data.decl;
+    while (dcl != nullptr && !is_initialized(dcl)) {
+        dcl = DECL_next(dcl);
     }
-    while (t != nullptr) {
+    if (dcl == nullptr) {
+        f.data.decl = nullptr;
+        return false;
+    }
+    f.data.decl = DECL_next(dcl);
+    f.data.init_num++;
+    kid.tree = get_decl_init_tree(dcl);
+    ASSERT0(kid.tree);
+    return true;
+}
+
+
+class TypeTranVisitor {
+    COPY_CONSTRUCTOR(TypeTranVisitor);
+    TYCtx m_ctx;
+public:
+    TypeTranVisitor() {}
+
+    WALK_ACT visitPre(TypeTranFrame & f)
+    {
+        Tree * t = f.tree;
         g_src_line_num = TREE_lineno(t);
+        f.data.decl = nullptr;
+        f.data.init_num = 0;
         switch (TREE_type(t)) {
-        case TR_ASSIGN:
-            if (ST_SUCC != TypeTranAssign(t, cont)) { goto FAILED; }
-            break;
-        case TR_ID:
-            if (ST_SUCC != TypeTranID(t, cont)) { goto FAILED; }
-            break;
-        case TR_IMM:
-            if (GET_HIGH_32BIT(TREE_imm_val(t)) != 0) {
-                TREE_result_type(t) = BUILD_TYNAME(T_SPEC_LONGLONG|T_QUA_CONST);
-            } else {
-                TREE_result_type(t) = BUILD_TYNAME(T_SPEC_INT|T_QUA_CONST);
-            }
+        case TR_SCOPE:
+            f.data.decl = SCOPE_decl_list(TREE_scope(t));
             break;
-        case TR_IMMU:
-            if (GET_HIGH_32BIT(TREE_imm_val(t)) != 0) {
-                TREE_result_type(t) = BUILD_TYNAME(
-                    T_SPEC_UNSIGNED|T_SPEC_LONGLONG|T_QUA_CONST);
-            } else {
-                TREE_result_type(t) = BUILD_TYNAME(
-                    T_SPEC_UNSIGNED|T_SPEC_INT|T_QUA_CONST);
+        case TR_FOR:
+            if (TREE_for_scope(t) != nullptr) {
+                f.data.decl = SCOPE_decl_list(TREE_for_scope(t));
             }
             break;
-        case TR_IMML:
-            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_LONGLONG|T_QUA_CONST);
-            break;
-        case TR_IMMUL:
-            TREE_result_type(t) = BUILD_TYNAME(
-                T_SPEC_UNSIGNED|T_SPEC_LONGLONG|T_QUA_CONST);
-            break;
-        case TR_FP:
-        case TR_FPLD:
-            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_DOUBLE|T_QUA_CONST);
-            break;
-        case TR_FPF:
-            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_FLOAT|T_QUA_CONST);
-            break;
-        case TR_ENUM_CONST:
-            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_ENUM|T_QUA_CONST);
-            break;
-        case TR_STRING: {
-            Decl * tn = BUILD_TYNAME(T_SPEC_CHAR|T_QUA_CONST);
-            Decl * d = new_decl(DCL_ARRAY);
-            ASSERT0(TREE_string_val(t));
-            DECL_array_dim(d) = strlen(SYM_name(TREE_string_val(t))) + 1;
-            xcom::add_next(&PURE_DECL(tn), d);
-            TREE_result_type(t) = tn;
+        case TR_SIZEOF:
+            if (ST_SUCC != TypeTranSizeofKid(t)) { return WALK_ABORT; }
             break;
+        default:;
         }
-        case TR_LOGIC_OR: //logical or ||
-        case TR_LOGIC_AND: //logical and &&
-            if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) { goto FAILED; }
-            if (ST_SUCC != TypeTran(TREE_rchild(t), cont)) { goto FAILED; }
-            TREE_result_type(t) = BUILD_TYNAME(T_SPEC_UNSIGNED|T_SPEC_CHAR);
-            break;
-        case TR_INCLUSIVE_OR: //inclusive or |
-        case TR_XOR: //exclusive or
-        case TR_INCLUSIVE_AND: //inclusive and &
-        case TR_SHIFT: // >> <<
-            if (ST_SUCC != TypeTranBinaryLogical(t, cont)) { goto FAILED; }
-            break;
-        case TR_EQUALITY: // == !=
-        case TR_RELATION: // < > >= <=
-            if (ST_SUCC != TypeTranBinaryRelation(t, cont)) { goto FAILED; }
-            break;
-        case TR_ADDITIVE: // '+' '-'
-            if (ST_SUCC != TypeTranAdditive(t, cont)) { goto FAILED; }
-            break;
-        case TR_MULTI: // '*' '/' '%'
-            if (ST_SUCC != TypeTranMulti(t, cont)) { goto FAILED; }
-            break;
+        return WALK_CONT;
+    }
+
+    bool getKid(TypeTranFrame & f, OUT TypeTranFrame & kid)
+    {
+        Tree * t = f.tree;
+        UINT idx = f.kid_idx;
+        switch (TREE_type(t)) {
+        case TR_ASSIGN:
+        case TR_LOGIC_OR:
+        case TR_LOGIC_AND:
+        case TR_INCLUSIVE_OR:
+        case TR_XOR:
+        case TR_INCLUSIVE_AND:
+        case TR_SHIFT:
+        case TR_EQUALITY:
+        case TR_RELATION:
+        case TR_ADDITIVE:
+        case TR_MULTI:
+            return fetchKid(idx, kid, 2, TREE_lchild(t), TREE_rchild(t));
         case TR_INITVAL_SCOPE:
-            if (ST_SUCC != TypeTranInitValScope(t, cont)) { goto FAILED; }
-            break;
-        case TR_SCOPE: {
-            Scope * sc = TREE_scope(t);
-            if (ST_SUCC != TypeTranDeclInit(SCOPE_decl_list(sc), nullptr)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(SCOPE_stmt_list(sc), nullptr)) {
-                goto FAILED;
+            if (!fetchKid(idx, kid, 1, TREE_initval_scope(t))) {
+                return false;
             }
-            break;
-        }
+            //The failure of initial value does not terminate translation.
+            kid.is_barrier = true;
+            return true;
+        case TR_SCOPE:
+            if (fetchDeclInitKid(f, kid)) { return true; }
+            return fetchKid(idx - f.data.init_num, kid, 1,
+                            SCOPE_stmt_list(TREE_scope(t)));
         case TR_IF:
-            if (ST_SUCC != TypeTran(TREE_if_det(t), cont)) { goto FAILED; }
-            if (ST_SUCC != TypeTran(TREE_if_true_stmt(t), cont)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_if_false_stmt(t), cont)) {
-                goto FAILED;
-            }
-            break;
+            return fetchKid(idx, kid, 3, TREE_if_det(t),
+                            TREE_if_true_stmt(t), TREE_if_false_stmt(t));
         case TR_DO:
-            if (ST_SUCC != TypeTran(TREE_dowhile_det(t), cont)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_dowhile_body(t), cont)) {
-                goto FAILED;
-            }
-            break;
+            return fetchKid(idx, kid, 2, TREE_dowhile_det(t),
+                            TREE_dowhile_body(t));
         case TR_WHILE:
-            if (ST_SUCC != TypeTran(TREE_whiledo_det(t), cont)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_whiledo_body(t), cont)) {
-                goto FAILED;
-            }
-            break;
+            return fetchKid(idx, kid, 2, TREE_whiledo_det(t),
+                            TREE_whiledo_body(t));
         case TR_FOR:
-            if (TREE_for_scope(t) != nullptr &&
-                ST_SUCC != TypeTranDeclInit(
-                    SCOPE_decl_list(TREE_for_scope(t)), nullptr)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_for_init(t), nullptr)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_for_det(t), nullptr)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_for_step(t), nullptr)) {
-                goto FAILED;
-            }
-            if (ST_SUCC != TypeTran(TREE_for_body(t), nullptr)) {
-                goto FAILED;
-            }
-            break;
+            if (fetchDeclInitKid(f, kid)) { return true; }
+            return fetchKid(idx - f.data.init_num, kid, 4, TREE_for_init(t),
+                            TREE_for_det(t), TREE_for_step(t),
+                            TREE_for_body(t));
         case TR_SWITCH:
-            if (ST_SUCC != TypeTran(TREE_switch_det(t), nullptr)) {
-                goto FAILED; 
-            }
-            if (ST_SUCC != TypeTran(TREE_switch_body(t), nullptr)) {
-                goto FAILED;
-            }
-            break;
-        case TR_BREAK:
-        case TR_CONTINUE:
-        case TR_GOTO:
-        case TR_LABEL:
-        case TR_DEFAULT:
-        case TR_CASE:
-            break;
+            return fetchKid(idx, kid, 2, TREE_switch_det(t),
+                            TREE_switch_body(t));
         case TR_RETURN:
-            if (ST_SUCC != TypeTran(TREE_ret_exp(t), cont)) { goto FAILED; }
-            break;
-        case TR_COND: //formulized log_OR_exp?exp:cond_exp
-            if (ST_SUCC != TypeTranCond(t, cont)) { goto FAILED; }
-            break;
-        case TR_CVT: { //type convertion
-            if (ST_SUCC != TypeTran(TREE_cast_exp(t), cont)) { goto FAILED; }
-
-            Decl * type_name = TREE_type_name(TREE_cvt_type(t));
-            if (IS_USER_TYPE_REF(DECL_spec(type_name))) {
-                //Expand the combined type here.
-                type_name = expand_user_type(type_name);
-                ASSERTN(is_valid_type_name(type_name),
-                        ("Illegal expanding user-type"));
-            }
-            TREE_result_type(t) = type_name;
-            break;
-        }
-        case TR_TYPE_NAME: //user defined type or C standard type
-            //TR_TYPE_NAME node should be process by its parent node directly.
-            ASSERTN(0, ("Should not be arrival"));
-            break;
-        case TR_LDA: {  // &a get address of 'a'
-            if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) goto FAILED;
-            Decl * ld = TREE_result_type(TREE_lchild(t));
-            Decl * td = cp_type_name(ld);
-            insertafter(&PURE_DECL(td), new_decl(DCL_POINTER));
-            TREE_result_type(t) = td;
-            break;
-        }
-        case TR_DEREF: // *p dereferencing the pointer 'p'
-            if (ST_SUCC != TypeTranDeref(t, cont)) { goto FAILED; }
-            break;
-        case TR_PLUS: // +123
-        case TR_MINUS: { // -123
-            if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) goto FAILED;
-            Decl * ld = TREE_result_type(TREE_lchild(t));
-            if (!is_arith(ld) || is_array(ld) || is_pointer(ld)) {
-                StrBuf buf(64);
-                format_declaration(buf,ld);
-                if (TREE_type(t) == TR_PLUS) {
-                    err(TREE_lineno(t),
-                        "illegal positive '+' for type '%s'", buf.buf);
-                } else {
-                    err(TREE_lineno(t),
-                        "illegal minus '-' for type '%s'", buf.buf);
-                }
-            }
-            TREE_result_type(t) = ld;
-            break;
-        }
-        case TR_REV: { // reverse
-            if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) goto FAILED;
-            Decl * ld = TREE_result_type(TREE_lchild(t));
-            if (!is_integer(ld) || is_array(ld) || is_pointer(ld)) {
-                StrBuf buf(64);
-                format_declaration(buf,ld);
-                err(TREE_lineno(t),
-                    "illegal bit reverse operation for type '%s'", buf.buf);
-            }
-            TREE_result_type(t) = ld;
-            break;
-        }
-        case TR_NOT: { // get non-value
-            if (ST_SUCC != TypeTran(TREE_lchild(t), cont)) goto FAILED;
-
-            Decl * ld = TREE_result_type(TREE_lchild(t));
-            if (!is_arith(ld) && !is_pointer(ld)) {
-                StrBuf buf(64);
-                format_declaration(buf, ld);
-                err(TREE_lineno(t),
-                    "illegal logical not operation for type '%s'", buf.buf);
+            return fetchKid(idx, kid, 1, TREE_ret_exp(t));
+        case TR_COND:
+            return fetchKid(idx, kid, 3, TREE_det(t), TREE_true_part(t),
+                            TREE_false_part(t));
+        case TR_CVT:
+            return fetchKid(idx, kid, 1, TREE_cast_exp(t));
+        case TR_LDA:
+        case TR_DEREF:
+        case TR_PLUS:
+        case TR_MINUS:
+        case TR_REV:
+        case TR_NOT:
+            return fetchKid(idx, kid, 1, TREE_lchild(t));
+        case TR_INC:
+        case TR_POST_INC:
+            return fetchKid(idx, kid, 1, TREE_inc_exp(t));
+        case TR_DEC:
+        case TR_POST_DEC:
+            return fetchKid(idx, kid, 1, TREE_dec_exp(t));
+        case TR_SIZEOF:
+            //TR_TYPE_NAME is processed by sizeof directly.
+            if (TREE_type(TREE_sizeof_exp(t)) == TR_TYPE_NAME) {
+                return false;
             }
-            TREE_result_type(t) = ld;
-            break;
-        }
-        case TR_INC:   //++a
-        case TR_POST_INC: //a++
-            if (ST_SUCC != TypeTranPreAndPostInc(t, cont)) { goto FAILED; }
-            break;
-        case TR_DEC: //--a
-        case TR_POST_DEC: //a--
-            if (ST_SUCC != TypeTranPreAndPostDec(t, cont)) { goto FAILED; }
-            break;
-        case TR_SIZEOF: // sizeof(a)
-            if (ST_SUCC != TypeTranSizeof(t, cont)) { goto FAILED; }
-            break;
+            return fetchKid(idx, kid, 1, TREE_sizeof_exp(t));
         case TR_CALL:
-            if (ST_SUCC != TypeTranCall(t, cont)) { goto FAILED; }
-            break;
+            return fetchKid(idx, kid, 2, TREE_para_list(t), TREE_fun_exp(t));
         case TR_ARRAY:
-            if (ST_SUCC != TypeTranArray(t, cont)) { goto FAILED; }
-            break;
-        case TR_DMEM: // a.b
-            if (ST_SUCC != TypeTranDMem(t, cont)) { goto FAILED; }
-            break;
-        case TR_INDMEM: // a->b
-            if (ST_SUCC != TypeTranInDMem(t, cont)) { goto FAILED; }
-            break;
-        case TR_PRAGMA:
-        case TR_PREP:
-            break;
-        default: ASSERTN(0, ("unknown tree type:%d", TREE_type(t)));
+            return fetchKid(idx, kid, 2, TREE_array_base(t),
+                            TREE_array_indx(t));
+        case TR_DMEM:
+        case TR_INDMEM:
+            //Field is translated along with its parent.
+            return fetchKid(idx, kid, 1, TREE_base_region(t));
+        default:;
         }
-        t = TREE_nsib(t);
+        return false;
     }
-    return ST_SUCC;
-FAILED:
-    return ST_ERR;
+
+    WALK_ACT visitPost(TypeTranFrame & f, TypeTranFrame *)
+    {
+        return ST_SUCC == TypeTranNode(f.tree, &m_ctx) ?
+               WALK_CONT : WALK_ABORT;
+    }
+};
+
+
+//Transfering type declaration for all AST nodes in list 't'.
+static INT TypeTran(Tree * t)
+{
+    TypeTranVisitor v;
+    TreeWalker<TypeTranVisitor, TypeTranData> w(v);
+    return w.walk(t, true) ? ST_SUCC : ST_ERR;
 }
 
 
@@ -1677,10 +1724,10 @@ INT TypeTransform()
         ASSERT0(DECL_decl_scope(dcl) == s);
         if (DECL_is_fun_def(dcl)) {
             Tree * stmt = SCOPE_stmt_list(DECL_fun_body(dcl));
-            if (ST_SUCC != TypeTran(stmt, nullptr)) {
+            if (ST_SUCC != TypeTran(stmt)) {
                 return ST_ERR;
             }
-            if (g_err_msg_list.get_elem_count() > 0) {
+            if (get_err_count() > 0) {
                 return ST_ERR;
             }
         }
@@ -0,0 +1,487 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __ARR_LIST_H__
+#define __ARR_LIST_H__
+
+namespace xcom {
+
+//The number of slots that allocated at the first time, the slot array is
+//doubled when it is full.
+#define ALIST_INIT_SLOT_NUM 8
+
+//Indicate there is no slot.
+#define ALIST_NIL ((UINT)-1)
+
+//Handle of element in ArrList.
+//The handle keeps referring to the element until the element is removed.
+//The slot of removed element may be reused, the generation tells a stale
+//handle from the handle of the new element.
+class ALHandle {
+public:
+    UINT idx; //slot index.
+    UINT gen; //generation of slot when the handle is made.
+public:
+    ALHandle() { clean(); }
+    ALHandle(UINT i, UINT g) : idx(i), gen(g) {}
+    void clean() { idx = ALIST_NIL; gen = 0; }
+    bool is_null() const { return idx == ALIST_NIL; }
+};
+
+
+//Element slot of ArrList.
+template <class T> class ALSlot {
+public:
+    UINT prev; //previous slot in list, or ALIST_NIL.
+    UINT next; //next slot in list or in free list, or ALIST_NIL.
+    UINT gen; //increased when the slot is freed.
+    T value;
+};
+
+
+//ArrList
+//
+//This class represents double linked list that keeps elements in slots of
+//one contiguous array rather than allocating container for each element.
+//The links between elements are slot indices.
+//The interface is similar to List, and the differences are:
+//  1. Elements are referred by ALHandle, instead of C<T>*. Handles are
+//     32-bit slot indices plus generation, and a stale handle can be
+//     detected by is_valid().
+//  2. The slots of elements appended one after another are adjacent in
+//     memory, thus traversal is cache friendly. The slot array may be
+//     reallocated when it grows, whereas handles are not affected.
+//  3. Besides the internal cursor of get_head()/get_next(), ALHandle can
+//     be used as external iterator, that allows nested iteration.
+//  4. get_head_nth() is O(1) if elements are only appended to and removed
+//     from the tail of list, namely elements are placed in slots in order.
+//T: refer to element type.
+//NOTE: T(0) is treated as the default nullptr, and T is copied as plain
+//    data.
+template <class T> class ArrList {
+    COPY_CONSTRUCTOR(ArrList);
+protected:
+    typedef ALSlot<T> Slot;
+    UINT m_elem_count;
+    UINT m_slot_num; //the number of slots that have ever been used.
+    UINT m_slot_cap; //the number of slots allocated.
+    UINT m_head;
+    UINT m_tail;
+    UINT m_free; //free slots linked by 'next'.
+    UINT m_cur; //the cursor of get_head()/get_next().
+    //True if the i-th element is placed in the i-th slot.
+    bool m_is_seq;
+    Slot * m_slots;
+
+protected:
+    Slot * getSlot(UINT idx) const
+    {
+        ASSERT0(idx < m_slot_num);
+        return &m_slots[idx];
+    }
+
+    UINT allocSlot(T t)
+    {
+        UINT idx;
+        if (m_free != ALIST_NIL) {
+            idx = m_free;
+            m_free = getSlot(idx)->next;
+        } else {
+            idx = m_slot_num;
+            if (idx == m_slot_cap) {
+                grow();
+            }
+            m_slot_num++;
+        }
+        m_is_seq = m_is_seq && idx == m_elem_count;
+        m_elem_count++;
+        Slot * s = getSlot(idx);
+        s->prev = ALIST_NIL;
+        s->next = ALIST_NIL;
+        s->value = t;
+        return idx;
+    }
+
+    void freeSlot(UINT idx)
+    {
+        Slot * s = getSlot(idx);
+        s->gen++;
+        ASSERT0(m_elem_count > 0);
+        m_elem_count--;
+        if (m_elem_count == 0) {
+            //Place the next elements from the first slot again.
+            m_slot_num = 0;
+            m_free = ALIST_NIL;
+            m_is_seq = true;
+            return;
+        }
+        s->next = m_free;
+        m_free = idx;
+    }
+
+    //Double the slot array, the slots in use are kept in place.
+    void grow()
+    {
+        UINT cap = m_slot_cap == 0 ? ALIST_INIT_SLOT_NUM : m_slot_cap * 2;
+        ASSERTN(cap > m_slot_cap, ("too many slots"));
+        m_slots = (Slot*)::realloc((void*)m_slots, sizeof(Slot) * cap);
+        ASSERT0(m_slots);
+        ::memset((void*)(m_slots + m_slot_cap), 0,
+                 sizeof(Slot) * (cap - m_slot_cap));
+        m_slot_cap = cap;
+    }
+
+    ALHandle makeHandle(UINT idx) const
+    {
+        return idx == ALIST_NIL ? ALHandle() :
+               ALHandle(idx, getSlot(idx)->gen);
+    }
+
+    //Link slot 'idx' before slot 'marker'.
+    void linkBefore(UINT idx, UINT marker)
+    {
+        Slot * s = getSlot(idx);
+        Slot * m = getSlot(marker);
+        s->next = marker;
+        s->prev = m->prev;
+        if (m->prev != ALIST_NIL) {
+            getSlot(m->prev)->next = idx;
+        } else {
+            m_head = idx;
+        }
+        m->prev = idx;
+    }
+
+    //Link slot 'idx' after slot 'marker'.
+    void linkAfter(UINT idx, UINT marker)
+    {
+        Slot * s = getSlot(idx);
+        Slot * m = getSlot(marker);
+        s->prev = marker;
+        s->next = m->next;
+        if (m->next != ALIST_NIL) {
+            getSlot(m->next)->prev = idx;
+        } else {
+            m_tail = idx;
+        }
+        m->next = idx;
+    }
+
+    T removeSlot(UINT idx)
+    {
+        Slot * s = getSlot(idx);
+        if (s->prev != ALIST_NIL) {
+            getSlot(s->prev)->next = s->next;
+        } else {
+            m_head = s->next;
+        }
+        if (s->next != ALIST_NIL) {
+            getSlot(s->next)->prev = s->prev;
+        } else {
+            m_tail = s->prev;
+        }
+        if (m_cur == idx) {
+            m_cur = ALIST_NIL;
+        }
+        T t = s->value;
+        //Elements are still in order if the tail is removed.
+        m_is_seq = m_is_seq && s->next == ALIST_NIL;
+        freeSlot(idx);
+        return t;
+    }
+
+    T valueOf(UINT idx) const
+    { return idx == ALIST_NIL ? T(0) : getSlot(idx)->value; }
+
+    //Make 'it' refer to slot 'idx', and return the element in the slot.
+    T moveTo(UINT idx, OUT ALHandle * it) const
+    {
+        if (idx == ALIST_NIL) {
+            it->clean();
+            return T(0);
+        }
+        Slot const* s = getSlot(idx);
+        it->idx = idx;
+        it->gen = s->gen;
+        return s->value;
+    }
+public:
+    ArrList() { init(); }
+    ~ArrList() { destroy(); }
+
+    void init()
+    {
+        m_elem_count = 0;
+        m_slot_num = 0;
+        m_slot_cap = 0;
+        m_head = ALIST_NIL;
+        m_tail = ALIST_NIL;
+        m_free = ALIST_NIL;
+        m_cur = ALIST_NIL;
+        m_is_seq = true;
+        m_slots = nullptr;
+    }
+
+    void destroy()
+    {
+        if (m_slots != nullptr) {
+            ::free(m_slots);
+        }
+        init();
+    }
+
+    //Append value t to head of list.
+    ALHandle append_head(T t)
+    {
+        UINT idx = allocSlot(t);
+        if (m_head == ALIST_NIL) {
+            m_head = m_tail = idx;
+        } else {
+            m_is_seq = false;
+            linkBefore(idx, m_head);
+        }
+        return makeHandle(idx);
+    }
+
+    //Append value t to tail of list.
+    ALHandle append_tail(T t)
+    {
+        UINT idx = allocSlot(t);
+        if (m_tail == ALIST_NIL) {
+            m_head = m_tail = idx;
+        } else {
+            linkAfter(idx, m_tail);
+        }
+        return makeHandle(idx);
+    }
+
+    //Append elements of 'src' to tail of list.
+    void append_tail(ArrList const& src)
+    {
+        for (UINT i = src.m_head; i != ALIST_NIL; i = src.getSlot(i)->next) {
+            append_tail(src.getSlot(i)->value);
+        }
+    }
+
+    //Clean list, the slot array is kept for later use.
+    //Note all handles are invalid after cleaning.
+    void clean()
+    {
+        for (UINT i = 0; i < m_slot_num; i++) {
+            getSlot(i)->gen++;
+        }
+        m_elem_count = 0;
+        m_slot_num = 0;
+        m_head = ALIST_NIL;
+        m_tail = ALIST_NIL;
+        m_free = ALIST_NIL;
+        m_cur = ALIST_NIL;
+        m_is_seq = true;
+    }
+
+    void copy(ArrList const& src)
+    {
+        ASSERTN(this != &src, ("copy self"));
+        clean();
+        append_tail(src);
+    }
+
+    //Count memory usage for current object.
+    size_t count_mem() const
+    {
+        return sizeof(ArrList) + sizeof(Slot) * m_slot_cap;
+    }
+
+    //Return true if 'h' refers to an element in list.
+    bool is_valid(ALHandle h) const
+    {
+        //The generation of slot has been increased when it was freed.
+        return h.idx < m_slot_num && getSlot(h.idx)->gen == h.gen;
+    }
+
+    //Return the element that 'h' refers to.
+    T get(ALHandle h) const
+    {
+        ASSERTN(is_valid(h), ("stale handle"));
+        return getSlot(h.idx)->value;
+    }
+    void set(ALHandle h, T t)
+    {
+        ASSERTN(is_valid(h), ("stale handle"));
+        getSlot(h.idx)->value = t;
+    }
+
+    UINT get_elem_count() const { return m_elem_count; }
+
+    //Iterate list by the internal cursor.
+    T get_head()
+    {
+        m_cur = m_head;
+        return valueOf(m_cur);
+    }
+    T get_tail()
+    {
+        m_cur = m_tail;
+        return valueOf(m_cur);
+    }
+    T get_next()
+    {
+        if (m_cur == ALIST_NIL) { return T(0); }
+        m_cur = getSlot(m_cur)->next;
+        return valueOf(m_cur);
+    }
+    T get_prev()
+    {
+        if (m_cur == ALIST_NIL) { return T(0); }
+        m_cur = getSlot(m_cur)->prev;
+        return valueOf(m_cur);
+    }
+
+    //Iterate list by external iterator 'it'.
+    //e.g: ALHandle it;
+    //     for (T t = l.get_head(&it); !it.is_null(); t = l.get_next(&it)) {
+    //         ...
+    //     }
+    T get_head(OUT ALHandle * it) const
+    {
+        ASSERT0(it);
+        return moveTo(m_head, it);
+    }
+    T get_tail(OUT ALHandle * it) const
+    {
+        ASSERT0(it);
+        return moveTo(m_tail, it);
+    }
+    T get_next(IN OUT ALHandle * it) const
+    {
+        ASSERT0(it && !it->is_null());
+        return moveTo(getSlot(it->idx)->next, it);
+    }
+    T get_prev(IN OUT ALHandle * it) const
+    {
+        ASSERT0(it && !it->is_null());
+        return moveTo(getSlot(it->idx)->prev, it);
+    }
+
+    //Return the n-th element from head, n starts from 0.
+    T get_head_nth(UINT n, OUT ALHandle * it = nullptr) const
+    {
+        if (n >= m_elem_count) {
+            if (it != nullptr) { it->clean(); }
+            return T(0);
+        }
+        UINT idx;
+        if (m_is_seq) {
+            idx = n;
+        } else if (n <= m_elem_count / 2) {
+            idx = m_head;
+            for (; n > 0; n--) { idx = getSlot(idx)->next; }
+        } else {
+            idx = m_tail;
+            for (n = m_elem_count - 1 - n; n > 0; n--) {
+                idx = getSlot(idx)->prev;
+            }
+        }
+        if (it != nullptr) { *it = makeHandle(idx); }
+        return getSlot(idx)->value;
+    }
+
+    //Return the n-th element from tail, n starts from 0.
+    T get_tail_nth(UINT n, OUT ALHandle * it = nullptr) const
+    {
+        if (n >= m_elem_count) {
+            if (it != nullptr) { it->clean(); }
+            return T(0);
+        }
+        return get_head_nth(m_elem_count - 1 - n, it);
+    }
+
+    //Find element 't', and return its handle if 'h' is not nullptr.
+    bool find(T t, OUT ALHandle * h = nullptr) const
+    {
+        for (UINT i = m_head; i != ALIST_NIL; i = getSlot(i)->next) {
+            if (getSlot(i)->value == t) {
+                if (h != nullptr) { *h = makeHandle(i); }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Insert value t before the element that 'marker' refers to.
+    ALHandle insert_before(T t, ALHandle marker)
+    {
+        ASSERTN(is_valid(marker), ("stale handle"));
+        UINT idx = allocSlot(t);
+        m_is_seq = false;
+        linkBefore(idx, marker.idx);
+        return makeHandle(idx);
+    }
+
+    //Insert value t after the element that 'marker' refers to.
+    ALHandle insert_after(T t, ALHandle marker)
+    {
+        ASSERTN(is_valid(marker), ("stale handle"));
+        UINT idx = allocSlot(t);
+        if (marker.idx != m_tail) {
+            m_is_seq = false;
+        }
+        linkAfter(idx, marker.idx);
+        return makeHandle(idx);
+    }
+
+    //Remove the element that 'h' refers to, and return the element.
+    T remove(ALHandle h)
+    {
+        ASSERTN(is_valid(h), ("stale handle"));
+        return removeSlot(h.idx);
+    }
+
+    //Remove the first element that equals 't'.
+    T remove(T t)
+    {
+        ALHandle h;
+        if (!find(t, &h)) { return T(0); }
+        return removeSlot(h.idx);
+    }
+
+    T remove_head()
+    {
+        if (m_head == ALIST_NIL) { return T(0); }
+        return removeSlot(m_head);
+    }
+
+    T remove_tail()
+    {
+        if (m_tail == ALIST_NIL) { return T(0); }
+        return removeSlot(m_tail);
+    }
+};
+
+} //namespace xcom
+#endif
@@ -0,0 +1,169 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "stdio.h"
+
+//The workload solves live variables of a pseudo random control flow graph
+//by iterating the dataflow equation until the fixed point:
+//  out(bb) = U in(succ), in(bb) = (out(bb) - def(bb)) U use(bb)
+//then counts and walks the elements of each set, and compares the sets
+//of adjacent blocks, repeatedly for ROUND times.
+//Define NO_FUSED_OP to compute in(bb) by separated copy, diff and
+//bunion rather than BitSet::diff_union().
+#define NUM_BB 4000
+#define NUM_VAR 8192
+#define NUM_REF 16
+#define ROUND 10
+#define RAND_NEXT(s) ((s) = (s) * 1103515245u + 12345u)
+#define RAND_VAL(s) (((s) >> 8) & 0xFFFFFF)
+
+//Return the successor of 'bb', each block has a fall through successor
+//and a back edge to a nearby block which models a loop.
+#define SUCC1(bb) ((bb) + 1 < NUM_BB ? (bb) + 1 : 0)
+#define SUCC2(bb) ((bb) >= 64 ? (bb) - ((bb) * 7 + 3) % 64 : 0)
+
+//Return a pseudo random variable referenced in 'bb', variables are mostly
+//referenced in a range of nearby blocks.
+#define RAND_VAR(bb, s) (((bb) * 2 + RAND_VAL(RAND_NEXT(s)) % 512) % NUM_VAR)
+
+#ifdef RUN_STL
+#include <bitset>
+typedef std::bitset<NUM_VAR> BS;
+static BS def[NUM_BB], use[NUM_BB], livein[NUM_BB], liveout[NUM_BB];
+
+int main()
+{
+    unsigned seed = 1;
+    unsigned sum = 0;
+    for (int r = 0; r < ROUND; r++) {
+        for (int i = 0; i < NUM_BB; i++) {
+            def[i].reset(); use[i].reset();
+            livein[i].reset(); liveout[i].reset();
+            for (int j = 0; j < NUM_REF; j++) {
+                def[i].set(RAND_VAR(i, seed));
+                use[i].set(RAND_VAR(i, seed));
+            }
+        }
+
+        bool change = true;
+        unsigned iter = 0;
+        while (change) {
+            change = false;
+            iter++;
+            for (int i = NUM_BB - 1; i >= 0; i--) {
+                BS out = livein[SUCC1(i)] | livein[SUCC2(i)];
+                liveout[i] = out;
+                BS in = (out & ~def[i]) | use[i];
+                if (in != livein[i]) {
+                    livein[i] = in;
+                    change = true;
+                }
+            }
+        }
+
+        for (int i = 0; i < NUM_BB; i++) {
+            sum += (unsigned)livein[i].count();
+            for (int j = 0; j < NUM_VAR; j++) {
+                if (liveout[i].test(j)) { sum += j; }
+            }
+            int k = i + 1 < NUM_BB ? i + 1 : 0;
+            sum += livein[i] == livein[k] ? 1 : 0;
+            sum += (livein[i] & ~liveout[i]).none() ? 1 : 0;
+            sum += (livein[i] & def[i]).any() ? 1 : 0;
+        }
+        sum += iter;
+    }
+    printf("%u\n", sum);
+    return 0;
+}
+
+#else
+
+#include "../xcominc.h"
+using xcom::BitSet;
+static BitSet def[NUM_BB], use[NUM_BB], livein[NUM_BB], liveout[NUM_BB];
+
+int main()
+{
+    unsigned seed = 1;
+    unsigned sum = 0;
+    for (int r = 0; r < ROUND; r++) {
+        for (int i = 0; i < NUM_BB; i++) {
+            def[i].clean(); use[i].clean();
+            livein[i].clean(); liveout[i].clean();
+            for (int j = 0; j < NUM_REF; j++) {
+                def[i].bunion(RAND_VAR(i, seed));
+                use[i].bunion(RAND_VAR(i, seed));
+            }
+        }
+
+        bool change = true;
+        unsigned iter = 0;
+        #ifdef NO_FUSED_OP
+        BitSet in;
+        #endif
+        while (change) {
+            change = false;
+            iter++;
+            for (int i = NUM_BB - 1; i >= 0; i--) {
+                BitSet & out = liveout[i];
+                out.copy(livein[SUCC1(i)]);
+                out.bunion(livein[SUCC2(i)]);
+                #ifdef NO_FUSED_OP
+                in.copy(out);
+                in.diff(def[i]);
+                in.bunion(use[i]);
+                if (!in.is_equal(livein[i])) {
+                    livein[i].copy(in);
+                    change = true;
+                }
+                #else
+                if (livein[i].diff_union(out, def[i], use[i])) {
+                    change = true;
+                }
+                #endif
+            }
+        }
+
+        for (int i = 0; i < NUM_BB; i++) {
+            sum += livein[i].get_elem_count();
+            for (int j = liveout[i].get_first(); j >= 0;
+                 j = liveout[i].get_next(j)) {
+                sum += j;
+            }
+            int k = i + 1 < NUM_BB ? i + 1 : 0;
+            sum += livein[i].is_equal(livein[k]) ? 1 : 0;
+            sum += liveout[i].is_contain(livein[i]) ? 1 : 0;
+            sum += livein[i].is_intersect(def[i]) ? 1 : 0;
+        }
+        sum += iter;
+    }
+    printf("%u\n", sum);
+    return 0;
+}
+#endif
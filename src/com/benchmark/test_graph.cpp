@@ -0,0 +1,194 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "stdio.h"
+#include "../xcominc.h"
+
+//The workload builds a graph with about one million edges, then runs the
+//read-only algorithms repeatedly for ROUND times.
+//By default the graph is CFG-like: each vertex has a fall through edge,
+//some have a forward branch, and some have a back edge which models a
+//loop. The workload computes rpo and immediate dominators.
+//Define TEST_CALL_GRAPH to build a call-graph-like DAG instead: each
+//function calls a few nearby functions and a few hot utility functions.
+//The workload sorts vertices in topological order.
+//Define USE_CSR to run the algorithms on CSRGraph that is built by
+//Graph::freeze(), rather than on Graph.
+//Define USE_SEMI_NCA to compute immediate dominators of Graph by
+//DGraph::computeIdomBySemiNCA(), which freezes the graph in each round.
+//Define TEST_TRANS_REDUCE to build a dependence-graph-like DAG instead:
+//each vertex has a few dependent vertices in a window after it, which
+//forms many transitive edges. The workload removes transitive edges from a copy
+//of the graph. Define THREAD_NUM to use multiple threads, and define
+//MAX_ROW_MEM to limit the memory of reachability rows, e.g: 1 makes
+//ReachMat fall back to searching.
+#define CFG_VEX_NUM 640000
+#define CG_VEX_NUM 200000
+#define CG_CALLEE_NUM 5
+#define CG_HOT_NUM 4000
+#define DEP_VEX_NUM 40000
+#define DEP_SUCC_NUM 6
+#define DEP_WINDOW 1024
+#ifndef THREAD_NUM
+#define THREAD_NUM 0
+#endif
+#ifndef MAX_ROW_MEM
+#define MAX_ROW_MEM REACH_DEFAULT_MAX_ROW_MEM
+#endif
+#define ROUND 10
+#define RAND_NEXT(s) ((s) = (s) * 1103515245u + 12345u)
+#define RAND_VAL(s) (((s) >> 8) & 0xFFFFFF)
+
+#if defined(TEST_TRANS_REDUCE)
+static void buildGraph(Graph & g)
+{
+    unsigned seed = 1;
+    for (UINT i = 1; i <= DEP_VEX_NUM; i++) {
+        g.addVertex(i);
+    }
+    for (UINT i = 1; i < DEP_VEX_NUM; i++) {
+        for (UINT j = 0; j < DEP_SUCC_NUM; j++) {
+            UINT to = i + 1 + RAND_VAL(RAND_NEXT(seed)) % DEP_WINDOW;
+            if (to <= DEP_VEX_NUM) {
+                g.addEdge(i, to);
+            }
+        }
+    }
+}
+#elif defined(TEST_CALL_GRAPH)
+static void buildGraph(Graph & g)
+{
+    unsigned seed = 1;
+    for (UINT i = 1; i <= CG_VEX_NUM; i++) {
+        g.addVertex(i);
+    }
+    for (UINT i = 1; i < CG_VEX_NUM; i++) {
+        for (UINT j = 0; j < CG_CALLEE_NUM; j++) {
+            UINT callee;
+            if (RAND_VAL(RAND_NEXT(seed)) % 4 == 0) {
+                //Call hot utility function.
+                callee = CG_VEX_NUM - RAND_VAL(RAND_NEXT(seed)) % CG_HOT_NUM;
+            } else {
+                UINT range = MIN(CG_VEX_NUM - i, 1000u);
+                callee = i + 1 + RAND_VAL(RAND_NEXT(seed)) % range;
+            }
+            if (callee > i) {
+                g.addEdge(i, callee);
+            }
+        }
+    }
+}
+#else
+static void buildGraph(Graph & g)
+{
+    unsigned seed = 1;
+    for (UINT i = 1; i <= CFG_VEX_NUM; i++) {
+        g.addVertex(i);
+    }
+    for (UINT i = 1; i < CFG_VEX_NUM; i++) {
+        g.addEdge(i, i + 1);
+        UINT r = RAND_VAL(RAND_NEXT(seed)) % 10;
+        if (r < 4) {
+            //Forward branch.
+            UINT to = i + 2 + RAND_VAL(RAND_NEXT(seed)) % 16;
+            if (to <= CFG_VEX_NUM) {
+                g.addEdge(i, to);
+            }
+        } else if (r < 6 && i > 2) {
+            //Back edge of loop, the entry is not in loop.
+            UINT dist = RAND_VAL(RAND_NEXT(seed)) % 32;
+            g.addEdge(i, i > dist + 3 ? i - 1 - dist : 2);
+        }
+    }
+}
+#endif
+
+int main()
+{
+    DGraph g;
+    g.set_dense(true);
+    g.set_unique(true);
+    g.set_direction(true);
+    buildGraph(g);
+    printf("\nvertex:%u edge:%u\n", g.getVertexNum(), g.getEdgeNum());
+
+    unsigned sum = 0;
+    #ifdef USE_CSR
+    CSRGraph csr;
+    g.freeze(csr);
+    #endif
+    for (int r = 0; r < ROUND; r++) {
+        #if defined(TEST_TRANS_REDUCE)
+        Graph h;
+        h.set_dense(true);
+        h.clone(g, false, false);
+        ReachOpt opt;
+        opt.thread_num = THREAD_NUM;
+        opt.max_row_mem = MAX_ROW_MEM;
+        ReachStat stat;
+        h.removeTransitiveEdge(&opt, &stat);
+        sum += h.getEdgeNum();
+        if (r == 0) { stat.dump(stdout); }
+        #elif defined(TEST_CALL_GRAPH)
+        #ifdef USE_CSR
+        Vector<UINT> order;
+        csr.sortInTopologOrder(order);
+        for (UINT i = 0; i < csr.getVertexNum(); i++) {
+            sum += csr.getId(order[i]) * i;
+        }
+        #else
+        Vector<Vertex*> order;
+        g.sortInTopologOrder(order);
+        for (UINT i = 0; i < g.getVertexNum(); i++) {
+            sum += order[i]->id() * i;
+        }
+        #endif
+        #else //CFG
+        #ifdef USE_CSR
+        Vector<UINT> idom;
+        csr.computeIdom(csr.getIdx(1), idom);
+        for (UINT i = 0; i < csr.getVertexNum(); i++) {
+            sum += idom[i] == CSR_UNDEF ? 0 : csr.getId(idom[i]);
+        }
+        #else
+        #ifdef USE_SEMI_NCA
+        g.computeIdomBySemiNCA();
+        #else
+        List<Vertex const*> vlst;
+        g.computeRpoNoRecursive(g.getVertex(1), vlst);
+        g.computeIdom2(vlst);
+        #endif
+        for (UINT i = 1; i <= g.getVertexNum(); i++) {
+            sum += g.get_idom(i);
+        }
+        #endif
+        #endif
+    }
+    printf("%u\n", sum);
+    return 0;
+}
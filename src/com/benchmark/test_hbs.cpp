@@ -0,0 +1,110 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "stdio.h"
+#include "../xcominc.h"
+
+//The workload models the points-to sets of an alias analysis, most of the
+//sets have one to three elements, some sets are scattered in a wide range,
+//and a few sets hold a large part of a dense range. It unions each set with
+//other sets, then compares, probes, walks and counts the sets repeatedly
+//for ROUND times, and reports the memory used by the sets at last.
+//Define USE_SBS to evaluate SBitSetCore instead of HBitSetCore.
+#define NUM_SET 20000
+#define NUM_ELEM 100000
+#define NUM_DENSE_ELEM 16384
+#define ROUND 20
+#define RAND_NEXT(s) ((s) = (s) * 1103515245u + 12345u)
+#define RAND_VAL(s) (((s) >> 8) & 0xFFFFFF)
+
+#ifdef USE_SBS
+typedef xcom::SBitSetCore<> SET;
+#else
+typedef xcom::HBitSetCore<> SET;
+#endif
+static SET set[NUM_SET];
+
+int main()
+{
+    xcom::MiscBitSetMgr<> mgr;
+    unsigned seed = 1;
+    for (int i = 0; i < NUM_SET; i++) {
+        unsigned kind = i % 100;
+        if (kind < 80) {
+            //Tiny set.
+            unsigned n = 1 + RAND_VAL(RAND_NEXT(seed)) % 3;
+            for (unsigned j = 0; j < n; j++) {
+                set[i].bunion(RAND_VAL(RAND_NEXT(seed)) % NUM_ELEM, mgr);
+            }
+        } else if (kind < 98) {
+            //Scattered set.
+            for (unsigned j = 0; j < 64; j++) {
+                set[i].bunion(RAND_VAL(RAND_NEXT(seed)) % NUM_ELEM, mgr);
+            }
+        } else {
+            //Dense set.
+            for (unsigned j = 0; j < NUM_DENSE_ELEM; j++) {
+                if (RAND_VAL(RAND_NEXT(seed)) % 4 != 0) {
+                    set[i].bunion(j, mgr);
+                }
+            }
+        }
+    }
+
+    unsigned sum = 0;
+    SET tmp;
+    for (int r = 0; r < ROUND; r++) {
+        for (int i = 0; i < NUM_SET; i++) {
+            int k = (int)(RAND_VAL(RAND_NEXT(seed)) % NUM_SET);
+            if (k == i) { continue; }
+            tmp.copy(set[i], mgr);
+            tmp.bunion(set[k], mgr);
+            sum += tmp.is_equal(set[i]) ? 1 : 0;
+            sum += set[i].is_intersect(set[k]) ? 1 : 0;
+            sum += set[k].is_contain(RAND_VAL(RAND_NEXT(seed)) % NUM_ELEM) ?
+                   1 : 0;
+            sum += tmp.get_elem_count();
+            if (i % 16 == 0) {
+                xcom::SEGIter * it = nullptr;
+                for (int e = set[i].get_first(&it); e >= 0;
+                     e = set[i].get_next((xcom::UINT)e, &it)) {
+                    sum += (unsigned)e;
+                }
+            }
+        }
+    }
+
+    size_t mem = 0;
+    for (int i = 0; i < NUM_SET; i++) {
+        mem += set[i].count_mem();
+        set[i].clean(mgr);
+    }
+    tmp.clean(mgr);
+    printf("%u\nmemory of sets: %luKB\n", sum, (unsigned long)(mem / 1024));
+    return 0;
+}
@@ -28,9 +28,58 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
 #include "stdio.h"
 
+//Define TEST_MIXED to evaluate the mixed workload, which builds a list of
+//MIXED_NUM elements, then in each round traverses the list, inserts an
+//element after every MIXED_STRIDE-th element and removes another one of
+//each stride, and moves MIXED_MOVE elements from head to tail.
+//Define USE_ARR_LIST to evaluate xcom::ArrList rather than xcom::List.
+#define MIXED_NUM 100000
+#define MIXED_ROUND 100
+#define MIXED_STRIDE 7
+#define MIXED_MOVE 1000
+
 #ifdef RUN_STL
 #include <list>
 using std::list;
+#ifdef TEST_MIXED
+int main()
+{
+    int x = 1;
+    std::list<int> mylist;
+    for (int i = 0; i < MIXED_NUM; i++) {
+        mylist.push_back(x++);
+    }
+
+    unsigned sum = 0;
+    for (int r = 0; r < MIXED_ROUND; r++) {
+        for (std::list<int>::iterator it = mylist.begin();
+             it != mylist.end(); it++) {
+            sum += *it;
+        }
+        int k = 0;
+        for (std::list<int>::iterator it = mylist.begin();
+             it != mylist.end(); k++) {
+            if (k % MIXED_STRIDE == 3) {
+                it = mylist.erase(it);
+                continue;
+            }
+            std::list<int>::iterator next = it;
+            next++;
+            if (k % MIXED_STRIDE == 0) {
+                mylist.insert(next, x++);
+            }
+            it = next;
+        }
+        for (int i = 0; i < MIXED_MOVE; i++) {
+            int v = mylist.front();
+            mylist.pop_front();
+            mylist.push_back(v);
+        }
+    }
+    printf("%u %u\n", sum, (unsigned)mylist.size());
+    return 0;
+}
+#else
 int main()
 {
     printf("\ntest std list\n");
@@ -59,15 +108,67 @@ int main()
     }
     return 0;
 }
+#endif
 
 #else
 
 #include "../xcominc.h"
+#ifdef USE_ARR_LIST
+typedef xcom::ArrList<int> LIST;
+typedef xcom::ALHandle HOLDER;
+#define IS_END(l, h) ((h).is_null())
+#define GET_HEAD(l, h) ((l).get_head(&(h)))
+#define GET_NEXT(l, h) ((l).get_next(&(h)))
+#else
+typedef xcom::List<int> LIST;
+typedef xcom::C<int> * HOLDER;
+#define IS_END(l, h) ((h) == (l).end())
+#define GET_HEAD(l, h) ((l).get_head(&(h)))
+#define GET_NEXT(l, h) ((l).get_next(&(h)))
+#endif
+
+#ifdef TEST_MIXED
+int main()
+{
+    int x = 1;
+    LIST mylist;
+    for (int i = 0; i < MIXED_NUM; i++) {
+        mylist.append_tail(x++);
+    }
+
+    unsigned sum = 0;
+    for (int r = 0; r < MIXED_ROUND; r++) {
+        HOLDER it;
+        for (int v = GET_HEAD(mylist, it); !IS_END(mylist, it);
+             v = GET_NEXT(mylist, it)) {
+            sum += v;
+        }
+        int k = 0;
+        HOLDER next;
+        for (GET_HEAD(mylist, it); !IS_END(mylist, it); it = next, k++) {
+            next = it;
+            GET_NEXT(mylist, next);
+            if (k % MIXED_STRIDE == 3) {
+                mylist.remove(it);
+                continue;
+            }
+            if (k % MIXED_STRIDE == 0) {
+                mylist.insert_after(x++, it);
+            }
+        }
+        for (int i = 0; i < MIXED_MOVE; i++) {
+            mylist.append_tail(mylist.remove_head());
+        }
+    }
+    printf("%u %u\n", sum, mylist.get_elem_count());
+    return 0;
+}
+#else
 int main()
 {
     printf("\ntest xoc sstl List\n");
     int x = 1;
-    xcom::List<int> mylist;
+    LIST mylist;
     for (int j = 0;j < 1000; j++) {
         for (int i = 0; i < 10000; i++) {
             int v = x++;
@@ -91,3 +192,4 @@ int main()
     return 0;
 }
 #endif
+#endif
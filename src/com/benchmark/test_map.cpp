@@ -28,7 +28,45 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 @*/
 #include "stdio.h"
 #define NUM 1000000
+
+//Define TEST_HASH to evaluate hash table instead of ordered map.
+//The hash workload inserts NUM pseudo random keys, finds every key and
+//NUM absent keys, erases all keys, then inserts NUM new keys.
+//Define USE_CHAINED_HASH to evaluate xcom::HMap rather than xcom::OAHMap.
+//Define USE_BTREE to evaluate xcom::BTMap rather than xcom::TMap, and
+//TEST_BULK_BUILD in addition to build the first NUM keys from sorted array.
+#define HASH_KEY(i) ((unsigned)((i) * 2654435761u) | 1u)
+#define HASH_ABSENT_KEY(i) ((unsigned)((i) * 2654435761u) & ~1u)
+
 #ifdef RUN_STL
+#ifdef TEST_HASH
+#include <unordered_map>
+int main()
+{
+    std::unordered_map<unsigned, unsigned> mymap;
+    for (unsigned i = 1; i <= NUM; i++) {
+        unsigned v = HASH_KEY(i);
+        mymap.insert(std::pair<unsigned, unsigned>(v, i));
+    }
+
+    unsigned sum = 0;
+    for (unsigned i = 1; i <= NUM; i++) {
+        sum += mymap.find(HASH_KEY(i))->second;
+        sum += mymap.count(HASH_ABSENT_KEY(i)) != 0 ? 1 : 0;
+    }
+
+    for (unsigned i = 1; i <= NUM; i++) {
+        mymap.erase(HASH_KEY(i));
+    }
+
+    for (unsigned i = NUM + 1; i <= 2 * NUM; i++) {
+        unsigned v = HASH_KEY(i);
+        mymap.insert(std::pair<unsigned, unsigned>(v, i));
+    }
+    printf("%u %u\n", sum, (unsigned)mymap.size());
+    return 0;
+}
+#else
 #include <map>
 int main()
 {
@@ -39,7 +77,11 @@ int main()
         mymap.insert(std::pair<int, int>(v, v));
     }
 
-    int sum = 0;
+    unsigned sum = 0;
+    for (int i = 1; i <= NUM; i++) {
+        sum += mymap.find(i)->second;
+    }
+
     for (std::map<int, int>::iterator it = mymap.begin();
          it != mymap.end(); it++) {
         sum += (*it).second;
@@ -55,23 +97,77 @@ int main()
         int v = x++;
         mymap.insert(std::pair<int, int>(v, v));
     }
+    printf("%u %u\n", sum, (unsigned)mymap.size());
     return 0;
 }
+#endif
 
 #else  //RUN XCOM
 
 #include "../xcominc.h"
+#ifdef TEST_HASH
+#ifdef USE_CHAINED_HASH
+typedef xcom::HMap<UINT, UINT, xcom::HashFuncBase2<UINT> > HashMap;
+#define HASH_INIT_SIZE (1 << 20)
+#else
+typedef xcom::OAHMap<UINT, UINT> HashMap;
+#define HASH_INIT_SIZE 16
+#endif
+int main()
+{
+    HashMap mymap(HASH_INIT_SIZE);
+    for (UINT i = 1; i <= NUM; i++) {
+        mymap.setAlways(HASH_KEY(i), i);
+    }
+
+    UINT sum = 0;
+    for (UINT i = 1; i <= NUM; i++) {
+        sum += mymap.get(HASH_KEY(i));
+        sum += mymap.find(HASH_ABSENT_KEY(i)) ? 1 : 0;
+    }
+
+    for (UINT i = 1; i <= NUM; i++) {
+        mymap.remove(HASH_KEY(i));
+    }
+
+    for (UINT i = NUM + 1; i <= 2 * NUM; i++) {
+        mymap.setAlways(HASH_KEY(i), i);
+    }
+    printf("%u %u\n", sum, mymap.get_elem_count());
+    return 0;
+}
+#else
+#ifdef USE_BTREE
+typedef xcom::BTMap<int, int> OrderedMap;
+typedef xcom::BTMapIter<int, int> OrderedMapIter;
+#else
+typedef xcom::TMap<int, int> OrderedMap;
+typedef xcom::TMapIter<int, int> OrderedMapIter;
+#endif
 int main()
 {
     int x = 1;
-    xcom::TMap<int, int> mymap;
+    OrderedMap mymap;
+    #ifdef TEST_BULK_BUILD
+    int * key = new int[NUM];
+    for (int i = 0; i < NUM; i++) {
+        key[i] = x++;
+    }
+    mymap.build(key, key, NUM);
+    delete [] key;
+    #else
     for (int i = 0; i < NUM; i++) {
         int v = x++;
         mymap.set(v, v);
     }
+    #endif
+
+    unsigned sum = 0;
+    for (int i = 1; i <= NUM; i++) {
+        sum += mymap.get(i);
+    }
 
-    int sum = 0;
-    xcom::TMapIter<int, int> iter;
+    OrderedMapIter iter;
     int tgt;
     for (int src = mymap.get_first(iter, &tgt);
          src != 0; src = mymap.get_next(iter, &tgt)) {
@@ -88,6 +184,8 @@ int main()
         int v = x++;
         mymap.set(v, v);
     }
+    printf("%u %u\n", sum, mymap.get_elem_count());
     return 0;
 }
 #endif
+#endif
@@ -0,0 +1,99 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "stdio.h"
+#include "../xcominc.h"
+
+//The workload builds a call-graph-like graph with two million vertices,
+//then finds strongly connected components repeatedly for ROUND times and
+//queries whether each function is recursive.
+//Each function calls a few nearby functions and a few hot utility
+//functions, some of the calls go backward which forms mutual recursions
+//of different sizes. In addition, a long chain of calls that goes back to
+//its head forms a deep SCC, which requires the DFS to go very deep.
+#define CG_VEX_NUM 2000000
+#define CG_CALLEE_NUM 2
+#define CG_HOT_NUM 4000
+#define CG_CHAIN_NUM 200000
+#define ROUND 5
+#define RAND_NEXT(s) ((s) = (s) * 1103515245u + 12345u)
+#define RAND_VAL(s) (((s) >> 8) & 0xFFFFFF)
+
+static void buildGraph(Graph & g)
+{
+    unsigned seed = 1;
+    for (UINT i = 1; i <= CG_VEX_NUM; i++) {
+        g.addVertex(i);
+    }
+    for (UINT i = 1; i < CG_VEX_NUM; i++) {
+        for (UINT j = 0; j < CG_CALLEE_NUM; j++) {
+            UINT r = RAND_VAL(RAND_NEXT(seed)) % 16;
+            UINT callee;
+            if (r < 4) {
+                //Call hot utility function.
+                callee = CG_VEX_NUM - RAND_VAL(RAND_NEXT(seed)) % CG_HOT_NUM;
+            } else if (r == 4) {
+                //Recursive call back to caller.
+                UINT dist = RAND_VAL(RAND_NEXT(seed)) % 64;
+                callee = i > dist ? i - dist : 1;
+            } else {
+                UINT range = MIN(CG_VEX_NUM - i, 1000u);
+                callee = i + 1 + RAND_VAL(RAND_NEXT(seed)) % range;
+            }
+            g.addEdge(i, callee);
+        }
+    }
+
+    //Deep SCC.
+    for (UINT i = 1; i < CG_CHAIN_NUM; i++) {
+        g.addEdge(i, i + 1);
+    }
+    g.addEdge(CG_CHAIN_NUM, 1);
+}
+
+
+int main()
+{
+    Graph g;
+    g.set_dense(true);
+    g.set_unique(true);
+    g.set_direction(true);
+    buildGraph(g);
+    printf("\nvertex:%u edge:%u\n", g.getVertexNum(), g.getEdgeNum());
+
+    unsigned sum = 0;
+    for (int r = 0; r < ROUND; r++) {
+        SCC scc(&g);
+        scc.findSCC();
+        for (UINT i = 1; i <= g.getVertexNum(); i++) {
+            sum += scc.isInSCC(i) ? i : 0;
+        }
+    }
+    printf("%u\n", sum);
+    return 0;
+}
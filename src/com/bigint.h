@@ -145,6 +145,8 @@ private:
 public:
     BigInt() { m_sig_pos = -1; }
     BigInt(BigInt const& bi) { copy(bi); }
+    BigInt(BigInt && bi) : xcom::Vector<BigIntElemType>(std::move(bi))
+    { m_sig_pos = bi.m_sig_pos; bi.m_sig_pos = -1; }
     BigInt(UINT elemnum, ...);
     ~BigInt() {}
 
@@ -189,6 +191,13 @@ public:
 
     //Support concatenation assignment, such as: a=b=c.
     BigInt const& operator = (BigInt const& src) { copy(src); return *this; }
+    BigInt & operator = (BigInt && src)
+    {
+        xcom::Vector<BigIntElemType>::operator = (std::move(src));
+        m_sig_pos = src.m_sig_pos;
+        src.m_sig_pos = -1;
+        return *this;
+    }
 
     //Set a list of integer that are expected value for each element.
     //Note this function makes sure the last element is significant number.
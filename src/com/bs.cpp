@@ -32,6 +32,11 @@ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 author: Su Zhenyu
 @*/
 #include "xcominc.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace xcom {
 
@@ -827,6 +832,315 @@ static BYTE const g_last_one[256] = {
 };
 
 
+//
+//START Word Operations
+//
+#define BS_WORD_BIT (BS_WORD_BYTE * BITS_PER_BYTE)
+#define DIVBPW(a) ((a) >> 6)
+#define MULBPW(a) ((a) << 6)
+#define MODBPW(a) ((a) & 63)
+
+//Vector register used by bulk operations, it holds BS_VEC_WORD words.
+//BS_VEC_ANDN(a, b) computes a & ~b.
+#if defined(__AVX2__)
+#define BS_VEC_WORD 4
+typedef __m256i BSVecReg;
+#define BS_VEC_LOAD(p) _mm256_loadu_si256((__m256i const*)(p))
+#define BS_VEC_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#define BS_VEC_ZERO() _mm256_setzero_si256()
+#define BS_VEC_OR(a, b) _mm256_or_si256((a), (b))
+#define BS_VEC_AND(a, b) _mm256_and_si256((a), (b))
+#define BS_VEC_ANDN(a, b) _mm256_andnot_si256((b), (a))
+#define BS_VEC_XOR(a, b) _mm256_xor_si256((a), (b))
+#define BS_VEC_IS_ZERO(v) (_mm256_testz_si256((v), (v)) != 0)
+#elif defined(__SSE2__)
+#define BS_VEC_WORD 2
+typedef __m128i BSVecReg;
+#define BS_VEC_LOAD(p) _mm_loadu_si128((__m128i const*)(p))
+#define BS_VEC_STORE(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+#define BS_VEC_ZERO() _mm_setzero_si128()
+#define BS_VEC_OR(a, b) _mm_or_si128((a), (b))
+#define BS_VEC_AND(a, b) _mm_and_si128((a), (b))
+#define BS_VEC_ANDN(a, b) _mm_andnot_si128((b), (a))
+#define BS_VEC_XOR(a, b) _mm_xor_si128((a), (b))
+#define BS_VEC_IS_ZERO(v) \
+    (_mm_movemask_epi8(_mm_cmpeq_epi8((v), _mm_setzero_si128())) == 0xFFFF)
+#else
+#define BS_VEC_WORD 1
+typedef BSWord BSVecReg;
+#define BS_VEC_LOAD(p) loadWord(p)
+#define BS_VEC_STORE(p, v) storeWord((p), (v))
+#define BS_VEC_ZERO() ((BSWord)0)
+#define BS_VEC_OR(a, b) ((a) | (b))
+#define BS_VEC_AND(a, b) ((a) & (b))
+#define BS_VEC_ANDN(a, b) ((a) & ~(b))
+#define BS_VEC_XOR(a, b) ((a) ^ (b))
+#define BS_VEC_IS_ZERO(v) ((v) == 0)
+#endif
+#define BS_VEC_BYTE (BS_VEC_WORD * BS_WORD_BYTE)
+
+//Load word from 'p', it is not necessary to be aligned.
+static inline BSWord loadWord(BYTE const* p)
+{
+    BSWord w;
+    ::memcpy(&w, p, sizeof(BSWord));
+    return w;
+}
+
+
+static inline void storeWord(BYTE * p, BSWord w)
+{
+    ::memcpy(p, &w, sizeof(BSWord));
+}
+
+
+//Return the 'i'th word of the buffer 'p' which has 'size' bytes.
+//Bytes out of buffer read as zero, because the buffer of ROBitSet
+//may not be padded to whole words.
+static inline BSWord getWordOrZero(BYTE const* p, UINT size, UINT i)
+{
+    UINT const ofst = i * BS_WORD_BYTE;
+    if (ofst + BS_WORD_BYTE <= size) { return loadWord(p + ofst); }
+    BSWord w = 0;
+    if (ofst < size) { ::memcpy(&w, p + ofst, size - ofst); }
+    return w;
+}
+
+
+//Zero words that stand for the words out of buffer.
+#define BS_ZERO_WORD_NUM 32
+static BSWord const g_zero_word[BS_ZERO_WORD_NUM] = { 0 };
+
+//Return the buffer of 'len' words start from the 'i'th word of buffer 'p'
+//which has 'size' bytes. 'len' will be shrunk so that the words are either
+//all in buffer or all out of buffer, for the latter case, return zero words.
+//Return nullptr if the 'i'th word is the last partial word.
+static inline BYTE const* getWordRange(BYTE const* p, UINT size, UINT i,
+                                       IN OUT UINT & len)
+{
+    UINT const full = size / BS_WORD_BYTE;
+    if (i < full) {
+        len = MIN(len, full - i);
+        return p + i * BS_WORD_BYTE;
+    }
+    if (i == full && full * BS_WORD_BYTE < size) { return nullptr; }
+    len = MIN(len, BS_ZERO_WORD_NUM);
+    return (BYTE const*)g_zero_word;
+}
+
+
+//Return the number of words, include the last partial word.
+static inline UINT getWordNum(UINT size)
+{
+    return (size + BS_WORD_BYTE - 1) / BS_WORD_BYTE;
+}
+
+
+static inline UINT countWordOne(BSWord w)
+{
+    #if defined(__GNUC__) && defined(__POPCNT__)
+    return (UINT)__builtin_popcountll(w);
+    #else
+    //Hamming weight.
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (UINT)((w * 0x0101010101010101ULL) >> 56);
+    #endif
+}
+
+
+//Return the bit position of the first one in 'w'.
+static inline UINT getWordFirstOne(BSWord w)
+{
+    ASSERT0(w != 0);
+    #ifdef __GNUC__
+    return (UINT)__builtin_ctzll(w);
+    #else
+    UINT n = 0;
+    for (; (w & 0xFF) == 0; w >>= BITS_PER_BYTE) { n += BITS_PER_BYTE; }
+    return n + g_first_one[w & 0xFF];
+    #endif
+}
+
+
+//Return the bit position of the last one in 'w'.
+static inline UINT getWordLastOne(BSWord w)
+{
+    ASSERT0(w != 0);
+    #ifdef __GNUC__
+    return BS_WORD_BIT - 1 - (UINT)__builtin_clzll(w);
+    #else
+    UINT n = BS_WORD_BIT - BITS_PER_BYTE;
+    for (; (w >> n) == 0; n -= BITS_PER_BYTE) {}
+    return n + g_last_one[(w >> n) & 0xFF];
+    #endif
+}
+
+
+//The following functions operate 'n' words of buffers, and process
+//a vector at a time, the rest words are processed one by one.
+//Return true if any word of 'dst' changed.
+//dst = dst | src
+static bool unionWord(BYTE * dst, BYTE const* src, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    BSVecReg vchg = BS_VEC_ZERO();
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        BSVecReg d = BS_VEC_LOAD(dst + i);
+        BSVecReg s = BS_VEC_LOAD(src + i);
+        vchg = BS_VEC_OR(vchg, BS_VEC_ANDN(s, d));
+        BS_VEC_STORE(dst + i, BS_VEC_OR(d, s));
+    }
+    BSWord chg = 0;
+    for (; i < nb; i += BS_WORD_BYTE) {
+        BSWord d = loadWord(dst + i);
+        BSWord s = loadWord(src + i);
+        chg |= s & ~d;
+        storeWord(dst + i, d | s);
+    }
+    return chg != 0 || !BS_VEC_IS_ZERO(vchg);
+}
+
+
+//dst = dst & src
+static bool intersectWord(BYTE * dst, BYTE const* src, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    BSVecReg vchg = BS_VEC_ZERO();
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        BSVecReg d = BS_VEC_LOAD(dst + i);
+        BSVecReg s = BS_VEC_LOAD(src + i);
+        vchg = BS_VEC_OR(vchg, BS_VEC_ANDN(d, s));
+        BS_VEC_STORE(dst + i, BS_VEC_AND(d, s));
+    }
+    BSWord chg = 0;
+    for (; i < nb; i += BS_WORD_BYTE) {
+        BSWord d = loadWord(dst + i);
+        BSWord s = loadWord(src + i);
+        chg |= d & ~s;
+        storeWord(dst + i, d & s);
+    }
+    return chg != 0 || !BS_VEC_IS_ZERO(vchg);
+}
+
+
+//dst = dst & ~src
+static void diffWord(BYTE * dst, BYTE const* src, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        BS_VEC_STORE(dst + i,
+                     BS_VEC_ANDN(BS_VEC_LOAD(dst + i), BS_VEC_LOAD(src + i)));
+    }
+    for (; i < nb; i += BS_WORD_BYTE) {
+        storeWord(dst + i, loadWord(dst + i) & ~loadWord(src + i));
+    }
+}
+
+
+//dst = (b & ~c) | d
+//'dst' may be the same buffer as any of 'b', 'c' and 'd'.
+static bool diffUnionWord(BYTE * dst, BYTE const* b, BYTE const* c,
+                          BYTE const* d, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    BSVecReg vchg = BS_VEC_ZERO();
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        BSVecReg r = BS_VEC_OR(BS_VEC_ANDN(BS_VEC_LOAD(b + i),
+                                           BS_VEC_LOAD(c + i)),
+                               BS_VEC_LOAD(d + i));
+        vchg = BS_VEC_OR(vchg, BS_VEC_XOR(r, BS_VEC_LOAD(dst + i)));
+        BS_VEC_STORE(dst + i, r);
+    }
+    BSWord chg = 0;
+    for (; i < nb; i += BS_WORD_BYTE) {
+        BSWord r = (loadWord(b + i) & ~loadWord(c + i)) | loadWord(d + i);
+        chg |= r ^ loadWord(dst + i);
+        storeWord(dst + i, r);
+    }
+    return chg != 0 || !BS_VEC_IS_ZERO(vchg);
+}
+
+
+//Return true if a == b.
+static bool isEqualWord(BYTE const* a, BYTE const* b, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        if (!BS_VEC_IS_ZERO(BS_VEC_XOR(BS_VEC_LOAD(a + i),
+                                       BS_VEC_LOAD(b + i)))) {
+            return false;
+        }
+    }
+    for (; i < nb; i += BS_WORD_BYTE) {
+        if (loadWord(a + i) != loadWord(b + i)) { return false; }
+    }
+    return true;
+}
+
+
+//Return true if 'b' is subset of 'a', namely b & ~a is empty.
+static bool isContainWord(BYTE const* a, BYTE const* b, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        if (!BS_VEC_IS_ZERO(BS_VEC_ANDN(BS_VEC_LOAD(b + i),
+                                        BS_VEC_LOAD(a + i)))) {
+            return false;
+        }
+    }
+    for (; i < nb; i += BS_WORD_BYTE) {
+        if ((loadWord(b + i) & ~loadWord(a + i)) != 0) { return false; }
+    }
+    return true;
+}
+
+
+//Return true if a & b is not empty.
+static bool isIntersectWord(BYTE const* a, BYTE const* b, UINT n)
+{
+    UINT const nb = n * BS_WORD_BYTE;
+    UINT i = 0;
+    for (; i + BS_VEC_BYTE <= nb; i += BS_VEC_BYTE) {
+        if (!BS_VEC_IS_ZERO(BS_VEC_AND(BS_VEC_LOAD(a + i),
+                                       BS_VEC_LOAD(b + i)))) {
+            return true;
+        }
+    }
+    for (; i < nb; i += BS_WORD_BYTE) {
+        if ((loadWord(a + i) & loadWord(b + i)) != 0) { return true; }
+    }
+    return false;
+}
+
+
+//Return true if all bits from the 'i'th word to the end of buffer 'p'
+//which has 'size' bytes are zero.
+static bool isZeroFromWord(BYTE const* p, UINT size, UINT i)
+{
+    UINT const nb = size / BS_WORD_BYTE * BS_WORD_BYTE;
+    UINT j = i * BS_WORD_BYTE;
+    for (; j + BS_VEC_BYTE <= nb; j += BS_VEC_BYTE) {
+        if (!BS_VEC_IS_ZERO(BS_VEC_LOAD(p + j))) { return false; }
+    }
+    for (; j < nb; j += BS_WORD_BYTE) {
+        if (loadWord(p + j) != 0) { return false; }
+    }
+    for (j = MAX(j, nb); j < size; j++) {
+        if (p[j] != 0) { return false; }
+    }
+    return true;
+}
+//END Word Operations
+
+
 //
 //START BitSet
 //
@@ -852,10 +1166,10 @@ void * BitSet::realloc(IN void * src, size_t orgsize, size_t newsize)
 //Allocate bytes
 void BitSet::alloc(UINT size)
 {
-    m_size = size;
+    m_size = BS_ROUNDUP_WORD(size);
     if (m_ptr != nullptr) { ::free(m_ptr); }
-    if (size != 0) {
-        m_ptr = (BYTE*)::malloc(size);
+    if (m_size != 0) {
+        m_ptr = (BYTE*)::malloc(m_size);
         ::memset(m_ptr, 0, m_size);
     } else {
         m_ptr = nullptr;
@@ -866,30 +1180,40 @@ void BitSet::alloc(UINT size)
 //Returns a new set which is the union of set1 and set2,
 //and modify set1 as result operand.
 void BitSet::bunion(BitSet const& bs)
+{
+    bunion_changed(bs);
+}
+
+
+//Union 'bs' into current set.
+//Return true if current set changed.
+bool BitSet::bunion_changed(BitSet const& bs)
 {
     ASSERT0(this != &bs);
-    if (bs.m_ptr == nullptr) { return; }
+    if (bs.m_ptr == nullptr) { return false; }
     UINT cp_sz = bs.m_size; //size needs to unifiy
     if (m_size < bs.m_size) {
         //src's last byte pos.
         INT l = bs.get_last();
-        if (l < 0) { return; }
+        if (l < 0) { return false; }
         cp_sz = l / BITS_PER_BYTE + 1;
         if (m_size < cp_sz) {
-            m_ptr = (BYTE*)realloc(m_ptr, m_size, cp_sz);
-            m_size = cp_sz;
+            UINT newsize = BS_ROUNDUP_WORD(cp_sz);
+            m_ptr = (BYTE*)realloc(m_ptr, m_size, newsize);
+            m_size = newsize;
         }
     }
-    UINT const num_of_uint = cp_sz / BYTES_PER_UINT; //floor-div.
     ASSERTN(m_ptr, ("not yet init"));
-    UINT * uint_ptr_this = (UINT*)m_ptr;
-    UINT * uint_ptr_bs = (UINT*)bs.m_ptr;
-    for (UINT i = 0; i < num_of_uint; i++) {
-        uint_ptr_this[i] |= uint_ptr_bs[i];
-    }
-    for (UINT i = num_of_uint * BYTES_PER_UINT; i < cp_sz; i++) {
-        m_ptr[i] |= bs.m_ptr[i];
-    }
+    UINT const n = cp_sz / BS_WORD_BYTE; //floor-div.
+    bool changed = unionWord(m_ptr, bs.m_ptr, n);
+    if (n * BS_WORD_BYTE < cp_sz) {
+        //The last partial word of ROBitSet.
+        BSWord d = loadWord(m_ptr + n * BS_WORD_BYTE);
+        BSWord s = getWordOrZero(bs.m_ptr, bs.m_size, n);
+        changed |= (s & ~d) != 0;
+        storeWord(m_ptr + n * BS_WORD_BYTE, d | s);
+    }
+    return changed;
 }
 
 
@@ -898,8 +1222,9 @@ void BitSet::bunion(UINT elem)
 {
     UINT const first_byte = DIVBPB(elem);
     if (m_size < (first_byte+1)) {
-        m_ptr = (BYTE*)realloc(m_ptr, m_size, first_byte + 1);
-        m_size = first_byte+1;
+        UINT newsize = BS_ROUNDUP_WORD(first_byte + 1);
+        m_ptr = (BYTE*)realloc(m_ptr, m_size, newsize);
+        m_size = newsize;
     }
     elem = MODBPB(elem);
     m_ptr[first_byte] |= (BYTE)(1 << elem);
@@ -930,46 +1255,98 @@ void BitSet::diff(BitSet const& bs)
 {
     ASSERT0(this != &bs);
     if (m_size == 0 || bs.m_size == 0) { return; }
+    ASSERTN(m_ptr != nullptr, ("not yet init"));
     UINT minsize = MIN(m_size, bs.m_size);
-    //Common part: copy the inverse bits.
-    //for (UINT i = 0; i < minsize; i++) {
-    //    m_ptr[i] &= ~bs.m_ptr[i];
-    //}
-    UINT num_of_uint = minsize / BYTES_PER_UINT;
-    UINT * uint_ptr_this = (UINT*)m_ptr;
-    UINT * uint_ptr_bs = (UINT*)bs.m_ptr;
-    for (UINT i = 0; i < num_of_uint; i++) {
-        UINT d = uint_ptr_bs[i];
-        if (d != 0) {
-            uint_ptr_this[i] &= ~d;
-        }
+    //Common part: clear the bits of 'bs'.
+    UINT const n = minsize / BS_WORD_BYTE;
+    diffWord(m_ptr, bs.m_ptr, n);
+    if (n * BS_WORD_BYTE < minsize) {
+        //The last partial word of ROBitSet.
+        storeWord(m_ptr + n * BS_WORD_BYTE,
+                  loadWord(m_ptr + n * BS_WORD_BYTE) &
+                  ~getWordOrZero(bs.m_ptr, bs.m_size, n));
     }
+}
 
-    ASSERTN(m_ptr != nullptr, ("not yet init"));
-    for (UINT i = num_of_uint * BYTES_PER_UINT; i < minsize; i++) {
-        BYTE d = bs.m_ptr[i];
-        if (d != 0) {
-            m_ptr[i] &= ~d;
+
+//Set current set to be (b - c) | d in one pass.
+//Return true if current set changed.
+bool BitSet::diff_union(BitSet const& b, BitSet const& c, BitSet const& d)
+{
+    UINT const maxsize = MAX(b.m_size, d.m_size);
+    if (m_size < maxsize) {
+        //Grow the buffer to hold the last element of 'b' and 'd'.
+        INT l = MAX(b.get_last(), d.get_last());
+        UINT need = l < 0 ? 0 : l / BITS_PER_BYTE + 1;
+        if (m_size < need) {
+            UINT newsize = BS_ROUNDUP_WORD(need);
+            //NOTE: 'this' may be the same object as b, c or d, their buffer
+            //pointer will be read after the reallocation.
+            m_ptr = (BYTE*)realloc(m_ptr, m_size, newsize);
+            m_size = newsize;
+        }
+    }
+    if (m_size == 0) { return false; }
+
+    //Process the words of current set range by range, the sets that
+    //are shorter than the range supply zero words.
+    bool changed = false;
+    UINT const num = m_size / BS_WORD_BYTE;
+    for (UINT i = 0; i < num;) {
+        UINT len = num - i;
+        BYTE const* pb = getWordRange(b.m_ptr, b.m_size, i, len);
+        BYTE const* pc = getWordRange(c.m_ptr, c.m_size, i, len);
+        BYTE const* pd = getWordRange(d.m_ptr, d.m_size, i, len);
+        BYTE * p = m_ptr + i * BS_WORD_BYTE;
+        if (pb != nullptr && pc != nullptr && pd != nullptr) {
+            changed |= diffUnionWord(p, pb, pc, pd, len);
+            i += len;
+            continue;
         }
+
+        //The last partial word of ROBitSet.
+        BSWord r = (getWordOrZero(b.m_ptr, b.m_size, i) &
+                    ~getWordOrZero(c.m_ptr, c.m_size, i)) |
+                   getWordOrZero(d.m_ptr, d.m_size, i);
+        changed |= r != loadWord(p);
+        storeWord(p, r);
+        i++;
     }
+    return changed;
 }
 
 
 //Returns the a new set which is intersection of 'set1' and 'set2'.
 void BitSet::intersect(BitSet const& bs)
+{
+    intersect_changed(bs);
+}
+
+
+//Intersect current set with 'bs'.
+//Return true if current set changed.
+bool BitSet::intersect_changed(BitSet const& bs)
 {
     ASSERT0(this != &bs);
-    if (m_ptr == nullptr) { return; }
-    if (m_size > bs.m_size) {
-        for (UINT i = 0; i < bs.m_size; i++) {
-            m_ptr[i] &= bs.m_ptr[i];
-        }
-        ::memset(m_ptr + bs.m_size, 0, m_size - bs.m_size);
-    } else {
-        for (UINT i = 0; i < m_size; i++) {
-            m_ptr[i] &= bs.m_ptr[i];
+    if (m_ptr == nullptr) { return false; }
+    UINT const minsize = MIN(m_size, bs.m_size);
+    UINT const n = minsize / BS_WORD_BYTE;
+    bool changed = intersectWord(m_ptr, bs.m_ptr, n);
+    if (n * BS_WORD_BYTE < minsize) {
+        //The last partial word of ROBitSet.
+        BSWord d = loadWord(m_ptr + n * BS_WORD_BYTE);
+        BSWord s = getWordOrZero(bs.m_ptr, bs.m_size, n);
+        changed |= (d & ~s) != 0;
+        storeWord(m_ptr + n * BS_WORD_BYTE, d & s);
+    }
+    if (m_size > minsize) {
+        UINT const start = BS_ROUNDUP_WORD(minsize);
+        if (start < m_size) {
+            changed |= !isZeroFromWord(m_ptr, m_size, start / BS_WORD_BYTE);
+            ::memset(m_ptr + start, 0, m_size - start);
         }
     }
+    return changed;
 }
 
 
@@ -979,27 +1356,19 @@ void BitSet::intersect(BitSet const& bs)
 void BitSet::rev(UINT last_bit_pos)
 {
     ASSERTN(m_ptr != nullptr, ("can not reverse empty set"));
-    UINT const last_byte_pos = last_bit_pos / BITS_PER_BYTE;
-    ASSERT0(last_byte_pos < m_size);
-
-    UINT const n = last_byte_pos / BYTES_PER_UINT;
-    for (UINT i = 0; i < n; i++) {
-        ((UINT*)m_ptr)[i] = ~(((UINT*)m_ptr)[i]);
-    }
-
-    for (UINT i = n * BYTES_PER_UINT; i < last_byte_pos; i++) {
-        m_ptr[i] = ~m_ptr[i];
-    }
-
-    //Here we use UINT type to avoid byte truncate operation.
-    UINT last_byte = m_ptr[last_byte_pos];
-
-    UINT const mask = (1 << (last_bit_pos % BITS_PER_BYTE + 1)) - 1;
-    UINT const rev_last_byte = (~last_byte) & mask;
-    last_byte = (last_byte & (~mask)) | rev_last_byte;
-
-    //Truncate to BYTE.
-    m_ptr[last_byte_pos] = (BYTE)last_byte;
+    ASSERT0(last_bit_pos / BITS_PER_BYTE < m_size);
+    UINT const last_word_pos = DIVBPW(last_bit_pos);
+    for (UINT i = 0; i < last_word_pos; i++) {
+        BYTE * p = m_ptr + i * BS_WORD_BYTE;
+        storeWord(p, ~loadWord(p));
+    }
+
+    //Reverse the bits of last word up to 'last_bit_pos'.
+    UINT const ofst = MODBPW(last_bit_pos);
+    BSWord const mask = ofst == BS_WORD_BIT - 1 ?
+        ~(BSWord)0 : (((BSWord)1) << (ofst + 1)) - 1;
+    BYTE * p = m_ptr + last_word_pos * BS_WORD_BYTE;
+    storeWord(p, loadWord(p) ^ mask);
 }
 
 
@@ -1013,31 +1382,18 @@ void BitSet::complement(BitSet const& univers)
 
 
 //Return the element count in 'set'
-//Add up the population count of each byte in the set.  We get the
-//population counts from the table above.  Great for a machine with
-//effecient loadbyte instructions.
+//Add up the population count of each word in the set.
 UINT BitSet::get_elem_count() const
 {
     if (m_ptr == nullptr) { return 0; }
     UINT count = 0;
-//#define HAMMING_WEIGHT_METHOD
-#ifdef HAMMING_WEIGHT_METHOD
-    ASSERT0(BYTES_PER_UINT == 4);
-    UINT const m = m_size / BYTES_PER_UINT;
-    for (UINT i = 0; i < m; i++) {
-        INT v = ((INT*)(m_ptr))[i];
-        v = v - ((v >> 1) & 0x55555555);
-        v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
-        count += (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
-    }
-    for (UINT i = m * BYTES_PER_UINT; i < m_size; i++) {
-        count += g_bit_count[m_ptr[i]];
+    UINT const n = m_size / BS_WORD_BYTE;
+    for (UINT i = 0; i < n; i++) {
+        count += countWordOne(loadWord(m_ptr + i * BS_WORD_BYTE));
     }
-#else
-    for (UINT i = 0; i < m_size; i++) {
-        count += g_bit_count[m_ptr[i]];
+    if (n * BS_WORD_BYTE < m_size) {
+        count += countWordOne(getWordOrZero(m_ptr, m_size, n));
     }
-#endif
     return count;
 }
 
@@ -1068,31 +1424,17 @@ bool BitSet::is_equal(BitSet const& bs) const
         size2 = tmp1;
     }
 
-    UINT v1 = *(UINT*)ptr1;
-    UINT v2 = *(UINT*)ptr2;
-    switch (size1) {
-    case 1:
-        if ((v1&0xff) != (v2&0xff)) { return false; }
-        break;
-    case 2:
-        if ((v1&0xffff) != (v2&0xffff)) { return false; }
-        break;
-    case 3:
-        if ((v1&0xffffff) != (v2&0xffffff)) { return false; }
-        break;
-    case 4:
-        if ((v1&0xffffffff) != (v2&0xffffffff)) { return false; }
-        break;
-    default:
-        if (::memcmp(ptr1, ptr2, size1) != 0) { return false; }
-    }
-
-    for (UINT i = size1; i < size2; i++) {
-        if (ptr2[i] != 0) {
+    UINT n = size1 / BS_WORD_BYTE;
+    if (!isEqualWord(ptr1, ptr2, n)) { return false; }
+    if (n * BS_WORD_BYTE < size1) {
+        //The last partial word of ROBitSet.
+        if (getWordOrZero(ptr1, size1, n) != getWordOrZero(ptr2, size2, n)) {
             return false;
         }
+        n++;
     }
-    return true;
+    //The rest part of set2 must be empty.
+    return isZeroFromWord(ptr2, size2, n);
 }
 
 
@@ -1117,95 +1459,49 @@ bool BitSet::is_contain(UINT elem) const
 bool BitSet::is_contain(BitSet const& bs, bool strict) const
 {
     ASSERT0(this != &bs);
-    bool scon = false; //Set to true if 'this' strictly contained 'bs'.
-    INT const first_bit = get_first();
-    if (first_bit == -1) {
-        return false;
-    }
-    INT const bs_first_bit = bs.get_first();
-    if (bs_first_bit == -1) {
-        //nullptr set be contained for any set.
-        return true;
-    }
-
-    if (first_bit > bs_first_bit) {
-        return false;
-    } else if (strict && first_bit < bs_first_bit) {
-        scon = true;
-    }
-
-    INT const start_bit = MAX(first_bit, bs_first_bit);
-    INT const start_byte = DIVBPB(start_bit);
-
-    if (m_size < bs.m_size) {//'this' is smaller
-        if (bs.get_next(MULBPB(m_size) - 1) != -1) {
-            //'bs' has more elements than 'this'.
-            return false;
-        }
-    } else if (strict && m_size > bs.m_size) {//'bs' is smaller
-        if (get_next(MULBPB(bs.m_size) - 1) != -1) {
-            //'this' has more elements than 'this'.
-            scon = true;
-        }
-    }
-
-    INT const minsize = MIN(m_size, bs.m_size);
-    for (INT i = start_byte; i < minsize; i++) {
-        if ((m_ptr[i] & bs.m_ptr[i]) != bs.m_ptr[i]) {
+    UINT const minsize = MIN(m_size, bs.m_size);
+    UINT n = minsize / BS_WORD_BYTE;
+    if (!isContainWord(m_ptr, bs.m_ptr, n)) { return false; }
+    if (n * BS_WORD_BYTE < minsize) {
+        //The last partial word of ROBitSet.
+        if ((getWordOrZero(bs.m_ptr, bs.m_size, n) &
+             ~getWordOrZero(m_ptr, m_size, n)) != 0) {
             return false;
         }
-        if (strict && m_ptr[i] != bs.m_ptr[i]) {
-            scon = true;
-        }
+        n++;
     }
-
-    if (strict && !scon) {
+    if (bs.m_size > minsize && !isZeroFromWord(bs.m_ptr, bs.m_size, n)) {
+        //'bs' has more elements than 'this'.
         return false;
     }
-    return true;
+
+    //Empty set does not contain any set, even if the empty set.
+    //And empty set is contained by any nonempty set.
+    if (is_empty()) { return false; }
+
+    //The bitset must have at least one element that does not belong
+    //to 'bs' if 'strict' is true.
+    return !strict || !is_equal(bs);
 }
 
 
 bool BitSet::is_empty() const
 {
     if (m_ptr == nullptr) { return true; }
-    UINT num_of_uint = m_size / BYTES_PER_UINT;
-    UINT * uint_ptr = (UINT*)m_ptr;
-    for (UINT i = 0; i < num_of_uint; i++) {
-        if (uint_ptr[i] != 0) {
-             return false;
-        }
-    }
-    for (UINT i = num_of_uint * BYTES_PER_UINT; i < m_size; i++) {
-        if (m_ptr[i] != (BYTE)0) {
-             return false;
-        }
-    }
-    return true;
+    return isZeroFromWord(m_ptr, m_size, 0);
 }
 
 
 bool BitSet::is_intersect(BitSet const& bs) const
 {
     ASSERT0(this != &bs);
-    INT const first_bit = get_first();
-    if (first_bit == -1) {
-        return false;
-    }
-    INT const bs_first_bit = bs.get_first();
-    if (bs_first_bit == -1) { //Empty set
-        return false;
-    }
-
-    UINT const start_bit = MAX(first_bit, bs_first_bit);
-    UINT const end_bit = MIN(get_last(), bs.get_last());
-    UINT const start_byte = DIVBPB(start_bit);
-    UINT const end_byte = DIVBPB(end_bit);
-
-    for (UINT i = start_byte; i <= end_byte; i++) {
-        if ((m_ptr[i] & bs.m_ptr[i]) != (BYTE)0) {
-            return true;
-        }
+    UINT const minsize = MIN(m_size, bs.m_size);
+    UINT const n = minsize / BS_WORD_BYTE;
+    if (isIntersectWord(m_ptr, bs.m_ptr, n)) { return true; }
+    if (n * BS_WORD_BYTE < minsize) {
+        //The last partial word of ROBitSet.
+        return (getWordOrZero(m_ptr, m_size, n) &
+                getWordOrZero(bs.m_ptr, bs.m_size, n)) != 0;
     }
     return false;
 }
@@ -1349,25 +1645,11 @@ bool BitSet::has_elem_in_range(UINT low, UINT high) const
 INT BitSet::get_first() const
 {
     if (m_size == 0) { return -1; }
-    UINT i = 0;
-    UINT m = m_size / BYTES_PER_UINT * BYTES_PER_UINT;
-    for (UINT const* uint_ptr = ((UINT const*)(m_ptr));
-         i < m; uint_ptr++, i += 4) {
-        if (*uint_ptr == 0) { continue; }
-        for (BYTE const* bptr = ((BYTE*)(uint_ptr));
-             i < m; bptr++, i++) {
-            BYTE byte = *bptr;
-            if (byte != (BYTE)0) {
-                return g_first_one[byte] + (MULBPB(i));
-            }
-        }
-        ASSERTN(0, ("not arrival"));
-    }
-    ASSERT0(i <= m_size);
-    for (; i < m_size; i++) {
-        BYTE byte = m_ptr[i];
-        if (byte != (BYTE)0) {
-            return g_first_one[byte] + (MULBPB(i));
+    UINT const num = getWordNum(m_size);
+    for (UINT i = 0; i < num; i++) {
+        BSWord w = getWordOrZero(m_ptr, m_size, i);
+        if (w != 0) {
+            return (INT)(MULBPW(i) + getWordFirstOne(w));
         }
     }
     return -1;
@@ -1379,31 +1661,12 @@ INT BitSet::get_first() const
 INT BitSet::get_last() const
 {
     if (m_size == 0) { return -1; }
-    INT i = m_size - 1;
-    UINT m = m_size % BYTES_PER_UINT;
-    if (m == 0) {
-        m = BYTES_PER_UINT;
-    }
-    for (; i >= (INT)(m_size - m); i--) {
-        BYTE byte = m_ptr[i];
-        if (byte != (BYTE)0) {
-            return g_last_one[byte] + (MULBPB(i));
-        }
-    }
-    if (i < 0) { return -1; }
-    UINT const* uint_ptr;
-    for (uint_ptr = ((UINT const*)(m_ptr)) + i / BYTES_PER_UINT;
-         i >= 0; uint_ptr--, i -= 4) {
-        if (*uint_ptr == 0) { continue; }
-        for (BYTE const* bptr = ((BYTE*)(uint_ptr)) + BYTES_PER_UINT - 1;
-             i >= 0; bptr--, i--) {
-            BYTE byte = *bptr;
-            if (byte != (BYTE)0) {
-                return g_last_one[byte] + (MULBPB(i));
-            }
+    for (UINT i = getWordNum(m_size); i > 0; i--) {
+        BSWord w = getWordOrZero(m_ptr, m_size, i - 1);
+        if (w != 0) {
+            return (INT)(MULBPW(i - 1) + getWordLastOne(w));
         }
     }
-    ASSERT0(m_ptr == ((BYTE*)uint_ptr) + sizeof(UINT));
     return -1;
 }
 
@@ -1529,30 +1792,22 @@ BitSet * BitSet::get_subset_in_range(UINT low, UINT high, OUT BitSet & subset)
 INT BitSet::get_next(UINT elem) const
 {
     if (m_size == 0) { return -1; }
-    INT first_byte = DIVBPB(elem);
-    if (((UINT)first_byte + 1) > m_size) {
+    if (DIVBPB(elem) + 1 > m_size) {
         return -1;
     }
-    BYTE byte = m_ptr[first_byte];
-    elem = MODBPB(elem) + 1; //index in 'first_byte'.
-    byte >>= elem; //Erase low 'elem' bits.
-    byte <<= elem;
-    if (byte == 0) {
-        //No elements in this byte.
-        UINT i = first_byte + 1;
-        while (i < m_size) {
-            byte = m_ptr[i];
-            if (byte != 0) {
-                first_byte = i;
-                break;
-            }
-            i++;
-        }
-        if (byte == 0) {
-            return -1;
-        }
-    }
-    return g_first_one[byte] + (MULBPB(first_byte));
+    UINT i = DIVBPW(elem);
+    //Erase the bits up to 'elem' in the word.
+    BSWord w = getWordOrZero(m_ptr, m_size, i);
+    UINT const ofst = MODBPW(elem);
+    w = ofst == BS_WORD_BIT - 1 ? 0 : w & (~(BSWord)0 << (ofst + 1));
+    UINT const num = getWordNum(m_size);
+    while (w == 0) {
+        //No elements in this word.
+        i++;
+        if (i >= num) { return -1; }
+        w = getWordOrZero(m_ptr, m_size, i);
+    }
+    return (INT)(MULBPW(i) + getWordFirstOne(w));
 }
 
 
@@ -1568,7 +1823,7 @@ void BitSet::copy(BitSet const& src)
 {
     ASSERTN(this != &src, ("copy self"));
     if (src.m_size == 0) {
-        ::memset(m_ptr, 0, m_size);
+        clean();
         return;
     }
 
@@ -1577,15 +1832,16 @@ void BitSet::copy(BitSet const& src)
         //src's last byte pos.
         INT l = src.get_last();
         if (l < 0) {
-            ::memset(m_ptr, 0, m_size);
+            clean();
             return;
         }
 
         cp_sz = l / BITS_PER_BYTE + 1;
         if (m_size < cp_sz) {
             ::free(m_ptr);
-            m_ptr = (BYTE*)::malloc(cp_sz);
-            m_size = cp_sz;
+            m_size = BS_ROUNDUP_WORD(cp_sz);
+            m_ptr = (BYTE*)::malloc(m_size);
+            ::memset(m_ptr + cp_sz, 0, m_size - cp_sz);
         } else if (m_size > cp_sz) {
             ::memset(m_ptr + cp_sz, 0, m_size - cp_sz);
         }
@@ -1745,6 +2001,93 @@ size_t BitSetMgr::count_mem(FILE * h) const
 
 
 
+//
+//Word Operations
+//
+bool bs_word_union(BSWord * dst, BSWord const* src, UINT n)
+{
+    return unionWord((BYTE*)dst, (BYTE const*)src, n);
+}
+
+
+bool bs_word_intersect(BSWord * dst, BSWord const* src, UINT n)
+{
+    return intersectWord((BYTE*)dst, (BYTE const*)src, n);
+}
+
+
+void bs_word_diff(BSWord * dst, BSWord const* src, UINT n)
+{
+    diffWord((BYTE*)dst, (BYTE const*)src, n);
+}
+
+
+bool bs_word_is_equal(BSWord const* a, BSWord const* b, UINT n)
+{
+    return isEqualWord((BYTE const*)a, (BYTE const*)b, n);
+}
+
+
+bool bs_word_is_intersect(BSWord const* a, BSWord const* b, UINT n)
+{
+    return isIntersectWord((BYTE const*)a, (BYTE const*)b, n);
+}
+
+
+bool bs_word_is_empty(BSWord const* p, UINT n)
+{
+    return isZeroFromWord((BYTE const*)p, n * BS_WORD_BYTE, 0);
+}
+
+
+UINT bs_word_get_elem_count(BSWord const* p, UINT n)
+{
+    UINT count = 0;
+    for (UINT i = 0; i < n; i++) {
+        count += countWordOne(p[i]);
+    }
+    return count;
+}
+
+
+INT bs_word_get_first(BSWord const* p, UINT n)
+{
+    for (UINT i = 0; i < n; i++) {
+        if (p[i] != 0) {
+            return (INT)(MULBPW(i) + getWordFirstOne(p[i]));
+        }
+    }
+    return -1;
+}
+
+
+INT bs_word_get_last(BSWord const* p, UINT n)
+{
+    for (UINT i = n; i > 0; i--) {
+        if (p[i - 1] != 0) {
+            return (INT)(MULBPW(i - 1) + getWordLastOne(p[i - 1]));
+        }
+    }
+    return -1;
+}
+
+
+INT bs_word_get_next(BSWord const* p, UINT n, UINT elem)
+{
+    UINT i = DIVBPW(elem);
+    if (i >= n) { return -1; }
+    UINT const ofst = MODBPW(elem);
+    BSWord w = ofst == BS_WORD_BIT - 1 ? 0 : p[i] & (~(BSWord)0 << (ofst + 1));
+    while (w == 0) {
+        i++;
+        if (i >= n) { return -1; }
+        w = p[i];
+    }
+    return (INT)(MULBPW(i) + getWordFirstOne(w));
+}
+//END Word Operations
+
+
 //
 //Binary Operations
 //
@@ -42,9 +42,23 @@ namespace xcom {
 #define BITS_PER_BYTE     8
 #define BYTES_PER_UINT    4
 
+//BitSet operates its buffer in 64-bit words, and the buffer size is always
+//rounded up to whole words, the padding bytes are zero.
+#define BS_WORD_BYTE      8
+#define BS_ROUNDUP_WORD(bytesize) \
+    (((bytesize) + BS_WORD_BYTE - 1) & ~(UINT)(BS_WORD_BYTE - 1))
+
+typedef ULONGLONG BSWord;
+
 class BitSet;
 class BitSetMgr;
 
+//The bitset is a byte vector, bit 'i' is the (i % 8)th bit of the (i / 8)th
+//byte. Operations process the vector in 64-bit words, and use SSE2 or AVX2
+//if the target supports it, the scanning of element count and position
+//use population count and trailing zero count of word.
+//NOTE: The mapping from bit position to the bit of word assumes the target
+//is little endian.
 class BitSet {
     friend BitSet * bs_union(BitSet const& set1,
                              BitSet const& set2,
@@ -80,12 +94,13 @@ public:
     ~BitSet() { destroy(); }
 
     //Initialize bit buffer.
+    //'init_pool_size': byte size, it will be rounded up to whole words.
     void init(UINT init_pool_size = 1)
     {
         if (m_ptr != nullptr) { return; }
-        m_size = init_pool_size;
-        if (init_pool_size == 0) { return; }
-        m_ptr = (BYTE*)::malloc(init_pool_size);
+        m_size = BS_ROUNDUP_WORD(init_pool_size);
+        if (m_size == 0) { return; }
+        m_ptr = (BYTE*)::malloc(m_size);
         ::memset(m_ptr, 0, m_size);
     }
 
@@ -99,13 +114,17 @@ public:
         m_size = 0;
     }
 
-    //Allocate bytes
+    //Allocate bytes, the size will be rounded up to whole words.
     void alloc(UINT size);
 
     //Returns a new set which is the union of set1 and set2,
     //and modify set1 as result operand.
     void bunion(BitSet const& bs);
 
+    //Union 'bs' into current set.
+    //Return true if current set changed.
+    bool bunion_changed(BitSet const& bs);
+
     //Add a element which corresponding to 'elem' bit, and set this bit.
     void bunion(UINT elem);
 
@@ -133,6 +152,12 @@ public:
     //  { x : member( x, 'set1' ) & ~ member( x, 'set2' ) }.
     void diff(BitSet const& bs);
 
+    //Set current set to be (b - c) | d in one pass, the typical transfer
+    //function of dataflow equation, e.g: livein = (liveout - def) | use.
+    //Return true if current set changed.
+    //Current set may be the same object as any of 'b', 'c' and 'd'.
+    bool diff_union(BitSet const& b, BitSet const& c, BitSet const& d);
+
     //Dump bit value and position.
     void dump(CHAR const* name = nullptr, bool is_del = false,
               UINT flag = BS_DUMP_BITSET | BS_DUMP_POS,
@@ -143,9 +168,7 @@ public:
     void dump(FILE * h) const { dump(h, BS_DUMP_BITSET|BS_DUMP_POS, -1); }
 
     //Return the element count in 'set'
-    //Add up the population count of each byte in the set.  We get the
-    //population counts from the table above.  Great for a machine with
-    //effecient loadbyte instructions.
+    //Add up the population count of each word in the set.
     UINT get_elem_count() const;
 
     //Return position of first element, start from '0'.
@@ -176,6 +199,10 @@ public:
     //Returns the a new set which is intersection of 'set1' and 'set2'.
     void intersect(BitSet const& bs);
 
+    //Intersect current set with 'bs'.
+    //Return true if current set changed.
+    bool intersect_changed(BitSet const& bs);
+
     //Return true if all elements in current bitset is equal to 'bs'.
     bool is_equal(BitSet const& bs) const;
 
@@ -217,6 +244,8 @@ public:
 
 
 //Read Only BitSet.
+//The byte vector is neither required to be word aligned nor padded to whole
+//words, BitSet reads the last partial word as if it is zero extended.
 class ROBitSet : public BitSet {
     COPY_CONSTRUCTOR(ROBitSet);
 public:
@@ -257,6 +286,12 @@ public:
     void alloc(UINT size) { DUMMYUSE(size); UNREACHABLE(); }
     void bunion(BitSet const& bs) { DUMMYUSE(bs); UNREACHABLE(); }
     void bunion(UINT elem) { DUMMYUSE(elem); UNREACHABLE(); }
+    bool bunion_changed(BitSet const& bs)
+    { DUMMYUSE(bs); UNREACHABLE(); return false; }
+    bool intersect_changed(BitSet const& bs)
+    { DUMMYUSE(bs); UNREACHABLE(); return false; }
+    bool diff_union(BitSet const& b, BitSet const& c, BitSet const& d)
+    { DUMMYUSE(b); DUMMYUSE(c); DUMMYUSE(d); UNREACHABLE(); return false; }
 };
 
 
@@ -647,5 +682,25 @@ extern BitSet * bs_diff(BitSet const& set1,
 extern BitSet * bs_intersect(BitSet const& set1,
                              BitSet const& set2,
                              OUT BitSet & res);
+
+//Word Operations
+//The following functions operate arrays of 'n' BSWord, they share the
+//vectorized kernels of BitSet with other bitset implementations, e.g:
+//the inline segments of SBitSet.
+//Return true if any word of 'dst' changed.
+extern bool bs_word_union(BSWord * dst, BSWord const* src, UINT n);
+//Return true if any word of 'dst' changed.
+extern bool bs_word_intersect(BSWord * dst, BSWord const* src, UINT n);
+extern void bs_word_diff(BSWord * dst, BSWord const* src, UINT n);
+extern bool bs_word_is_equal(BSWord const* a, BSWord const* b, UINT n);
+extern bool bs_word_is_intersect(BSWord const* a, BSWord const* b, UINT n);
+extern bool bs_word_is_empty(BSWord const* p, UINT n);
+extern UINT bs_word_get_elem_count(BSWord const* p, UINT n);
+//Return -1 if there is no element.
+extern INT bs_word_get_first(BSWord const* p, UINT n);
+//Return -1 if there is no element.
+extern INT bs_word_get_last(BSWord const* p, UINT n);
+//Return the first element after 'elem', or -1 if there is no such one.
+extern INT bs_word_get_next(BSWord const* p, UINT n, UINT elem);
 } //namespace xcom
 #endif
@@ -0,0 +1,886 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __BTREE_H__
+#define __BTREE_H__
+
+namespace xcom {
+
+//B+ tree based ordered map.
+//Keys and mapped values are stored in arrays of leaf nodes, and leaves are
+//linked in key order, thus lookup touches one node of a few cache lines per
+//level and iteration walks the leaf chain without any allocation.
+//Compared with TMap, which allocates one RBTNode per key, BTMap allocates
+//one node per tens of keys.
+
+//The default byte size of node.
+//It is recommended to be 64 to 256, namely one to four cache lines.
+#define BTREE_NODE_BYTE_SIZE 256
+
+//The maximum number of levels of inner nodes.
+#define BTREE_MAX_DEPTH 32
+
+//Compute the number of elements that node can hold.
+//The number is at least 4 to keep node splitting meaningful.
+#define BTREE_NODE_CAP(node_byte_size, hdr_byte_size, elem_byte_size) \
+    (((node_byte_size) - (hdr_byte_size)) / (elem_byte_size) < 4 ? 4 : \
+     ((node_byte_size) - (hdr_byte_size)) / (elem_byte_size))
+
+//The common head of inner node and leaf node.
+class BTNodeHeader {
+public:
+    UINT num; //the number of keys in node.
+    bool is_leaf;
+};
+
+
+//Leaf node holds CAP keys and their mapped values.
+template <class Tsrc, class Ttgt, UINT NodeByteSize> class BTLeaf {
+public:
+    enum {
+        CAP = BTREE_NODE_CAP(NodeByteSize,
+                             sizeof(BTNodeHeader) + sizeof(void*) * 2,
+                             sizeof(Tsrc) + sizeof(Ttgt))
+    };
+    BTNodeHeader hdr;
+    BTLeaf * prev;
+    BTLeaf * next;
+    Tsrc key[CAP];
+    Ttgt mapped[CAP];
+};
+
+
+//Inner node holds CAP keys and CAP + 1 children.
+//Keys in child[i] are not less than key[i - 1], and are less than key[i].
+template <class Tsrc, UINT NodeByteSize> class BTInner {
+public:
+    enum {
+        CAP = BTREE_NODE_CAP(NodeByteSize,
+                             sizeof(BTNodeHeader) + sizeof(void*),
+                             sizeof(Tsrc) + sizeof(void*))
+    };
+    BTNodeHeader hdr;
+    Tsrc key[CAP];
+    BTNodeHeader * child[CAP + 1];
+};
+
+
+//BTMap Iterator.
+//The iterator refers to a position in leaf, it does not need allocation.
+//The iterator is invalid after the map is modified.
+template <class Tsrc, class Ttgt> class BTMapIter {
+public:
+    void const* leaf;
+    UINT pos;
+public:
+    BTMapIter() { clean(); }
+    void clean() { leaf = nullptr; pos = 0; }
+};
+
+
+//BTMap
+//
+//Make an ordered map between Tsrc and Ttgt, the interface is similar to
+//TMap and CompareKey is the same as the one of TMap.
+//
+//Tsrc: the type of keys maintained by this map.
+//Ttgt: the type of mapped values.
+//NodeByteSize: the approximate byte size of each node.
+//
+//NOTICE:
+//    1. Tsrc(0) is defined as default nullptr in BTMap, do NOT use T(0)
+//       as element.
+//    2. Keep the key *UNIQUE*.
+//    3. Tsrc and Ttgt are copied as plain data when nodes are split or
+//       merged.
+//    4. Unlike TMap, elements are iterated in ascending order of key.
+template <class Tsrc, class Ttgt, class CompareKey = CompareKeyBase<Tsrc>,
+          UINT NodeByteSize = BTREE_NODE_BYTE_SIZE>
+class BTMap {
+    COPY_CONSTRUCTOR(BTMap);
+protected:
+    typedef BTLeaf<Tsrc, Ttgt, NodeByteSize> Leaf;
+    typedef BTInner<Tsrc, NodeByteSize> Inner;
+    enum { LEAF_MIN = Leaf::CAP / 2, INNER_MIN = Inner::CAP / 2 };
+
+    UINT m_num_of_elem;
+    UINT m_height; //the number of levels of inner node.
+    BTNodeHeader * m_root;
+    Leaf * m_first_leaf;
+    Leaf * m_last_leaf;
+    SMemPool * m_pool;
+    void * m_free_list; //free nodes linked by the first word.
+    CompareKey m_ck;
+
+    //Inner node and leaf node are allocated in same size.
+    static size_t node_byte_size()
+    { return sizeof(Leaf) > sizeof(Inner) ? sizeof(Leaf) : sizeof(Inner); }
+
+    void * alloc_node()
+    {
+        void * p = m_free_list;
+        if (p != nullptr) {
+            m_free_list = *(void**)p;
+            return p;
+        }
+        p = smpoolMallocConstSize(node_byte_size(), m_pool);
+        ASSERT0(p);
+        return p;
+    }
+
+    void free_node(BTNodeHeader * n)
+    {
+        *(void**)n = m_free_list;
+        m_free_list = n;
+    }
+
+    Leaf * new_leaf()
+    {
+        Leaf * l = (Leaf*)alloc_node();
+        l->hdr.num = 0;
+        l->hdr.is_leaf = true;
+        l->prev = nullptr;
+        l->next = nullptr;
+        return l;
+    }
+
+    Inner * new_inner()
+    {
+        Inner * in = (Inner*)alloc_node();
+        in->hdr.num = 0;
+        in->hdr.is_leaf = false;
+        return in;
+    }
+
+    //Return the index of the first key that is not less than 't'.
+    UINT lower_bound(Tsrc const* key, UINT num, Tsrc t) const
+    {
+        UINT lo = 0;
+        UINT hi = num;
+        while (lo < hi) {
+            UINT mid = (lo + hi) >> 1;
+            if (m_ck.is_less(key[mid], t)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    //Return the index of the first key that is greater than 't'.
+    UINT upper_bound(Tsrc const* key, UINT num, Tsrc t) const
+    {
+        UINT lo = 0;
+        UINT hi = num;
+        while (lo < hi) {
+            UINT mid = (lo + hi) >> 1;
+            if (m_ck.is_less(t, key[mid])) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    //Descend to the leaf that may contain 't'.
+    //'path': record inner nodes from root if it is not nullptr.
+    //'cidx': record the child index taken at each inner node.
+    Leaf * find_leaf(Tsrc t, OUT Inner ** path, OUT UINT * cidx) const
+    {
+        ASSERT0(m_root != nullptr);
+        BTNodeHeader * n = m_root;
+        for (UINT d = 0; !n->is_leaf; d++) {
+            Inner * in = (Inner*)n;
+            UINT i = upper_bound(in->key, in->hdr.num, t);
+            if (path != nullptr) {
+                path[d] = in;
+                cidx[d] = i;
+            }
+            n = in->child[i];
+        }
+        return (Leaf*)n;
+    }
+
+    static void insert_leaf_entry(Leaf * l, UINT pos, Tsrc t, Ttgt mapped)
+    {
+        ASSERT0(l->hdr.num < (UINT)Leaf::CAP && pos <= l->hdr.num);
+        for (UINT i = l->hdr.num; i > pos; i--) {
+            l->key[i] = l->key[i - 1];
+            l->mapped[i] = l->mapped[i - 1];
+        }
+        l->key[pos] = t;
+        l->mapped[pos] = mapped;
+        l->hdr.num++;
+    }
+
+    static void remove_leaf_entry(Leaf * l, UINT pos)
+    {
+        ASSERT0(pos < l->hdr.num);
+        for (UINT i = pos + 1; i < l->hdr.num; i++) {
+            l->key[i - 1] = l->key[i];
+            l->mapped[i - 1] = l->mapped[i];
+        }
+        l->hdr.num--;
+    }
+
+    //Remove key[ki] and child[ki + 1] of inner node.
+    static void remove_inner_entry(Inner * in, UINT ki)
+    {
+        ASSERT0(ki < in->hdr.num);
+        for (UINT i = ki + 1; i < in->hdr.num; i++) {
+            in->key[i - 1] = in->key[i];
+            in->child[i] = in->child[i + 1];
+        }
+        in->hdr.num--;
+    }
+
+    //Link leaf 'r' after 'l'.
+    void link_leaf(Leaf * l, Leaf * r)
+    {
+        r->prev = l;
+        r->next = l->next;
+        if (l->next != nullptr) {
+            l->next->prev = r;
+        } else {
+            m_last_leaf = r;
+        }
+        l->next = r;
+    }
+
+    //Append all entries of leaf 'r' to its left sibling 'l', then free 'r'.
+    void merge_leaf(Leaf * l, Leaf * r)
+    {
+        ASSERT0(l->next == r && l->hdr.num + r->hdr.num <= (UINT)Leaf::CAP);
+        for (UINT i = 0; i < r->hdr.num; i++) {
+            l->key[l->hdr.num + i] = r->key[i];
+            l->mapped[l->hdr.num + i] = r->mapped[i];
+        }
+        l->hdr.num += r->hdr.num;
+        l->next = r->next;
+        if (r->next != nullptr) {
+            r->next->prev = l;
+        } else {
+            m_last_leaf = l;
+        }
+        free_node(&r->hdr);
+    }
+
+    //Append separator 'sep' and all entries of inner node 'r' to its
+    //left sibling 'l', then free 'r'.
+    void merge_inner(Inner * l, Tsrc sep, Inner * r)
+    {
+        UINT n = l->hdr.num;
+        ASSERT0(n + 1 + r->hdr.num <= (UINT)Inner::CAP);
+        l->key[n] = sep;
+        for (UINT i = 0; i < r->hdr.num; i++) {
+            l->key[n + 1 + i] = r->key[i];
+        }
+        for (UINT i = 0; i <= r->hdr.num; i++) {
+            l->child[n + 1 + i] = r->child[i];
+        }
+        l->hdr.num += 1 + r->hdr.num;
+        free_node(&r->hdr);
+    }
+
+    //Insert separator 'sep' and its right node 'right' into the parent of
+    //'left', where the parent is path[depth - 1]. Split parents that are
+    //full, and grow a new root if necessary.
+    void insert_into_parent(Inner ** path, UINT const* cidx, UINT depth,
+                            BTNodeHeader * left, Tsrc sep,
+                            BTNodeHeader * right)
+    {
+        while (depth > 0) {
+            depth--;
+            Inner * p = path[depth];
+            UINT ci = cidx[depth];
+            ASSERT0(p->child[ci] == left);
+            if (p->hdr.num < (UINT)Inner::CAP) {
+                for (UINT i = p->hdr.num; i > ci; i--) {
+                    p->key[i] = p->key[i - 1];
+                    p->child[i + 1] = p->child[i];
+                }
+                p->key[ci] = sep;
+                p->child[ci + 1] = right;
+                p->hdr.num++;
+                return;
+            }
+
+            //Split full inner node, gather CAP + 1 keys at first.
+            Tsrc key[Inner::CAP + 1];
+            BTNodeHeader * child[Inner::CAP + 2];
+            for (UINT i = 0, j = 0; i <= (UINT)Inner::CAP; i++) {
+                key[i] = i == ci ? sep : p->key[j++];
+            }
+            for (UINT i = 0, j = 0; i <= (UINT)Inner::CAP + 1; i++) {
+                child[i] = i == ci + 1 ? right : p->child[j++];
+            }
+
+            //Left part keeps 'h' keys, key[h] goes up to parent.
+            UINT h = (Inner::CAP + 1) / 2;
+            Inner * q = new_inner();
+            p->hdr.num = h;
+            for (UINT i = 0; i < h; i++) {
+                p->key[i] = key[i];
+                p->child[i] = child[i];
+            }
+            p->child[h] = child[h];
+            q->hdr.num = Inner::CAP - h;
+            for (UINT i = 0; i < q->hdr.num; i++) {
+                q->key[i] = key[h + 1 + i];
+                q->child[i] = child[h + 1 + i];
+            }
+            q->child[q->hdr.num] = child[Inner::CAP + 1];
+            left = &p->hdr;
+            sep = key[h];
+            right = &q->hdr;
+        }
+
+        //Split root.
+        ASSERTN(m_height < BTREE_MAX_DEPTH, ("too deep"));
+        Inner * r = new_inner();
+        r->hdr.num = 1;
+        r->key[0] = sep;
+        r->child[0] = left;
+        r->child[1] = right;
+        m_root = &r->hdr;
+        m_height++;
+    }
+
+    //Insert 't' if it does not exist.
+    //Return the leaf that holds 't', and its position in 'pos'.
+    Leaf * insert(Tsrc t, OUT UINT & pos, OUT bool * find)
+    {
+        if (m_root == nullptr) {
+            Leaf * l = new_leaf();
+            m_root = &l->hdr;
+            m_first_leaf = l;
+            m_last_leaf = l;
+        }
+
+        Inner * path[BTREE_MAX_DEPTH];
+        UINT cidx[BTREE_MAX_DEPTH];
+        Leaf * l = find_leaf(t, path, cidx);
+        UINT i = lower_bound(l->key, l->hdr.num, t);
+        if (i < l->hdr.num && m_ck.is_equ(l->key[i], t)) {
+            if (find != nullptr) { *find = true; }
+            pos = i;
+            return l;
+        }
+        if (find != nullptr) { *find = false; }
+
+        m_num_of_elem++;
+        Tsrc key = m_ck.createKey(t);
+        if (l->hdr.num < (UINT)Leaf::CAP) {
+            insert_leaf_entry(l, i, key, Ttgt(0));
+            pos = i;
+            return l;
+        }
+
+        //Split full leaf, the upper half moves to new leaf.
+        UINT mid = Leaf::CAP / 2;
+        Leaf * r = new_leaf();
+        for (UINT j = mid; j < (UINT)Leaf::CAP; j++) {
+            r->key[j - mid] = l->key[j];
+            r->mapped[j - mid] = l->mapped[j];
+        }
+        r->hdr.num = Leaf::CAP - mid;
+        l->hdr.num = mid;
+        link_leaf(l, r);
+
+        Leaf * res = l;
+        if (i <= mid) {
+            insert_leaf_entry(l, i, key, Ttgt(0));
+            pos = i;
+        } else {
+            insert_leaf_entry(r, i - mid, key, Ttgt(0));
+            pos = i - mid;
+            res = r;
+        }
+        insert_into_parent(path, cidx, m_height, &l->hdr, r->key[0], &r->hdr);
+        return res;
+    }
+
+    //Rebalance leaf 'l' that is child[ci] of 'p' and has too few keys.
+    //Return true if 'p' lost one key because of merging.
+    bool rebalance_leaf(Leaf * l, Inner * p, UINT ci)
+    {
+        if (ci > 0) {
+            Leaf * s = (Leaf*)p->child[ci - 1];
+            if (s->hdr.num > (UINT)LEAF_MIN) {
+                //Borrow the last entry of left sibling.
+                UINT last = s->hdr.num - 1;
+                insert_leaf_entry(l, 0, s->key[last], s->mapped[last]);
+                s->hdr.num--;
+                p->key[ci - 1] = l->key[0];
+                return false;
+            }
+        }
+        if (ci < p->hdr.num) {
+            Leaf * r = (Leaf*)p->child[ci + 1];
+            if (r->hdr.num > (UINT)LEAF_MIN) {
+                //Borrow the first entry of right sibling.
+                l->key[l->hdr.num] = r->key[0];
+                l->mapped[l->hdr.num] = r->mapped[0];
+                l->hdr.num++;
+                remove_leaf_entry(r, 0);
+                p->key[ci] = r->key[0];
+                return false;
+            }
+            if (ci == 0) {
+                merge_leaf(l, r);
+                remove_inner_entry(p, ci);
+                return true;
+            }
+        }
+        merge_leaf((Leaf*)p->child[ci - 1], l);
+        remove_inner_entry(p, ci - 1);
+        return true;
+    }
+
+    //Rebalance inner node 'n' that is child[ci] of 'p' and has too
+    //few keys. Return true if 'p' lost one key because of merging.
+    bool rebalance_inner(Inner * n, Inner * p, UINT ci)
+    {
+        if (ci > 0) {
+            Inner * s = (Inner*)p->child[ci - 1];
+            if (s->hdr.num > (UINT)INNER_MIN) {
+                //Rotate the last child of left sibling through parent.
+                n->child[n->hdr.num + 1] = n->child[n->hdr.num];
+                for (UINT i = n->hdr.num; i > 0; i--) {
+                    n->key[i] = n->key[i - 1];
+                    n->child[i] = n->child[i - 1];
+                }
+                n->key[0] = p->key[ci - 1];
+                n->child[0] = s->child[s->hdr.num];
+                n->hdr.num++;
+                p->key[ci - 1] = s->key[s->hdr.num - 1];
+                s->hdr.num--;
+                return false;
+            }
+        }
+        if (ci < p->hdr.num) {
+            Inner * r = (Inner*)p->child[ci + 1];
+            if (r->hdr.num > (UINT)INNER_MIN) {
+                //Rotate the first child of right sibling through parent.
+                n->key[n->hdr.num] = p->key[ci];
+                n->child[n->hdr.num + 1] = r->child[0];
+                n->hdr.num++;
+                p->key[ci] = r->key[0];
+                for (UINT i = 1; i < r->hdr.num; i++) {
+                    r->key[i - 1] = r->key[i];
+                    r->child[i - 1] = r->child[i];
+                }
+                r->child[r->hdr.num - 1] = r->child[r->hdr.num];
+                r->hdr.num--;
+                return false;
+            }
+            if (ci == 0) {
+                merge_inner(n, p->key[ci], r);
+                remove_inner_entry(p, ci);
+                return true;
+            }
+        }
+        merge_inner((Inner*)p->child[ci - 1], p->key[ci - 1], n);
+        remove_inner_entry(p, ci - 1);
+        return true;
+    }
+
+    Tsrc get_elem(BTMapIter<Tsrc, Ttgt> const& iter, Ttgt * mapped) const
+    {
+        Leaf const* l = (Leaf const*)iter.leaf;
+        if (l == nullptr) {
+            if (mapped != nullptr) { *mapped = Ttgt(0); }
+            return Tsrc(0);
+        }
+        ASSERT0(iter.pos < l->hdr.num);
+        if (mapped != nullptr) { *mapped = l->mapped[iter.pos]; }
+        return l->key[iter.pos];
+    }
+public:
+    BTMap() { m_pool = nullptr; init(); }
+    ~BTMap() { destroy(); }
+
+    void init()
+    {
+        if (is_init()) { return; }
+        m_pool = smpoolCreate(node_byte_size() * 4, MEM_CONST_SIZE);
+        m_free_list = nullptr;
+        m_root = nullptr;
+        m_first_leaf = nullptr;
+        m_last_leaf = nullptr;
+        m_num_of_elem = 0;
+        m_height = 0;
+    }
+
+    void destroy()
+    {
+        if (!is_init()) { return; }
+        smpoolDelete(m_pool);
+        m_pool = nullptr;
+        m_free_list = nullptr;
+        m_root = nullptr;
+        m_first_leaf = nullptr;
+        m_last_leaf = nullptr;
+        m_num_of_elem = 0;
+        m_height = 0;
+    }
+
+    //Build the map from 'num' keys that are in strictly ascending order.
+    //'mapped': mapped values of keys, it can be nullptr.
+    //The original elements are cleaned. Leaves are filled evenly, thus
+    //building is linear and needs no comparison except for sanity check.
+    void build(Tsrc const* key, Ttgt const* mapped, UINT num)
+    {
+        clean();
+        if (num == 0) { return; }
+
+        Vector<BTNodeHeader*> level;
+        Vector<Tsrc> lowkey; //the minimum key of each node in level.
+        UINT count = (num + Leaf::CAP - 1) / Leaf::CAP;
+        Leaf * prev = nullptr;
+        for (UINT j = 0, k = 0; j < count; j++) {
+            UINT n = num / count + (j < num % count ? 1 : 0);
+            Leaf * l = new_leaf();
+            for (UINT e = 0; e < n; e++, k++) {
+                ASSERTN(k == 0 || m_ck.is_less(key[k - 1], key[k]),
+                        ("keys are not in ascending order"));
+                l->key[e] = m_ck.createKey(key[k]);
+                l->mapped[e] = mapped != nullptr ? mapped[k] : Ttgt(0);
+            }
+            l->hdr.num = n;
+            if (prev == nullptr) {
+                m_first_leaf = l;
+                m_last_leaf = l;
+            } else {
+                link_leaf(prev, l);
+            }
+            prev = l;
+            level.set(j, &l->hdr);
+            lowkey.set(j, l->key[0]);
+        }
+        m_num_of_elem = num;
+
+        //Build inner levels bottom-up. The node at index j of upper level
+        //is recorded in place since it consumes at least one lower node.
+        while (count > 1) {
+            UINT upcount = (count + Inner::CAP) / (Inner::CAP + 1);
+            for (UINT j = 0, c = 0; j < upcount; j++) {
+                UINT n = count / upcount + (j < count % upcount ? 1 : 0);
+                Inner * in = new_inner();
+                Tsrc low = lowkey.get(c);
+                for (UINT e = 0; e < n; e++, c++) {
+                    in->child[e] = level.get(c);
+                    if (e > 0) {
+                        in->key[e - 1] = lowkey.get(c);
+                    }
+                }
+                in->hdr.num = n - 1;
+                level.set(j, &in->hdr);
+                lowkey.set(j, low);
+            }
+            count = upcount;
+            m_height++;
+        }
+        m_root = level.get(0);
+    }
+
+    //Remove all elements, memory of nodes is kept for reuse.
+    void clean()
+    {
+        if (m_root == nullptr) { return; }
+        Vector<BTNodeHeader*> wl;
+        UINT n = 0;
+        wl.set(n++, m_root);
+        while (n != 0) {
+            BTNodeHeader * x = wl.get(--n);
+            if (!x->is_leaf) {
+                Inner * in = (Inner*)x;
+                for (UINT i = 0; i <= in->hdr.num; i++) {
+                    wl.set(n++, in->child[i]);
+                }
+            }
+            free_node(x);
+        }
+        m_root = nullptr;
+        m_first_leaf = nullptr;
+        m_last_leaf = nullptr;
+        m_num_of_elem = 0;
+        m_height = 0;
+    }
+
+    void copy(BTMap const& src)
+    {
+        clean();
+        BTMapIter<Tsrc, Ttgt> iter;
+        Ttgt mapped;
+        for (Tsrc t = src.get_first(iter, &mapped);
+             iter.leaf != nullptr; t = src.get_next(iter, &mapped)) {
+            setAlways(t, mapped);
+        }
+    }
+
+    //Count memory usage for current object.
+    size_t count_mem() const
+    {
+        size_t c = sizeof(*this);
+        if (m_pool != nullptr) {
+            c += smpoolGetPoolSize(m_pool);
+        }
+        return c;
+    }
+
+    CompareKey * getCompareKeyObject() { return &m_ck; }
+    UINT get_elem_count() const { return m_num_of_elem; }
+
+    //Return the number of levels, a tree that only has one leaf is 1.
+    UINT get_height() const { return m_root == nullptr ? 0 : m_height + 1; }
+
+    //Return true if current object has been initialized.
+    bool is_init() const { return m_pool != nullptr; }
+
+    //Alway set new mapping even if it has done.
+    //Return the key in map, it may be different with 't'.
+    Tsrc setAlways(Tsrc t, Ttgt mapped)
+    {
+        UINT pos = 0;
+        Leaf * l = insert(t, pos, nullptr);
+        l->mapped[pos] = mapped;
+        return l->key[pos];
+    }
+
+    //Establishing mapping in between 't' and 'mapped'.
+    //Note this function will check whether 't' has been mapped.
+    Tsrc set(Tsrc t, Ttgt mapped)
+    {
+        UINT pos = 0;
+        bool find = false;
+        Leaf * l = insert(t, pos, &find);
+        ASSERTN(!find, ("already mapped"));
+        l->mapped[pos] = mapped;
+        return l->key[pos];
+    }
+
+    //Get mapped element of 't'. Set find to true if t is already be mapped.
+    Ttgt get(Tsrc t, bool * find = nullptr) const
+    {
+        if (m_root != nullptr) {
+            Leaf const* l = find_leaf(t, nullptr, nullptr);
+            UINT i = lower_bound(l->key, l->hdr.num, t);
+            if (i < l->hdr.num && m_ck.is_equ(l->key[i], t)) {
+                if (find != nullptr) { *find = true; }
+                return l->mapped[i];
+            }
+        }
+        if (find != nullptr) { *find = false; }
+        return Ttgt(0);
+    }
+
+    bool find(Tsrc t) const
+    {
+        bool f = false;
+        get(t, &f);
+        return f;
+    }
+
+    //Remove 't' from map. Return true if 't' exists.
+    bool remove(Tsrc t)
+    {
+        if (m_root == nullptr) { return false; }
+        Inner * path[BTREE_MAX_DEPTH];
+        UINT cidx[BTREE_MAX_DEPTH];
+        Leaf * l = find_leaf(t, path, cidx);
+        UINT i = lower_bound(l->key, l->hdr.num, t);
+        if (i >= l->hdr.num || !m_ck.is_equ(l->key[i], t)) { return false; }
+        remove_leaf_entry(l, i);
+        m_num_of_elem--;
+
+        if (m_height == 0) {
+            if (l->hdr.num == 0) {
+                free_node(&l->hdr);
+                m_root = nullptr;
+                m_first_leaf = nullptr;
+                m_last_leaf = nullptr;
+            }
+            return true;
+        }
+        if (l->hdr.num >= (UINT)LEAF_MIN ||
+            !rebalance_leaf(l, path[m_height - 1], cidx[m_height - 1])) {
+            return true;
+        }
+
+        //Parent lost one key, rebalance upward.
+        for (UINT d = m_height - 1;; d--) {
+            Inner * p = path[d];
+            if (d == 0) {
+                if (p->hdr.num == 0) {
+                    //Root has only one child, shrink the tree.
+                    m_root = p->child[0];
+                    free_node(&p->hdr);
+                    m_height--;
+                }
+                break;
+            }
+            if (p->hdr.num >= (UINT)INNER_MIN ||
+                !rebalance_inner(p, path[d - 1], cidx[d - 1])) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    //Iterate elements in ascending order of key.
+    //Return Tsrc(0) if there is no element.
+    Tsrc get_first(BTMapIter<Tsrc, Ttgt> & iter,
+                   Ttgt * mapped = nullptr) const
+    {
+        iter.leaf = m_first_leaf;
+        iter.pos = 0;
+        return get_elem(iter, mapped);
+    }
+
+    Tsrc get_next(BTMapIter<Tsrc, Ttgt> & iter,
+                  Ttgt * mapped = nullptr) const
+    {
+        Leaf const* l = (Leaf const*)iter.leaf;
+        if (l != nullptr && ++iter.pos >= l->hdr.num) {
+            iter.leaf = l->next;
+            iter.pos = 0;
+        }
+        return get_elem(iter, mapped);
+    }
+
+    //Iterate elements in descending order of key.
+    Tsrc get_last(BTMapIter<Tsrc, Ttgt> & iter,
+                  Ttgt * mapped = nullptr) const
+    {
+        iter.leaf = m_last_leaf;
+        iter.pos = m_last_leaf != nullptr ? m_last_leaf->hdr.num - 1 : 0;
+        return get_elem(iter, mapped);
+    }
+
+    Tsrc get_prev(BTMapIter<Tsrc, Ttgt> & iter,
+                  Ttgt * mapped = nullptr) const
+    {
+        Leaf const* l = (Leaf const*)iter.leaf;
+        if (l != nullptr) {
+            if (iter.pos == 0) {
+                l = l->prev;
+                iter.leaf = l;
+                iter.pos = l != nullptr ? l->hdr.num - 1 : 0;
+            } else {
+                iter.pos--;
+            }
+        }
+        return get_elem(iter, mapped);
+    }
+
+    //Position 'iter' at the first element whose key is not less than 't'.
+    //Range scan over [lo, hi) can be written as:
+    //  for (Tsrc k = map.get_lower_bound(lo, iter);
+    //       iter.leaf != nullptr && is_less(k, hi); k = map.get_next(iter))
+    Tsrc get_lower_bound(Tsrc t, BTMapIter<Tsrc, Ttgt> & iter,
+                         Ttgt * mapped = nullptr) const
+    {
+        iter.clean();
+        if (m_root != nullptr) {
+            Leaf const* l = find_leaf(t, nullptr, nullptr);
+            UINT i = lower_bound(l->key, l->hdr.num, t);
+            if (i < l->hdr.num) {
+                iter.leaf = l;
+                iter.pos = i;
+            } else {
+                //All keys of 'l' are less than 't'.
+                iter.leaf = l->next;
+            }
+        }
+        return get_elem(iter, mapped);
+    }
+};
+//END BTMap
+
+
+//BTTab
+//
+//Ordered table based on BTMap, the interface is similar to TTab.
+//NOTICE:
+//    1. T(0) is defined as default nullptr in BTTab, do not use T(0)
+//       as element.
+//    2. Keep the key *UNIQUE*.
+template <class T>
+class BTTabIter : public BTMapIter<T, bool> {
+public:
+    BTTabIter() {}
+};
+
+template <class T, class CompareKey = CompareKeyBase<T>,
+          UINT NodeByteSize = BTREE_NODE_BYTE_SIZE>
+class BTTab : public BTMap<T, bool, CompareKey, NodeByteSize> {
+    COPY_CONSTRUCTOR(BTTab);
+public:
+    typedef BTMap<T, bool, CompareKey, NodeByteSize> BaseBTMap;
+    BTTab() {}
+
+    //Add element into table, if it is exist, return the exist one.
+    T append(T t)
+    {
+        ASSERT0(t != T(0));
+        return BaseBTMap::setAlways(t, true);
+    }
+
+    //Add element into table, if it is exist, return the exist one.
+    T append_and_retrieve(T t) { return append(t); }
+
+    //Build the table from 'num' elements in strictly ascending order.
+    void build(T const* t, UINT num) { BaseBTMap::build(t, nullptr, num); }
+
+    void remove(T t)
+    {
+        ASSERT0(t != T(0));
+        BaseBTMap::remove(t);
+    }
+
+    bool find(T t) const { return BaseBTMap::find(t); }
+
+    T get_first(BTTabIter<T> & iter) const
+    { return BaseBTMap::get_first(iter, nullptr); }
+
+    T get_next(BTTabIter<T> & iter) const
+    { return BaseBTMap::get_next(iter, nullptr); }
+
+    T get_last(BTTabIter<T> & iter) const
+    { return BaseBTMap::get_last(iter, nullptr); }
+
+    T get_prev(BTTabIter<T> & iter) const
+    { return BaseBTMap::get_prev(iter, nullptr); }
+};
+//END BTTab
+
+} //namespace xcom
+#endif
@@ -1103,6 +1103,22 @@ ULONGLONG getusec()
 }
 
 
+//Get current wall time in micro-second.
+ULONGLONG getMicroSec()
+{
+#ifdef _ON_WINDOWS_
+    //time() is only precise to second.
+    time_t timer;
+    timer = time(&timer);
+    return (ULONGLONG)timer * 1000000LL;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return ((ULONGLONG)tv.tv_sec) * 1000000LL + tv.tv_usec;
+#endif
+}
+
+
 static inline bool prtchar(CHAR * buf, UINT buflen, UINT * pbufpos, CHAR c)
 {
     if ((*pbufpos) >= buflen) {
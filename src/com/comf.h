@@ -37,7 +37,8 @@ author: Su Zhenyu
 namespace xcom {
 
 //Forward Declaration
-template <class T> class Vector;
+template <class T> class allocator;
+template <class T, class Allocator = allocator<T> > class Vector;
 
 //Compute the maximum unsigned integer value that type is ValueType.
 //e.g: given bitwidth is 3, return 7 as result.
@@ -162,6 +163,9 @@ CHAR * getfilename(CHAR const* n, OUT CHAR * buf, UINT bufl);
 
 //Get current micro-second.
 ULONGLONG getusec();
+//Get current wall time in micro-second, that is used to measure elapsed
+//time.
+ULONGLONG getMicroSec();
 LONG getclockstart();
 float getclockend(LONG start);
 
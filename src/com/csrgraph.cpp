@@ -0,0 +1,488 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "xcominc.h"
+
+namespace xcom {
+
+//Make 'vec' hold 'num' elements that are all initialized to 'val', and
+//return the buffer of 'vec'.
+static UINT * initVec(Vector<UINT> & vec, UINT num, UINT val)
+{
+    vec.clean();
+    if (num == 0) { return nullptr; }
+    vec.set(num - 1, val);
+    UINT * p = vec.get_vec();
+    if (val != 0) {
+        for (UINT i = 0; i < num - 1; i++) { p[i] = val; }
+    }
+    return p;
+}
+
+
+//
+//START CSRGraph
+//
+void CSRGraph::clean()
+{
+    m_vex_num = 0;
+    m_edge_num = 0;
+    m_idx2id.clean();
+    m_dense_id2idx.clean();
+    m_sparse_id2idx.clean();
+    m_succ_off.clean();
+    m_succ.clean();
+    m_pred_off.clean();
+    m_pred.clean();
+}
+
+
+size_t CSRGraph::count_mem() const
+{
+    size_t count = sizeof(CSRGraph);
+    count += m_idx2id.count_mem();
+    count += m_dense_id2idx.count_mem();
+    count += m_sparse_id2idx.count_mem();
+    count += m_succ_off.count_mem();
+    count += m_succ.count_mem();
+    count += m_pred_off.count_mem();
+    count += m_pred.count_mem();
+    return count;
+}
+
+
+void CSRGraph::setIdx(UINT id, UINT idx)
+{
+    if (m_is_dense) {
+        m_dense_id2idx.set(id, idx + 1);
+        return;
+    }
+    m_sparse_id2idx.setAlways(id, idx + 1);
+}
+
+
+void CSRGraph::build(Graph const& g)
+{
+    clean();
+    m_is_dense = g.is_dense();
+    UINT n = g.getVertexNum();
+
+    //Number vertices densely.
+    UINT * idx2id = initVec(m_idx2id, n, 0);
+    VertexIter c = VERTEX_UNDEF;
+    for (Vertex const* v = g.get_first_vertex(c);
+         v != nullptr; v = g.get_next_vertex(c)) {
+        ASSERT0(m_vex_num < n);
+        idx2id[m_vex_num] = v->id();
+        setIdx(v->id(), m_vex_num);
+        m_vex_num++;
+    }
+    ASSERT0(m_vex_num == n);
+
+    //Count successors and predecessors of each vertex.
+    UINT * succ_off = initVec(m_succ_off, n + 1, 0);
+    UINT * pred_off = initVec(m_pred_off, n + 1, 0);
+    for (UINT i = 0; i < n; i++) {
+        Vertex const* v = g.getVertex(idx2id[i]);
+        UINT succ_num = 0;
+        for (EdgeC const* ec = v->getOutList();
+             ec != nullptr; ec = ec->get_next()) {
+            succ_num++;
+        }
+        UINT pred_num = 0;
+        for (EdgeC const* ec = v->getInList();
+             ec != nullptr; ec = ec->get_next()) {
+            pred_num++;
+        }
+        succ_off[i + 1] = succ_off[i] + succ_num;
+        pred_off[i + 1] = pred_off[i] + pred_num;
+    }
+    m_edge_num = succ_off[n];
+
+    //Record successors and predecessors.
+    UINT * succ = initVec(m_succ, succ_off[n], 0);
+    UINT * pred = initVec(m_pred, pred_off[n], 0);
+    for (UINT i = 0; i < n; i++) {
+        Vertex const* v = g.getVertex(idx2id[i]);
+        UINT pos = succ_off[i];
+        for (EdgeC const* ec = v->getOutList();
+             ec != nullptr; ec = ec->get_next()) {
+            succ[pos++] = getIdx(ec->getToId());
+        }
+        pos = pred_off[i];
+        for (EdgeC const* ec = v->getInList();
+             ec != nullptr; ec = ec->get_next()) {
+            pred[pos++] = getIdx(ec->getFromId());
+        }
+    }
+}
+
+
+//The function does not use recursion, thus it is able to handle graph
+//that is very deep.
+void CSRGraph::computeRpo(UINT root, OUT Vector<UINT> & order,
+                          OUT Vector<UINT> * rpo) const
+{
+    ASSERT0(root < m_vex_num);
+    Vector<UINT> tmp_rpo;
+    UINT * pos = initVec(rpo != nullptr ? *rpo : tmp_rpo, m_vex_num,
+                         CSR_UNDEF);
+    Vector<UINT> stk_vec;
+    Vector<UINT> cur_vec;
+    UINT * stk = initVec(stk_vec, m_vex_num, 0);
+    //Record the position of next successor to visit for each vertex.
+    UINT * cur = initVec(cur_vec, m_vex_num, 0);
+    UINT const* succ_off = m_succ_off.m_vec;
+    UINT const* succ = m_succ.m_vec;
+
+    //Record vertices in post order first.
+    order.clean();
+    order.reserve(m_vex_num);
+    UINT num = 0;
+    UINT top = 0;
+    stk[top++] = root;
+    pos[root] = 0; //Mark as visited.
+    cur[root] = succ_off[root];
+    while (top != 0) {
+        UINT v = stk[top - 1];
+        if (cur[v] < succ_off[v + 1]) {
+            UINT s = succ[cur[v]++];
+            if (pos[s] == CSR_UNDEF) {
+                pos[s] = 0;
+                cur[s] = succ_off[s];
+                stk[top++] = s;
+            }
+            continue;
+        }
+        top--;
+        order.set(num++, v);
+    }
+
+    //Reverse the post order.
+    UINT * o = order.get_vec();
+    for (UINT i = 0, j = num - 1; i < j; i++, j--) {
+        UINT t = o[i];
+        o[i] = o[j];
+        o[j] = t;
+    }
+    for (UINT i = 0; i < num; i++) {
+        pos[o[i]] = i;
+    }
+}
+
+
+//Return the vertex that has the minimal semi-dominator on the path from
+//'v' to the root of its virtual tree, and compress the path.
+//The vertices numbered not less than 'last_linked' have been linked to
+//their ancestors.
+//stk: buffer to record the path.
+static UINT evalSemiNCA(UINT v, UINT last_linked, UINT * ancestor,
+                        UINT * label, UINT const* semi, UINT * stk)
+{
+    if (ancestor[v] < last_linked) { return label[v]; }
+    UINT top = 0;
+    do {
+        stk[top++] = v;
+        v = ancestor[v];
+    } while (ancestor[v] >= last_linked);
+
+    //Point each vertex on path to the root, and update its label if one of
+    //its ancestors has smaller semi-dominator.
+    UINT p = v;
+    UINT plabel = label[p];
+    do {
+        v = stk[--top];
+        ancestor[v] = ancestor[p];
+        if (semi[plabel] < semi[label[v]]) {
+            label[v] = plabel;
+        } else {
+            plabel = label[v];
+        }
+        p = v;
+    } while (top != 0);
+    return label[v];
+}
+
+
+//Compute immediate dominator by Semi-NCA algorithm, refer to
+//Georgiadis, "Linear-Time Algorithms for Dominators and Related Problems".
+//Vertices are numbered in DFS preorder from 2, and number 1 is a virtual
+//root that is the parent of each vertex in 'roots'.
+//is_reverse: true to walk edges backward, that computes post dominator.
+void CSRGraph::computeIdomBySemiNCA(UINT const* roots, UINT root_num,
+                                   bool is_reverse,
+                                   OUT Vector<UINT> & idom) const
+{
+    UINT * res = initVec(idom, m_vex_num, CSR_UNDEF);
+    if (root_num == 0) { return; }
+    UINT const* off = is_reverse ? m_pred_off.m_vec : m_succ_off.m_vec;
+    UINT const* adj = is_reverse ? m_pred.m_vec : m_succ.m_vec;
+    UINT const* roff = is_reverse ? m_succ_off.m_vec : m_pred_off.m_vec;
+    UINT const* radj = is_reverse ? m_succ.m_vec : m_pred.m_vec;
+    UINT n = m_vex_num;
+    Vector<UINT> dfn_vec;
+    Vector<UINT> vert_vec;
+    Vector<UINT> parent_vec;
+    Vector<UINT> cur_vec;
+    Vector<UINT> stk_vec;
+    UINT * dfn = initVec(dfn_vec, n, 0); //0 means unvisited.
+    UINT * vert = initVec(vert_vec, n + 2, 0); //map number to vertex.
+    UINT * parent = initVec(parent_vec, n + 2, 0);
+    UINT * cur = initVec(cur_vec, n, 0);
+    UINT * stk = initVec(stk_vec, n, 0);
+
+    //Number vertices in DFS preorder.
+    UINT num = 1;
+    for (UINT r = 0; r < root_num; r++) {
+        UINT root = roots[r];
+        ASSERT0(root < n);
+        if (dfn[root] != 0) { continue; }
+        dfn[root] = ++num;
+        vert[num] = root;
+        parent[num] = 1;
+        cur[root] = off[root];
+        UINT top = 0;
+        stk[top++] = root;
+        while (top != 0) {
+            UINT v = stk[top - 1];
+            if (cur[v] < off[v + 1]) {
+                UINT s = adj[cur[v]++];
+                if (dfn[s] == 0) {
+                    dfn[s] = ++num;
+                    vert[num] = s;
+                    parent[num] = dfn[v];
+                    cur[s] = off[s];
+                    stk[top++] = s;
+                }
+                continue;
+            }
+            top--;
+        }
+    }
+
+    Vector<UINT> semi_vec;
+    Vector<UINT> label_vec;
+    Vector<UINT> dom_vec;
+    UINT * semi = initVec(semi_vec, num + 1, 0);
+    UINT * label = initVec(label_vec, num + 1, 0);
+    UINT * dom = initVec(dom_vec, num + 1, 0);
+    for (UINT i = 1; i <= num; i++) {
+        semi[i] = i;
+        label[i] = i;
+        dom[i] = parent[i];
+    }
+
+    //Compute semi-dominator in reverse preorder, 'parent' is used as the
+    //ancestor in virtual tree, and it is compressed by evalSemiNCA().
+    for (UINT i = num; i >= 2; i--) {
+        UINT v = vert[i];
+        semi[i] = parent[i];
+        for (UINT k = roff[v]; k < roff[v + 1]; k++) {
+            UINT u = dfn[radj[k]];
+            if (u == 0) { continue; } //Unreachable vertex.
+            UINT s = semi[evalSemiNCA(u, i + 1, parent, label, semi, stk)];
+            if (s < semi[i]) { semi[i] = s; }
+        }
+    }
+
+    //Immediate dominator is the nearest common ancestor of the
+    //semi-dominator and the parent in dominator tree.
+    for (UINT i = 2; i <= num; i++) {
+        UINT d = dom[i];
+        while (d > semi[i]) { d = dom[d]; }
+        dom[i] = d;
+        res[vert[i]] = d == 1 ? CSR_UNDEF : vert[d];
+    }
+}
+
+
+//Collect graph entries, or graph exits if 'is_exit' is true.
+void CSRGraph::collectRoots(bool is_exit, OUT Vector<UINT> & roots) const
+{
+    roots.clean();
+    UINT num = 0;
+    for (UINT i = 0; i < m_vex_num; i++) {
+        if (is_exit ? is_graph_exit(i) : is_graph_entry(i)) {
+            roots.set(num++, i);
+        }
+    }
+}
+
+
+void CSRGraph::computeIdom(UINT root, OUT Vector<UINT> & idom) const
+{
+    ASSERT0(root < m_vex_num);
+    computeIdomBySemiNCA(&root, 1, false, idom);
+}
+
+
+void CSRGraph::computeIdom(OUT Vector<UINT> & idom) const
+{
+    Vector<UINT> roots;
+    collectRoots(false, roots);
+    computeIdomBySemiNCA(roots.get_vec(), roots.get_elem_count(), false,
+                         idom);
+}
+
+
+void CSRGraph::computeIpdom(OUT Vector<UINT> & ipdom) const
+{
+    Vector<UINT> roots;
+    collectRoots(true, roots);
+    computeIdomBySemiNCA(roots.get_vec(), roots.get_elem_count(), true,
+                         ipdom);
+}
+
+
+void CSRGraph::computeTreeInterval(Vector<UINT> const& parent,
+                                   OUT Vector<UINT> & pre,
+                                   OUT Vector<UINT> & last) const
+{
+    UINT n = m_vex_num;
+    UINT * p = initVec(pre, n, 0);
+    UINT * l = initVec(last, n, 0);
+    if (n == 0) { return; }
+    UINT const* par = parent.m_vec;
+
+    //Record children of each vertex contiguously.
+    Vector<UINT> off_vec;
+    Vector<UINT> kid_vec;
+    UINT * off = initVec(off_vec, n + 1, 0);
+    UINT * kid = initVec(kid_vec, n, 0);
+    for (UINT i = 0; i < n; i++) {
+        if (par[i] != CSR_UNDEF) { off[par[i] + 1]++; }
+    }
+    for (UINT i = 0; i < n; i++) { off[i + 1] += off[i]; }
+    //Use 'l' as the fill cursor temporarily.
+    for (UINT i = 0; i < n; i++) {
+        if (par[i] != CSR_UNDEF) { kid[off[par[i]] + l[par[i]]++] = i; }
+    }
+
+    Vector<UINT> stk_vec;
+    Vector<UINT> cur_vec;
+    UINT * stk = initVec(stk_vec, n, 0);
+    UINT * cur = initVec(cur_vec, n, 0);
+    UINT num = 0;
+    for (UINT r = 0; r < n; r++) {
+        if (par[r] != CSR_UNDEF) { continue; }
+        UINT top = 0;
+        stk[top++] = r;
+        p[r] = ++num;
+        cur[r] = off[r];
+        while (top != 0) {
+            UINT v = stk[top - 1];
+            if (cur[v] < off[v + 1]) {
+                UINT k = kid[cur[v]++];
+                p[k] = ++num;
+                cur[k] = off[k];
+                stk[top++] = k;
+                continue;
+            }
+            l[v] = num;
+            top--;
+        }
+    }
+    ASSERTN(num == n, ("cycle in tree"));
+}
+
+
+bool CSRGraph::is_reachable(UINT from, UINT to) const
+{
+    ASSERT0(from < m_vex_num && to < m_vex_num);
+    BitSet visited;
+    Vector<UINT> stk_vec;
+    //'from' may be pushed again if it is in a cycle.
+    UINT * stk = initVec(stk_vec, m_vex_num + 1, 0);
+    UINT const* succ_off = m_succ_off.m_vec;
+    UINT const* succ = m_succ.m_vec;
+    UINT top = 0;
+    stk[top++] = from;
+    while (top != 0) {
+        UINT v = stk[--top];
+        for (UINT k = succ_off[v]; k < succ_off[v + 1]; k++) {
+            UINT s = succ[k];
+            if (s == to) { return true; }
+            if (visited.is_contain(s)) { continue; }
+            visited.bunion(s);
+            stk[top++] = s;
+        }
+    }
+    return false;
+}
+
+
+//The ready vertex is processed in first-in-first-out order, as
+//Graph::sortInTopologOrder() does.
+bool CSRGraph::sortInTopologOrder(OUT Vector<UINT> & order) const
+{
+    Vector<UINT> indeg_vec;
+    UINT * indeg = initVec(indeg_vec, m_vex_num, 0);
+    UINT * o = initVec(order, m_vex_num, 0);
+    UINT tail = 0;
+    for (UINT i = 0; i < m_vex_num; i++) {
+        indeg[i] = getInDegree(i);
+        if (indeg[i] == 0) {
+            o[tail++] = i;
+        }
+    }
+    UINT const* succ_off = m_succ_off.m_vec;
+    UINT const* succ = m_succ.m_vec;
+    for (UINT head = 0; head < tail; head++) {
+        UINT v = o[head];
+        for (UINT k = succ_off[v]; k < succ_off[v + 1]; k++) {
+            UINT s = succ[k];
+            ASSERT0(indeg[s] > 0);
+            indeg[s]--;
+            if (indeg[s] == 0) {
+                o[tail++] = s;
+            }
+        }
+    }
+    for (UINT i = tail; i < m_vex_num; i++) {
+        o[i] = CSR_UNDEF;
+    }
+    return tail == m_vex_num;
+}
+
+
+void CSRGraph::dump(FILE * h) const
+{
+    if (h == nullptr) { return; }
+    fprintf(h, "\n==---- DUMP CSR GRAPH: vertex %u, edge %u ----==",
+            m_vex_num, m_edge_num);
+    for (UINT i = 0; i < m_vex_num; i++) {
+        fprintf(h, "\nVERTEX(%u) idx:%u succ: ", getId(i), i);
+        for (UINT const* s = getSuccBegin(i); s != getSuccEnd(i); s++) {
+            fprintf(h, "%u ", getId(*s));
+        }
+    }
+    fprintf(h, "\n");
+    fflush(h);
+}
+//END CSRGraph
+
+} //namespace xcom
@@ -0,0 +1,193 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __CSR_GRAPH_H__
+#define __CSR_GRAPH_H__
+
+namespace xcom {
+
+//Indicate there is no vertex in CSRGraph.
+#define CSR_UNDEF ((UINT)-1)
+
+//CSRGraph
+//
+//This class represents an immutable snapshot of Graph in compressed sparse
+//row form, it is built by Graph::freeze().
+//Vertices are renumbered densely from 0 in the order of
+//Graph::get_first_vertex()/get_next_vertex(), that number is named index.
+//The successors of vertex 'i' are recorded contiguously in
+//m_succ[m_succ_off[i], m_succ_off[i+1]), and so are the predecessors.
+//Successors and predecessors keep the order of out-list and in-list of
+//Graph, thus the algorithms below visit vertices in the same order as the
+//algorithms of Graph do.
+//USAGE:
+//  CSRGraph csr;
+//  g.freeze(csr);
+//  Vector<UINT> idom;
+//  csr.computeIdom(csr.getIdx(entry_id), idom);
+//NOTE: all algorithms take and produce vertex index rather than vertex id,
+//    and the snapshot does not follow the changes of Graph after freezing.
+class CSRGraph {
+    COPY_CONSTRUCTOR(CSRGraph);
+protected:
+    BYTE m_is_dense:1; //true if vertex id of frozen graph is dense.
+    UINT m_vex_num;
+    UINT m_edge_num;
+    Vector<UINT> m_idx2id; //map vertex index to vertex id.
+    //Map vertex id to index plus one if graph is dense.
+    Vector<UINT> m_dense_id2idx;
+    //Map vertex id to index plus one if graph is sparse.
+    OAHMap<UINT, UINT> m_sparse_id2idx;
+    Vector<UINT> m_succ_off; //offset of successors of each vertex.
+    Vector<UINT> m_succ; //successors of all vertices.
+    Vector<UINT> m_pred_off; //offset of predecessors of each vertex.
+    Vector<UINT> m_pred; //predecessors of all vertices.
+
+protected:
+    void computeIdomBySemiNCA(UINT const* roots, UINT root_num,
+                              bool is_reverse, OUT Vector<UINT> & idom) const;
+    void collectRoots(bool is_exit, OUT Vector<UINT> & roots) const;
+    void setIdx(UINT id, UINT idx);
+public:
+    CSRGraph() { m_is_dense = true; m_vex_num = 0; m_edge_num = 0; }
+    ~CSRGraph() {}
+
+    //Build snapshot of 'g', the former snapshot is dropped.
+    void build(Graph const& g);
+
+    void clean();
+    //Count memory usage for current object.
+    size_t count_mem() const;
+    //Sort vertices that are reachable from 'root' in reverse post order.
+    //order: record vertices in rpo.
+    //rpo: record the position in 'order' for each vertex if it is not
+    //     nullptr, and CSR_UNDEF for unreachable vertex.
+    void computeRpo(UINT root, OUT Vector<UINT> & order,
+                    OUT Vector<UINT> * rpo = nullptr) const;
+    //Compute immediate dominator of each vertex in near linear time.
+    //idom: record the immediate dominator for each vertex, and CSR_UNDEF
+    //      for 'root' and the vertex that is unreachable from 'root'.
+    void computeIdom(UINT root, OUT Vector<UINT> & idom) const;
+    //Compute immediate dominator of each vertex, all graph entries are
+    //regarded as root. The vertex that is dominated by more than one entry
+    //does not have idom, as DGraph::computeIdom2() does.
+    void computeIdom(OUT Vector<UINT> & idom) const;
+    //Compute immediate post dominator of each vertex, all graph exits are
+    //regarded as root.
+    //ipdom: record the immediate post dominator for each vertex, and
+    //       CSR_UNDEF for graph exit and the vertex that does not have one.
+    void computeIpdom(OUT Vector<UINT> & ipdom) const;
+    //Number vertices of the tree described by 'parent' in preorder.
+    //parent: record parent of each vertex, and CSR_UNDEF for root.
+    //pre: record preorder number of each vertex, start at 1.
+    //last: record the max preorder number in subtree of each vertex.
+    //Vertex 'a' is ancestor of 'b' if pre[a] <= pre[b] <= last[a].
+    void computeTreeInterval(Vector<UINT> const& parent,
+                             OUT Vector<UINT> & pre,
+                             OUT Vector<UINT> & last) const;
+
+    void dump(FILE * h) const;
+
+    UINT getVertexNum() const { return m_vex_num; }
+    UINT getEdgeNum() const { return m_edge_num; }
+
+    //Return vertex id of vertex 'idx'.
+    UINT getId(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_idx2id.m_vec[idx];
+    }
+
+    //Return index of vertex 'id', or CSR_UNDEF if there is no such vertex.
+    UINT getIdx(UINT id) const
+    {
+        UINT i = m_is_dense ? m_dense_id2idx.get(id) :
+                              m_sparse_id2idx.get(id);
+        return i == 0 ? CSR_UNDEF : i - 1;
+    }
+
+    UINT getInDegree(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_pred_off.m_vec[idx + 1] - m_pred_off.m_vec[idx];
+    }
+    UINT getOutDegree(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_succ_off.m_vec[idx + 1] - m_succ_off.m_vec[idx];
+    }
+
+    //Return the position of the first successor of vertex 'idx' in
+    //successors of all vertices.
+    UINT getSuccOff(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_succ_off.m_vec[idx];
+    }
+
+    //Iterate successors of vertex 'idx'.
+    //e.g: for (UINT const* s = csr.getSuccBegin(i);
+    //          s != csr.getSuccEnd(i); s++) { ... }
+    UINT const* getSuccBegin(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_succ.m_vec + m_succ_off.m_vec[idx];
+    }
+    UINT const* getSuccEnd(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_succ.m_vec + m_succ_off.m_vec[idx + 1];
+    }
+
+    //Iterate predecessors of vertex 'idx'.
+    UINT const* getPredBegin(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_pred.m_vec + m_pred_off.m_vec[idx];
+    }
+    UINT const* getPredEnd(UINT idx) const
+    {
+        ASSERT0(idx < m_vex_num);
+        return m_pred.m_vec + m_pred_off.m_vec[idx + 1];
+    }
+
+    bool is_graph_entry(UINT idx) const { return getInDegree(idx) == 0; }
+    bool is_graph_exit(UINT idx) const { return getOutDegree(idx) == 0; }
+
+    //Return true if there is a path from 'from' to 'to'.
+    //Note the path has one edge at least, as Graph::is_reachable() does.
+    bool is_reachable(UINT from, UINT to) const;
+
+    //Sort vertices in topological order.
+    //order: record vertices in topological order.
+    //Return true if sorting success, otherwise there exist cycles in graph,
+    //and the vertices that are in or after cycles are CSR_UNDEF in 'order'.
+    bool sortInTopologOrder(OUT Vector<UINT> & order) const;
+};
+
+} //namespace xcom
+#endif
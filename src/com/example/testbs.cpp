@@ -44,7 +44,7 @@ void bs_test(FILE * h)
     a.bunion(b);
     a.dump(h);
 
-    DBitSet<BITS_PER_SEG> x(&sm, 20);
+    DBitSet<BITS_PER_SEG> x(&sm);
     x.set_sparse(false);
     x.bunion(1999);
     x.bunion(2000);
@@ -59,7 +59,7 @@ void bs_test(FILE * h)
     x.dump(h);
 
     int n = x.get_elem_count();
-    SC<SEG<BITS_PER_SEG>*>  * ct = nullptr;
+    SEG<BITS_PER_SEG> * ct = nullptr;
     n = x.get_first(&ct);
     n = x.get_next(n, &ct);
     n = x.get_next(n, &ct);
@@ -69,7 +69,7 @@ void bs_test(FILE * h)
     n = x.get_next(n, &ct);
     n = x.get_last(&ct);
 
-    DBitSet<BITS_PER_SEG> y(&sm, 20);
+    DBitSet<BITS_PER_SEG> y(&sm);
     y.set_sparse(false);
     y.bunion(23);
     y.bunion(1990);
@@ -162,17 +162,7 @@ template <UINT BitsPerSeg>
 void dumpSegMgr(SegMgr<BitsPerSeg> & m, FILE * h)
 {
     if (h == nullptr) { return; }
-    SC<SEG<BitsPerSeg>*> * st = nullptr;
-    fprintf(h, "\n====start %d:%d===\n",
-            m.get_free_list()->get_elem_count(),
-            m.get_seg_count());
-    BitSet x;
-    SList<SEG<BitsPerSeg>*> const* flst = m.get_free_list();
-    for (flst->get_head(&st); st != flst->end(); st = flst->get_next(st)) {
-        SEG<BitsPerSeg> const* s = st->val();
-        prt("%d,", s->id);
-        x.bunion(s->id);
-    }
+    fprintf(h, "\n====start %d:%lu===\n",
+            m.get_seg_count(), (ULONG)m.count_mem());
     fflush(h);
-    x.dump(h);
 }
@@ -32,7 +32,7 @@ void sparse_bs()
     sbs.bunion(99999, mbsm);
 
     printf("Iter element:\n");
-    SC<SEG<100>*> * iter;
+    SEG<100> * iter;
     for (int elem = sbs.get_first(&iter);
          elem != -1; elem = sbs.get_next(elem, &iter)) {
         printf("%d\n", elem);
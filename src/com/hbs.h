@@ -0,0 +1,258 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __HYBRID_BITSET_H__
+#define __HYBRID_BITSET_H__
+
+namespace xcom {
+
+//The maximum number of elements that are held in the inline array.
+#define HBS_ARRAY_SIZE 4
+
+//Convert the set back to inline array if the number of elements is not
+//more than this value after removing elements. The value is less than
+//HBS_ARRAY_SIZE to avoid converting forth and back frequently.
+#define HBS_SHRINK_NUM (HBS_ARRAY_SIZE / 2)
+
+//A sparse set with segments less than this value will not be converted to
+//dense form.
+#define HBS_MIN_DENSE_SEG 4
+
+typedef enum {
+    HBS_ARRAY = 0, //elements are held in inline sorted array.
+    HBS_SPARSE, //elements are held in the segments of SBitSetCore.
+    HBS_DENSE, //elements are held in BitSet.
+} HBS_KIND;
+
+//
+//START HBitSetCore, Hybrid BitSetCore
+//
+//This class represent a BitSet which chooses its representation
+//according to the number and the distribution of elements:
+//  * Up to HBS_ARRAY_SIZE elements are held in an inline sorted array, thus
+//    tiny sets do not allocate any memory.
+//  * Larger set is held in the segments of SBitSetCore.
+//  * If the segments cover most of the range from zero to the last element,
+//    the set is held in a BitSet allocated by SegMgr, because the BitSet
+//    costs less memory and operates faster in that case.
+//The conversion happens automatically, and the operations accept operands
+//in different representations. Note a dense set is only converted back to
+//array form when most of its elements have been removed.
+//Note the object is valid if all its fields are zero. The iterator is only
+//used by sparse form, and it is ignored by other forms.
+//e.g1:
+//    MiscBitSetMgr<47> mbsm;
+//    HBitSetCore<47> * x = mbsm.allocHBitSetCore();
+//    x->bunion(100, mbsm);
+//    mbsm.freeHBitSetCore(x); //Very Important!
+//e.g2:
+//    MiscBitSetMgr<47> mbsm;
+//    HBitSetCore<47> x;
+//    x.bunion(100, mbsm);
+//    x.clean(mbsm); //Very Important!
+template <UINT BitsPerSeg = BITS_PER_SEG>
+class HBitSetCore {
+    COPY_CONSTRUCTOR(HBitSetCore);
+protected:
+    union {
+        UINT m_elem[HBS_ARRAY_SIZE]; //sorted elements of array form.
+        BitSet * m_dense; //bitset of dense form.
+    };
+    //Segments of sparse form. In array form, it may keep an empty SEG
+    //vector for reuse, see copy().
+    SBitSetCore<BitsPerSeg> m_sparse;
+    BYTE m_kind; //record HBS_KIND.
+    BYTE m_num; //the number of elements of array form.
+
+protected:
+    //Return the index of the first element in array that is not less
+    //than 'elem'.
+    UINT findElem(UINT elem) const
+    {
+        ASSERT0(m_kind == HBS_ARRAY);
+        UINT i = 0;
+        for (; i < m_num && m_elem[i] < elem; i++) {}
+        return i;
+    }
+
+    //Convert the set to dense form if the segments of sparse form cover
+    //most of the range of elements.
+    void checkDense(SegMgr<BitsPerSeg> * sm)
+    {
+        ASSERT0(m_kind == HBS_SPARSE);
+        UINT n = m_sparse.get_seg_num();
+        if (n < HBS_MIN_DENSE_SEG) { return; }
+        TSEGIter * it = nullptr;
+        INT last = m_sparse.get_last(&it);
+        ASSERT0(last >= 0);
+        if ((size_t)n * sizeof(SEG<BitsPerSeg>) >=
+            (size_t)last / BITS_PER_BYTE + 1) {
+            toDense(sm);
+        }
+    }
+
+    //Convert the set to array form if it has only a few elements.
+    void checkShrink(SegMgr<BitsPerSeg> * sm)
+    {
+        if (m_kind == HBS_ARRAY) { return; }
+        if (get_elem_count() <= HBS_SHRINK_NUM) {
+            toArray(sm);
+        }
+    }
+
+    //Add the elements of 'src' to current set one by one.
+    void unionByElem(HBitSetCore const& src, SegMgr<BitsPerSeg> * sm)
+    {
+        TSEGIter * it = nullptr;
+        for (INT e = src.get_first(&it); e >= 0;
+             e = src.get_next((UINT)e, &it)) {
+            bunion((UINT)e, sm);
+        }
+    }
+
+    void toArray(SegMgr<BitsPerSeg> * sm);
+    void toDense(SegMgr<BitsPerSeg> * sm);
+    void toSparse(SegMgr<BitsPerSeg> * sm);
+public:
+    HBitSetCore() { init(); }
+    ~HBitSetCore()
+    {
+        //should call clean() before destruction,
+        //otherwise it will incur SegMgr assertion.
+    }
+
+    void bunion(UINT elem, SegMgr<BitsPerSeg> * sm);
+    void bunion(HBitSetCore const& src, SegMgr<BitsPerSeg> * sm);
+    void bunion(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
+    { bunion(elem, &m.sm); }
+    void bunion(HBitSetCore const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { bunion(src, &m.sm); }
+
+    void clean(SegMgr<BitsPerSeg> * sm);
+    void clean(MiscBitSetMgr<BitsPerSeg> & m) { clean(&m.sm); }
+    void copy(HBitSetCore const& src, SegMgr<BitsPerSeg> * sm);
+    void copy(HBitSetCore const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { copy(src, &m.sm); }
+    //Count memory usage for current object.
+    size_t count_mem() const;
+
+    void diff(UINT elem, SegMgr<BitsPerSeg> * sm);
+    void diff(HBitSetCore const& src, SegMgr<BitsPerSeg> * sm);
+    void diff(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
+    { diff(elem, &m.sm); }
+    void diff(HBitSetCore const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { diff(src, &m.sm); }
+    void dump(FILE * h) const;
+
+    UINT get_elem_count() const;
+    INT get_first(TSEGIter ** cur) const;
+    INT get_last(TSEGIter ** cur) const;
+    INT get_next(UINT elem, TSEGIter ** cur) const;
+    HBS_KIND get_kind() const { return (HBS_KIND)m_kind; }
+
+    void init()
+    {
+        ::memset(m_elem, 0, sizeof(m_elem));
+        m_sparse.init();
+        m_kind = HBS_ARRAY;
+        m_num = 0;
+    }
+    void intersect(HBitSetCore const& src, SegMgr<BitsPerSeg> * sm);
+    void intersect(HBitSetCore const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { intersect(src, &m.sm); }
+
+    bool is_equal(HBitSetCore const& src) const;
+    bool is_contain(UINT elem) const;
+
+    //Return true if current set contains all elements of 'src'.
+    //Note the semantics is the same as BitSet::is_contain(), the empty set
+    //does not contain any set.
+    //'strict': true if current set must have other elements than 'src'.
+    bool is_contain(HBitSetCore const& src, bool strict = false) const;
+    bool is_intersect(HBitSetCore const& src) const;
+    bool is_empty() const
+    {
+        switch (m_kind) {
+        case HBS_ARRAY: return m_num == 0;
+        case HBS_SPARSE: return m_sparse.is_empty();
+        default: return m_dense->is_empty();
+        }
+    }
+};
+
+
+//Hybrid BitSet
+//This class encapsulates operations of HBitSetCore, and
+//simply the use of them.
+//e.g:
+//    MiscBitSetMgr<47> mbsm;
+//    HBitSet<47> x(mbsm.getSegMgr());
+//    x.bunion(100);
+template <UINT BitsPerSeg = BITS_PER_SEG>
+class HBitSet : public HBitSetCore<BitsPerSeg> {
+    COPY_CONSTRUCTOR(HBitSet);
+protected:
+    SegMgr<BitsPerSeg> * m_sm;
+public:
+    HBitSet(SegMgr<BitsPerSeg> * sm)
+    {
+        ASSERTN(sm, ("need SegMgr"));
+        m_sm = sm;
+    }
+    ~HBitSet() { clean(); }
+
+    void bunion(UINT elem) { HBitSetCore<BitsPerSeg>::bunion(elem, m_sm); }
+    void bunion(HBitSetCore<BitsPerSeg> const& src)
+    { HBitSetCore<BitsPerSeg>::bunion(src, m_sm); }
+
+    void clean() { HBitSetCore<BitsPerSeg>::clean(m_sm); }
+    void copy(HBitSetCore<BitsPerSeg> const& src)
+    {
+        //Do NOT change current m_sm.
+        HBitSetCore<BitsPerSeg>::copy(src, m_sm);
+    }
+    //Count memory usage for current object.
+    size_t count_mem() const
+    { return HBitSetCore<BitsPerSeg>::count_mem() + sizeof(m_sm); }
+
+    void diff(UINT elem) { HBitSetCore<BitsPerSeg>::diff(elem, m_sm); }
+    void diff(HBitSetCore<BitsPerSeg> const& src)
+    { HBitSetCore<BitsPerSeg>::diff(src, m_sm); }
+
+    void intersect(HBitSetCore<BitsPerSeg> const& src)
+    { HBitSetCore<BitsPerSeg>::intersect(src, m_sm); }
+};
+
+typedef HBitSetCore<> DefHBitSetCore; //Default Size HBitSetCore.
+typedef HBitSet<> DefHBitSet; //Default Size HBitSet.
+
+#include "hbs.impl"
+
+} //namespace xcom
+
+#endif
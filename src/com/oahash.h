@@ -0,0 +1,733 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __OAHASH_H__
+#define __OAHASH_H__
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace xcom {
+
+//Open addressing hash table.
+//The table keeps one control byte per slot, followed by the slot array.
+//A control byte is either OAH_CTRL_EMPTY, OAH_CTRL_DELETED, or the low
+//7 bits of the hash value of the element that occupies the slot.
+//Lookup probes a group of control bytes at a time, compares the 7-bit tag
+//of all slots in the group in parallel, and only calls HF::compare() for
+//slots whose tag matched. Probing stops at the first group that contains an
+//empty slot.
+//
+//The group is 16 bytes and compared by SSE2 when the target supports it,
+//otherwise it is 8 bytes and compared by 64-bit bitwise arithmetic.
+#define OAH_CTRL_EMPTY ((BYTE)0x80)
+#define OAH_CTRL_DELETED ((BYTE)0xFE)
+#define OAH_CTRL_IS_FULL(c) (((c) & 0x80) == 0)
+
+//Hash function class such as HashFuncBase, HashFuncString2 computes the
+//hash value modulo the bucket size. OAHash passes this range as bucket size
+//to obtain a 31-bit hash value, then mixes it by hash32bit().
+//The range must be power of 2 because some of HF require that.
+#define OAH_HF_RANGE 0x80000000u
+
+//Position part of the mixed hash value.
+#define OAH_H1(hv) ((hv) >> 7)
+
+//Tag part of the mixed hash value, stored in control byte.
+#define OAH_H2(hv) ((BYTE)((hv) & 0x7F))
+
+//The minimum number of slots, it must be power of 2 and not less
+//than group width.
+#define OAH_MIN_CAP 16
+
+//Maximum load factor is 7/8, counting both full and deleted slots.
+#define OAH_MAX_LOAD(cap) ((cap) - ((cap) >> 3))
+
+//Indicate slot is not found.
+#define OAH_UNDEF ((UINT)-1)
+
+#ifdef __SSE2__
+#define OAH_GROUP_WIDTH 16
+typedef UINT OAHashMask;
+#else
+#define OAH_GROUP_WIDTH 8
+typedef ULONGLONG OAHashMask;
+#endif
+
+//A group of OAH_GROUP_WIDTH control bytes.
+//The match functions return a mask in which each set bit refers to a slot
+//of the group, use firstIdx() and clearFirst() to walk through the mask.
+class OAHashGroup {
+#ifdef __SSE2__
+    __m128i m_ctrl;
+#else
+    ULONGLONG m_ctrl;
+    static ULONGLONG lsbs() { return 0x0101010101010101ULL; }
+    static ULONGLONG msbs() { return 0x8080808080808080ULL; }
+#endif
+public:
+    explicit OAHashGroup(BYTE const* pos)
+    {
+        #ifdef __SSE2__
+        m_ctrl = _mm_loadu_si128((__m128i const*)pos);
+        #else
+        //Assume little endian, the first byte is the least significant.
+        ::memcpy(&m_ctrl, pos, sizeof(m_ctrl));
+        #endif
+    }
+
+    //Return the index of first slot in 'mask'.
+    static UINT firstIdx(OAHashMask mask)
+    {
+        ASSERT0(mask != 0);
+        #ifdef __SSE2__
+        return (UINT)countTrailingZero(mask);
+        #else
+        return (UINT)countTrailingZero(mask) >> 3;
+        #endif
+    }
+
+    //Return the number of slots before the last slot in 'mask', counting
+    //from the end of group.
+    static UINT lastIdxFromEnd(OAHashMask mask)
+    {
+        ASSERT0(mask != 0);
+        #ifdef __SSE2__
+        return (UINT)countLeadingZero(mask) - (32 - OAH_GROUP_WIDTH);
+        #else
+        return (UINT)countLeadingZero(mask) >> 3;
+        #endif
+    }
+
+    static OAHashMask clearFirst(OAHashMask mask) { return mask & (mask - 1); }
+
+    static UINT countTrailingZero(OAHashMask v)
+    {
+        ASSERT0(v != 0);
+        #ifdef __GNUC__
+        return sizeof(v) == sizeof(UINT) ? (UINT)__builtin_ctz((UINT)v) :
+                                           (UINT)__builtin_ctzll(v);
+        #else
+        UINT n = 0;
+        for (; (v & 1) == 0; v >>= 1) { n++; }
+        return n;
+        #endif
+    }
+
+    static UINT countLeadingZero(OAHashMask v)
+    {
+        ASSERT0(v != 0);
+        #ifdef __GNUC__
+        return sizeof(v) == sizeof(UINT) ? (UINT)__builtin_clz((UINT)v) :
+                                           (UINT)__builtin_clzll(v);
+        #else
+        UINT n = 0;
+        OAHashMask hb = ((OAHashMask)1) << (sizeof(v) * 8 - 1);
+        for (; (v & hb) == 0; v <<= 1) { n++; }
+        return n;
+        #endif
+    }
+
+    //Return slots whose tag equals 'h2'.
+    //NOTE: the portable version may report false positive, the caller
+    //always confirms the candidate by HF::compare().
+    OAHashMask match(BYTE h2) const
+    {
+        #ifdef __SSE2__
+        return (OAHashMask)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_set1_epi8((char)h2), m_ctrl));
+        #else
+        ULONGLONG x = m_ctrl ^ (lsbs() * h2);
+        return (x - lsbs()) & ~x & msbs();
+        #endif
+    }
+
+    //Return empty slots.
+    OAHashMask matchEmpty() const
+    {
+        #ifdef __SSE2__
+        return match(OAH_CTRL_EMPTY);
+        #else
+        //Only EMPTY has the highest bit set and the second lowest bit clear.
+        return m_ctrl & (~m_ctrl << 6) & msbs();
+        #endif
+    }
+
+    //Return empty or deleted slots.
+    OAHashMask matchEmptyOrDeleted() const
+    {
+        #ifdef __SSE2__
+        return (OAHashMask)_mm_movemask_epi8(m_ctrl);
+        #else
+        return m_ctrl & msbs();
+        #endif
+    }
+};
+
+
+template <class T> struct OAHashSlot {
+    T val;
+    UINT vec_idx; //position of element in element vector.
+};
+
+
+//'T': the element type.
+//'HF': Hash function type, the interface is the same as Hash.
+//
+//OAHash is API compatible with Hash, user can switch between them by
+//changing base class or typedef. Differences:
+//  1. The bucket size is the number of slots. The table grows automatically
+//     when the load factor exceeds 7/8, grow() is only a capacity hint.
+//  2. There is no hash container, the optional output parameter of append()
+//     is the position of element in element vector, which is stable until
+//     the element is removed.
+//  3. Elements are iterated in the order of element vector, as Hash does,
+//     so that the iteration order does not depend on the hash value.
+//
+//NOTE: Do NOT append T(0) to table.
+template <class T, class HF = HashFuncBase<T> > class OAHash {
+    COPY_CONSTRUCTOR(OAHash);
+protected:
+    HF m_hf;
+    BYTE * m_ctrl; //control bytes, the first group is cloned at the end.
+    OAHashSlot<T> * m_slot;
+    UINT m_cap; //the number of slots, it is power of 2.
+    UINT m_growth_left; //the number of empty slots can be used.
+    UINT m_elem_count;
+    VectorWithFreeIndex<T, 8> m_elem_vector;
+
+    UINT computeHashValue(T t) const
+    { return hash32bit(m_hf.get_hash_value(t, OAH_HF_RANGE)); }
+
+    UINT computeHashValue(OBJTY val) const
+    { return hash32bit(m_hf.get_hash_value(val, OAH_HF_RANGE)); }
+
+    void setCtrl(UINT i, BYTE c)
+    {
+        ASSERT0(i < m_cap);
+        m_ctrl[i] = c;
+        if (i < OAH_GROUP_WIDTH) {
+            m_ctrl[m_cap + i] = c;
+        }
+    }
+
+    //Return the slot that holds the element equal to 'k', or OAH_UNDEF.
+    template <class KEY> UINT findSlot(KEY k, UINT hv) const
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        BYTE h2 = OAH_H2(hv);
+        UINT mask = m_cap - 1;
+        UINT pos = OAH_H1(hv) & mask;
+        //Triangular probing visits every group because m_cap is power of 2.
+        for (UINT stride = 0;;) {
+            OAHashGroup g(m_ctrl + pos);
+            for (OAHashMask m = g.match(h2); m != 0;
+                 m = OAHashGroup::clearFirst(m)) {
+                UINT i = (pos + OAHashGroup::firstIdx(m)) & mask;
+                if (m_hf.compare(m_slot[i].val, k)) { return i; }
+            }
+            if (g.matchEmpty() != 0) { return OAH_UNDEF; }
+            stride += OAH_GROUP_WIDTH;
+            ASSERTN(stride <= m_cap, ("table is full"));
+            pos = (pos + stride) & mask;
+        }
+        return OAH_UNDEF;
+    }
+
+    //Return the first empty or deleted slot on the probe sequence of 'hv'.
+    UINT findFreeSlot(UINT hv) const
+    {
+        UINT mask = m_cap - 1;
+        UINT pos = OAH_H1(hv) & mask;
+        for (UINT stride = 0;;) {
+            OAHashGroup g(m_ctrl + pos);
+            OAHashMask m = g.matchEmptyOrDeleted();
+            if (m != 0) {
+                return (pos + OAHashGroup::firstIdx(m)) & mask;
+            }
+            stride += OAH_GROUP_WIDTH;
+            ASSERTN(stride <= m_cap, ("table is full"));
+            pos = (pos + stride) & mask;
+        }
+        return OAH_UNDEF;
+    }
+
+    //Occupy a free slot for 't' which does not exist in table.
+    UINT insertNew(T t, UINT hv)
+    {
+        if (m_growth_left == 0) {
+            //Rehash in place if there are enough deleted slots.
+            rehash(m_elem_count * 2 <= OAH_MAX_LOAD(m_cap) ?
+                   m_cap : m_cap * 2);
+        }
+        UINT i = findFreeSlot(hv);
+        if (m_ctrl[i] == OAH_CTRL_EMPTY) {
+            ASSERT0(m_growth_left > 0);
+            m_growth_left--;
+        }
+        setCtrl(i, OAH_H2(hv));
+        m_slot[i].val = t;
+        m_slot[i].vec_idx = m_elem_vector.get_free_idx();
+        m_elem_vector.set(m_slot[i].vec_idx, t);
+        m_elem_count++;
+        return i;
+    }
+
+    //Reallocate table to 'cap' slots and reinsert all elements.
+    //The position of element in m_elem_vector is unchanged.
+    void rehash(UINT cap)
+    {
+        ASSERT0(isPowerOf2(cap) && OAH_MAX_LOAD(cap) >= m_elem_count);
+        BYTE * old_ctrl = m_ctrl;
+        OAHashSlot<T> * old_slot = m_slot;
+        UINT old_cap = m_cap;
+        alloc(cap);
+        for (UINT i = 0; i < old_cap; i++) {
+            if (!OAH_CTRL_IS_FULL(old_ctrl[i])) { continue; }
+            UINT hv = computeHashValue(old_slot[i].val);
+            UINT j = findFreeSlot(hv);
+            setCtrl(j, OAH_H2(hv));
+            m_slot[j] = old_slot[i];
+        }
+        ASSERT0(m_growth_left >= m_elem_count);
+        m_growth_left -= m_elem_count;
+        ::free(old_ctrl);
+        ::free(old_slot);
+    }
+
+    //Allocate an empty table with 'cap' slots.
+    void alloc(UINT cap)
+    {
+        ASSERT0(isPowerOf2(cap) && cap >= OAH_GROUP_WIDTH);
+        m_ctrl = (BYTE*)::malloc(cap + OAH_GROUP_WIDTH);
+        ::memset(m_ctrl, OAH_CTRL_EMPTY, cap + OAH_GROUP_WIDTH);
+        m_slot = (OAHashSlot<T>*)::malloc(sizeof(OAHashSlot<T>) * cap);
+        m_cap = cap;
+        m_growth_left = OAH_MAX_LOAD(cap);
+    }
+
+    //Free slot 'i'.
+    //The slot becomes empty rather than deleted if no probe sequence
+    //has ever passed it, namely the run of non-empty slots that covers
+    //'i' is shorter than a group.
+    void eraseSlot(UINT i)
+    {
+        ASSERT0(OAH_CTRL_IS_FULL(m_ctrl[i]));
+        m_elem_vector.set(m_slot[i].vec_idx, T(0));
+        m_elem_count--;
+        if (m_elem_count == 0) {
+            ::memset(m_ctrl, OAH_CTRL_EMPTY, m_cap + OAH_GROUP_WIDTH);
+            m_growth_left = OAH_MAX_LOAD(m_cap);
+            return;
+        }
+        UINT before = (i - OAH_GROUP_WIDTH) & (m_cap - 1);
+        OAHashMask empty_after = OAHashGroup(m_ctrl + i).matchEmpty();
+        OAHashMask empty_before = OAHashGroup(m_ctrl + before).matchEmpty();
+        if (empty_after != 0 && empty_before != 0 &&
+            OAHashGroup::firstIdx(empty_after) +
+            OAHashGroup::lastIdxFromEnd(empty_before) < OAH_GROUP_WIDTH) {
+            setCtrl(i, OAH_CTRL_EMPTY);
+            m_growth_left++;
+            return;
+        }
+        setCtrl(i, OAH_CTRL_DELETED);
+    }
+
+    virtual T create(OBJTY v)
+    {
+        ASSERTN(0, ("Inherited class need to implement"));
+        DUMMYUSE(v);
+        return T(0);
+    }
+public:
+    OAHash(UINT bsize = MAX_SHASH_BUCKET)
+    {
+        m_ctrl = nullptr;
+        m_slot = nullptr;
+        m_cap = 0;
+        m_growth_left = 0;
+        m_elem_count = 0;
+        init(bsize);
+    }
+    virtual ~OAHash() { destroy(); }
+
+    //Append 't' into hash table and record its reference into
+    //Vector in order to walk through the table rapidly.
+    //If 't' already exists, return the element immediately.
+    //'vec_idx': output the position of element in element vector.
+    //'find': set to true if 't' already exist.
+    T append(T t, OUT UINT * vec_idx = nullptr, bool * find = nullptr)
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        if (t == T(0)) { return T(0); }
+        UINT hv = computeHashValue(t);
+        UINT i = findSlot(t, hv);
+        bool found = i != OAH_UNDEF;
+        if (!found) {
+            i = insertNew(t, hv);
+        }
+        if (find != nullptr) { *find = found; }
+        if (vec_idx != nullptr) { *vec_idx = m_slot[i].vec_idx; }
+        return m_slot[i].val;
+    }
+
+    //Append 'val' into hash table, the element is created by create()
+    //if 'val' does not exist.
+    //More comment see above function.
+    T append(OBJTY val, OUT UINT * vec_idx = nullptr, bool * find = nullptr)
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        UINT hv = computeHashValue(val);
+        UINT i = findSlot(val, hv);
+        bool found = i != OAH_UNDEF;
+        if (!found) {
+            i = insertNew(create(val), hv);
+        }
+        if (find != nullptr) { *find = found; }
+        if (vec_idx != nullptr) { *vec_idx = m_slot[i].vec_idx; }
+        return m_slot[i].val;
+    }
+
+    //Count up the memory which hash table used.
+    size_t count_mem() const
+    {
+        size_t count = sizeof(*this) - sizeof(m_elem_vector);
+        count += m_elem_vector.count_mem();
+        if (m_ctrl != nullptr) {
+            count += m_cap + OAH_GROUP_WIDTH;
+            count += sizeof(OAHashSlot<T>) * m_cap;
+        }
+        return count;
+    }
+
+    //Clean the data structure but not destroy.
+    void clean()
+    {
+        if (m_ctrl == nullptr) { return; }
+        ::memset(m_ctrl, OAH_CTRL_EMPTY, m_cap + OAH_GROUP_WIDTH);
+        m_growth_left = OAH_MAX_LOAD(m_cap);
+        m_elem_count = 0;
+        m_elem_vector.clean();
+    }
+
+    //Get the number of slots.
+    UINT get_bucket_size() const { return m_cap; }
+
+    //Get the number of element in hash table.
+    UINT get_elem_count() const { return m_elem_count; }
+
+    //This function return the first element if it exists, and initialize
+    //the iterator, otherwise return T(0), where T is the template parameter.
+    //The iteration is the same as Hash.
+    T get_first(INT & iter) const
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        iter = -1;
+        return get_next(iter);
+    }
+
+    //This function return the next element of given iterator.
+    //If it exists, record its index at 'iter' and return the element,
+    //otherwise set 'iter' to -1, and return T(0).
+    T get_next(INT & iter) const
+    {
+        ASSERTN(m_ctrl != nullptr && iter >= -1,
+                ("OAHash not yet initialized."));
+        if (m_elem_count == 0) { iter = -1; return T(0); }
+        INT l = m_elem_vector.get_last_idx();
+        for (INT i = iter + 1; i <= l; i++) {
+            T t = m_elem_vector.get((UINT)i);
+            if (t != T(0)) {
+                iter = i;
+                return t;
+            }
+        }
+        iter = -1;
+        return T(0);
+    }
+
+    //This function return the last element if it exists, and initialize
+    //the iterator, otherwise return T(0).
+    T get_last(INT & iter) const
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        iter = m_elem_vector.get_last_idx() + 1;
+        return get_prev(iter);
+    }
+
+    //This function return the previous element of given iterator.
+    //If it exists, record its index at 'iter' and return the element,
+    //otherwise set 'iter' to -1, and return T(0).
+    T get_prev(INT & iter) const
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        if (m_elem_count == 0) { iter = -1; return T(0); }
+        for (INT i = iter - 1; i >= 0; i--) {
+            T t = m_elem_vector.get((UINT)i);
+            if (t != T(0)) {
+                iter = i;
+                return t;
+            }
+        }
+        iter = -1;
+        return T(0);
+    }
+
+    //'bsize': the initial number of slots, it will be rounded up to
+    //power of 2.
+    void init(UINT bsize = MAX_SHASH_BUCKET)
+    {
+        if (m_ctrl != nullptr || bsize == 0) { return; }
+        alloc(getNearestPowerOf2(MAX(bsize, (UINT)OAH_MIN_CAP)));
+        m_elem_count = 0;
+        m_elem_vector.init();
+    }
+
+    //Free all memory objects.
+    void destroy()
+    {
+        if (m_ctrl == nullptr) { return; }
+        ::free(m_ctrl);
+        ::free(m_slot);
+        m_ctrl = nullptr;
+        m_slot = nullptr;
+        m_cap = 0;
+        m_growth_left = 0;
+        m_elem_count = 0;
+        m_elem_vector.destroy();
+    }
+
+    //Dump the occupation of slots, one group per line.
+    //'*' is full slot, 'x' is deleted slot, '.' is empty slot.
+    void dump_intersp(FILE * h) const
+    {
+        if (h == nullptr || m_ctrl == nullptr) { return; }
+        fprintf(h, "\n=== OAHash ===");
+        for (UINT i = 0; i < m_cap; i++) {
+            if (i % OAH_GROUP_WIDTH == 0) {
+                fprintf(h, "\nGROUP[%u]:", i / OAH_GROUP_WIDTH);
+            }
+            BYTE c = m_ctrl[i];
+            fprintf(h, "%c", OAH_CTRL_IS_FULL(c) ? '*' :
+                             c == OAH_CTRL_DELETED ? 'x' : '.');
+        }
+        fflush(h);
+    }
+
+    //This function remove one element, and return the removed one.
+    //Note that 't' may be different with the return one accroding to
+    //the behavior of user's defined HF class.
+    //The position of other elements in m_elem_vector is unchanged.
+    T remove(T t)
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        if (t == T(0)) { return T(0); }
+        UINT i = findSlot(t, computeHashValue(t));
+        if (i == OAH_UNDEF) { return T(0); }
+        T r = m_slot[i].val;
+        eraseSlot(i);
+        return r;
+    }
+
+    //Grow hash to at least 'bsize' slots and rehash all elements in table.
+    //The default grow size is twice as the current size.
+    //The position of element in m_elem_vector is unchanged.
+    void grow(UINT bsize = 0)
+    {
+        ASSERTN(m_ctrl != nullptr, ("OAHash not yet initialized."));
+        if (bsize != 0) {
+            ASSERT0(bsize > m_cap);
+            bsize = getNearestPowerOf2(bsize);
+        } else {
+            bsize = m_cap * 2;
+        }
+        rehash(bsize);
+    }
+
+    //Find element accroding to specific 'val'.
+    T find(OBJTY val) const
+    {
+        UINT i = findSlot(val, computeHashValue(val));
+        return i == OAH_UNDEF ? T(0) : m_slot[i].val;
+    }
+
+    //Return true if 't' exist.
+    bool find(T t) const
+    {
+        if (t == T(0)) { return false; }
+        return findSlot(t, computeHashValue(t)) != OAH_UNDEF;
+    }
+
+    //Find one element and return the element which record in hash table.
+    //Note t may be different with the return one.
+    //'ot': output the element if found it.
+    bool find(T t, OUT T * ot) const
+    {
+        ASSERT0(ot != nullptr);
+        if (t == T(0)) { return false; }
+        UINT i = findSlot(t, computeHashValue(t));
+        if (i == OAH_UNDEF) { return false; }
+        *ot = m_slot[i].val;
+        return true;
+    }
+
+    //Find one element and output its position in element vector.
+    //Return true if 't' exist.
+    bool findVecIdx(T t, OUT UINT & vec_idx) const
+    {
+        if (t == T(0)) { return false; }
+        UINT i = findSlot(t, computeHashValue(t));
+        if (i == OAH_UNDEF) { return false; }
+        vec_idx = m_slot[i].vec_idx;
+        return true;
+    }
+};
+//END OAHash
+
+
+//Open addressing hash map, it is API compatible with HMap.
+//Mapped elements are recorded in a vector indexed by the position of
+//source element in element vector of OAHash.
+//NOTE: Tsrc(0) and Ttgt(0) are served as default nullptr.
+template <class Tsrc, class Ttgt, class HF = HashFuncBase<Tsrc> >
+class OAHMap : public OAHash<Tsrc, HF> {
+    COPY_CONSTRUCTOR(OAHMap);
+protected:
+    Vector<Ttgt> m_mapped_elem_table;
+public:
+    OAHMap(UINT bsize = MAX_SHASH_BUCKET) : OAHash<Tsrc, HF>(bsize)
+    { m_mapped_elem_table.init(); }
+    virtual ~OAHMap() { destroy(); }
+
+    //Alway set new mapping even if it has done.
+    void setAlways(Tsrc t, Ttgt mapped)
+    {
+        if (t == Tsrc(0)) { return; }
+        UINT vec_idx = 0;
+        OAHash<Tsrc, HF>::append(t, &vec_idx, nullptr);
+        m_mapped_elem_table.set(vec_idx, mapped);
+    }
+
+    //Get mapped element of 't'.
+    Ttgt get(Tsrc t, bool * find = nullptr) const
+    {
+        UINT vec_idx = 0;
+        if (OAHash<Tsrc, HF>::findVecIdx(t, vec_idx)) {
+            if (find != nullptr) { *find = true; }
+            return m_mapped_elem_table.get(vec_idx);
+        }
+        if (find != nullptr) { *find = false; }
+        return Ttgt(0);
+    }
+
+    Vector<Ttgt> * get_tgt_elem_vec() { return &m_mapped_elem_table; }
+
+    void clean()
+    {
+        OAHash<Tsrc, HF>::clean();
+        m_mapped_elem_table.clean();
+    }
+
+    //Count memory usage for current object.
+    size_t count_mem() const
+    {
+        return m_mapped_elem_table.count_mem() +
+               OAHash<Tsrc, HF>::count_mem();
+    }
+
+    void init(UINT bsize = MAX_SHASH_BUCKET)
+    {
+        //Only do initialization while table is nullptr.
+        OAHash<Tsrc, HF>::init(bsize);
+        m_mapped_elem_table.init();
+    }
+
+    void destroy()
+    {
+        OAHash<Tsrc, HF>::destroy();
+        m_mapped_elem_table.destroy();
+    }
+
+    //This function iterate mappped elements.
+    Ttgt get_first_elem(INT & pos) const
+    {
+        pos = -1;
+        return get_next_elem(pos);
+    }
+
+    //This function iterate mappped elements.
+    Ttgt get_next_elem(INT & pos) const
+    {
+        ASSERT0(pos >= -1);
+        for (INT i = pos + 1; i <= m_mapped_elem_table.get_last_idx(); i++) {
+            Ttgt t = m_mapped_elem_table.get((UINT)i);
+            if (t != Ttgt(0)) {
+                pos = i;
+                return t;
+            }
+        }
+        pos = -1;
+        return Ttgt(0);
+    }
+
+    //Remove 't' and its mapping.
+    //Unlike HMap, the position of 't' can be reused by later set().
+    Tsrc remove(Tsrc t)
+    {
+        UINT vec_idx = 0;
+        if (!OAHash<Tsrc, HF>::findVecIdx(t, vec_idx)) { return Tsrc(0); }
+        m_mapped_elem_table.set(vec_idx, Ttgt(0));
+        return OAHash<Tsrc, HF>::remove(t);
+    }
+
+    //Establishing mapping in between 't' and 'mapped'.
+    void set(Tsrc t, Ttgt mapped)
+    {
+        if (t == Tsrc(0)) { return; }
+        UINT vec_idx = 0;
+        OAHash<Tsrc, HF>::append(t, &vec_idx, nullptr);
+        ASSERTN(Ttgt(0) == m_mapped_elem_table.get(vec_idx),
+                ("Already be mapped"));
+        m_mapped_elem_table.set(vec_idx, mapped);
+    }
+
+    void setv(OBJTY v, Ttgt mapped)
+    {
+        if (v == 0) { return; }
+        UINT vec_idx = 0;
+        OAHash<Tsrc, HF>::append(v, &vec_idx, nullptr);
+        ASSERTN(Ttgt(0) == m_mapped_elem_table.get(vec_idx),
+                ("Already be mapped"));
+        m_mapped_elem_table.set(vec_idx, mapped);
+    }
+};
+//END OAHMap
+
+} //namespace xcom
+#endif
@@ -0,0 +1,644 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#include "xcominc.h"
+#ifndef _ON_WINDOWS_
+#include "pthread.h"
+#endif
+
+namespace xcom {
+
+//The level that has less components than this is computed by the main
+//thread alone, since waking up other threads costs more than computing.
+#define REACH_PARALLEL_MIN_COMP 64
+
+//The max number of components that a thread takes at a time.
+#define REACH_MAX_CHUNK 64
+
+//Sort 'num' elements of 'a' in ascending order by shell sort, the number
+//of successors is usually small.
+static void sortAscend(UINT * a, UINT num)
+{
+    UINT gap = 1;
+    while (gap < num / 3) { gap = gap * 3 + 1; }
+    for (; gap > 0; gap /= 3) {
+        for (UINT i = gap; i < num; i++) {
+            UINT t = a[i];
+            UINT j = i;
+            for (; j >= gap && a[j - gap] > t; j -= gap) {
+                a[j] = a[j - gap];
+            }
+            a[j] = t;
+        }
+    }
+}
+
+
+//
+//START ReachStat
+//
+void ReachStat::dump(FILE * h) const
+{
+    if (h == nullptr) { return; }
+    fprintf(h, "\nREACH STAT:");
+    fprintf(h, "\n  vertex:%u edge:%u", vex_num, edge_num);
+    fprintf(h, "\n  component:%u scc:%u level:%u", comp_num, scc_num,
+            level_num);
+    fprintf(h, "\n  thread:%u transitive edge:%u", thread_num,
+            trans_edge_num);
+    fprintf(h, "\n  row memory:%llu bytes", (unsigned long long)row_mem);
+    fprintf(h, "\n  scc time:%llu us, reach time:%llu us\n",
+            (unsigned long long)scc_usec, (unsigned long long)reach_usec);
+    fflush(h);
+}
+//END ReachStat
+
+
+//
+//START ReachWorker
+//
+class ReachPool;
+
+//The class computes rows of components, each thread has its own worker
+//that holds private buffers.
+class ReachWorker {
+    COPY_CONSTRUCTOR(ReachWorker);
+public:
+    ReachMat * m_rm;
+    ReachPool * m_pool;
+    UINT m_gen; //the generation of level that has been computed.
+    UINT m_trans_num; //the number of transitive edges found.
+    //m_mark[d] is 2c+1 if 'd' is successor of component 'c', and is 2c+2
+    //if the edge from 'c' to 'd' is transitive.
+    Vector<UINT> m_mark;
+    Vector<UINT> m_succ; //distinct successor components.
+    //Following buffers are only used if there is no row.
+    //m_visit[d] is c+1 if 'd' is visited by the search of component 'c'.
+    Vector<UINT> m_visit;
+    Vector<UINT> m_stack;
+    #ifndef _ON_WINDOWS_
+    pthread_t m_thread;
+    #endif
+public:
+    ReachWorker(ReachMat * rm, ReachPool * pool)
+    {
+        m_rm = rm;
+        m_pool = pool;
+        m_gen = 0;
+        m_trans_num = 0;
+        UINT n = rm->getSCC().getCompNum();
+        if (n != 0) {
+            m_mark.set(n - 1, 0);
+            if (!rm->hasRow()) { m_visit.set(n - 1, 0); }
+        }
+    }
+
+    UINT collectSucc(UINT c);
+    void mergeRow(UINT c, UINT num);
+    void searchTrans(UINT c, UINT num);
+    void markTrans(UINT c);
+    void computeRow(UINT c);
+    void computeLevel();
+};
+
+
+//Collect distinct successor components of 'c' into 'm_succ' in
+//topological order, and return the number of them.
+UINT ReachWorker::collectSucc(UINT c)
+{
+    SCC const& scc = m_rm->m_scc;
+    CSRGraph const& csr = scc.getCSR();
+    UINT * mark = m_mark.get_vec();
+    UINT seen = 2 * c + 1;
+    UINT num = 0;
+    for (UINT const* v = scc.getCompVexBegin(c);
+         v != scc.getCompVexEnd(c); v++) {
+        UINT i = csr.getIdx(*v);
+        for (UINT const* s = csr.getSuccBegin(i);
+             s != csr.getSuccEnd(i); s++) {
+            UINT d = scc.getCompByIdx(*s);
+            if (d == c || mark[d] == seen) { continue; }
+            mark[d] = seen;
+            m_succ.set(num, d);
+            num++;
+        }
+    }
+    if (num != 0) { sortAscend(m_succ.get_vec(), num); }
+    return num;
+}
+
+
+//Compute the row of 'c' by merging rows of successors in topological
+//order. The successor that is already in row is reachable from another
+//successor.
+void ReachWorker::mergeRow(UINT c, UINT num)
+{
+    UINT * mark = m_mark.get_vec();
+    UINT trans = 2 * c + 2;
+    UINT const* succ = m_succ.get_vec();
+    UINT w = m_rm->m_word_num;
+    UINT cb = c >> 6;
+    ULONGLONG * row = m_rm->getRow(c);
+    for (UINT k = 0; k < num; k++) {
+        UINT d = succ[k];
+        ULONGLONG bit = (ULONGLONG)1 << (d & 63);
+        ULONGLONG * word = row + (d >> 6) - cb;
+        if ((*word & bit) != 0) {
+            mark[d] = trans;
+            continue;
+        }
+        UINT db = d >> 6;
+        ULONGLONG const* drow = m_rm->getRow(d);
+        ULONGLONG * p = row + db - cb;
+        for (UINT j = 0; j < w - db; j++) {
+            p[j] |= drow[j];
+        }
+        *word |= bit;
+    }
+}
+
+
+//Find the successors of 'c' that are reachable from other successors
+//by depth first search, which is used if there is no row.
+void ReachWorker::searchTrans(UINT c, UINT num)
+{
+    SCC const& scc = m_rm->m_scc;
+    CSRGraph const& csr = scc.getCSR();
+    UINT * mark = m_mark.get_vec();
+    UINT * visit = m_visit.get_vec();
+    UINT trans = 2 * c + 2;
+    UINT stamp = c + 1;
+    UINT const* succ = m_succ.get_vec();
+    //Components after the last successor in topological order can not
+    //reach any successor.
+    UINT last = succ[num - 1];
+    UINT top = 0;
+    //Successors are not visited themselves, but their successors are.
+    for (UINT k = 0; k < num; k++) {
+        m_stack.set(top++, succ[k]);
+    }
+    while (top != 0) {
+        UINT d = m_stack.get(--top);
+        for (UINT const* v = scc.getCompVexBegin(d);
+             v != scc.getCompVexEnd(d); v++) {
+            UINT i = csr.getIdx(*v);
+            for (UINT const* s = csr.getSuccBegin(i);
+                 s != csr.getSuccEnd(i); s++) {
+                UINT e = scc.getCompByIdx(*s);
+                if (e == d || e > last || visit[e] == stamp) { continue; }
+                visit[e] = stamp;
+                if (mark[e] == 2 * c + 1) { mark[e] = trans; }
+                m_stack.set(top++, e);
+            }
+        }
+    }
+}
+
+
+//Mark the edges of 'c' whose target component is marked transitive.
+void ReachWorker::markTrans(UINT c)
+{
+    SCC const& scc = m_rm->m_scc;
+    CSRGraph const& csr = scc.getCSR();
+    UINT const* mark = m_mark.get_vec();
+    UINT trans = 2 * c + 2;
+    BYTE * is_trans = m_rm->m_is_trans.get_vec();
+    for (UINT const* v = scc.getCompVexBegin(c);
+         v != scc.getCompVexEnd(c); v++) {
+        UINT i = csr.getIdx(*v);
+        UINT pos = csr.getSuccOff(i);
+        for (UINT const* s = csr.getSuccBegin(i);
+             s != csr.getSuccEnd(i); s++, pos++) {
+            if (mark[scc.getCompByIdx(*s)] == trans) {
+                is_trans[pos] = true;
+                m_trans_num++;
+            }
+        }
+    }
+}
+
+
+//Compute the row of component 'c', rows of successors of 'c' have been
+//computed. Only transitive edges are found if there is no row.
+void ReachWorker::computeRow(UINT c)
+{
+    UINT num = collectSucc(c);
+    if (num == 0) { return; }
+    if (m_rm->hasRow()) {
+        mergeRow(c, num);
+    } else {
+        searchTrans(c, num);
+    }
+    markTrans(c);
+}
+//END ReachWorker
+
+
+#ifndef _ON_WINDOWS_
+//
+//START ReachPool
+//
+//The class dispatches components of one level to threads. Each thread
+//takes a chunk of components at a time until the level is finished, and
+//the main thread waits until all threads finish the level.
+class ReachPool {
+    COPY_CONSTRUCTOR(ReachPool);
+public:
+    bool m_is_done;
+    UINT m_gen; //the generation of level.
+    UINT m_busy; //the number of threads that are computing the level.
+    UINT m_next; //the position of next component to compute.
+    UINT m_end;
+    UINT m_chunk;
+    UINT const* m_comp; //components of level.
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_start_cond;
+    pthread_cond_t m_finish_cond;
+public:
+    ReachPool()
+    {
+        m_is_done = false;
+        m_gen = 0;
+        m_busy = 0;
+        m_next = 0;
+        m_end = 0;
+        m_chunk = 1;
+        m_comp = nullptr;
+        pthread_mutex_init(&m_lock, nullptr);
+        pthread_cond_init(&m_start_cond, nullptr);
+        pthread_cond_init(&m_finish_cond, nullptr);
+    }
+    ~ReachPool()
+    {
+        pthread_cond_destroy(&m_finish_cond);
+        pthread_cond_destroy(&m_start_cond);
+        pthread_mutex_destroy(&m_lock);
+    }
+
+    static void * run(void * arg);
+};
+
+
+void * ReachPool::run(void * arg)
+{
+    ReachWorker * wk = (ReachWorker*)arg;
+    ReachPool * pool = wk->m_pool;
+    for (;;) {
+        pthread_mutex_lock(&pool->m_lock);
+        while (pool->m_gen == wk->m_gen && !pool->m_is_done) {
+            pthread_cond_wait(&pool->m_start_cond, &pool->m_lock);
+        }
+        if (pool->m_is_done) {
+            pthread_mutex_unlock(&pool->m_lock);
+            break;
+        }
+        wk->m_gen = pool->m_gen;
+        pthread_mutex_unlock(&pool->m_lock);
+
+        wk->computeLevel();
+
+        pthread_mutex_lock(&pool->m_lock);
+        ASSERT0(pool->m_busy > 0);
+        pool->m_busy--;
+        if (pool->m_busy == 0) {
+            pthread_cond_signal(&pool->m_finish_cond);
+        }
+        pthread_mutex_unlock(&pool->m_lock);
+    }
+    return nullptr;
+}
+//END ReachPool
+#endif
+
+
+void ReachWorker::computeLevel()
+{
+    #ifndef _ON_WINDOWS_
+    ReachPool * pool = m_pool;
+    for (;;) {
+        UINT i = __atomic_fetch_add(&pool->m_next, pool->m_chunk,
+                                    __ATOMIC_RELAXED);
+        if (i >= pool->m_end) { break; }
+        UINT end = MIN(i + pool->m_chunk, pool->m_end);
+        for (; i < end; i++) {
+            computeRow(pool->m_comp[i]);
+        }
+    }
+    #else
+    ASSERTN(0, ("thread is not supported"));
+    #endif
+}
+
+
+//
+//START ReachMat
+//
+ReachMat::ReachMat() : m_scc(nullptr)
+{
+    m_word_num = 0;
+    m_trans_num = 0;
+    m_row = nullptr;
+}
+
+
+void ReachMat::destroy()
+{
+    if (m_row != nullptr) {
+        ::free(m_row);
+        m_row = nullptr;
+    }
+    m_word_num = 0;
+    m_trans_num = 0;
+    m_scc.destroy();
+    m_is_trans.clean();
+    m_level_off.clean();
+    m_level_comp.clean();
+}
+
+
+ULONGLONG ReachMat::computeRowMem() const
+{
+    UINT n = m_scc.getCompNum();
+    return n == 0 ? 0 : (getRowOff(n - 1) + 1) * sizeof(ULONGLONG);
+}
+
+
+size_t ReachMat::getRowMem() const
+{
+    return m_row == nullptr ? 0 : (size_t)computeRowMem();
+}
+
+
+//Return true if component 'to' is reachable from component 'from' by
+//searching condensation DAG, which is used if there is no row.
+bool ReachMat::searchComp(UINT from, UINT to) const
+{
+    CSRGraph const& csr = getCSR();
+    BitSet visited;
+    Vector<UINT> stk;
+    UINT top = 0;
+    stk.set(top++, from);
+    while (top != 0) {
+        UINT d = stk.get(--top);
+        for (UINT const* v = m_scc.getCompVexBegin(d);
+             v != m_scc.getCompVexEnd(d); v++) {
+            UINT i = csr.getIdx(*v);
+            for (UINT const* s = csr.getSuccBegin(i);
+                 s != csr.getSuccEnd(i); s++) {
+                UINT e = m_scc.getCompByIdx(*s);
+                if (e == to) { return true; }
+                //Components after 'to' in topological order can not
+                //reach it.
+                if (e == d || e > to || visited.is_contain(e)) { continue; }
+                visited.bunion(e);
+                stk.set(top++, e);
+            }
+        }
+    }
+    return false;
+}
+
+
+size_t ReachMat::count_mem() const
+{
+    return sizeof(ReachMat) + getRowMem() + getCSR().count_mem() +
+           m_is_trans.count_mem() + m_level_off.count_mem() +
+           m_level_comp.count_mem();
+}
+
+
+void ReachMat::reportProgress(ReachOpt const& opt, UINT done,
+                              UINT & last) const
+{
+    if (opt.progress == nullptr) { return; }
+    UINT total = m_scc.getCompNum();
+    if (done != total && done - last < MAX(total / 100, 1u)) { return; }
+    last = done;
+    opt.progress(done, total, opt.progress_arg);
+}
+
+
+//Compute the level of each component, which is the longest distance to
+//sink of condensation DAG, and group components by level.
+void ReachMat::computeLevel()
+{
+    CSRGraph const& csr = getCSR();
+    UINT n = m_scc.getCompNum();
+    m_level_off.clean();
+    m_level_comp.clean();
+    if (n == 0) { return; }
+    Vector<UINT> level_vec;
+    level_vec.set(n - 1, 0);
+    UINT * level = level_vec.get_vec();
+    UINT max_level = 0;
+    for (UINT c = n; c-- > 0;) {
+        UINT l = 0;
+        for (UINT const* v = m_scc.getCompVexBegin(c);
+             v != m_scc.getCompVexEnd(c); v++) {
+            UINT i = csr.getIdx(*v);
+            for (UINT const* s = csr.getSuccBegin(i);
+                 s != csr.getSuccEnd(i); s++) {
+                UINT d = m_scc.getCompByIdx(*s);
+                if (d != c) { l = MAX(l, level[d] + 1); }
+            }
+        }
+        level[c] = l;
+        max_level = MAX(max_level, l);
+    }
+
+    m_level_off.set(max_level + 1, 0);
+    m_level_comp.set(n - 1, 0);
+    UINT * off = m_level_off.get_vec();
+    UINT * comp = m_level_comp.get_vec();
+    for (UINT c = 0; c < n; c++) {
+        off[level[c] + 1]++;
+    }
+    for (UINT l = 0; l < max_level + 1; l++) {
+        off[l + 1] += off[l];
+    }
+    Vector<UINT> pos_vec;
+    pos_vec.set(max_level, 0);
+    UINT * pos = pos_vec.get_vec();
+    for (UINT c = 0; c < n; c++) {
+        comp[off[level[c]] + pos[level[c]]++] = c;
+    }
+}
+
+
+void ReachMat::computeSerial(ReachOpt const& opt)
+{
+    ReachWorker wk(this, nullptr);
+    UINT n = m_scc.getCompNum();
+    UINT last = 0;
+    for (UINT c = n; c-- > 0;) {
+        wk.computeRow(c);
+        reportProgress(opt, n - c, last);
+    }
+    m_trans_num = wk.m_trans_num;
+}
+
+
+void ReachMat::computeParallel(ReachOpt const& opt, UINT thread_num)
+{
+    #ifdef _ON_WINDOWS_
+    computeSerial(opt);
+    #else
+    computeLevel();
+    ReachPool pool;
+    ReachWorker main_wk(this, &pool);
+    Vector<ReachWorker*> wk_vec;
+    UINT wk_num = 0;
+    for (UINT i = 1; i < thread_num; i++) {
+        ReachWorker * wk = new ReachWorker(this, &pool);
+        if (pthread_create(&wk->m_thread, nullptr, ReachPool::run, wk) != 0) {
+            //Go on with the threads that have been created.
+            delete wk;
+            break;
+        }
+        wk_vec.set(wk_num, wk);
+        wk_num++;
+    }
+
+    UINT const* off = m_level_off.get_vec();
+    UINT const* comp = m_level_comp.get_vec();
+    UINT last = 0;
+    for (UINT l = 0; l < getLevelNum(); l++) {
+        UINT num = off[l + 1] - off[l];
+        if (wk_num == 0 || num < REACH_PARALLEL_MIN_COMP) {
+            for (UINT i = off[l]; i < off[l + 1]; i++) {
+                main_wk.computeRow(comp[i]);
+            }
+            reportProgress(opt, off[l + 1], last);
+            continue;
+        }
+        pthread_mutex_lock(&pool.m_lock);
+        pool.m_comp = comp;
+        pool.m_next = off[l];
+        pool.m_end = off[l + 1];
+        pool.m_chunk = MAX(MIN(num / ((wk_num + 1) * 8),
+                               (UINT)REACH_MAX_CHUNK), 1u);
+        pool.m_busy = wk_num;
+        pool.m_gen++;
+        pthread_cond_broadcast(&pool.m_start_cond);
+        pthread_mutex_unlock(&pool.m_lock);
+
+        main_wk.computeLevel();
+
+        pthread_mutex_lock(&pool.m_lock);
+        while (pool.m_busy != 0) {
+            pthread_cond_wait(&pool.m_finish_cond, &pool.m_lock);
+        }
+        pthread_mutex_unlock(&pool.m_lock);
+        reportProgress(opt, off[l + 1], last);
+    }
+
+    pthread_mutex_lock(&pool.m_lock);
+    pool.m_is_done = true;
+    pthread_cond_broadcast(&pool.m_start_cond);
+    pthread_mutex_unlock(&pool.m_lock);
+    m_trans_num = main_wk.m_trans_num;
+    for (UINT i = 0; i < wk_num; i++) {
+        ReachWorker * wk = wk_vec.get(i);
+        pthread_join(wk->m_thread, nullptr);
+        m_trans_num += wk->m_trans_num;
+        delete wk;
+    }
+    #endif
+}
+
+
+bool ReachMat::build(Graph * g, ReachOpt const* opt, OUT ReachStat * stat)
+{
+    ASSERT0(g);
+    destroy();
+    ReachOpt def_opt;
+    if (opt == nullptr) { opt = &def_opt; }
+
+    ULONGLONG start = getMicroSec();
+    m_scc.init(g);
+    m_scc.findSCC();
+    ULONGLONG scc_end = getMicroSec();
+
+    CSRGraph const& csr = getCSR();
+    UINT n = m_scc.getCompNum();
+    ASSERTN(n < 0x7FFFFFFF, ("too many components"));
+    m_word_num = (n + 63) / 64;
+    ULONGLONG mem = computeRowMem();
+    bool has_row = mem == 0 ||
+        ((opt->max_row_mem == 0 || mem <= opt->max_row_mem) &&
+         mem == (size_t)mem);
+    if (has_row && mem != 0) {
+        m_row = (ULONGLONG*)::calloc(1, (size_t)mem);
+        //Fall back to searching if memory is exhausted.
+        has_row = m_row != nullptr;
+    }
+    if (csr.getEdgeNum() != 0) {
+        m_is_trans.set(csr.getEdgeNum() - 1, 0);
+    }
+    UINT thread_num = MAX(opt->thread_num, 1u);
+    #ifdef _ON_WINDOWS_
+    thread_num = 1;
+    #endif
+    if (thread_num > 1) {
+        computeParallel(*opt, thread_num);
+    } else {
+        computeSerial(*opt);
+    }
+    if (stat == nullptr) { return has_row; }
+
+    stat->vex_num = csr.getVertexNum();
+    stat->edge_num = csr.getEdgeNum();
+    stat->comp_num = n;
+    stat->scc_num = m_scc.getSCCNum();
+    stat->level_num = getLevelNum();
+    stat->thread_num = thread_num;
+    stat->trans_edge_num = m_trans_num;
+    stat->row_mem = getRowMem();
+    stat->scc_usec = scc_end - start;
+    stat->reach_usec = getMicroSec() - scc_end;
+    return has_row;
+}
+
+
+void ReachMat::dump(FILE * h) const
+{
+    if (h == nullptr) { return; }
+    fprintf(h, "\nREACH MAT:");
+    for (UINT c = 0; c < m_scc.getCompNum(); c++) {
+        fprintf(h, "\nCOMP%u:", c);
+        for (UINT d = c; d < m_scc.getCompNum(); d++) {
+            if (is_comp_reachable(c, d)) {
+                fprintf(h, " %u", d);
+            }
+        }
+    }
+    fprintf(h, "\n");
+    fflush(h);
+}
+//END ReachMat
+
+} //namespace xcom
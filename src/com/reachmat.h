@@ -0,0 +1,220 @@
+/*@
+Copyright (c) 2013-2014, Su Zhenyu steven.known@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Su Zhenyu nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+@*/
+#ifndef __REACH_MAT_H__
+#define __REACH_MAT_H__
+
+namespace xcom {
+
+//The default limit of bytes of reachability rows, which is enough for
+//about 130000 components.
+#define REACH_DEFAULT_MAX_ROW_MEM ((ULONGLONG)1 << 30)
+
+//The options of computing reachability.
+class ReachOpt {
+public:
+    //Report the progress, 'done' of 'total' components have been finished.
+    typedef void (*HOOK_PROGRESS_FUNPTR)(UINT done, UINT total, void * arg);
+
+    //The number of threads that compute reachability, 0 or 1 means the
+    //computation is serial.
+    UINT thread_num;
+    //Invoked about every one percent of components if it is not nullptr.
+    HOOK_PROGRESS_FUNPTR progress;
+    void * progress_arg; //passed to 'progress'.
+    //Rows are not allocated if they take more bytes than this, and
+    //ReachMat falls back to searching, 0 means no limitation.
+    ULONGLONG max_row_mem;
+public:
+    ReachOpt()
+    {
+        thread_num = 0;
+        progress = nullptr;
+        progress_arg = nullptr;
+        max_row_mem = REACH_DEFAULT_MAX_ROW_MEM;
+    }
+};
+
+
+//The statistics of computing reachability and transitive reduction.
+class ReachStat {
+public:
+    UINT vex_num;
+    UINT edge_num;
+    UINT comp_num; //the number of components, include trivial one.
+    UINT scc_num; //the number of components that are SCC.
+    //The number of levels of condensation DAG, 0 if the computation is
+    //serial.
+    UINT level_num;
+    UINT thread_num; //the number of threads that are actually used.
+    UINT trans_edge_num; //the number of transitive edges.
+    size_t row_mem; //bytes of reachability rows, 0 if rows are absent.
+    ULONGLONG scc_usec; //microseconds of finding SCC.
+    ULONGLONG reach_usec; //microseconds of computing reachability.
+public:
+    ReachStat() { clean(); }
+
+    void clean() { ::memset((void*)this, 0, sizeof(ReachStat)); }
+    void dump(FILE * h) const;
+};
+
+
+//ReachMat
+//
+//This class records the reachability of each pair of vertices of graph in
+//bit-parallel manner.
+//Vertices in same SCC reach the same vertices, thus the matrix is computed
+//on the condensation DAG that is described by SCC. Each component has a
+//row that is a bit vector packed in 64-bit words, which records the
+//components that are reachable from it, except itself. Since components
+//are numbered in topological order, the row of component 'c' only records
+//components that are greater than 'c', and it is stored from the word
+//that contains 'c', which takes about half the space of full matrix.
+//Rows are computed in reverse topological order, the row of 'c' is the
+//union of rows of its successors plus the successors themselves. The
+//successors of 'c' are visited in topological order, and successor 'd'
+//that is already in the row must be reachable from another successor,
+//thus the edge from 'c' to 'd' is transitive and the row of 'd' is not
+//needed to merge.
+//Components in the same level of condensation DAG do not depend on each
+//other, where the level is the longest distance to sink, thus rows of one
+//level are computed by multiple threads in parallel.
+//USAGE:
+//  ReachMat rm;
+//  g.computeReach(rm);
+//  rm.is_reachable(from_id, to_id);
+//If the rows take more memory than ReachOpt::max_row_mem, or they fail to
+//allocate, the matrix falls back to searching: the transitive edges of
+//'c' are the successors that are reachable from other successors, which
+//is found by depth first search on condensation DAG, and each query of
+//reachability is a search as well. The fallback takes linear memory and
+//O(N*(N+E)) time.
+//NOTE: the memory of rows is about N*N/16 bytes, where N is the number of
+//    components, and the matrix does not follow the changes of Graph.
+class ReachMat {
+    COPY_CONSTRUCTOR(ReachMat);
+    friend class ReachWorker;
+protected:
+    UINT m_word_num; //the number of words of full row.
+    UINT m_trans_num; //the number of transitive edges.
+    ULONGLONG * m_row; //rows of all components.
+    SCC m_scc;
+    //Record whether each edge of the snapshot is transitive, the edge is
+    //identified by its position in successors of snapshot.
+    Vector<BYTE> m_is_trans;
+    //Record components in topological order of level, components of level
+    //'l' are m_level_comp[m_level_off[l], m_level_off[l+1]).
+    Vector<UINT> m_level_off;
+    Vector<UINT> m_level_comp;
+
+protected:
+    void computeLevel();
+    void computeSerial(ReachOpt const& opt);
+    void computeParallel(ReachOpt const& opt, UINT thread_num);
+
+    //Return the position of the row of component 'c' in words.
+    ULONGLONG getRowOff(UINT c) const
+    {
+        ULONGLONG b = c >> 6;
+        return 64 * (b * m_word_num - b * (b - 1) / 2) +
+               (c & 63) * (m_word_num - b);
+    }
+    //Return the row of component 'c', the first word contains 'c'.
+    ULONGLONG * getRow(UINT c) const
+    {
+        ASSERT0(m_row);
+        return m_row + (size_t)getRowOff(c);
+    }
+    //Return the bytes that rows of all components need.
+    ULONGLONG computeRowMem() const;
+    size_t getRowMem() const;
+    bool searchComp(UINT from, UINT to) const;
+    void reportProgress(ReachOpt const& opt, UINT done, UINT & last) const;
+public:
+    ReachMat();
+    ~ReachMat() { destroy(); }
+
+    //Compute reachability of 'g', the former result is dropped.
+    //opt: options of computation, the default is serial if it is nullptr.
+    //stat: record statistics if it is not nullptr.
+    //Return true if rows are built, otherwise the matrix falls back to
+    //searching, whereas the result is still valid.
+    bool build(Graph * g, ReachOpt const* opt = nullptr,
+               OUT ReachStat * stat = nullptr);
+
+    //Count memory usage for current object.
+    size_t count_mem() const;
+
+    void destroy();
+    void dump(FILE * h) const;
+
+    //Return the snapshot that reachability is computed on.
+    CSRGraph const& getCSR() const { return m_scc.getCSR(); }
+    SCC const& getSCC() const { return m_scc; }
+    //Return the number of transitive edges.
+    UINT getTransEdgeNum() const { return m_trans_num; }
+    //Return true if reachability is recorded in rows, otherwise each
+    //query is a search.
+    bool hasRow() const { return m_row != nullptr; }
+    UINT getLevelNum() const
+    { return m_level_off.get_elem_count() == 0 ?
+             0 : m_level_off.get_elem_count() - 1; }
+
+    //Return true if component 'to' is reachable from component 'from'
+    //through at least one edge.
+    bool is_comp_reachable(UINT from, UINT to) const
+    {
+        if (from == to) { return m_scc.is_scc(from); }
+        if (to < from) { return false; }
+        if (m_row == nullptr) { return searchComp(from, to); }
+        return (getRow(from)[(to >> 6) - (from >> 6)] &
+                ((ULONGLONG)1 << (to & 63))) != 0;
+    }
+
+    //Return true if there is a path from vertex 'from' to vertex 'to'.
+    //Note the path has one edge at least, as Graph::is_reachable() does.
+    bool is_reachable(UINT from, UINT to) const
+    {
+        UINT cf = m_scc.getComp(from);
+        UINT ct = m_scc.getComp(to);
+        if (cf == CSR_UNDEF || ct == CSR_UNDEF) { return false; }
+        return is_comp_reachable(cf, ct);
+    }
+
+    //Return true if the edge at position 'pos' of successors of snapshot
+    //is transitive, namely there is another path from its source to its
+    //target. The edge inside component is never transitive.
+    //e.g: the k-th out edge of vertex 'i' is at csr.getSuccOff(i) + k.
+    bool is_trans(UINT pos) const
+    {
+        ASSERT0(pos < getCSR().getEdgeNum());
+        return m_is_trans.m_vec[pos] != 0;
+    }
+};
+
+} //namespace xcom
+#endif
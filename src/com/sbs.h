@@ -37,59 +37,59 @@ namespace xcom {
 
 #define BITS_PER_SEG 512
 
+//Number of bits in a word of SEG.
+#define SEG_WORD_BIT (BS_WORD_BYTE * BITS_PER_BYTE)
+
+//Number of words to hold 'bits' bits.
+#define SEG_WORD_NUM(bits) (((bits) + SEG_WORD_BIT - 1) / SEG_WORD_BIT)
+
+//Number of capacity classes of SEG vector, the capacity of
+//the 'i'th class is 2^i.
+#define SEG_VEC_CLASS_NUM 32
+
 class BitSet;
 class BitSetMgr;
 template <UINT BitsPerSeg> class MiscBitSetMgr;
+template <UINT BitsPerSeg> class HBitSetCore;
 
 //Templated SEG iter.
-#define TSEGIter SC<SEG<BitsPerSeg>*>
+//The iterator points to the segment that holds the current element.
+#define TSEGIter SEG<BitsPerSeg>
 
 //
 //Sparse BitSet
 //
 //Segment of Sparse BitSet.
-//Each segment indicates a BitSet.
+//Each segment describes the elements in range of
+//[start, start + BitsPerSeg - 1], and the bits are held inline, thus
+//segments can be stored by value in a contiguous vector.
+//Note the bits beyond BitsPerSeg in the last word are always zero.
 template <UINT BitsPerSeg = BITS_PER_SEG>
 class SEG {
 public:
-    #ifdef DEBUG_SEG
-    UINT id;
-    #endif
+    enum { WORD_NUM = SEG_WORD_NUM(BitsPerSeg) };
     UINT start;
-    BitSet bs;    
+    BSWord w[WORD_NUM];
 
-    SEG()
+public:
+    //Add 'elem' into segment, 'elem' must be in range of segment.
+    void bunion(UINT elem)
     {
-        #ifdef DEBUG_SEG
-        id = 0;
-        #endif
-        start = 0;
+        ASSERT0(elem >= start && elem <= get_end());
+        UINT ofst = elem - start;
+        w[ofst / SEG_WORD_BIT] |= (BSWord)1 << (ofst % SEG_WORD_BIT);
     }
-    SEG(SEG const& src) { copy(src); }
 
-    inline void copy(SEG const& src)
-    {
-        start = src.start;
-        bs.copy(src.bs);
-    }
+    inline void copy(SEG const& src) { ::memcpy(this, &src, sizeof(SEG)); }
     //Count memory usage for current object.
-    size_t count_mem() const { return sizeof(start) + bs.count_mem(); }
-
-    inline void clean()
-    {
-        start = 0;
-        bs.clean();
-    }
+    size_t count_mem() const { return sizeof(SEG); }
 
-    inline bool is_contain(UINT elem)
+    //Remove 'elem' from segment, 'elem' must be in range of segment.
+    void diff(UINT elem)
     {
-        if (elem < start) { return false; }
-        UINT last = start + MAX(bs.get_byte_size(), BYTES_PER_UINT) *
-                    BITS_PER_BYTE - 1;
-        if (elem <= last) {
-            return true;
-        }
-        return false;
+        ASSERT0(elem >= start && elem <= get_end());
+        UINT ofst = elem - start;
+        w[ofst / SEG_WORD_BIT] &= ~((BSWord)1 << (ofst % SEG_WORD_BIT));
     }
 
     //Return the start position of current segment.
@@ -97,134 +97,221 @@ public:
 
     //Return the end position of current segment.
     UINT get_end() const { return start + BitsPerSeg - 1; }
+
+    //Return the first element, or -1 if segment is empty.
+    INT get_first() const
+    {
+        INT n = bs_word_get_first(w, WORD_NUM);
+        return n < 0 ? -1 : (INT)(start + (UINT)n);
+    }
+
+    //Return the last element, or -1 if segment is empty.
+    INT get_last() const
+    {
+        INT n = bs_word_get_last(w, WORD_NUM);
+        return n < 0 ? -1 : (INT)(start + (UINT)n);
+    }
+
+    //Return the next element to 'elem', or -1 if there is no one.
+    INT get_next(UINT elem) const
+    {
+        ASSERT0(elem >= start && elem <= get_end());
+        INT n = bs_word_get_next(w, WORD_NUM, elem - start);
+        return n < 0 ? -1 : (INT)(start + (UINT)n);
+    }
+    UINT get_elem_count() const
+    { return bs_word_get_elem_count(w, WORD_NUM); }
+
+    //Reset segment to hold the range of elements that 'elem' belongs to.
+    void init(UINT elem)
+    {
+        start = elem / BitsPerSeg * BitsPerSeg;
+        ::memset(w, 0, sizeof(w));
+    }
+
+    //Return true if 'elem' is in current segment.
+    bool is_contain(UINT elem) const
+    {
+        if (elem < start || elem > get_end()) { return false; }
+        UINT ofst = elem - start;
+        return (w[ofst / SEG_WORD_BIT] &
+                ((BSWord)1 << (ofst % SEG_WORD_BIT))) != 0;
+    }
+    bool is_empty() const { return bs_word_is_empty(w, WORD_NUM); }
+    bool is_equal(SEG const& src) const
+    {
+        return start == src.start &&
+               bs_word_is_equal(w, src.w, WORD_NUM);
+    }
 };
 
 
 //Segment Manager.
-//This class is responsible to allocate and destroy SEG object.
-//Note this class only handle Default SEG.
+//This class is responsible to allocate and recycle the SEG vectors of
+//sparse bitsets, and the BitSets of dense bitsets.
+//A SEG vector is allocated in capacity of power of 2, and recycled into
+//the free list of its capacity class for next use.
 template <UINT BitsPerSeg = BITS_PER_SEG>
 class SegMgr {
     COPY_CONSTRUCTOR(SegMgr);
-    SList<SEG<BitsPerSeg>*> m_free_list;
-
-#ifdef DEBUG_SEG
-    void debugSegMgr()
+    //Free SEG vectors of each capacity class. A freed vector records the
+    //next freed one in its leading bytes.
+    SEG<BitsPerSeg> * m_free_vec[SEG_VEC_CLASS_NUM];
+    SMemPool * m_pool; //be used to alloc container of BitSet list.
+    SList<BitSet*> m_bs_list; //record all BitSets allocated.
+    SList<BitSet*> m_free_bs_list;
+
+    //Return the capacity class that is able to hold 'cap' segments.
+    static UINT computeClass(UINT cap)
     {
-        //Dump Segs to help find leaks.
-        //DefSegMgr * segmgr = m_sbs_mgr.getSegMgr();
-        //dumpSegMgr(segmgr, g_tfile);
-        FILE * h = fopen("dump_seg.txt", "a+");
-        dumpSegMgr(this, h);
-        fclose(h);
+        UINT c = 0;
+        for (; ((UINT)1 << c) < cap; c++) {}
+        ASSERT0(c < SEG_VEC_CLASS_NUM);
+        return c;
     }
+
+#ifdef DEBUG_SEG
 public:
-    UINT seg_count;
-    BitSet allocated;
+    UINT seg_count; //the number of SEG vectors in use.
 #endif
 
 public:
-    SegMgr() { init(); }
+    SegMgr() { m_pool = nullptr; init(); }
     ~SegMgr() { destroy(); }
 
-    SEG<BitsPerSeg> * allocSEG()
+    //Alloc a SEG vector which is able to hold 'cap' segments.
+    //'cap' will be updated to the actual capacity of the vector.
+    SEG<BitsPerSeg> * allocSEGVec(IN OUT UINT & cap)
     {
-        SEG<BitsPerSeg> * s = m_free_list.remove_head();
-        if (s != nullptr) {
-            #ifdef DEBUG_SEG
-            allocated.bunion(s->id);
-            #endif
-            return s;
+        UINT c = computeClass(cap);
+        cap = (UINT)1 << c;
+        SEG<BitsPerSeg> * v = m_free_vec[c];
+        if (v != nullptr) {
+            m_free_vec[c] = *(SEG<BitsPerSeg>**)v;
+        } else {
+            v = (SEG<BitsPerSeg>*)::malloc(sizeof(SEG<BitsPerSeg>) * cap);
+            ASSERTN(v, ("malloc failed"));
         }
-        s = new SEG<BitsPerSeg>();
-
         #ifdef DEBUG_SEG
         seg_count++;
-        s->id = seg_count;
-        allocated.bunion(s->id);
         #endif
-        
-        return s;
+        return v;
+    }
+
+    //Alloc a BitSet for dense bitset.
+    BitSet * allocBitSet()
+    {
+        BitSet * bs = m_free_bs_list.remove_head();
+        if (bs != nullptr) { return bs; }
+        bs = new BitSet();
+        m_bs_list.append_head(bs);
+        return bs;
     }
 
     void init()
     {
-        if (m_free_list.get_pool() != nullptr) { return; }
+        if (m_pool != nullptr) { return; }
         #ifdef DEBUG_SEG
         seg_count = 0;
-        allocated.clean();
         #endif
-        SMemPool * p = smpoolCreate(sizeof(TSEGIter) * 4, MEM_CONST_SIZE);
-        m_free_list.set_pool(p);
+        ::memset(m_free_vec, 0, sizeof(m_free_vec));
+        m_pool = smpoolCreate(sizeof(SC<BitSet*>) * 4, MEM_CONST_SIZE);
+        m_bs_list.set_pool(m_pool);
+        m_free_bs_list.set_pool(m_pool);
     }
 
     void destroy()
     {
-        if (m_free_list.get_pool() == nullptr) { return; }
-        #ifdef DEBUG_SEG
-        UINT n = m_free_list.get_elem_count();
+        if (m_pool == nullptr) { return; }
         ///////////////////////////////////////////////////////////////
         //NOTE: SBitSet or SBitSetCore's clean() should be invoked   //
         //before destruction, otherwise it will lead to SegMgr leaks.//
         ///////////////////////////////////////////////////////////////
-        if (seg_count != n) {
-            debugSegMgr();
-        }
-        ASSERTN(seg_count == n, ("MemLeak! There still are SEGs not freed"));        
+        #ifdef DEBUG_SEG
+        ASSERTN(seg_count == 0, ("MemLeak! There still are SEGs not freed"));
+        ASSERTN(m_bs_list.get_elem_count() ==
+                m_free_bs_list.get_elem_count(),
+                ("MemLeak! There still are BitSets not freed"));
         #endif
+        for (UINT c = 0; c < SEG_VEC_CLASS_NUM; c++) {
+            for (SEG<BitsPerSeg> * v = m_free_vec[c]; v != nullptr;) {
+                SEG<BitsPerSeg> * next = *(SEG<BitsPerSeg>**)v;
+                ::free(v);
+                v = next;
+            }
+            m_free_vec[c] = nullptr;
+        }
 
-        for (TSEGIter * sc = m_free_list.get_head();
-             sc != m_free_list.end(); sc = m_free_list.get_next(sc)) {
-            SEG<BitsPerSeg> * s = sc->val();
-            ASSERT0(s);
-            delete s;
+        for (SC<BitSet*> * sc = m_bs_list.get_head();
+             sc != m_bs_list.end(); sc = m_bs_list.get_next(sc)) {
+            ASSERT0(sc->val());
+            delete sc->val();
         }
 
-        //Note member of m_free_list is allocated in pool,
+        //Note member of list is allocated in pool,
         //thus delete pool at first.
-        m_free_list.clean();
-        ASSERTN(m_free_list.get_pool(), ("miss pool"));
-        smpoolDelete(m_free_list.get_pool());        
-        m_free_list.set_pool(nullptr);
+        m_bs_list.clean();
+        m_free_bs_list.clean();
+        smpoolDelete(m_pool);
+        m_pool = nullptr;
+        m_bs_list.set_pool(nullptr);
+        m_free_bs_list.set_pool(nullptr);
     }
 
-    void freeSEG(SEG<BitsPerSeg> * s)
+    //Free SEG vector 'v' which capacity is 'cap'.
+    void freeSEGVec(SEG<BitsPerSeg> * v, UINT cap)
     {
+        ASSERT0(v && cap != 0 && (cap & (cap - 1)) == 0);
+        UINT c = computeClass(cap);
+        *(SEG<BitsPerSeg>**)v = m_free_vec[c];
+        m_free_vec[c] = v;
         #ifdef DEBUG_SEG
-        allocated.diff(s->id);
+        ASSERT0(seg_count > 0);
+        seg_count--;
         #endif
+    }
 
-        s->clean();
-        m_free_list.append_head(s);
+    void freeBitSet(BitSet * bs)
+    {
+        ASSERT0(bs);
+        bs->clean();
+        m_free_bs_list.append_head(bs);
     }
-    
+
     //Count memory usage for current object.
     size_t count_mem() const
     {
         size_t count = 0;
-        for (TSEGIter * sc = m_free_list.get_head();
-             sc != m_free_list.end(); sc = m_free_list.get_next(sc)) {
-            SEG<BitsPerSeg> * s = sc->val();
-            ASSERT0(s);
-            count += s->count_mem();
+        for (UINT c = 0; c < SEG_VEC_CLASS_NUM; c++) {
+            for (SEG<BitsPerSeg> * v = m_free_vec[c]; v != nullptr;
+                 v = *(SEG<BitsPerSeg>**)v) {
+                count += sizeof(SEG<BitsPerSeg>) << c;
+            }
         }
-
-        count += m_free_list.count_mem();
+        for (SC<BitSet*> * sc = m_free_bs_list.get_head();
+             sc != m_free_bs_list.end(); sc = m_free_bs_list.get_next(sc)) {
+            ASSERT0(sc->val());
+            count += sc->val()->count_mem();
+        }
+        count += m_bs_list.count_mem();
+        count += m_free_bs_list.count_mem();
         return count;
     }
 
     #ifdef DEBUG_SEG
     UINT get_seg_count() const { return seg_count; }
-    //Decrease seg_count.
-    void dec_seg_count() { seg_count--; }
     #endif
-
-    SList<SEG<BitsPerSeg>*> const* get_free_list() const
-    { return &m_free_list; }
 };
 
 
 //Sparse BitSet Core
+//The segments are kept by value in a vector which is sorted by the start
+//of segment, and there is no empty segment in the vector.
+//Element operations locate the segment via binary search, and set
+//operations merge the two vectors and apply word operations to the
+//segments with the same start.
+//Note the object is valid if all its fields are zero, and modifying the
+//set will invalidate the iterators of it.
 //e.g1:
 //    MiscBitSetMgr<33> mbsm;
 //    SBitSetCore<33> * x = mbsm.allocSBitSetCore() ;
@@ -239,67 +326,111 @@ template <UINT BitsPerSeg = BITS_PER_SEG>
 class SBitSetCore {
     COPY_CONSTRUCTOR(SBitSetCore);
 protected:
-    SListEx<SEG<BitsPerSeg>*> segs;
+    SEG<BitsPerSeg> * m_segs; //segment vector, sorted by start.
+    UINT m_seg_num; //the number of segments in vector.
+    UINT m_seg_cap; //the capacity of vector.
+
+protected:
+    //Return the index of the first segment which end is not less
+    //than 'elem'.
+    UINT findSeg(UINT elem) const
+    {
+        UINT lo = 0;
+        UINT hi = m_seg_num;
+        while (lo < hi) {
+            UINT mid = (lo + hi) / 2;
+            if (m_segs[mid].get_end() < elem) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    //Grow the vector to be able to hold 'num' segments.
+    void grow(UINT num, SegMgr<BitsPerSeg> * sm)
+    {
+        if (num <= m_seg_cap) { return; }
+        UINT cap = MAX(num, m_seg_cap * 2);
+        SEG<BitsPerSeg> * v = sm->allocSEGVec(cap);
+        if (m_segs != nullptr) {
+            ::memcpy(v, m_segs, sizeof(SEG<BitsPerSeg>) * m_seg_num);
+            sm->freeSEGVec(m_segs, m_seg_cap);
+        }
+        m_segs = v;
+        m_seg_cap = cap;
+    }
 
-    void * realloc(IN void * src, size_t orgsize, size_t newsize);
+    //Remove segment 'i' from vector.
+    void removeSeg(UINT i, SegMgr<BitsPerSeg> * sm)
+    {
+        ASSERT0(i < m_seg_num);
+        ::memmove(m_segs + i, m_segs + i + 1,
+                  sizeof(SEG<BitsPerSeg>) * (m_seg_num - i - 1));
+        setSegNum(m_seg_num - 1, sm);
+    }
+
+    //Update the number of segments. The vector will be freed if it is
+    //empty, thus an empty set does not hold any SEG.
+    void setSegNum(UINT num, SegMgr<BitsPerSeg> * sm)
+    {
+        m_seg_num = num;
+        if (num == 0 && m_segs != nullptr) {
+            sm->freeSEGVec(m_segs, m_seg_cap);
+            m_segs = nullptr;
+            m_seg_cap = 0;
+        }
+    }
 public:
-    SBitSetCore() {}
+    SBitSetCore() { init(); }
     ~SBitSetCore()
     {
         //should call clean() before destruction,
         //otherwise it will incur SegMgr assertion.
     }
 
-    void bunion(SBitSetCore<BitsPerSeg> const& src,
-                SegMgr<BitsPerSeg> * sm,
-                TSEGIter ** free_list,
-                SMemPool * pool);
-    void bunion(UINT elem,
-                SegMgr<BitsPerSeg> * sm,
-                TSEGIter ** free_list,
-                SMemPool * pool);
+    void bunion(SBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm);
+    void bunion(UINT elem, SegMgr<BitsPerSeg> * sm);
     void bunion(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
-    { bunion(elem, &m.sm, &m.scflst, m.ptr_pool); }
-
+    { bunion(elem, &m.sm); }
     void bunion(SBitSetCore<BitsPerSeg> const& src,
                 MiscBitSetMgr<BitsPerSeg> & m)
-    { bunion(src, &m.sm, &m.scflst, m.ptr_pool); }
+    { bunion(src, &m.sm); }
 
-    void clean(MiscBitSetMgr<BitsPerSeg> & m) { clean(&m.sm, &m.scflst); }
-    void clean(SegMgr<BitsPerSeg> * sm, TSEGIter ** free_list);
-    void copy(SBitSetCore<BitsPerSeg> const& src,
-              SegMgr<BitsPerSeg> * sm,
-              TSEGIter ** free_list,
-              SMemPool * pool)
+    void clean(MiscBitSetMgr<BitsPerSeg> & m) { clean(&m.sm); }
+    void clean(SegMgr<BitsPerSeg> * sm) { setSegNum(0, sm); }
+    //Remove all elements but keep the SEG vector for later use.
+    void cleanAndKeepVec() { m_seg_num = 0; }
+    void copy(SBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(this != &src, ("operate on same set"));
-        clean(sm, free_list);
-        for (TSEGIter * st = src.segs.get_head();
-             st != src.segs.end(); st = src.segs.get_next(st)) {
-            SEG<BitsPerSeg> * s = st->val();
-            ASSERT0(s);
-
-            SEG<BitsPerSeg> * t = sm->allocSEG();
-            t->copy(*s);
-            segs.append_tail(t, free_list, pool);
+        if (src.m_seg_num == 0) {
+            clean(sm);
+            return;
         }
+        m_seg_num = 0;
+        grow(src.m_seg_num, sm);
+        ::memcpy(m_segs, src.m_segs,
+                 sizeof(SEG<BitsPerSeg>) * src.m_seg_num);
+        m_seg_num = src.m_seg_num;
     }
-
     void copy(SBitSetCore<BitsPerSeg> const& src, MiscBitSetMgr<BitsPerSeg> & m)
-    { copy(src, &m.sm, &m.scflst, m.ptr_pool); }
+    { copy(src, &m.sm); }
     //Count memory usage for current object.
-    size_t count_mem() const;
+    size_t count_mem() const
+    { return sizeof(SBitSetCore) + sizeof(SEG<BitsPerSeg>) * m_seg_cap; }
 
-    void destroySEGandClean(SegMgr<BitsPerSeg> * sm, TSEGIter ** free_list);
-    void diff(UINT elem, SegMgr<BitsPerSeg> * sm, TSEGIter ** free_list);
-    void diff(SBitSetCore<BitsPerSeg> const& src,
-              SegMgr<BitsPerSeg> * sm,
-              TSEGIter ** free_list);
+    //Free the SEG vector back to SegMgr.
+    //The function is kept for compatibility, it is equal to clean().
+    void destroySEGandClean(SegMgr<BitsPerSeg> * sm) { clean(sm); }
+    void diff(UINT elem, SegMgr<BitsPerSeg> * sm);
+    void diff(SBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm);
     void diff(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
-    { diff(elem, &m.sm, &m.scflst); }
+    { diff(elem, &m.sm); }
     void diff(SBitSetCore<BitsPerSeg> const& src,
               MiscBitSetMgr<BitsPerSeg> & m)
-    { diff(src, &m.sm, &m.scflst); }
+    { diff(src, &m.sm); }
 
     void dump(FILE * h) const;
     void dump2(FILE * h) const;
@@ -309,18 +440,25 @@ public:
     INT get_last(TSEGIter ** cur) const;
     INT get_next(UINT elem, TSEGIter ** cur) const;
 
-    void init() { segs.init(); }
+    //Return the number of segments.
+    UINT get_seg_num() const { return m_seg_num; }
+
+    void init()
+    {
+        m_segs = nullptr;
+        m_seg_num = 0;
+        m_seg_cap = 0;
+    }
     void intersect(SBitSetCore<BitsPerSeg> const& src,
-                   SegMgr<BitsPerSeg> * sm,
-                   TSEGIter ** free_list);
+                   SegMgr<BitsPerSeg> * sm);
     void intersect(SBitSetCore<BitsPerSeg> const& src,
                    MiscBitSetMgr<BitsPerSeg> & m)
-    { intersect(src, &m.sm, &m.scflst); }
+    { intersect(src, &m.sm); }
 
     bool is_equal(SBitSetCore<BitsPerSeg> const& src) const;
     bool is_contain(UINT elem) const;
     bool is_intersect(SBitSetCore<BitsPerSeg> const& src) const;
-    bool is_empty() const;
+    bool is_empty() const { return m_seg_num == 0; }
 };
 
 
@@ -340,78 +478,63 @@ template <UINT BitsPerSeg = BITS_PER_SEG>
 class SBitSet : public SBitSetCore<BitsPerSeg> {
     COPY_CONSTRUCTOR(SBitSet);
 protected:
-    SMemPool * m_pool;
-    TSEGIter * m_flst; //free list
     SegMgr<BitsPerSeg> * m_sm;
 public:
-    SBitSet(SegMgr<BitsPerSeg> * sm, UINT sz = sizeof(TSEGIter))
+    SBitSet(SegMgr<BitsPerSeg> * sm)
     {
-        m_pool = nullptr;
-        init(sm, sz);
+        m_sm = nullptr;
+        init(sm);
     }
     ~SBitSet() { destroy(); }
 
-    void init(SegMgr<BitsPerSeg> * sm, UINT sz = sizeof(TSEGIter))
+    void init(SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(sm, ("need SegMgr"));
-        ASSERTN(sz % sizeof(TSEGIter) == 0, ("pool size must be mulitple."));
-        ASSERTN(m_pool == nullptr, ("already initialized"));
-        m_pool = smpoolCreate(sz, MEM_CONST_SIZE);
+        ASSERTN(m_sm == nullptr, ("already initialized"));
+        SBitSetCore<BitsPerSeg>::init();
         m_sm = sm;
-        m_flst = nullptr;
     }
 
     void destroy()
     {
-        ASSERTN(m_pool, ("already destroy"));
-        for (TSEGIter * st = SBitSetCore<BitsPerSeg>::segs.get_head();
-             st != SBitSetCore<BitsPerSeg>::segs.end();
-             st = SBitSetCore<BitsPerSeg>::segs.get_next(st)) {
-            SEG<BitsPerSeg> * s = st->val();
-            ASSERT0(s);
-
-            m_sm->freeSEG(s);
-        }
-
-        //Unnecessary call clean(), since free pool will free all
-        //SEGIter object.
-        //SBitSetCore::clean(m_sm, &m_flst);
-        smpoolDelete(m_pool);
-        m_pool = nullptr;
+        ASSERTN(m_sm, ("already destroy"));
+        SBitSetCore<BitsPerSeg>::clean(m_sm);
+        m_sm = nullptr;
     }
 
     void bunion(SBitSet<BitsPerSeg> const& src)
-    { SBitSetCore<BitsPerSeg>::bunion(src, m_sm, &m_flst, m_pool);    }
+    { SBitSetCore<BitsPerSeg>::bunion(src, m_sm); }
 
     void bunion(UINT elem)
-    { SBitSetCore<BitsPerSeg>::bunion(elem, m_sm, &m_flst, m_pool); }
+    { SBitSetCore<BitsPerSeg>::bunion(elem, m_sm); }
 
-    void clean() { SBitSetCore<BitsPerSeg>::clean(m_sm, &m_flst); }
+    void clean() { SBitSetCore<BitsPerSeg>::clean(m_sm); }
     void copy(SBitSet<BitsPerSeg> const& src)
     {
         //Do NOT change current m_sm.
-        SBitSetCore<BitsPerSeg>::copy(src, m_sm, &m_flst, m_pool);
+        SBitSetCore<BitsPerSeg>::copy(src, m_sm);
     }
     void copy(SBitSetCore<BitsPerSeg> const& src)
     {
         //Do NOT change current m_sm.
-        SBitSetCore<BitsPerSeg>::copy(src, m_sm, &m_flst, m_pool);
+        SBitSetCore<BitsPerSeg>::copy(src, m_sm);
     }
     //Count memory usage for current object.
-    size_t count_mem() const;
+    size_t count_mem() const
+    { return SBitSetCore<BitsPerSeg>::count_mem() + sizeof(m_sm); }
 
     void diff(UINT elem)
-    { SBitSetCore<BitsPerSeg>::diff(elem, m_sm, &m_flst); }
+    { SBitSetCore<BitsPerSeg>::diff(elem, m_sm); }
 
     //Difference between current bitset and 'src', current bitset
     //will be modified.
     void diff(SBitSet<BitsPerSeg> const& src)
-    { SBitSetCore<BitsPerSeg>::diff(src, m_sm, &m_flst); }
+    { SBitSetCore<BitsPerSeg>::diff(src, m_sm); }
 
     //Do intersection for current bitset and 'src', current bitset
     //will be modified.
     void intersect(SBitSet<BitsPerSeg> const& src)
-    { SBitSetCore<BitsPerSeg>::intersect(src, m_sm, &m_flst); }
+    { SBitSetCore<BitsPerSeg>::intersect(src, m_sm); }
 };
 
 
@@ -420,6 +543,7 @@ public:
 //
 //This class represent a BitSet which can be transformed
 //in between sparse and dense bitset.
+//The dense bitset is a BitSet allocated by SegMgr.
 //e.g1:
 //    MiscBitSetMgr<47> mbsm;
 //    DBitSetCore<47> x;
@@ -437,139 +561,130 @@ class DBitSetCore : public SBitSetCore<BitsPerSeg> {
     COPY_CONSTRUCTOR(DBitSetCore);
 protected:
     BYTE m_is_sparse:1; //true if bitset is sparse.
+    BitSet * m_bs; //dense bitset.
 
 protected:
     //Only read BitSet.
     BitSet const* read_bs() const
     {
         ASSERTN(!m_is_sparse, ("only used by dense bitset"));
-        TSEGIter * sc = SBitSetCore<BitsPerSeg>::segs.get_head();
-        if (sc == SBitSetCore<BitsPerSeg>::segs.end()) {
-            return nullptr;
-        }
-        ASSERT0(sc->val());
-        return &sc->val()->bs;
+        return m_bs;
     }
 
     //Get BitSet, alloc BitSet if it not exist.
-    BitSet * alloc_bs(SegMgr<BitsPerSeg> * sm,
-                      TSEGIter ** flst,
-                      SMemPool * pool)
+    BitSet * alloc_bs(SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(!m_is_sparse, ("only used by dense bitset"));
-        TSEGIter * sc = SBitSetCore<BitsPerSeg>::segs.get_head();
-        if (sc == SBitSetCore<BitsPerSeg>::segs.end()) {
-            SEG<BitsPerSeg> * t = sm->allocSEG();
-            SBitSetCore<BitsPerSeg>::segs.append_head(t, flst, pool);
-            return &t->bs;
+        if (m_bs == nullptr) {
+            m_bs = sm->allocBitSet();
         }
-        ASSERT0(sc->val());
-        return &sc->val()->bs;
+        return m_bs;
     }
 
     //Get BitSet and modify BitSet, do not alloc.
     BitSet * get_bs()
     {
         ASSERTN(!m_is_sparse, ("only used by dense bitset"));
-        TSEGIter * sc = SBitSetCore<BitsPerSeg>::segs.get_head();
-        if (sc == SBitSetCore<BitsPerSeg>::segs.end()) {
-            return nullptr;
-        }
-        ASSERT0(sc->val());
-        return &sc->val()->bs;
+        return m_bs;
     }
 public:
-    DBitSetCore() { m_is_sparse = true; }
-    DBitSetCore(bool is_sparse) { set_sparse(is_sparse); }
+    DBitSetCore() { m_is_sparse = true; m_bs = nullptr; }
+    DBitSetCore(bool is_sparse) { m_bs = nullptr; set_sparse(is_sparse); }
     ~DBitSetCore() {}
 
-    void bunion(DBitSetCore<BitsPerSeg> const& src,
-                SegMgr<BitsPerSeg> * sm,
-                TSEGIter ** free_list,
-                SMemPool * pool)
+    void bunion(DBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(this != &src, ("operate on same set"));
         ASSERTN(m_is_sparse == src.m_is_sparse, ("diff set type"));
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::bunion(src, sm, free_list, pool);
+            SBitSetCore<BitsPerSeg>::bunion(src, sm);
         } else {
             BitSet const* srcbs = src.read_bs();
             if (srcbs == nullptr) { return; }
-            BitSet * tgtbs = alloc_bs(sm, free_list, pool);
+            BitSet * tgtbs = alloc_bs(sm);
             tgtbs->bunion(*srcbs);
         }
     }
 
     void bunion(DBitSetCore<BitsPerSeg> const& src,
                 MiscBitSetMgr<BitsPerSeg> & m)
-    { bunion(src, &m.sm, &m.scflst, m.ptr_pool); }
+    { bunion(src, &m.sm); }
 
     void bunion(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
-    { bunion(elem, &m.sm, &m.scflst, m.ptr_pool); }
-
-    void copy(DBitSetCore<BitsPerSeg> const& src, MiscBitSetMgr<BitsPerSeg> & m)
-    { copy(src, &m.sm, &m.scflst, m.ptr_pool); }
-
-    void diff(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
-    { diff(elem, &m.sm, &m.scflst); }
-
-    void diff(DBitSetCore<BitsPerSeg> const& src, MiscBitSetMgr<BitsPerSeg> & m)
-    { diff(src, &m.sm, &m.scflst); }
+    { bunion(elem, &m.sm); }
 
-    void bunion(UINT elem,
-                SegMgr<BitsPerSeg> * sm,
-                TSEGIter ** free_list,
-                SMemPool * pool)
+    void bunion(UINT elem, SegMgr<BitsPerSeg> * sm)
     {
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::bunion(elem, sm, free_list, pool);
+            SBitSetCore<BitsPerSeg>::bunion(elem, sm);
         } else {
-            BitSet * tgtbs = alloc_bs(sm, free_list, pool);
+            BitSet * tgtbs = alloc_bs(sm);
             tgtbs->bunion(elem);
         }
     }
 
-    void copy(DBitSetCore<BitsPerSeg> const& src,
-              SegMgr<BitsPerSeg> * sm,
-              TSEGIter ** free_list,
-              SMemPool * pool)
+    void clean(MiscBitSetMgr<BitsPerSeg> & m) { clean(&m.sm); }
+    void clean(SegMgr<BitsPerSeg> * sm)
+    {
+        if (m_is_sparse) {
+            SBitSetCore<BitsPerSeg>::clean(sm);
+            return;
+        }
+        if (m_bs != nullptr) {
+            sm->freeBitSet(m_bs);
+            m_bs = nullptr;
+        }
+    }
+    void copy(DBitSetCore<BitsPerSeg> const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { copy(src, &m.sm); }
+    void copy(DBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(this != &src, ("operate on same set"));
         ASSERTN(m_is_sparse == src.m_is_sparse, ("diff set type"));
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::copy(src, sm, free_list, pool);
+            SBitSetCore<BitsPerSeg>::copy(src, sm);
         } else {
             BitSet const* srcbs = src.read_bs();
             if (srcbs == nullptr) {
-                SBitSetCore<BitsPerSeg>::clean(sm, free_list);
+                clean(sm);
                 return;
             }
-            BitSet * tgtbs = alloc_bs(sm, free_list, pool);
+            BitSet * tgtbs = alloc_bs(sm);
             tgtbs->copy(*srcbs);
         }
     }
     //Count memory usage for current object.
     size_t count_mem() const
-    { return SBitSetCore<BitsPerSeg>::count_mem() + 1; }
+    {
+        size_t count = SBitSetCore<BitsPerSeg>::count_mem() +
+                       sizeof(DBitSetCore) - sizeof(SBitSetCore<BitsPerSeg>);
+        if (m_bs != nullptr) {
+            count += m_bs->count_mem();
+        }
+        return count;
+    }
 
-    void diff(UINT elem, SegMgr<BitsPerSeg> * sm, TSEGIter ** free_list)
+    void destroySEGandClean(SegMgr<BitsPerSeg> * sm) { clean(sm); }
+    void diff(UINT elem, MiscBitSetMgr<BitsPerSeg> & m)
+    { diff(elem, &m.sm); }
+    void diff(DBitSetCore<BitsPerSeg> const& src, MiscBitSetMgr<BitsPerSeg> & m)
+    { diff(src, &m.sm); }
+    void diff(UINT elem, SegMgr<BitsPerSeg> * sm)
     {
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::diff(elem, sm, free_list);
+            SBitSetCore<BitsPerSeg>::diff(elem, sm);
         } else {
             BitSet * tgtbs = get_bs();
             if (tgtbs == nullptr) { return; }
             tgtbs->diff(elem);
         }
     }
-    void diff(DBitSetCore<BitsPerSeg> const& src,
-              SegMgr<BitsPerSeg> * sm,
-              TSEGIter ** free_list)
+    void diff(DBitSetCore<BitsPerSeg> const& src, SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(this != &src, ("operate on same set"));
         ASSERTN(m_is_sparse == src.m_is_sparse, ("diff set type"));
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::diff(src, sm, free_list);
+            SBitSetCore<BitsPerSeg>::diff(src, sm);
         } else {
             BitSet const* srcbs = src.read_bs();
             if (srcbs == nullptr) { return; }
@@ -578,23 +693,81 @@ public:
             tgtbs->diff(*srcbs);
         }
     }
+    void dump(FILE * h) const
+    {
+        if (m_is_sparse) {
+            SBitSetCore<BitsPerSeg>::dump(h);
+            return;
+        }
+        ASSERT0(h);
+        if (m_bs == nullptr) { return; }
+        fprintf(h, " [");
+        INT n;
+        for (INT e = m_bs->get_first(); e >= 0; e = n) {
+            n = m_bs->get_next((UINT)e);
+            fprintf(h, "%d", e);
+            if (n >= 0) {
+                fprintf(h, ",");
+            }
+        }
+        fprintf(h, "]");
+        fflush(h);
+    }
+
+    UINT get_elem_count() const
+    {
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::get_elem_count();
+        }
+        return m_bs == nullptr ? 0 : m_bs->get_elem_count();
+    }
+
+    //*cur will be set to nullptr if set is empty.
+    //Note dense bitset does not need the iterator.
+    INT get_first(TSEGIter ** cur) const
+    {
+        ASSERT0(cur);
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::get_first(cur);
+        }
+        *cur = nullptr;
+        return m_bs == nullptr ? -1 : m_bs->get_first();
+    }
+
+    //*cur will be set to nullptr if set is empty.
+    INT get_last(TSEGIter ** cur) const
+    {
+        ASSERT0(cur);
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::get_last(cur);
+        }
+        *cur = nullptr;
+        return m_bs == nullptr ? -1 : m_bs->get_last();
+    }
+
+    INT get_next(UINT elem, TSEGIter ** cur) const
+    {
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::get_next(elem, cur);
+        }
+        return m_bs == nullptr ? -1 : m_bs->get_next(elem);
+    }
 
     void intersect(DBitSetCore<BitsPerSeg> const& src,
                    MiscBitSetMgr<BitsPerSeg> & m)
-    { intersect(src, &m.sm, &m.scflst); }
+    { intersect(src, &m.sm); }
 
     void intersect(DBitSetCore<BitsPerSeg> const& src,
-                   SegMgr<BitsPerSeg> * sm,
-                   TSEGIter ** free_list)
+                   SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(this != &src, ("operate on same set"));
         ASSERTN(m_is_sparse == src.m_is_sparse, ("diff set type"));
         if (m_is_sparse) {
-            SBitSetCore<BitsPerSeg>::intersect(src, sm, free_list);
+            SBitSetCore<BitsPerSeg>::intersect(src, sm);
         } else {
             BitSet const* srcbs = src.read_bs();
             if (srcbs == nullptr) {
-                SBitSetCore<BitsPerSeg>::clean(sm, free_list);
+                clean(sm);
                 return;
             }
             BitSet * tgtbs = get_bs();
@@ -613,6 +786,14 @@ public:
         return tgtbs->is_contain(elem);
     }
 
+    bool is_empty() const
+    {
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::is_empty();
+        }
+        return m_bs == nullptr || m_bs->is_empty();
+    }
+
     bool is_equal(DBitSetCore<BitsPerSeg> const& src) const
     {
         ASSERTN(this != &src, ("operate on same set"));
@@ -634,49 +815,26 @@ public:
         return tgtbs->is_equal(*srcbs);
     }
 
-    //*cur will be set to nullptr if set is empty.
-    INT get_first(TSEGIter ** cur) const
+    bool is_intersect(DBitSetCore<BitsPerSeg> const& src) const
     {
-        ASSERT0(cur);
-
-        TSEGIter * sc = SBitSetCore<BitsPerSeg>::segs.get_head();
-        if (sc == SBitSetCore<BitsPerSeg>::segs.end()) {
-            ASSERT0(SBitSetCore<BitsPerSeg>::segs.get_elem_count() == 0);
-            *cur = nullptr;
-            return -1;
+        ASSERTN(this != &src, ("operate on same set"));
+        ASSERTN(m_is_sparse == src.m_is_sparse, ("diff set type"));
+        if (m_is_sparse) {
+            return SBitSetCore<BitsPerSeg>::is_intersect(src);
         }
-
-        *cur = sc;
-        ASSERT0(sc->val());
-        SEG<BitsPerSeg> * s = sc->val();
-
-        //DBitSetCore allow bs is empty if it is not sparse.
-        //ASSERT0(!s->bs.is_empty());
-        return s->get_start() + s->bs.get_first();
+        BitSet const* srcbs = src.read_bs();
+        BitSet const* tgtbs = read_bs();
+        if (srcbs == nullptr || tgtbs == nullptr) { return false; }
+        return tgtbs->is_intersect(*srcbs);
     }
 
-    //*cur will be set to nullptr if set is empty.
-    INT get_last(TSEGIter ** cur) const
+    //Note the set must be empty when changing its type.
+    void set_sparse(bool is_sparse)
     {
-        TSEGIter * sc = SBitSetCore<BitsPerSeg>::segs.get_tail();
-        if (sc == SBitSetCore<BitsPerSeg>::segs.end()) {
-            ASSERT0(SBitSetCore<BitsPerSeg>::segs.get_elem_count() == 0);
-            *cur = nullptr;
-            return -1;
-        }
-
-        ASSERT0(cur);
-        *cur = sc;
-        ASSERT0(sc->val());
-
-        SEG<BitsPerSeg> * s = sc->val();
-
-        //DBitSetCore allow bs is empty if it is not sparse.
-        //ASSERT0(!s->bs.is_empty());
-        return s->get_start() + s->bs.get_last();
+        ASSERTN(SBitSetCore<BitsPerSeg>::is_empty() && m_bs == nullptr,
+                ("set is not empty"));
+        m_is_sparse = (UINT)is_sparse;
     }
-
-    void set_sparse(bool is_sparse) { m_is_sparse = (UINT)is_sparse; }
 };
 
 
@@ -689,10 +847,10 @@ public:
 //simply the use of them.
 //e.g1:
 //    MiscBitSetMgr<47> mbsm;
-//    DBitSet<47> x(mbsm);
+//    DBitSet<47> x(mbsm.getSegMgr());
 //    x.set_sparse(True or False);
 //    x.bunion(100);
-//    x.clean(mbsm); //Very Important!
+//    x.clean(); //Very Important!
 //e.g2:
 //    MiscBitSetMgr<47> mbsm;
 //    DBitSet<47> * x = mbsm.allocDBitSet();
@@ -703,70 +861,41 @@ template <UINT BitsPerSeg = BITS_PER_SEG>
 class DBitSet : public DBitSetCore<BitsPerSeg> {
     COPY_CONSTRUCTOR(DBitSet);
 protected:
-    SMemPool * m_pool;
-    TSEGIter * m_flst;
     SegMgr<BitsPerSeg> * m_sm;
 public:
-    DBitSet(SegMgr<BitsPerSeg> * sm, UINT sz = sizeof(TSEGIter))
+    DBitSet(SegMgr<BitsPerSeg> * sm)
     {
         ASSERTN(sm, ("need SegMgr"));
-        ASSERTN(sz % sizeof(TSEGIter) == 0, ("pool size must be mulitple."));
         DBitSetCore<BitsPerSeg>::m_is_sparse = true;
-        m_pool = smpoolCreate(sz, MEM_CONST_SIZE);
         m_sm = sm;
-        m_flst = nullptr;
-    }
-    ~DBitSet()
-    {
-        for (TSEGIter * st = SBitSetCore<BitsPerSeg>::segs.get_head();
-             st != SBitSetCore<BitsPerSeg>::segs.end();
-             st = SBitSetCore<BitsPerSeg>::segs.get_next(st)) {
-            SEG<BitsPerSeg> * s = st->val();
-            ASSERT0(s);
-
-            m_sm->freeSEG(s);
-        }
-
-        //Unnecessary call clean(), since free pool will free all
-        //SEGIter object.
-        //DBitSetCore::clean(m_sm, &m_flst);
-        smpoolDelete(m_pool);
     }
+    ~DBitSet() { clean(); }
 
     void bunion(DBitSet<BitsPerSeg> const& src)
-    { DBitSetCore<BitsPerSeg>::bunion(src, m_sm, &m_flst, m_pool);    }
+    { DBitSetCore<BitsPerSeg>::bunion(src, m_sm); }
 
     void bunion(UINT elem)
-    { DBitSetCore<BitsPerSeg>::bunion(elem, m_sm, &m_flst, m_pool);    }
+    { DBitSetCore<BitsPerSeg>::bunion(elem, m_sm); }
 
     void copy(DBitSet<BitsPerSeg> const& src)
-    { DBitSetCore<BitsPerSeg>::copy(src, m_sm, &m_flst, m_pool); }
+    { DBitSetCore<BitsPerSeg>::copy(src, m_sm); }
     //Count memory usage for current object.
     size_t count_mem() const
-    {
-        size_t count = sizeof(m_pool);
-        count += sizeof(m_flst);
-        count += sizeof(m_sm);
-        count += smpoolGetPoolSize(m_pool);
-        count += DBitSetCore<BitsPerSeg>::count_mem();
-        return count;
-    }
+    { return DBitSetCore<BitsPerSeg>::count_mem() + sizeof(m_sm); }
 
-    void clean() { DBitSetCore<BitsPerSeg>::clean(m_sm, &m_flst); }
+    void clean() { DBitSetCore<BitsPerSeg>::clean(m_sm); }
 
-    void diff(UINT elem) { DBitSetCore<BitsPerSeg>::diff(elem, m_sm, &m_flst); }
+    void diff(UINT elem) { DBitSetCore<BitsPerSeg>::diff(elem, m_sm); }
     void diff(DBitSet<BitsPerSeg> const& src)
-    { DBitSetCore<BitsPerSeg>::diff(src, m_sm, &m_flst); }
+    { DBitSetCore<BitsPerSeg>::diff(src, m_sm); }
 
     void intersect(DBitSet<BitsPerSeg> const& src)
-    { DBitSetCore<BitsPerSeg>::intersect(src, m_sm, &m_flst); }
+    { DBitSetCore<BitsPerSeg>::intersect(src, m_sm); }
 };
 
 
 //This class represent a BitSet Manager that is response for creating
-//and destory dense bitset, sparse bitset and dual bitset.
-#define MiscBitSetMgr_sc_free_list(sbs) ((sbs)->scflst)
-
+//and destory dense bitset, sparse bitset, dual bitset and hybrid bitset.
 template <UINT BitsPerSeg = BITS_PER_SEG>
 class MiscBitSetMgr {
     COPY_CONSTRUCTOR(MiscBitSetMgr);
@@ -777,8 +906,10 @@ protected:
     SList<SBitSet<BitsPerSeg>*> m_free_sbitset_list;
     SList<DBitSet<BitsPerSeg>*> m_free_dbitset_list;
     SList<DBitSetCore<BitsPerSeg>*> m_free_dbitsetcore_list;
+    SList<HBitSetCore<BitsPerSeg>*> m_free_hbitsetcore_list;
     SMemPool * m_sbitsetcore_pool;
     SMemPool * m_dbitsetcore_pool;
+    SMemPool * m_hbitsetcore_pool; //created at the first allocation.
 
 protected:
     SBitSetCore<BitsPerSeg> * xmalloc_sbitsetc()
@@ -802,14 +933,25 @@ protected:
         ::memset(p, 0, sizeof(DBitSetCore<BitsPerSeg>));
         return p;
     }
+
+    HBitSetCore<BitsPerSeg> * xmalloc_hbitsetc()
+    {
+        if (m_hbitsetcore_pool == nullptr) {
+            m_hbitsetcore_pool = smpoolCreate(
+                sizeof(HBitSetCore<BitsPerSeg>) * 10, MEM_CONST_SIZE);
+        }
+        HBitSetCore<BitsPerSeg> * p =
+            (HBitSetCore<BitsPerSeg>*)smpoolMallocConstSize(
+                sizeof(HBitSetCore<BitsPerSeg>), m_hbitsetcore_pool);
+        ASSERTN(p, ("malloc failed"));
+        ::memset(p, 0, sizeof(HBitSetCore<BitsPerSeg>));
+        return p;
+    }
 public:
     //SEG manager.
     SegMgr<BitsPerSeg> sm;
 
-    //Free list of SEGIter container. It will be allocated in ptr_pool.
-    TSEGIter * scflst;
-
-    //Only used to allocate SEGIter.
+    //Only used to allocate the containers of bitset lists.
     SMemPool * ptr_pool;
 
 public:
@@ -820,11 +962,13 @@ public:
     {
         if (ptr_pool != nullptr) { return; }
 
-        ptr_pool = smpoolCreate(sizeof(TSEGIter) * 10, MEM_CONST_SIZE);
+        ptr_pool = smpoolCreate(sizeof(SC<SBitSet<BitsPerSeg>*>) * 10,
+                                MEM_CONST_SIZE);
         m_sbitsetcore_pool = smpoolCreate(
             sizeof(SBitSetCore<BitsPerSeg>) * 10, MEM_CONST_SIZE);
         m_dbitsetcore_pool = smpoolCreate(
             sizeof(DBitSetCore<BitsPerSeg>) * 10, MEM_CONST_SIZE);
+        m_hbitsetcore_pool = nullptr;
 
         m_sbitset_list.set_pool(ptr_pool);
         m_dbitset_list.set_pool(ptr_pool);
@@ -833,8 +977,8 @@ public:
         m_free_sbitset_list.set_pool(ptr_pool);
         m_free_dbitset_list.set_pool(ptr_pool);
         m_free_dbitsetcore_list.set_pool(ptr_pool);
+        m_free_hbitsetcore_list.set_pool(ptr_pool);
 
-        scflst = nullptr;
         sm.init();
     }
 
@@ -860,13 +1004,16 @@ public:
 
         smpoolDelete(m_sbitsetcore_pool);
         smpoolDelete(m_dbitsetcore_pool);
+        if (m_hbitsetcore_pool != nullptr) {
+            smpoolDelete(m_hbitsetcore_pool);
+        }
         smpoolDelete(ptr_pool);
         sm.destroy();
 
         ptr_pool = nullptr;
         m_sbitsetcore_pool = nullptr;
         m_dbitsetcore_pool = nullptr;
-        scflst = nullptr;
+        m_hbitsetcore_pool = nullptr;
     }
 
     inline SBitSet<BitsPerSeg> * allocSBitSet()
@@ -908,9 +1055,18 @@ public:
         return p;
     }
 
+    inline HBitSetCore<BitsPerSeg> * allocHBitSetCore()
+    {
+        HBitSetCore<BitsPerSeg> * p = m_free_hbitsetcore_list.remove_head();
+        if (p == nullptr) {
+            p = xmalloc_hbitsetc();
+        }
+        return p;
+    }
+
     //Note that this function does not add up the memory allocated by
-    //allocSBitSetCore() and allocDBitSetCore(). You should count these
-    //objects additionally.
+    //allocSBitSetCore(), allocDBitSetCore() and allocHBitSetCore(). You
+    //should count these objects additionally.
     size_t count_mem(FILE * h = nullptr) const;
 
     //free bs for next use.
@@ -941,16 +1097,24 @@ public:
     inline void freeDBitSetCore(DBitSetCore<BitsPerSeg> * bs)
     {
         if (bs == nullptr) { return; }
-        bs->clean(&sm, &scflst);
+        bs->clean(&sm);
         m_free_dbitsetcore_list.append_head(bs);
     }
 
+    //Free bs for next use.
+    inline void freeHBitSetCore(HBitSetCore<BitsPerSeg> * bs)
+    {
+        if (bs == nullptr) { return; }
+        bs->clean(&sm);
+        m_free_hbitsetcore_list.append_head(bs);
+    }
+
     //This function destroy SEG objects and free containers back to
     //MiscBitSetMgr for next use.
     inline void destroySEGandFreeDBitSetCore(DBitSetCore<BitsPerSeg> * bs)
     {
         if (bs == nullptr) { return; }
-        bs->destroySEGandClean(&sm, &scflst);
+        bs->destroySEGandClean(&sm);
 
         //Recycle bitset.
         m_free_dbitsetcore_list.append_head(bs);
@@ -972,7 +1136,7 @@ typedef MiscBitSetMgr<> DefMiscBitSetMgr;
 #include "sbs.impl"
 
 //If you want to use different size SEG, then declare the new iter.
-typedef SC<DefSEG*> SEGIter; //Default SEG iter.
+typedef DefSEG SEGIter; //Default SEG iter.
 
 //Note the iterator of DefSBitSetCore, DBitSet, DBitSetCore are
 //same with DefSBitSet.
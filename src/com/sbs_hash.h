@@ -36,10 +36,11 @@ namespace xcom {
 #define MD2NODE2_INIT_SZ 8 //The size must be power of 2.
 
 //For given SBitSetCore, mapping MD to its subsequently MD elements via HMap.
-template <UINT BitsPerSeg = BITS_PER_SEG>
+template <UINT BitsPerSeg = BITS_PER_SEG,
+          class SetType = SBitSetCore<BitsPerSeg> >
 class Bit2NodeH {
 public:
-    SBitSetCore<BitsPerSeg> * set; //will be freed by sbs_mgr.
+    SetType * set; //will be freed by sbs_mgr.
     HMap<UINT, Bit2NodeH*, HashFuncBase2<UINT> > next;
 public:
     Bit2NodeH(UINT hash_tab_size = 16) : next(hash_tab_size) { set = nullptr; }
@@ -50,11 +51,12 @@ public:
 
 
 //For given SBitSetCore, mapping bit to its subsequently element via TMap.
-template <UINT BitsPerSeg = BITS_PER_SEG>
+template <UINT BitsPerSeg = BITS_PER_SEG,
+          class SetType = SBitSetCore<BitsPerSeg> >
 class Bit2NodeT {
     COPY_CONSTRUCTOR(Bit2NodeT);
 public:
-    SBitSetCore<BitsPerSeg> * set; //will be freed by sbs_mgr.
+    SetType * set; //will be freed by sbs_mgr.
     TMap<UINT, Bit2NodeT*> next;
 public:
     Bit2NodeT(SMemPool * pool = nullptr) : next(pool) { set = nullptr; }
@@ -77,26 +79,30 @@ public:
 //Allocator should supply three method: alloc, free, getBsMgr.
 //e.g: class Allocator {
 //   public:
-//   SBitSetCore<BitsPerSeg> * alloc();
-//   void free(SBitSetCore<BitsPerSeg>*);
+//   SetType * alloc();
+//   void free(SetType*);
 //   MiscBitSetMgr<BitsPerSeg> * getBsMgr() const;
 // }
-template <class Allocator, UINT BitsPerSeg = BITS_PER_SEG>
+//SetType is the type of hashed set, it can be SBitSetCore or HBitSetCore,
+//which supplies copy(), is_equal(), dump() and the iteration with SEG
+//iterator.
+template <class Allocator, UINT BitsPerSeg = BITS_PER_SEG,
+          class SetType = SBitSetCore<BitsPerSeg> >
 class SBitSetCoreHash {
     COPY_CONSTRUCTOR(SBitSetCoreHash);
 protected:
     SMemPool * m_pool;    
     Allocator * m_allocator;
-    List<SBitSetCore<BitsPerSeg>*> m_bit2node_set_list;
+    List<SetType*> m_bit2node_set_list;
 
     #ifdef _DEBUG_
     UINT m_num_node; //record the number of MD2Node in the tree.
     #endif
 
     #ifdef _BIT2NODE_IN_HASH_
-    typedef Bit2NodeH<BitsPerSeg> B2NType;
+    typedef Bit2NodeH<BitsPerSeg, SetType> B2NType;
     #else
-    typedef Bit2NodeT<BitsPerSeg> B2NType;
+    typedef Bit2NodeT<BitsPerSeg, SetType> B2NType;
     SMemPool * m_rbtn_pool; //pool to store RBTNType.
     #endif
 
@@ -122,7 +128,7 @@ protected:
 
     //dump_helper for SBitSetCore.
     void dump_helper_set(FILE * h,
-                         SBitSetCore<BitsPerSeg> const* set,
+                         SetType const* set,
                          UINT indent,
                          UINT id) const
     {
@@ -132,7 +138,7 @@ protected:
         fprintf(h, "%d", id);
         if (set == nullptr) { return; }
         fprintf(h, " {");
-        SEGIter * iter = nullptr;
+        SEG<BitsPerSeg> * iter = nullptr;
         for (INT j = set->get_first(&iter); j >= 0;) {
             fprintf(h, "%d", j);
             j = set->get_next((UINT)j, &iter);
@@ -204,7 +210,7 @@ public:
         m_bit2node = new B2NType(MD2NODE2_INIT_SZ);
         #else
         m_rbtn_pool = smpoolCreate(
-            sizeof(RBTNode<UINT, Bit2NodeT<BitsPerSeg>*>) * 4,
+            sizeof(RBTNode<UINT, B2NType*>) * 4,
             MEM_CONST_SIZE);
         m_bit2node = new B2NType();
         #endif
@@ -281,8 +287,8 @@ public:
             mn->next.destroy();
         }
         #else
-        C<SBitSetCore<BitsPerSeg>*> * ct = nullptr;
-        for (SBitSetCore<BitsPerSeg>* set = m_bit2node_set_list.get_head(&ct);
+        C<SetType*> * ct = nullptr;
+        for (SetType* set = m_bit2node_set_list.get_head(&ct);
              ct != m_bit2node_set_list.end();
              set = m_bit2node_set_list.get_next(&ct)) {
             ASSERT0(set);
@@ -319,9 +325,9 @@ public:
         #endif
     }
 
-    SBitSetCore<BitsPerSeg> const* append(SBitSetCore<BitsPerSeg> const& set)
+    SetType const* append(SetType const& set)
     {
-        SEGIter * iter = nullptr;
+        SEG<BitsPerSeg> * iter = nullptr;
         INT id = set.get_first(&iter);
         if (id < 0) { return nullptr; }
 
@@ -345,7 +351,7 @@ public:
 
         ASSERT0(mn);
         if (mn->set == nullptr) {
-            SBitSetCore<BitsPerSeg> * s = m_allocator->alloc();
+            SetType * s = m_allocator->alloc();
             ASSERT0(s);
             s->copy(set, *m_allocator->getBsMgr());
             mn->set = s;
@@ -471,9 +477,9 @@ public:
     }
 
     //Return true if SBitSetCore pointer has been record in the hash.
-    bool find(SBitSetCore<BitsPerSeg> const& set) const
+    bool find(SetType const& set) const
     {
-        SEGIter * iter = nullptr;
+        SEG<BitsPerSeg> * iter = nullptr;
         INT id = set.get_first(&iter);
         if (id < 0) { return false; }
 
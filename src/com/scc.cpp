@@ -29,8 +29,6 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xcom {
 
-#define UNDEF_GROUP 0
-
 //
 //START SCC
 //
@@ -51,8 +49,8 @@ void SCC::init(Graph * g)
 {
     if (is_init()) { return; }
     m_g = g;
-    m_scc.init();
-    m_sbsmgr.init();
+    m_comp_num = 0;
+    m_scc_num = 0;
 }
 
 
@@ -60,118 +58,176 @@ void SCC::destroy()
 {
     if (!is_init()) { return; }
     m_g = nullptr;
-    for (VertexSet * vs = m_scc.get_head();
-         vs != nullptr; vs = m_scc.get_next()) {
-        vs->clean();
-    }
-    m_scc.destroy();
+    m_comp_num = 0;
+    m_scc_num = 0;
+    m_csr.clean();
+    m_comp.clean();
+    m_comp_off.clean();
+    m_comp_vex.clean();
+    m_is_scc.clean();
 }
 
 
-//Searchs for SCC starting from 'v'.
-//onpath: records vertices till in accessing stack.
-//visited: records vertices that have been visited.
-void SCC::scan(Vertex const* v, VertexSet & onpath, VertexSet & visited,
-               GAI & gai, UINT & count, Group2VertexSet & group2bs)
+//Find each strongly connected components, include minor or nest scc.
+//e.g:scc1 includes graph vertex 1,2,3,4; scc2 includes node 5,6.
+//    Both of them can be found.
+//The components are finished in reverse topological order, and numbered
+//from n downward in 'rindex', whereas the visiting order is numbered
+//from 1 upward, both of them share the same array, and 0 means the vertex
+//is not yet visited.
+void SCC::findSCC()
 {
     ASSERTN(is_init(), ("not yet initialized."));
-    gai.set_index(v->id(), count);
-    gai.set_group(v->id(), count);
-    visited.bunion(v->id());
-    count++;
-    ASSERT0(!onpath.is_contain(v->id()));
-    visited.bunion(v->id());
-    onpath.bunion(v->id());
-
-    UINT v_group = gai.get_group(v->id());
-    //Walk through each successors of 'v'
-    bool find_scc = false;
-    for (EdgeC * el = v->getOutList(); el != nullptr; el = el->get_next()) {
-        Vertex const* succ = el->getEdge()->to();
-        UINT succ_group = UNDEF_GROUP;
-        if (!visited.is_contain(succ->id())) {
-            scan(succ, onpath, visited, gai, count, group2bs);
-            succ_group = gai.get_group(succ->id());
-            v_group = gai.get_group(v->id());
-            v_group = MIN(v_group, succ_group);
-            gai.set_group(v->id(), MIN(v_group, succ_group));
-
-            if (succ_group == gai.get_index(succ->id())) {
-                //succ is critical vertex.
-                //TODO:record and dump critical vertex info.
+    m_g->freeze(m_csr);
+    UINT n = m_csr.getVertexNum();
+    m_comp.clean();
+    m_comp_num = 0;
+    if (n == 0) {
+        groupVertex();
+        return;
+    }
+    m_comp.set(n - 1, 0);
+    UINT * rindex = m_comp.get_vec();
+    Vector<UINT> cur_vec; //the next successor to visit of each vertex.
+    Vector<UINT> dfs_vec; //DFS stack.
+    Vector<UINT> stk_vec; //vertices that are waiting for a root.
+    Vector<BYTE> root_vec; //true if vertex is root of a component.
+    cur_vec.set(n - 1, 0);
+    dfs_vec.set(n - 1, 0);
+    stk_vec.set(n - 1, 0);
+    root_vec.set(n - 1, 0);
+    UINT * cur = cur_vec.get_vec();
+    UINT * dfs = dfs_vec.get_vec();
+    UINT * stk = stk_vec.get_vec();
+    BYTE * root = root_vec.get_vec();
+    UINT index = 1;
+    UINT c = n;
+    UINT stk_top = 0;
+    for (UINT s = 0; s < n; s++) {
+        if (rindex[s] != 0) { continue; }
+        UINT dfs_top = 0;
+        dfs[dfs_top++] = s;
+        rindex[s] = index++;
+        root[s] = true;
+        cur[s] = 0;
+        while (dfs_top != 0) {
+            UINT v = dfs[dfs_top - 1];
+            UINT const* succ = m_csr.getSuccBegin(v);
+            if (cur[v] < m_csr.getOutDegree(v)) {
+                UINT w = succ[cur[v]++];
+                if (rindex[w] == 0) {
+                    dfs[dfs_top++] = w;
+                    rindex[w] = index++;
+                    root[w] = true;
+                    cur[w] = 0;
+                } else if (rindex[w] < rindex[v]) {
+                    rindex[v] = rindex[w];
+                    root[v] = false;
+                }
+                continue;
             }
-        } else if (onpath.is_contain(succ->id())) {
-            succ_group = gai.get_group(succ->id());
-            v_group = gai.get_group(v->id());
-            v_group = MIN(v_group, succ_group);
-            gai.set_group(v->id(), v_group);
-        } else {
-            //The vertex may be included in other scc.
-        }
 
-        if (v_group == succ_group) {
-            find_scc = true;
+            //Finish visiting 'v'.
+            dfs_top--;
+            if (root[v]) {
+                index--;
+                while (stk_top != 0 && rindex[v] <= rindex[stk[stk_top - 1]]) {
+                    UINT w = stk[--stk_top];
+                    rindex[w] = c;
+                    index--;
+                }
+                rindex[v] = c;
+                c--;
+            } else {
+                stk[stk_top++] = v;
+            }
+            if (dfs_top != 0) {
+                //Finish the edge from parent to 'v'.
+                UINT u = dfs[dfs_top - 1];
+                if (rindex[v] < rindex[u]) {
+                    rindex[u] = rindex[v];
+                    root[u] = false;
+                }
+            }
         }
     }
+    ASSERT0(stk_top == 0);
 
-    if (find_scc) {
-        addToGroup(v, v_group, group2bs);
+    //Components are numbered in [c+1, n] in reverse topological order,
+    //renumber them in topological order from 0.
+    m_comp_num = n - c;
+    for (UINT i = 0; i < n; i++) {
+        rindex[i] -= c + 1;
     }
-    onpath.diff(v->id());
-    return;
+    groupVertex();
 }
 
 
-void SCC::addToGroup(Vertex const* v, UINT group, Group2VertexSet & group2bs)
+//Record vertices of each component contiguously, and determine the
+//components that are SCC.
+void SCC::groupVertex()
 {
-    VertexSet * p = group2bs.get(group);
-    if (p == nullptr) {
-        p = m_sbsmgr.allocSBitSet();
-        group2bs.set(group, p);
-        m_scc.append_tail(p);
+    UINT n = m_csr.getVertexNum();
+    m_comp_off.clean();
+    m_comp_vex.clean();
+    m_is_scc.clean();
+    m_scc_num = 0;
+    m_comp_off.set(m_comp_num, 0);
+    if (n == 0) { return; }
+    m_comp_vex.set(n - 1, 0);
+    UINT const* comp = m_comp.get_vec();
+    UINT * off = m_comp_off.get_vec();
+    UINT * vex = m_comp_vex.get_vec();
+    for (UINT i = 0; i < n; i++) {
+        off[comp[i] + 1]++;
+    }
+    for (UINT i = 0; i < m_comp_num; i++) {
+        off[i + 1] += off[i];
+    }
+    Vector<UINT> pos_vec;
+    pos_vec.set(m_comp_num - 1, 0);
+    UINT * pos = pos_vec.get_vec();
+    for (UINT i = 0; i < n; i++) {
+        vex[off[comp[i]] + pos[comp[i]]++] = m_csr.getId(i);
+    }
+    for (UINT i = 0; i < m_comp_num; i++) {
+        if (off[i + 1] - off[i] > 1) {
+            m_is_scc.bunion(i);
+            m_scc_num++;
+        }
     }
-    p->bunion(v->id());
-}
-
 
-//Find each strongly connected components, include minor or nest scc.
-//e.g:scc1 includes graph vertex 1,2,3,4; scc2 includes node 5,6.
-//    Both of them can be found.
-void SCC::findSCC()
-{
-    ASSERTN(is_init(), ("not yet initialized."));
-    //Search for connected components
-    VertexSet visited(getSbsMgr()->getSegMgr());
-    VertexSet onpath(getSbsMgr()->getSegMgr());
-    GAI gai(m_g->is_dense());
-    UINT count = UNDEF_GROUP + 1;
-    Group2VertexSet group2bs;
-    VertexIter cur = VERTEX_UNDEF;
-    for (Vertex const* v = m_g->get_first_vertex(cur);
-         v != nullptr; v = m_g->get_next_vertex(cur)) {
-        if (visited.is_contain(v->id())) {
-            continue;
+    //A vertex that has an edge to itself is SCC.
+    for (UINT i = 0; i < n; i++) {
+        if (m_is_scc.is_contain(comp[i])) { continue; }
+        for (UINT const* s = m_csr.getSuccBegin(i);
+             s != m_csr.getSuccEnd(i); s++) {
+            if (*s == i) {
+                m_is_scc.bunion(comp[i]);
+                m_scc_num++;
+                break;
+            }
         }
-        onpath.clean();
-        scan(v, onpath, visited, gai, count, group2bs);
     }
-    return;
 }
 
 
-bool SCC::isInSCC(UINT vid, OUT VertexSet ** scc_vertex_set) const
+void SCC::getCondensation(OUT Graph & dag) const
 {
-    VertexSetIter it;
-    for (VertexSet * scc = m_scc.get_head(&it);
-         scc != nullptr; scc = m_scc.get_next(&it)) {
-        if (scc->is_contain(vid)) {
-            if (scc_vertex_set != nullptr) {
-                *scc_vertex_set = scc;
+    ASSERTN(is_init(), ("not yet initialized."));
+    for (UINT i = 0; i < m_comp_num; i++) {
+        dag.addVertex(i + 1);
+    }
+    UINT const* comp = m_comp.m_vec;
+    for (UINT i = 0; i < m_csr.getVertexNum(); i++) {
+        for (UINT const* s = m_csr.getSuccBegin(i);
+             s != m_csr.getSuccEnd(i); s++) {
+            if (comp[*s] != comp[i]) {
+                ASSERT0(comp[i] < comp[*s]);
+                dag.addEdge(comp[i] + 1, comp[*s] + 1);
             }
-            return true;
         }
     }
-    return false;
 }
 
 
@@ -179,11 +235,14 @@ void SCC::dump(FILE * h) const
 {
     ASSERT0(h);
     fprintf(h, "\nSCC INFO:\n");
-    VertexSetIter it;
-    for (VertexSet const* scc = m_scc.get_head(&it);
-         scc != nullptr; scc = m_scc.get_next(&it)) {
-        scc->dump(h);
+    for (UINT i = 0; i < m_comp_num; i++) {
+        if (!is_scc(i)) { continue; }
+        fprintf(h, "\nSCC%u:", i);
+        for (UINT const* v = getCompVexBegin(i); v != getCompVexEnd(i); v++) {
+            fprintf(h, " %u", *v);
+        }
     }
+    fprintf(h, "\n");
     fflush(h);
 }
 
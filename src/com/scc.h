@@ -31,106 +31,38 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xcom {
 
-//Group and Index
-class GAI {
-    BYTE m_is_dense:1;
-    union {
-        Vector<UINT> * dense;
-        TMap<UINT, UINT> * sparse;
-    } group;
-    union {
-        Vector<UINT> * dense;
-        TMap<UINT, UINT> * sparse;
-    } index;
-    COPY_CONSTRUCTOR(GAI);
-public:
-    GAI(bool is_dense)
-    {
-        if (is_dense) {
-            group.dense = new Vector<UINT>();
-            index.dense = new Vector<UINT>();
-        } else {
-            group.sparse = new TMap<UINT, UINT>();
-            index.sparse = new TMap<UINT, UINT>();
-        }
-        m_is_dense = is_dense;
-    }
-    ~GAI()
-    {
-        if (m_is_dense) {
-            delete group.dense;
-            delete index.dense;
-        } else {
-            delete group.sparse;
-            delete index.sparse;
-        }
-    }
-
-    void set_group(UINT idx, UINT group_val)
-    { 
-        if (m_is_dense) {
-            group.dense->set(idx, group_val);
-        } else {
-            group.sparse->setAlways(idx, group_val);
-        }
-    }
-
-    UINT get_group(UINT idx) const
-    { 
-        if (m_is_dense) {
-            return group.dense->get(idx);
-        }
-        return group.sparse->get(idx);
-    }
-
-    void set_index(UINT i, UINT idx)
-    { 
-        if (m_is_dense) {
-            index.dense->set(i, idx);
-        } else {
-            index.sparse->setAlways(i, idx);
-        }
-    }
-
-    UINT get_index(UINT i) const
-    { 
-        if (m_is_dense) {
-            return index.dense->get(i);
-        }
-        return index.sparse->get(i);
-    }
-};
-
-
 //The class finds all Strongly Connected Component on given graph.
+//The algorithm is the iterative variant of Pearce's algorithm, refer to
+//Pearce, "A Space-Efficient Algorithm for Finding Strongly Connected
+//Components". It runs on the CSRGraph snapshot of graph, and uses plain
+//integer arrays instead of recursion and vertex sets, thus it is able to
+//handle very deep graph.
+//Each vertex belongs to exactly one component, and components are numbered
+//in topological order of the condensation DAG, namely, if there is an edge
+//from component 'a' to component 'b', then a < b.
+//A component is regarded as SCC if it has more than one vertex, or its
+//only vertex has an edge to itself.
 //USAGE:
 //  Graph g;
 //  SCC s(&g);
 //  s.findSCC();
+//  s.isInSCC(vid);
 //  s.dump(h); //Dump SCC.
 class SCC {
-    //The map is used to loop up container rapidly.
-    typedef DefSBitSet VertexSet;
-    typedef List<VertexSet const*> ConstVertexSetList;
-    typedef List<VertexSet*> VertexSetList;
-    typedef C<VertexSet*> * VertexSetIter;
-    typedef TMap<UINT, VertexSet*> Group2VertexSet;
-
-    //BitSetMgr m_bsmgr;
-    DefMiscBitSetMgr m_sbsmgr;
-
+    COPY_CONSTRUCTOR(SCC);
     Graph * m_g;
-    VertexSetList m_scc;
+    CSRGraph m_csr; //snapshot of graph when finding SCC.
+    UINT m_comp_num; //the number of components, include trivial one.
+    UINT m_scc_num; //the number of components that are SCC.
+    Vector<UINT> m_comp; //component of each vertex index.
+    //Vertices of component 'c' are recorded in
+    //m_comp_vex[m_comp_off[c], m_comp_off[c+1]) by vertex id.
+    Vector<UINT> m_comp_off;
+    Vector<UINT> m_comp_vex;
+    BitSet m_is_scc; //record the component that is SCC.
 
-    void addToGroup(Vertex const* v, UINT group, Group2VertexSet & group2bs);
-    DefMiscBitSetMgr * getSbsMgr() { return &m_sbsmgr; }
     bool is_init() const { return m_g != nullptr; }
-
-    //Searchs for scc starting from 'v'.
-    //onpath: records vertices still in accessing stack.
-    //visited: records vertices have been found.
-    void scan(Vertex const* v, VertexSet & onpath, VertexSet & visited,
-              GAI & gai, UINT & count, Group2VertexSet & group2bs);
+    void groupVertex();
 public:
     SCC(Graph * g);
     ~SCC();
@@ -142,16 +74,67 @@ public:
     //    Both of them can be found.
     void findSCC();
 
+    //Return the CSRGraph snapshot that components are computed on.
+    CSRGraph const& getCSR() const { return m_csr; }
+
+    //Return the component of vertex index 'idx' of the snapshot.
+    UINT getCompByIdx(UINT idx) const
+    {
+        ASSERT0(idx < m_csr.getVertexNum());
+        return m_comp.m_vec[idx];
+    }
+
+    //Return the number of components, include the components that are not
+    //SCC.
+    UINT getCompNum() const { return m_comp_num; }
+
+    //Return the number of components that are SCC.
+    UINT getSCCNum() const { return m_scc_num; }
+
+    //Return the component of vertex 'vid', or CSR_UNDEF if the vertex is
+    //not found.
+    UINT getComp(UINT vid) const
+    {
+        UINT idx = m_csr.getIdx(vid);
+        return idx == CSR_UNDEF ? CSR_UNDEF : m_comp.get(idx);
+    }
+
+    //Iterate vertex id of component 'comp'.
+    //e.g: for (UINT const* v = s.getCompVexBegin(c);
+    //          v != s.getCompVexEnd(c); v++) { ... }
+    UINT const* getCompVexBegin(UINT comp) const
+    {
+        ASSERT0(comp < m_comp_num);
+        return m_comp_vex.m_vec + m_comp_off.m_vec[comp];
+    }
+    UINT const* getCompVexEnd(UINT comp) const
+    {
+        ASSERT0(comp < m_comp_num);
+        return m_comp_vex.m_vec + m_comp_off.m_vec[comp + 1];
+    }
+
+    //Build the condensation DAG of graph, each component is a vertex, and
+    //the vertex id is component plus one. The vertices are added in
+    //topological order.
+    void getCondensation(OUT Graph & dag) const;
+
     void init(Graph * g);
 
-    //Return true if 'v' is in SCC, and records the SCC in 'scc_vertex_set'.
-    bool isInSCC(Vertex const* v,
-                 OUT VertexSet ** scc_vertex_set = nullptr) const
-    { return isInSCC(v->id(), scc_vertex_set); }
+    //Return true if component 'comp' is SCC.
+    bool is_scc(UINT comp) const { return m_is_scc.is_contain(comp); }
+
+    //Return true if 'v' is in SCC, and records the component in 'comp'.
+    bool isInSCC(Vertex const* v, OUT UINT * comp = nullptr) const
+    { return isInSCC(v->id(), comp); }
+
+    //Return true if 'v' is in SCC, and records the component in 'comp'.
+    bool isInSCC(UINT vid, OUT UINT * comp = nullptr) const
+    {
+        UINT c = getComp(vid);
+        if (comp != nullptr) { *comp = c; }
+        return c != CSR_UNDEF && is_scc(c);
+    }
 
-    //Return true if 'v' is in SCC, and records the SCC in 'scc_vertex_set'.
-    bool isInSCC(UINT vid, OUT VertexSet ** scc_vertex_set = nullptr) const;
-    
     void dump(FILE * h) const;
 };
 
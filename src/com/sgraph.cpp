@@ -71,6 +71,7 @@ Graph::Graph(UINT edge_hash_size, UINT vex_hash_size) : m_edgetab(self())
     m_ec_pool = nullptr;
     m_dense_vertex = nullptr; //default vertex layout is sparse.
     m_sparse_vertex = nullptr;
+    m_change_count = 0;
     init();
 }
 
@@ -82,6 +83,7 @@ Graph::Graph(Graph const& g) : m_edgetab(self())
     m_ec_pool = nullptr;
     m_dense_vertex = nullptr; //default vertex layout is sparse.
     m_sparse_vertex = nullptr;
+    m_change_count = 0;
     init();
     clone(g, true, true);
 }
@@ -195,6 +197,7 @@ void Graph::destroy()
 void Graph::erase()
 {
     ASSERTN(m_ec_pool != nullptr, ("Graph must be initialized before clone."));
+    m_change_count++;
     if (is_dense()) {
         m_dense_vertex->destroy();
         m_dense_vertex->init();
@@ -302,6 +305,7 @@ Vertex * Graph::newVertex(UINT vid)
 {
     ASSERTN(m_vertex_pool, ("not yet initialized."));
     ASSERTN(vid != VERTEX_UNDEF, ("Use undefined vertex id"));
+    m_change_count++;
     Vertex * vex = m_v_free_list.get_free_elem();
     if (vex == nullptr) {
         vex = newVertex();
@@ -315,6 +319,7 @@ Edge * Graph::newEdge(Vertex * from, Vertex * to)
 {
     ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
     if (from == nullptr || to == nullptr) return nullptr;
+    m_change_count++;
     if (m_is_unique) {
         Edge placeholder;
         EDGE_from(&placeholder) = from;
@@ -466,6 +471,7 @@ Edge * Graph::removeEdge(Edge * e)
 {
     ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
     if (e == nullptr) { return nullptr; }
+    m_change_count++;
     Vertex * from = EDGE_from(e);
     Vertex * to = EDGE_to(e);
 
@@ -500,6 +506,7 @@ Vertex * Graph::removeVertex(Vertex * vex)
 {
     ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
     if (vex == nullptr) { return nullptr; }
+    m_change_count++;
     EdgeC * el = VERTEX_out_list(vex);
     //remove all out-edge
     while (el != nullptr) {
@@ -745,79 +752,70 @@ bool Graph::is_equal(Graph & g) const
 }
 
 
+void Graph::freeze(OUT CSRGraph & csr) const
+{
+    ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
+    csr.build(*this);
+}
+
+
+bool Graph::computeReach(OUT ReachMat & rm, ReachOpt const* opt,
+                         OUT ReachStat * stat)
+{
+    ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
+    return rm.build(this, opt, stat);
+}
+
+
 //Is there exist a path connect 'from' and 'to'.
+//The function does not use recursion, and each vertex is visited at most
+//once.
 bool Graph::is_reachable(Vertex * from, Vertex * to) const
 {
     ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
     ASSERTN(from != nullptr && to != nullptr, ("parameters cannot be nullptr"));
-    EdgeC * el = VERTEX_out_list(from);
-    Edge * e = nullptr;
-    if (el == nullptr) { return false; }
-
-    //Walk through each succ of 'from'
-    for (e = EC_edge(el); e != nullptr; el = EC_next(el),
-         e = el ? EC_edge(el):nullptr) {
-        Vertex * succ = EDGE_to(e);
-        if (VERTEX_id(succ) == VERTEX_id(to)) {
-            return true;
-        } else {
-            if (is_reachable(succ, to)) {
-                return true;
-            }
+    BitSet visited;
+    Vector<Vertex const*> stk;
+    UINT top = 0;
+    stk.set(top++, from);
+    while (top != 0) {
+        Vertex const* v = stk.get(--top);
+        for (EdgeC const* el = v->getOutList();
+             el != nullptr; el = el->get_next()) {
+            Vertex const* succ = el->getTo();
+            if (succ->id() == to->id()) { return true; }
+            if (visited.is_contain(succ->id())) { continue; }
+            visited.bunion(succ->id());
+            stk.set(top++, succ);
         }
-    } //end for
+    }
     return false;
 }
 
 
 //Sort graph vertices in topological order.
 //vex_vec: record vertics in topological order.
-//Return true if sorting success, otherwise there exist cycles in graph.
+//Return true if sorting success, otherwise there exist cycles in graph,
+//and the vertices that are in or after cycles are nullptr in 'vex_vec'.
 //Note you should NOT retrieve vertex in 'vex_vec' via vertex's index because
 //they are stored in dense manner.
+//The function sorts on the CSRGraph snapshot by in-degree counters.
 bool Graph::sortInTopologOrder(OUT Vector<Vertex*> & vex_vec)
 {
     ASSERTN(m_ec_pool != nullptr, ("Graph still not yet initialize."));
     if (getVertexNum() == 0) {
         return true;
     }
-    List<Vertex*> ready_list;
-    DefMiscBitSetMgr sm;
-    DefSBitSet is_removed(sm.getSegMgr());
-    VertexIter c = VERTEX_UNDEF;
-    for (xcom::Vertex * vex = get_first_vertex(c);
-         vex != nullptr; vex = get_next_vertex(c)) {
-        if (getInDegree(vex) == 0) {
-            ready_list.append_tail(vex);
-        }
-    }
+    CSRGraph csr;
+    freeze(csr);
+    Vector<UINT> order;
+    bool succ = csr.sortInTopologOrder(order);
     vex_vec.set(getVertexNum() - 1, nullptr);
-    UINT pos = 0;
-    for (; ready_list.get_elem_count() != 0;) {
-        Vertex * ready = ready_list.remove_head();
-        is_removed.bunion(ready->id());
-        vex_vec.set(pos, ready);
-        pos++;
-        for (xcom::EdgeC const* el = ready->getOutList();
-             el != nullptr; el = el->get_next()) {
-            Vertex * ready_succ = el->getTo();
-
-            //Determine if in-degree is not equal to 0.
-            UINT in_degree = 0;
-            for (xcom::EdgeC const* el2 = ready_succ->getInList();
-                 el2 != nullptr; el2 = el2->get_next()) {
-                Vertex const* ready_succ_pred = el2->getFrom();
-                if (is_removed.is_contain(ready_succ_pred->id())) {
-                    continue;
-                }
-                in_degree++;
-            }
-            if (in_degree == 0) {
-                ready_list.append_tail(ready_succ);
-            }
-        }
+    for (UINT i = 0; i < csr.getVertexNum(); i++) {
+        UINT idx = order[i];
+        vex_vec.set(i, idx == CSR_UNDEF ? nullptr : getVertex(csr.getId(idx)));
     }
-    return pos == getVertexNum() - 1;
+    return succ;
 }
 
 
@@ -853,21 +851,23 @@ void Graph::removeEdgeBetween(Vertex * v1, Vertex * v2)
 //transitive edge.
 //ALGO:
 //    INPUT: Graph with N vertices.
-//    1. Sort vertices in topological order.
-//    2. Associate each edges with indicator respective,
-//       and recording them in one matrix(N*N)
+//    1. Find SCC, and number components in topological order.
+//    2. Scan components in reverse topological order, and record the
+//       components that each component is able to reach in one bit
+//       matrix(N*N).
 //       e.g: e1:v0->v2, e2:v1->v2, e3:v0->v1
 //              0   1    2
-//            0 --  e3   e1
-//            1 --  --   e2
+//            0 --  1    1
+//            1 --  --   1
 //            2 --  --   --
 //
-//    3. Scan vertices according to toplogical order,
-//       remove all edges which the target-node has been
-//       marked at else rows.
+//    3. When scanning successors of a component in topological order,
+//       remove all edges which the target-node has been marked at the row
+//       of the component.
 //       e.g: There are dependence edges: v0->v1, v0->v2.
 //       If v1->v2 has been marked, we said v0->v2 is removable,
 //       and the same goes for the rest of edges.
+//    Edges inside SCC are kept. Refer to ReachMat for details.
 //e.g: E->D, A->D are transitive edges.
 //           E   A
 //         __|   |_
@@ -882,102 +882,24 @@ void Graph::removeEdgeBetween(Vertex * v1, Vertex * v2)
 //            \|/
 //             V
 //             D
-void Graph::removeTransitiveEdge()
-{
-    Vector<Vertex*> vex_vec;
-    sortInTopologOrder(vex_vec);
-    DefMiscBitSetMgr bs_mgr;
-    Vector<DefSBitSetCore*> reachset_vec;
-    TMap<UINT, DefSBitSetCore*> reachset_map;
-    BitSet is_visited;
-    //Scanning vertices in topological order.
-    for (INT i = 0; i <= vex_vec.get_last_idx(); i++) {
-        Vertex const* fromvex = vex_vec.get(i);
-        ASSERT0(fromvex);
-        if (is_dense()) {
-            removeTransitiveEdgeHelper(fromvex, &reachset_vec,
-                                       is_visited, bs_mgr);
-        } else {
-            removeTransitiveEdgeHelper(fromvex,
-                (Vector<DefSBitSetCore*>*)&reachset_map, is_visited, bs_mgr);
-        }
-    }
-    if (is_dense()) {
-        for (INT i = 0; i <= reachset_vec.get_last_idx(); i++) {
-            DefSBitSetCore * bs = reachset_vec.get(i);
-            if (bs != nullptr) {
-                bs->clean(bs_mgr);
-            }
-        }
-    } else {
-        TMapIter<UINT, DefSBitSetCore*> iter;
-        DefSBitSetCore * bs = nullptr;
-        for (reachset_map.get_first(iter, &bs);
-             bs != nullptr; reachset_map.get_next(iter, &bs)) {
-            bs->clean(bs_mgr);
-        }
-    }
-}
-
-
-void Graph::removeTransitiveEdgeHelper(Vertex const* fromvex,
-                                       Vector<DefSBitSetCore*> * reachset,
-                                       BitSet & is_visited,
-                                       DefMiscBitSetMgr & bs_mgr)
+void Graph::removeTransitiveEdge(ReachOpt const* opt, OUT ReachStat * stat)
 {
-    ASSERT0(reachset);
-    if (is_visited.is_contain(fromvex->id())) { return; }
-    is_visited.bunion(fromvex->id());
-
-    ASSERT0(fromvex);
-    if (fromvex->getOutList() == nullptr) { return; }
-
-    //Reachset defines the set of vertex that fromvex is able to reach.
-    DefSBitSetCore * from_reachset = is_dense() ?
-        reachset->get(fromvex->id()) :
-        ((TMap<UINT, DefSBitSetCore*>*)reachset)->get(fromvex->id());
-    if (from_reachset == nullptr) {
-        from_reachset = bs_mgr.allocSBitSetCore();
-        if (is_dense()) {
-            reachset->set(fromvex->id(), from_reachset);
-        } else {
-            ((TMap<UINT, DefSBitSetCore*>*)reachset)->set(fromvex->id(),
-                                                      from_reachset);
-        }
-    }
-
-    //Position in bitset has been sorted in topological order.
-    EdgeC const* next_ec = nullptr;
-    for (EdgeC const* ec = fromvex->getOutList(); ec != nullptr; ec = next_ec) {
-        next_ec = ec->get_next();
-        Vertex const* tovex = ec->getTo();
-
-        from_reachset->bunion(tovex->id(), bs_mgr);
-        removeTransitiveEdgeHelper(tovex, reachset, is_visited, bs_mgr);
-
-        //Reachset defines the set of vertex that tovex is able to reach.
-        DefSBitSetCore * to_reachset = is_dense() ?
-            reachset->get(tovex->id()) :
-            ((TMap<UINT, DefSBitSetCore*>*)reachset)->get(tovex->id());
-        if (to_reachset == nullptr) { continue; }
-        from_reachset->bunion(*to_reachset, bs_mgr);
-
-        //Get successor set correspond to to_dense.
-        if (tovex->getOutList() == nullptr) { continue; }
-
-        //Iterate other successors except 'to'.
-        EdgeC const* next_ec2 = nullptr;
-        for (EdgeC const* ec2 = fromvex->getOutList();
-             ec2 != nullptr; ec2 = next_ec2) {
-            next_ec2 = ec2->get_next();
-            Vertex const* othervex = ec2->getTo();
-            if (othervex == tovex || !to_reachset->is_contain(othervex->id())) {
-                continue;
-            }
-            if (next_ec == ec2) {
-                next_ec = ec->get_next();
+    ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
+    ReachMat rm;
+    rm.build(this, opt, stat);
+    if (rm.getTransEdgeNum() == 0) { return; }
+
+    //Successors of snapshot keep the order of out-list.
+    CSRGraph const& csr = rm.getCSR();
+    for (UINT i = 0; i < csr.getVertexNum(); i++) {
+        Vertex * v = getVertex(csr.getId(i));
+        UINT pos = csr.getSuccOff(i);
+        EdgeC * next = nullptr;
+        for (EdgeC * ec = v->getOutList(); ec != nullptr; ec = next, pos++) {
+            next = ec->get_next();
+            if (rm.is_trans(pos)) {
+                removeEdge(ec->getEdge());
             }
-            removeEdge(ec2->getEdge());
         }
     }
 }
@@ -1129,12 +1051,16 @@ bool Graph::tryFindLessRpo(Vertex * v, Vertex const* ref)
 DGraph::DGraph(UINT edge_hash_size, UINT vex_hash_size) :
     Graph(edge_hash_size, vex_hash_size)
 {
+    m_dom_change_count = 0;
+    m_pdom_change_count = 0;
     m_bs_mgr = nullptr;
 }
 
 
 DGraph::DGraph(DGraph const& g) : Graph(g)
 {
+    m_dom_change_count = 0;
+    m_pdom_change_count = 0;
     m_bs_mgr = g.m_bs_mgr;
     if (m_bs_mgr != nullptr) {
         cloneDomAndPdom(g);
@@ -1164,6 +1090,16 @@ bool DGraph::cloneDomAndPdom(DGraph const& src)
     }
     m_idom_set.copy(src.m_idom_set);
     m_ipdom_set.copy(src.m_ipdom_set);
+    m_dom_pre.copy(src.m_dom_pre);
+    m_dom_last.copy(src.m_dom_last);
+    m_pdom_pre.copy(src.m_pdom_pre);
+    m_pdom_last.copy(src.m_pdom_last);
+    //The intervals of 'src' are valid for current graph only if they are
+    //valid for 'src', which has same vertices and edges as current graph.
+    m_dom_change_count = src.m_dom_change_count == src.m_change_count ?
+                         m_change_count : m_change_count - 1;
+    m_pdom_change_count = src.m_pdom_change_count == src.m_change_count ?
+                          m_change_count : m_change_count - 1;
     return true;
 }
 
@@ -1174,6 +1110,10 @@ size_t DGraph::count_mem() const
     count += m_pdom_set.count_mem(); //record post-dominator-set of each vertex.
     count += m_idom_set.count_mem(); //immediate dominator.
     count += m_ipdom_set.count_mem(); //immediate post dominator.
+    count += m_dom_pre.count_mem();
+    count += m_dom_last.count_mem();
+    count += m_pdom_pre.count_mem();
+    count += m_pdom_last.count_mem();
     count += sizeof(m_bs_mgr); //Do NOT count up the bitset in BS_MGR.
     return count;
 }
@@ -1186,6 +1126,9 @@ size_t DGraph::count_mem() const
 //'uni': universe.
 bool DGraph::computeDom(List<Vertex const*> const* vlst, BitSet const* uni)
 {
+    //The interval of dominator tree is out of date.
+    m_dom_pre.clean();
+    m_dom_last.clean();
     List<Vertex const*> tmpvlst;
     List<Vertex const*> * pvlst = &tmpvlst;
     if (vlst != nullptr) {
@@ -1282,6 +1225,9 @@ bool DGraph::computeDom(List<Vertex const*> const* vlst, BitSet const* uni)
 //'uni': universe.
 bool DGraph::computeDom3(List<Vertex const*> const* vlst, BitSet const* uni)
 {
+    //The interval of dominator tree is out of date.
+    m_dom_pre.clean();
+    m_dom_last.clean();
     DUMMYUSE(uni);
     List<Vertex const*> tmpvlst;
     List<Vertex const*> * pvlst = &tmpvlst;
@@ -1408,6 +1354,9 @@ bool DGraph::computePdom(List<Vertex const*> const* vlst)
 //uni: universe.
 bool DGraph::computePdom(List<Vertex const*> const* vlst, BitSet const* uni)
 {
+    //The interval of post dominator tree is out of date.
+    m_pdom_pre.clean();
+    m_pdom_last.clean();
     ASSERT0(vlst && uni);
 
     //Initialize pdom for each bb
@@ -1506,6 +1455,9 @@ bool DGraph::computeDom2(List<Vertex const*> const& vlst)
 //    3. Entry does not have idom.
 bool DGraph::computeIdom2(List<Vertex const*> const& vlst)
 {
+    //The interval of dominator tree is out of date.
+    m_dom_pre.clean();
+    m_dom_last.clean();
     bool change = true;
 
     //Initialize idom-set for each BB.
@@ -1604,6 +1556,9 @@ bool DGraph::computeIdom2(List<Vertex const*> const& vlst)
 //NOTE: Entry does not have idom.
 bool DGraph::computeIdom()
 {
+    //The interval of dominator tree is out of date.
+    m_dom_pre.clean();
+    m_dom_last.clean();
     //Initialize idom-set for each BB.
     m_idom_set.clean();
 
@@ -1730,9 +1685,69 @@ Vertex * Graph::get_next_vertex(VertexIter & cur) const
 }
 
 
+//Record idom computed on 'csr' by vertex id, and number the vertices of
+//dominator tree.
+void DGraph::setDomTree(CSRGraph const& csr, Vector<UINT> const& idom,
+                        OUT Vector<INT> & idom_set, OUT Vector<UINT> & pre,
+                        OUT Vector<UINT> & last)
+{
+    Vector<UINT> tpre;
+    Vector<UINT> tlast;
+    csr.computeTreeInterval(idom, tpre, tlast);
+    idom_set.clean();
+    pre.clean();
+    last.clean();
+    for (UINT i = 0; i < csr.getVertexNum(); i++) {
+        UINT id = csr.getId(i);
+        if (idom[i] != CSR_UNDEF) {
+            idom_set.set(id, (INT)csr.getId(idom[i]));
+        }
+        pre.set(id, tpre[i]);
+        last.set(id, tlast[i]);
+    }
+}
+
+
+//NOTE: Entry does not have idom.
+bool DGraph::computeIdomBySemiNCA(CSRGraph const* csr)
+{
+    CSRGraph tmp;
+    if (csr == nullptr) {
+        freeze(tmp);
+        csr = &tmp;
+    }
+    ASSERT0(csr->getVertexNum() == getVertexNum());
+    Vector<UINT> idom;
+    csr->computeIdom(idom);
+    setDomTree(*csr, idom, m_idom_set, m_dom_pre, m_dom_last);
+    m_dom_change_count = m_change_count;
+    return true;
+}
+
+
+//NOTE: graph exit vertex does not have ipdom.
+bool DGraph::computeIpdomBySemiNCA(CSRGraph const* csr)
+{
+    CSRGraph tmp;
+    if (csr == nullptr) {
+        freeze(tmp);
+        csr = &tmp;
+    }
+    ASSERT0(csr->getVertexNum() == getVertexNum());
+    Vector<UINT> ipdom;
+    csr->computeIpdom(ipdom);
+    setDomTree(*csr, ipdom, m_ipdom_set, m_pdom_pre, m_pdom_last);
+    m_pdom_change_count = m_change_count;
+    return true;
+}
+
+
 //NOTE: graph exit vertex does not have ipdom.
 bool DGraph::computeIpdom()
 {
+    //The interval of post dominator tree is out of date.
+    m_pdom_pre.clean();
+    m_pdom_last.clean();
     //Initialize ipdom-set for each BB.
     m_ipdom_set.clean();
 
@@ -47,6 +47,10 @@ class Edge;
 class EdgeC;
 class Graph;
 class BMat;
+class CSRGraph;
+class ReachMat;
+class ReachOpt;
+class ReachStat;
 
 #define EDGE_next(e) ((e)->next)
 #define EDGE_prev(e) ((e)->prev)
@@ -303,6 +307,9 @@ protected:
     UINT m_edge_hash_size;
     UINT m_vex_hash_size;
     UINT m_dense_vex_num; //record the number of vertex in dense mode.
+    //Count the changes of vertices and edges. The information derived from
+    //graph is stale if the count differs from the one at computing.
+    UINT m_change_count;
     //record vertex if vertex id is densen distribution.
     //map vertex id to vertex.
     Vector<Vertex*> * m_dense_vertex;
@@ -400,10 +407,6 @@ protected:
         return el;
     }
 
-    void removeTransitiveEdgeHelper(Vertex const* fromvex,
-                                    Vector<DefSBitSetCore*> * reachset_vec,
-                                    BitSet & is_visited,
-                                    DefMiscBitSetMgr & bs_mgr);
     Graph * self() { return this; }
 public:
     Graph(UINT edge_hash_size = 64, UINT vex_hash_size = 64);
@@ -454,6 +457,22 @@ public:
     void dumpVCG(CHAR const* name = nullptr) const;
     void dumpVexVector(Vector<Vertex*> const& vec, FILE * h);
 
+    //Build an immutable snapshot of graph in compressed sparse row form.
+    //Read-only algorithms run faster on the snapshot, refer to CSRGraph.
+    void freeze(OUT CSRGraph & csr) const;
+
+    //Compute reachability of each pair of vertices in bit-parallel manner.
+    //Use it instead of is_reachable() if there are many queries.
+    //opt: options of computation, e.g: the number of threads.
+    //stat: record statistics if it is not nullptr.
+    //Return true if the bit rows are built. The rows take about N*N/16
+    //bytes, where N is the number of SCCs plus vertices out of SCC, e.g:
+    //100000 components take 625MB. If it exceeds opt->max_row_mem, which
+    //defaults to 1GB, or allocation fails, 'rm' answers queries by search
+    //in linear memory and the function returns false.
+    bool computeReach(OUT ReachMat & rm, ReachOpt const* opt = nullptr,
+                      OUT ReachStat * stat = nullptr);
+
     //Return true if graph vertex id is dense.
     bool is_dense() const { return m_dense_vertex != nullptr; }
     //Return true if 'succ' is successor of 'v'.
@@ -579,7 +598,13 @@ public:
         ASSERTN(m_ec_pool != nullptr, ("not yet initialized."));
         return removeVertex(getVertex(vid));
     }
-    void removeTransitiveEdge();
+    //Remove transitive edges, refer to ReachMat for the algorithm.
+    //opt: options of computation, e.g: the number of threads.
+    //stat: record statistics if it is not nullptr.
+    //The memory is bounded as computeReach() says, which falls back to
+    //searching that takes linear memory and O(N*(N+E)) time.
+    void removeTransitiveEdge(ReachOpt const* opt = nullptr,
+                              OUT ReachStat * stat = nullptr);
 
     //Sort graph vertices in topological order.
     //vex_vec: record vertics in topological order.
@@ -646,8 +671,23 @@ protected:
     Vector<BitSet*> m_pdom_set; //record post-dominator-set of each vertex.
     Vector<INT> m_idom_set; //immediate dominator.
     Vector<INT> m_ipdom_set; //immediate post dominator.
+    //Preorder number of each vertex in dominator tree, and the max preorder
+    //number in its subtree. They are computed along with idom by Semi-NCA,
+    //and answer is_dom() in O(1).
+    Vector<UINT> m_dom_pre;
+    Vector<UINT> m_dom_last;
+    //Preorder interval of each vertex in post dominator tree.
+    Vector<UINT> m_pdom_pre;
+    Vector<UINT> m_pdom_last;
+    //The change count of graph when the intervals are computed. Intervals
+    //are not used if graph has been changed since then.
+    UINT m_dom_change_count;
+    UINT m_pdom_change_count;
     BitSetMgr * m_bs_mgr;
     void _removeUnreachNode(UINT id, BitSet & visited);
+    void setDomTree(CSRGraph const& csr, Vector<UINT> const& idom,
+                    OUT Vector<INT> & idom_set, OUT Vector<UINT> & pre,
+                    OUT Vector<UINT> & last);
 public:
     DGraph(UINT edge_hash_size = 64, UINT vex_hash_size = 64);
     DGraph(DGraph const& g);
@@ -672,6 +712,16 @@ public:
     bool computeIdom();
     //Compute immediate dominate vertex.
     bool computeIdom2(List<Vertex const*> const& vlst);
+    //Compute immediate dominate vertex by Semi-NCA algorithm in near linear
+    //time, all graph entries are regarded as root.
+    //The dominator sets are not computed, use computeDom2() to compute them
+    //from idom if needed.
+    //csr: snapshot of current graph, it is built inside if csr is nullptr.
+    bool computeIdomBySemiNCA(CSRGraph const* csr = nullptr);
+    //Compute immediate post dominate vertex by Semi-NCA algorithm, all
+    //graph exits are regarded as root.
+    //The post dominator sets are not computed.
+    bool computeIpdomBySemiNCA(CSRGraph const* csr = nullptr);
     //Compute immediate post dominate vertex.
     //NOTE: graph exit vertex does not have idom.
     bool computeIpdom();
@@ -700,6 +750,9 @@ public:
     inline BitSet * get_dom_set(UINT id)
     {
         ASSERT0(m_bs_mgr != nullptr);
+        //Set may be modified, the interval of dominator tree is out of date.
+        m_dom_pre.clean();
+        m_dom_last.clean();
         BitSet * set = m_dom_set.get(id);
         if (set == nullptr) {
             set = m_bs_mgr->create();
@@ -723,6 +776,10 @@ public:
     inline BitSet * get_pdom_set(UINT id)
     {
         ASSERT0(m_bs_mgr != nullptr);
+        //Set may be modified, the interval of post dominator tree is out of
+        //date.
+        m_pdom_pre.clean();
+        m_pdom_last.clean();
         BitSet * set = m_pdom_set.get(id);
         if (set == nullptr) {
             set = m_bs_mgr->create();
@@ -740,15 +797,29 @@ public:
     }
 
     //Return true if 'v1' dominate 'v2'.
+    //The query is O(1) if idom is computed by computeIdomBySemiNCA() and
+    //graph is not changed since then.
     bool is_dom(UINT v1, UINT v2) const
     {
+        UINT pre2 = m_dom_pre.get(v2);
+        if (pre2 != 0 && m_dom_change_count == m_change_count) {
+            UINT pre1 = m_dom_pre.get(v1);
+            return pre1 != 0 && pre1 <= pre2 && pre2 <= m_dom_last.get(v1);
+        }
         ASSERTN(read_dom_set(v2), ("no DOM info about vertex%d", v2));
         return read_dom_set(v2)->is_contain(v1);
     }
 
     //Return true if 'v1' post dominate 'v2'.
+    //The query is O(1) if ipdom is computed by computeIpdomBySemiNCA() and
+    //graph is not changed since then.
     bool is_pdom(UINT v1, UINT v2) const
     {
+        UINT pre2 = m_pdom_pre.get(v2);
+        if (pre2 != 0 && m_pdom_change_count == m_change_count) {
+            UINT pre1 = m_pdom_pre.get(v1);
+            return pre1 != 0 && pre1 <= pre2 && pre2 <= m_pdom_last.get(v1);
+        }
         ASSERTN(read_pdom_set(v2), ("no PDOM info about vertex%d", v2));
         return read_pdom_set(v2)->is_contain(v1);
     }
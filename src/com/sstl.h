@@ -34,13 +34,119 @@ author: Su Zhenyu
 #ifndef __SSTL_H__
 #define __SSTL_H__
 
+#include <new>
+#include <utility>
+#include <type_traits>
+
 namespace xcom {
+//This class allocates memory from heap.
 template <class T> class allocator {
 public:
     allocator() throw() {}
     allocator (allocator const& alloc) throw() {}
     template <class U> allocator (allocator<U> const& alloc) throw() {}
     ~allocator() {}
+    allocator & operator = (allocator const&) throw() { return *this; }
+
+    //Allocate buffer that is able to hold 'num' elements.
+    T * allocate(size_t num) { return (T*)::malloc(sizeof(T) * num); }
+
+    //Reallocate buffer 'p' that hold 'orgnum' elements to hold 'num'
+    //elements, the buffer may be extended in place.
+    T * reallocate(T * p, size_t orgnum, size_t num)
+    {
+        DUMMYUSE(orgnum);
+        return (T*)::realloc(p, sizeof(T) * num);
+    }
+
+    //Free buffer 'p' that hold 'num' elements.
+    void deallocate(T * p, size_t num)
+    {
+        DUMMYUSE(num);
+        ::free(p);
+    }
+};
+
+
+//This class allocates memory from SMemPool.
+//Note the memory can not be freed one by one, it will be recycled when
+//the pool is deleted.
+template <class T> class PoolAllocator {
+    SMemPool * m_pool;
+public:
+    PoolAllocator() : m_pool(nullptr) {}
+    PoolAllocator(PoolAllocator const& src) : m_pool(src.m_pool) {}
+    PoolAllocator & operator = (PoolAllocator const& src)
+    { m_pool = src.m_pool; return *this; }
+
+    SMemPool * get_pool() const { return m_pool; }
+    void set_pool(SMemPool * pool) { m_pool = pool; }
+
+    T * allocate(size_t num)
+    {
+        ASSERTN(m_pool, ("pool is not set"));
+        return (T*)smpoolMalloc(sizeof(T) * num, m_pool);
+    }
+
+    T * reallocate(T * p, size_t orgnum, size_t num)
+    {
+        T * q = allocate(num);
+        if (p != nullptr) {
+            ::memcpy(q, p, sizeof(T) * MIN(orgnum, num));
+        }
+        return q;
+    }
+
+    void deallocate(T *, size_t) {}
+};
+
+
+//This class allocates buffer that holds no more than N elements from
+//the storage embedded in itself, and allocates from heap otherwise.
+//Note the embedded storage serves one buffer at a time.
+template <class T, UINT N> class InlineAllocator {
+    bool m_is_inline_used;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type m_inline;
+public:
+    InlineAllocator() : m_is_inline_used(false) {}
+    //The embedded storage is never shared.
+    InlineAllocator(InlineAllocator const&) : m_is_inline_used(false) {}
+    InlineAllocator & operator = (InlineAllocator const&) { return *this; }
+
+    T * get_inline() { return (T*)&m_inline; }
+
+    T * allocate(size_t num)
+    {
+        if (num <= N && !m_is_inline_used) {
+            m_is_inline_used = true;
+            return get_inline();
+        }
+        return (T*)::malloc(sizeof(T) * num);
+    }
+
+    T * reallocate(T * p, size_t orgnum, size_t num)
+    {
+        if (p != get_inline()) {
+            return (T*)::realloc(p, sizeof(T) * num);
+        }
+        if (num <= N) { return p; }
+        //Spill to heap.
+        T * q = (T*)::malloc(sizeof(T) * num);
+        ASSERT0(q);
+        ::memcpy((void*)q, (void const*)p, sizeof(T) * orgnum);
+        m_is_inline_used = false;
+        return q;
+    }
+
+    void deallocate(T * p, size_t num)
+    {
+        DUMMYUSE(num);
+        if (p == get_inline()) {
+            m_is_inline_used = false;
+            return;
+        }
+        ::free(p);
+    }
 };
 } //namespace xcom
 
@@ -175,6 +281,22 @@ inline void add_next(IN OUT T ** pheader, IN OUT T ** last, IN T * t)
 }
 
 
+//Append 't' to the tail of list, where 'last' caches the tail of list.
+//This is the O(1) alternative to add_next(pheader, t), which walks to the
+//tail on every appending. The cached tail is recomputed if it is nullptr,
+//thus the owner may reset it to nullptr after modifying the list in other
+//ways.
+//Note 't' may be a list, and 'last' is updated to the tail of 't'.
+template <class T>
+inline void append_tail(IN OUT T ** pheader, IN OUT T ** last, IN T * t)
+{
+    if (pheader == nullptr || t == nullptr) { return; }
+    ASSERT0(last);
+    if (*last == nullptr) { *last = get_last(*pheader); }
+    add_next(pheader, last, t);
+}
+
+
 template <class T>
 inline void remove(T ** pheader, T * t)
 {
@@ -197,6 +319,17 @@ inline void remove(T ** pheader, T * t)
 }
 
 
+//Remove 't' from list, and update the cached tail 'last'.
+template <class T>
+inline void remove(IN OUT T ** pheader, IN OUT T ** last, IN T * t)
+{
+    if (pheader == nullptr || t == nullptr) { return; }
+    ASSERT0(last);
+    if (*last == t) { *last = t->prev; }
+    remove(pheader, t);
+}
+
+
 //Swap t1 t2 in list.
 template <class T>
 inline void swap(T ** pheader, T * t1, T * t2)
@@ -2684,7 +2817,11 @@ public:
 //    2. The object allocated in heap.
 //    3. Zero is reserved and regard it as the default nullptr when we
 //    determine whether an element is exist.
-template <class T> class Vector {
+//    4. The buffer is allocated by 'Allocator', refer to allocator and
+//    PoolAllocator. The default argument is declared in comf.h.
+//    5. The elements that are trivially copyable are relocated bitwise when
+//    buffer grows, others are moved one by one.
+template <class T, class Allocator> class Vector : protected Allocator {
 protected:
     UINT m_elem_num:31; //The number of element in vector.
 
@@ -2696,24 +2833,29 @@ public:
     T * m_vec;
 
 public:
-    Vector()
+    Vector() : m_elem_num(0), m_is_init(true), m_last_idx(-1),
+        m_vec(nullptr) {}
+    explicit Vector(INT size) : m_elem_num(0), m_is_init(true),
+        m_last_idx(-1), m_vec(nullptr)
+    { grow(size); }
+    Vector(Vector const& vec) : Allocator(vec), m_elem_num(0),
+        m_is_init(true), m_last_idx(-1), m_vec(nullptr)
+    { copy(vec); }
+    //Move the buffer of 'vec' to current vector, 'vec' will be empty.
+    Vector(Vector && vec) : Allocator(vec)
     {
         m_is_init = false;
-        init();
+        takeVec(vec);
     }
-    explicit Vector(INT size)
-    {
-        m_is_init = false;
-        init();
-        grow(size);
-    }
-    Vector(Vector const& vec)
+    Vector const& operator = (Vector const&); //DISALBE COPY-CONSTRUCTOR.
+    Vector & operator = (Vector && vec)
     {
-        m_is_init = false;
-        init();
-        copy(vec);
+        if (this == &vec) { return *this; }
+        destroy();
+        Allocator::operator = (vec);
+        takeVec(vec);
+        return *this;
     }
-    Vector const& operator = (Vector const&); //DISALBE COPY-CONSTRUCTOR.
     ~Vector() { destroy(); }
 
     void append(T t)
@@ -2735,7 +2877,7 @@ public:
     {
         if (m_is_init) { return; }
         ASSERT0(size != 0);
-        m_vec = (T*)::malloc(sizeof(T) * size);
+        m_vec = this->allocate(size);
         ASSERT0(m_vec);
         ::memset(m_vec, 0, sizeof(T) * size);
         m_elem_num = size;
@@ -2748,10 +2890,10 @@ public:
     void destroy()
     {
         if (!m_is_init) { return; }
-        m_elem_num = 0;
         if (m_vec != nullptr) {
-            ::free(m_vec);
+            this->deallocate(m_vec, m_elem_num);
         }
+        m_elem_num = 0;
         m_vec = nullptr;
         m_last_idx = -1;
         m_is_init = false;
@@ -2762,10 +2904,12 @@ public:
     void destroy_vec()
     {
         if (m_vec != nullptr) {
-            ::free(m_vec);
+            this->deallocate(m_vec, m_elem_num);
         }
     }
 
+    Allocator & get_allocator() { return *this; }
+
     T get(UINT index) const
     {
         ASSERTN(is_init(), ("VECTOR not yet initialized."));
@@ -2826,7 +2970,9 @@ public:
             init(n);
         }
         if (n > 0) {
-            ::memcpy(m_vec, vec.m_vec, sizeof(T) * n);
+            //Elements are copied bitwise, since the slots that have not
+            //been set are zero-filled rather than constructed.
+            ::memcpy((void*)m_vec, (void const*)vec.m_vec, sizeof(T) * n);
         }
         m_last_idx = vec.m_last_idx;
     }
@@ -2843,7 +2989,16 @@ public:
     }
     //Count memory usage for current object.
     size_t count_mem() const
-    { return m_elem_num * sizeof(T) + sizeof(Vector<T>); }
+    { return m_elem_num * sizeof(T) + sizeof(Vector); }
+
+    //Reserve memory to hold at least 'num' elements.
+    void reserve(UINT num)
+    {
+        ASSERTN(is_init(), ("VECTOR not yet initialized."));
+        if (num > (UINT)m_elem_num) {
+            grow(num);
+        }
+    }
 
     //Place elem to vector according to index.
     //Growing vector if 'index' is greater than m_elem_num.
@@ -2851,7 +3006,8 @@ public:
     {
         ASSERTN(is_init(), ("VECTOR not yet initialized."));
         if (index >= (UINT)m_elem_num) {
-            grow(getNearestPowerOf2(index) + 2);
+            //Keep the capacity in power of 2 to double the buffer at least.
+            grow(MAX(getNearestPowerOf2(index + 1), 4u));
         }
         m_last_idx = MAX((INT)index, m_last_idx);
         m_vec[index] = elem;
@@ -2897,7 +3053,7 @@ public:
         if (num_of_elem == 0) { return; }
         if (m_elem_num == 0) {
             ASSERTN(m_vec == nullptr, ("vector should be nullptr if size is zero."));
-            m_vec = (T*)::malloc(sizeof(T) * num_of_elem);
+            m_vec = this->allocate(num_of_elem);
             ASSERT0(m_vec);
             ::memset(m_vec, 0, sizeof(T) * num_of_elem);
             m_elem_num = num_of_elem;
@@ -2905,18 +3061,89 @@ public:
         }
 
         ASSERT0(num_of_elem > (UINT)m_elem_num);
-        T * tmp = (T*)::malloc(num_of_elem * sizeof(T));
-        ASSERT0(tmp);
-        ::memcpy(tmp, m_vec, m_elem_num * sizeof(T));
-        ::memset(((CHAR*)tmp) + m_elem_num * sizeof(T), 0,
+        reallocVec(num_of_elem);
+        ::memset(((CHAR*)m_vec) + m_elem_num * sizeof(T), 0,
                  (num_of_elem - m_elem_num)* sizeof(T));
-        ::free(m_vec);
-        m_vec = tmp;
         m_elem_num = num_of_elem;
     }
 
+    //Release the memory that is not used by elements.
+    void shrink_to_fit()
+    {
+        ASSERTN(is_init(), ("VECTOR not yet initialized."));
+        UINT num = (UINT)(m_last_idx + 1);
+        if (num == (UINT)m_elem_num) { return; }
+        if (num == 0) {
+            this->deallocate(m_vec, m_elem_num);
+            m_vec = nullptr;
+            m_elem_num = 0;
+            return;
+        }
+        reallocVec(num);
+        m_elem_num = num;
+    }
+
     //Return true if there is not any element.
     bool is_empty() const { return get_last_idx() == -1; }
+protected:
+    //Reallocate buffer to hold 'num' elements, the elements that exceed
+    //'num' are dropped. Note m_elem_num is not updated.
+    void reallocVec(UINT num)
+    { reallocVec(num, std::is_trivially_copyable<T>()); }
+    void reallocVec(UINT num, std::true_type)
+    {
+        //The buffer might be extended in place.
+        m_vec = this->reallocate(m_vec, m_elem_num, num);
+        ASSERT0(m_vec);
+    }
+    //Element that is not trivially copyable is relocated one by one
+    //through its move constructor rather than by realloc().
+    void reallocVec(UINT num, std::false_type)
+    {
+        T * tmp = this->allocate(num);
+        ASSERT0(tmp);
+        UINT n = MIN((UINT)m_elem_num, num);
+        for (UINT i = 0; i < n; i++) {
+            ::new ((void*)(tmp + i)) T(std::move(m_vec[i]));
+            m_vec[i].~T();
+        }
+        this->deallocate(m_vec, m_elem_num);
+        m_vec = tmp;
+    }
+
+    //Take over the buffer of 'vec', and 'vec' will be empty.
+    void takeVec(Vector & vec)
+    {
+        m_elem_num = vec.m_elem_num;
+        m_is_init = vec.m_is_init;
+        m_last_idx = vec.m_last_idx;
+        m_vec = vec.m_vec;
+        vec.m_is_init = false;
+        vec.init();
+    }
+};
+
+
+//This class represents vector which buffer is allocated from 'pool'.
+//Note the memory is recycled when the pool is deleted.
+//e.g: PoolVector<INT> v(pool);
+//    v.set(10, 1);
+template <class T> class PoolVector : public Vector<T, PoolAllocator<T> > {
+public:
+    explicit PoolVector(SMemPool * pool)
+    { Vector<T, PoolAllocator<T> >::get_allocator().set_pool(pool); }
+};
+
+
+//This class represents vector that holds up to N elements in the object
+//itself, the buffer is allocated in heap only if vector grows beyond N.
+//e.g: SmallVector<UINT, 8> v;
+//    v.set(3, 10); //No heap allocation.
+template <class T, UINT N>
+class SmallVector : public Vector<T, InlineAllocator<T, N> > {
+    COPY_CONSTRUCTOR(SmallVector);
+public:
+    SmallVector() { Vector<T, InlineAllocator<T, N> >::grow(N); }
 };
 //END Vector
 
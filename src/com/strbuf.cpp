@@ -44,7 +44,7 @@ void StrBuf::strcat(UINT l, CHAR const* format, va_list args)
         buflen += l + 1;
         buf = (CHAR*)malloc(buflen);
         ::memcpy(buf, oldbuf, sl);
-        free(oldbuf);
+        freeBuf(oldbuf);
     }
     UINT k = VSNPRINTF(buf + sl, l + 1, format, args);
     ASSERT0(k == l);
@@ -36,6 +36,26 @@ public:
     CHAR * buf;
     UINT buflen;
 
+protected:
+    //Record the buffer embedded in derived class, it is not freed.
+    CHAR * m_inline_buf;
+
+    StrBuf(CHAR * inline_buf, UINT size)
+    {
+        ASSERT0(inline_buf && size > 0);
+        buflen = size;
+        buf = inline_buf;
+        buf[0] = 0;
+        m_inline_buf = inline_buf;
+    }
+
+    //Free the buffer if it is allocated in heap.
+    void freeBuf(CHAR * b)
+    {
+        if (b != nullptr && b != m_inline_buf) {
+            ::free(b);
+        }
+    }
 public:
     StrBuf(UINT initsize)
     {
@@ -43,13 +63,9 @@ public:
         buflen = initsize;
         buf = (CHAR*)::malloc(initsize);
         buf[0] = 0;
+        m_inline_buf = nullptr;
     }
-    ~StrBuf()
-    {
-        if (buf != nullptr) {
-            ::free(buf);
-        }
-    }
+    ~StrBuf() { freeBuf(buf); }
 
     void clean()
     {
@@ -97,5 +113,18 @@ public:
     void vstrcat(CHAR const* format, va_list args);
 };
 
+
+//This class represents string buffer that holds string of no more than
+//N bytes, including the terminating '\0', in the object itself. The
+//buffer is allocated in heap only if string grows beyond that.
+//e.g: SmallStrBuf<64> buf;
+//    buf.sprint("%s", name); //No heap allocation for short name.
+template <UINT N> class SmallStrBuf : public StrBuf {
+    COPY_CONSTRUCTOR(SmallStrBuf);
+    CHAR m_buf[N];
+public:
+    SmallStrBuf() : StrBuf(m_buf, N) {}
+};
+
 } //namespace xcom
 #endif
@@ -14,10 +14,15 @@ using namespace xcom;
 #include "strbuf.h"
 #include "comf.h" //used by sstl.h
 #include "sstl.h"
+#include "oahash.h"
+#include "btree.h"
+#include "arrlist.h"
 #include "bs.h"
 #include "sbs.h"
+#include "hbs.h"
 #include "sbs_hash.h"
 #include "sgraph.h"
+#include "csrgraph.h"
 #include "rational.h"
 #include "flty.h"
 #include "bigint.h"
@@ -30,5 +35,6 @@ using namespace xcom;
 #include "lpsol.h"
 #include "sort.h"
 #include "scc.h"
+#include "reachmat.h"
 #endif
 
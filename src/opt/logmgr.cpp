@@ -94,7 +94,7 @@ static void note_helper(LogMgr const* lm, CHAR const* format, va_list args)
 
     va_list targs;
     va_copy(targs, args);
-    StrBuf buf(64);
+    SmallStrBuf<64> buf;
     buf.vstrcat(format, targs);
     va_end(targs);
 
@@ -145,7 +145,7 @@ static void prt_helper(LogMgr const* lm, CHAR const* format, va_list args)
 
     va_list targs;
     va_copy(targs, args);
-    StrBuf buf(64);
+    SmallStrBuf<64> buf;
     buf.vstrcat(format, targs);
     va_end(targs);
 
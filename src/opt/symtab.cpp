@@ -39,7 +39,7 @@ Sym * SymTab::add(CHAR const* s)
         sym = (Sym*)smpoolMalloc(sizeof(Sym), m_pool);
     }
     SYM_name(sym) = const_cast<CHAR*>(s);
-    Sym * appended_one = TTab<Sym*, CompareSymTab>::append(sym);
+    Sym * appended_one = BTTab<Sym*, CompareSymTab>::append(sym);
     ASSERT0(m_free_one == nullptr || m_free_one == sym);
     if (appended_one != sym) {
         //'s' has already been appended.
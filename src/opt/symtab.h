@@ -147,11 +147,11 @@ public:
 //
 //START SymTab based on Hash
 //
-class SymTabHash : public Hash<Sym*, SymbolHashFunc> {
+class SymTabHash : public OAHash<Sym*, SymbolHashFunc> {
     COPY_CONSTRUCTOR(SymTabHash);
     SMemPool * m_pool;
 public:
-    explicit SymTabHash(UINT bsize) : Hash<Sym*, SymbolHashFunc>(bsize)
+    explicit SymTabHash(UINT bsize) : OAHash<Sym*, SymbolHashFunc>(bsize)
     { m_pool = smpoolCreate(64, MEM_COMM); }
     virtual ~SymTabHash() { smpoolDelete(m_pool); }
 
@@ -175,18 +175,12 @@ public:
     }
 
     //Add const string into symbol table.
-    //If the string table is not big enough to hold strings, expand it.
+    //The table grows by itself when it is not big enough to hold strings.
     inline Sym * add(CHAR const* s)
-    {
-        UINT sz = Hash<Sym*, SymbolHashFunc>::get_bucket_size() * 4;
-        if (sz < Hash<Sym*, SymbolHashFunc>::get_elem_count()) {
-            Hash<Sym*, SymbolHashFunc>::grow(sz);
-        }
-        return Hash<Sym*, SymbolHashFunc>::append((OBJTY)s);
-    }
+    { return OAHash<Sym*, SymbolHashFunc>::append((OBJTY)s); }
 
     Sym * get(CHAR const* s)
-    { return Hash<Sym*, SymbolHashFunc>::find((OBJTY)s); }
+    { return OAHash<Sym*, SymbolHashFunc>::find((OBJTY)s); }
 };
 //END SymTabHash
 
@@ -228,7 +222,7 @@ public:
 };
 
 
-class SymTab : public TTab<Sym*, CompareSymTab> {
+class SymTab : public BTTab<Sym*, CompareSymTab> {
     COPY_CONSTRUCTOR(SymTab);
     Sym * m_free_one;
     SMemPool * m_pool;
@@ -238,7 +232,7 @@ public:
     {
         m_pool = smpoolCreate(64, MEM_COMM);
         m_free_one = nullptr;
-        TTab<Sym*, CompareSymTab>::m_ck.m_pool = m_pool;
+        BTTab<Sym*, CompareSymTab>::m_ck.m_pool = m_pool;
         ASSERT0(m_pool);
     }
     virtual ~SymTab() { smpoolDelete(m_pool); }
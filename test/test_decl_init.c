@@ -0,0 +1,60 @@
+/*
+This program tests the lowering of array initializers, which keeps the
+constant elements of scalar arrays in a compact buffer, see InitData in
+src/cfe/decl.h. The initializers cover nested braces, partially
+initialized rows, rows initialized by string, size determined by
+initializer, and non-constant elements.
+
+The program is legal C and returns 0 if every element has the expected
+value. Run the front end and check INIT_DATA of each array in the dump:
+    ./xocfe.exe ../test/test_decl_init.c -decl-init -dump a.tmp
+*/
+int printf(char const* fmt, ...);
+
+int g_mat[2][3] = { { 1, 2, 3 }, { 4, 5 } };
+unsigned short g_us[] = { 65535, 1, 2 };
+char g_names[3][4] = { "ab", "cde", { 'f' } };
+float g_flt[2][2] = { { 1.5f, -2 }, { 0 } };
+long long g_ll[2][2][2] = { { { 1, -1 }, { 2 } }, { { 3 } } };
+
+static int g_err = 0;
+
+static void check(int cond, char const* name, int i)
+{
+    if (!cond) {
+        printf("%s[%d] is not expected\n", name, i);
+        g_err++;
+    }
+}
+
+static int nonconst(int a)
+{
+    int loc[2][3] = { { a, 2, 3 }, { 4, a + 1 } };
+    char str[] = "xyz";
+    int i;
+    int s = 0;
+    for (i = 0; i < 3; i++) {
+        s += loc[0][i] + loc[1][i];
+    }
+    check(sizeof(str) == 4 && str[2] == 'z' && str[3] == 0, "str", 0);
+    return s;
+}
+
+int main()
+{
+    int i;
+    int mat[6] = { 1, 2, 3, 4, 5, 0 };
+    for (i = 0; i < 6; i++) {
+        check(g_mat[i / 3][i % 3] == mat[i], "g_mat", i);
+    }
+    check(sizeof(g_us) == 3 * sizeof(unsigned short), "g_us", 0);
+    check(g_us[0] == 65535 && g_us[2] == 2, "g_us", 1);
+    check(g_names[0][1] == 'b' && g_names[0][2] == 0, "g_names", 0);
+    check(g_names[1][2] == 'e' && g_names[1][3] == 0, "g_names", 1);
+    check(g_names[2][0] == 'f' && g_names[2][1] == 0, "g_names", 2);
+    check(g_flt[0][1] == -2 && g_flt[1][1] == 0, "g_flt", 0);
+    check(g_ll[0][0][1] == -1 && g_ll[0][1][0] == 2, "g_ll", 0);
+    check(g_ll[1][0][0] == 3 && g_ll[1][1][1] == 0, "g_ll", 1);
+    check(nonconst(10) == 30, "nonconst", 0);
+    return g_err;
+}